@@ -0,0 +1,110 @@
+﻿/**
+ * @file main.cpp
+ * @brief 背景图缓存示例：大尺寸背景图下反复调整窗口尺寸，测量尺寸变化后的重绘耗时。
+ * @description
+ *     先生成一张 4032x3024 的 PPM 作为背景图（相机照片量级），窗口在 4 种尺寸之间循环拉伸，
+ *     每次都触发整窗重绘并按新尺寸绘制背景图。
+ *     结束后输出耗时、读盘解码次数、缓存统计，并打印最终帧的哈希。
+ *
+ *     用法: bk-image-bench [调整次数] [on|off] [背景图.ppm] [输出文件.ppm]
+ *       on  —— 默认，解码结果常驻 ImageCache，尺寸变化只在内存中缩放
+ *       off —— 每次尺寸变化都 loadimage 读盘 + 解码 + 缩放（旧行为）
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// 渐变 + 斜纹，缩小时有足够的高频细节
+	bool writeSource(const std::string& path, int w, int h)
+	{
+		FILE* fp = std::fopen(path.c_str(), "wb");
+		if (!fp) return false;
+		std::fprintf(fp, "P6\n%d %d\n255\n", w, h);
+		std::vector<unsigned char> row((std::size_t)w * 3);
+		for (int y = 0; y < h; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				const bool stripe = ((x + y) / 6) % 2 == 0;
+				row[(std::size_t)x * 3 + 0] = (unsigned char)(x * 255 / w);
+				row[(std::size_t)x * 3 + 1] = (unsigned char)(stripe ? 220 : 60);
+				row[(std::size_t)x * 3 + 2] = (unsigned char)(y * 255 / h);
+			}
+			std::fwrite(row.data(), 1, row.size(), fp);
+		}
+		std::fclose(fp);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int resizes = argc > 1 ? std::atoi(argv[1]) : 20;
+	const bool cached = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+	const std::string source = argc > 3 ? argv[3] : "bk-image-bench-source.ppm";
+	const std::string outFile = argc > 4 ? argv[4] : "";
+
+	if (!writeSource(source, 4032, 3024))
+	{
+		std::fprintf(stderr, "failed to write %s\n", source.c_str());
+		return 1;
+	}
+	StellarX::ImageCache::Get().setEnabled(cached);
+	// 本示例测的是尺寸变化后的缩放，首帧同步解码，保证每次调整尺寸时源图都已在内存中
+	StellarX::ImageCache::Get().setAsync(false);
+
+	// 初始尺寸即最小客户区，其余尺寸都比它大
+	Window mainWindow(1280, 720, 0, RGB(240, 240, 240), "StellarX background image bench");
+	for (int i = 0; i < 6; ++i)
+		mainWindow.addControl(std::make_unique<Button>(20 + i * 150, 20, 130, 36, "Button " + std::to_string(i)));
+	StellarX::ImageCache::Get().resetStats();   // 缓存统计含首次解码
+	mainWindow.draw(source);
+
+	// 1280x720 与 1600x900 不到源图的一半，走 mip 级；最后停在 2560x1440（纯双线性，on/off 帧一致）
+	struct Size { int w, h; };
+	const Size sizes[] = { { 1600, 900 }, { 1920, 1080 }, { 1280, 720 }, { 2560, 1440 } };
+	namespace H = StellarX::Headless;
+	for (int i = 0; i < resizes; ++i)
+	{
+		const Size& sz = sizes[i % 4];
+		H::postResize(sz.w, sz.h, 16);
+	}
+	if (resizes % 4)
+		H::postResize(2560, 1440, 16);
+	// 队列清空时事件循环即退出：最后再放一条消息，让最后一次尺寸变化也完成收口重绘
+	H::postMouse(WM_MOUSEMOVE, 5, 5, 16);
+
+	H::resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = H::stats();
+	const auto& cs = StellarX::ImageCache::Get().getStats();
+	const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	std::printf("image cache   : %s\n", cached ? "on" : "off");
+	std::printf("wall time     : %.3f ms (%.3f ms/resize)\n", ms, resizes ? ms / resizes : 0.0);
+	std::printf("presents      : %llu\n", (unsigned long long)st.presents);
+	std::printf("file loads    : %llu (during resizes)\n", (unsigned long long)st.imageLoads);
+	std::printf("cache         : %llu decodes, %llu hits, %llu rescales, %llu mip levels, %.1f MiB held\n",
+		(unsigned long long)cs.decodes, (unsigned long long)cs.hits, (unsigned long long)cs.rescales,
+		(unsigned long long)cs.mipLevels, cs.bytesHeld / 1048576.0);
+
+	// 最终帧哈希：on / off 必须相同
+	SetWorkingImage(nullptr);
+	std::printf("frame hash    : %016llx\n",
+		(unsigned long long)StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0));
+	if (!outFile.empty() && !H::dumpPPM(outFile))
+	{
+		std::fprintf(stderr, "failed to write %s\n", outFile.c_str());
+		return 1;
+	}
+	std::remove(source.c_str());
+	return 0;
+}
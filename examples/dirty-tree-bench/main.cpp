@@ -0,0 +1,131 @@
+﻿/**
+ * @file main.cpp
+ * @brief 代号制脏标记示例：深层嵌套画布树上整树标脏 / 清脏与脏查询的开销，并校验标记语义。
+ * @description
+ *     构造一棵嵌套 Canvas 树（每层 fanout 个子画布，横竖交替切分，叶子为按钮），挂到 1280x720 窗口上。
+ *       1) 整树标脏 / 清脏：对根画布反复 setDirty(true/false)，测每次调用的耗时（与树的规模无关）；
+ *       2) 脏查询：对每个叶子按钮调用 isDirty()（与父节点缓存的祖先代号比较，均摊 O(1)）；
+ *       3) 校验：整树标脏后所有节点为脏、整树清脏后全部干净、画完一帧后全部干净，
+ *          叶子自身标脏不影响兄弟与祖先；
+ *       4) 调整窗口尺寸若干次（每次整场景重绘），输出耗时与最终帧的哈希。
+ *
+ *     用法: dirty-tree-bench [深度] [每层子画布数] [调整次数]
+ */
+
+#include "StellarX.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	struct Tree
+	{
+		std::vector<Control*> nodes;    // 全部画布与按钮
+		std::vector<Button*> leaves;
+	};
+
+	// 在 (x, y, w, h) 内构造 depth 层子树；横竖交替切分
+	std::unique_ptr<Control> build(Tree& t, int x, int y, int w, int h, int depth, int fanout, bool horizontal)
+	{
+		if (depth == 0)
+		{
+			auto b = std::make_unique<Button>(x + 1, y + 1, (std::max)(4, w - 2), (std::max)(4, h - 2), "");
+			t.leaves.push_back(b.get());
+			t.nodes.push_back(b.get());
+			return b;
+		}
+		auto c = std::make_unique<Canvas>(x, y, w, h);
+		c->setCanvasBkColor(RGB(230 - depth * 12, 236 - depth * 8, 245));
+		t.nodes.push_back(c.get());
+		for (int i = 0; i < fanout; ++i)
+		{
+			const int cx = horizontal ? x + 2 + (w - 4) * i / fanout : x + 2;
+			const int cy = horizontal ? y + 2 : y + 2 + (h - 4) * i / fanout;
+			const int cw = horizontal ? (w - 4) / fanout : w - 4;
+			const int ch = horizontal ? h - 4 : (h - 4) / fanout;
+			c->addControl(build(t, cx, cy, cw, ch, depth - 1, fanout, !horizontal));
+		}
+		return c;
+	}
+
+	std::size_t countDirty(const std::vector<Control*>& nodes)
+	{
+		std::size_t n = 0;
+		for (Control* c : nodes)
+			n += c->isDirty() ? 1 : 0;
+		return n;
+	}
+
+	double nsPer(std::chrono::steady_clock::time_point t0, std::size_t n)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (double)n;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int depth = argc > 1 ? (std::max)(1, std::atoi(argv[1])) : 6;
+	const int fanout = argc > 2 ? (std::max)(1, std::atoi(argv[2])) : 3;
+	const int resizes = argc > 3 ? std::atoi(argv[3]) : 6;
+
+	Window mainWindow(1280, 720, 0, RGB(250, 250, 250), "StellarX dirty tree bench");
+	Tree tree;
+	auto rootOwner = build(tree, 10, 10, 1260, 700, depth, fanout, true);
+	Control* root = rootOwner.get();
+	mainWindow.addControl(std::move(rootOwner));
+	mainWindow.draw();
+
+	bool ok = countDirty(tree.nodes) == 0;
+
+	// 1) 整树标脏 / 清脏
+	const std::size_t marks = 200000;
+	auto t0 = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < marks; ++i)
+		root->setDirty((i & 1) == 0);
+	const double markNs = nsPer(t0, marks);
+
+	root->setDirty(true);
+	ok = ok && countDirty(tree.nodes) == tree.nodes.size();
+
+	// 2) 叶子脏查询
+	std::size_t dirtyLeaves = 0;
+	const int queryRounds = 200;
+	t0 = std::chrono::steady_clock::now();
+	for (int r = 0; r < queryRounds; ++r)
+		for (Button* b : tree.leaves)
+			dirtyLeaves += b->isDirty() ? 1 : 0;
+	const double queryNs = nsPer(t0, tree.leaves.size() * queryRounds);
+	ok = ok && dirtyLeaves == tree.leaves.size() * queryRounds;
+
+	// 3) 语义校验
+	root->setDirty(false);
+	ok = ok && countDirty(tree.nodes) == 0;
+	tree.leaves.front()->setDirty(true);
+	ok = ok && countDirty(tree.nodes) == 1 && tree.leaves.front()->isDirty();
+	root->setDirty(true);
+	root->draw();
+	ok = ok && countDirty(tree.nodes) == 0;
+
+	// 4) 整场景重绘
+	namespace H = StellarX::Headless;
+	for (int i = 0; i < resizes; ++i)
+		H::postResize(i % 2 ? 1280 : 1440, i % 2 ? 720 : 810, 16);
+	t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const double loopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	ok = ok && countDirty(tree.nodes) == 0;
+
+	std::printf("tree          : depth %d, fanout %d, %zu nodes (%zu leaves)\n", depth, fanout, tree.nodes.size(), tree.leaves.size());
+	std::printf("subtree mark  : %.1f ns per root setDirty\n", markNs);
+	std::printf("leaf isDirty  : %.1f ns per query (depth %d)\n", queryNs, depth);
+	std::printf("resize loop   : %.3f ms for %d resizes\n", loopMs, resizes);
+	std::printf("verify        : %s\n", ok ? "ok" : "FAILED");
+
+	SetWorkingImage(nullptr);
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash    : %016llx\n", (unsigned long long)hash);
+	return ok ? 0 : 1;
+}
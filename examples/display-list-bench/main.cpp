@@ -0,0 +1,162 @@
+﻿/**
+ * @file main.cpp
+ * @brief 显示列表示例：虚假重绘只花一次哈希比较，不重放、不提交。
+ * @description
+ *     面板(Canvas)里放若干按钮、标签与文本框，脚本包含两类重绘：
+ *       - 真实变化：悬停在可用按钮上、点击“刷新”按钮；
+ *       - 虚假重绘：悬停在禁用按钮上（悬停不改变禁用按钮的外观），
+ *         以及“刷新”回调把标签设成相同文本后 panel->setDirty(true) 递归标脏整块面板。
+ *     grid 场景：1920x1080 窗口铺满一块画布，里面 20x30 个按钮，鼠标在按钮间逐个移动——
+ *     大容器里只有一两个子控件真正变化，检查每次悬停的耗时与读屏幕像素的次数不随画布面积增长。
+ *     结束后输出显示列表的比较/跳过/重放次数、读像素求哈希的次数与后端统计，并打印最终帧的哈希。
+ *
+ *     用法: display-list-bench [panel|grid] [往返次数] [snapshot|compositor] [on|off] [输出文件.ppm]
+ *       panel —— 默认场景（首个参数不是场景名时即为 panel）
+ *       on  —— 默认，列表与屏幕像素未变时跳过重放
+ *       off —— 关闭跳过（每次都重放），用于对比统计与帧哈希
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	// 跑完脚本并输出统计；panel 与 grid 两个场景共用
+	int runScript(Window& mainWindow, const char* scene, int rounds, bool compositor, bool skip, const std::string& outFile, int refreshes)
+	{
+		namespace H = StellarX::Headless;
+		H::resetStats();
+		StellarX::DisplayList::resetStats();
+		const auto t0 = std::chrono::steady_clock::now();
+		mainWindow.runEventLoop();
+		const auto t1 = std::chrono::steady_clock::now();
+
+		const auto& st = H::stats();
+		const auto& dl = StellarX::DisplayList::stats();
+		const int events = rounds * 10;
+		const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+		std::printf("scene         : %s\n", scene);
+		std::printf("repaint mode  : %s, skip %s\n", compositor ? "compositor" : "snapshot", skip ? "on" : "off");
+		std::printf("events        : %d (%d refreshes)\n", events, refreshes);
+		std::printf("wall time     : %.3f ms (%.3f us/event)\n", ms, ms * 1000.0 / events);
+		std::printf("lists         : %llu recorded, %llu compared, %llu skipped, %llu replayed (%llu commands)\n",
+			(unsigned long long)dl.recorded, (unsigned long long)dl.compared, (unsigned long long)dl.skipped,
+			(unsigned long long)dl.replayed, (unsigned long long)dl.commandsReplayed);
+		std::printf("pixel hashes  : %llu reads, %.2f Mpx (%.1f kpx/event)\n",
+			(unsigned long long)dl.pixelHashes, dl.pixelsHashed / 1e6, dl.pixelsHashed / 1e3 / events);
+		std::printf("draw calls    : %llu\n", (unsigned long long)st.drawCalls);
+		std::printf("text calls    : %llu\n", (unsigned long long)st.textCalls);
+		std::printf("presents      : %llu\n", (unsigned long long)st.presents);
+		std::printf("bytes written : %llu\n", (unsigned long long)st.bytesWritten);
+
+		// 最终帧哈希：on / off 两次运行必须相同
+		SetWorkingImage(nullptr);
+		std::printf("frame hash    : %016llx\n",
+			(unsigned long long)StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0));
+		if (!outFile.empty() && !H::dumpPPM(outFile))
+		{
+			std::fprintf(stderr, "failed to write %s\n", outFile.c_str());
+			return 1;
+		}
+		return 0;
+	}
+
+	// 大容器悬停：铺满窗口的画布里 20 列 x 30 行按钮，鼠标逐个移过每个按钮
+	void buildGrid(Window& mainWindow, int rounds)
+	{
+		const int cols = 20, rows = 30, cellW = 96, cellH = 36;
+		auto grid = std::make_unique<Canvas>(0, 0, 1920, 1080);
+		grid->setCanvasBkColor(RGB(250, 250, 250));
+		for (int r = 0; r < rows; ++r)
+			for (int c = 0; c < cols; ++c)
+				grid->addControl(std::make_unique<Button>(c * cellW + 4, r * cellH + 4, cellW - 8, cellH - 8,
+					std::to_string(r * cols + c)));
+		mainWindow.addControl(std::move(grid));
+
+		namespace H = StellarX::Headless;
+		for (int i = 0; i < rounds * 10; ++i)
+		{
+			const int cell = (i * 7) % (cols * rows);
+			H::postMouse(WM_MOUSEMOVE, (cell % cols) * cellW + cellW / 2, (cell / cols) * cellH + cellH / 2, 16);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool gridScene = argc > 1 && std::strcmp(argv[1], "grid") == 0;
+	const int shift = argc > 1 && (gridScene || std::strcmp(argv[1], "panel") == 0) ? 1 : 0;
+	argc -= shift;
+	argv += shift;
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+	const bool compositor = argc > 2 && std::strcmp(argv[2], "compositor") == 0;
+	const bool skip = !(argc > 3 && std::strcmp(argv[3], "off") == 0);
+	const std::string outFile = argc > 4 ? argv[4] : "";
+
+	StellarX::DisplayList::setSkipEnabled(skip);
+	Window mainWindow(gridScene ? 1920 : 640, gridScene ? 1080 : 400, 0, RGB(240, 240, 240), "StellarX display list bench");
+	if (gridScene)
+	{
+		buildGrid(mainWindow, rounds);
+		mainWindow.setCompositorEnabled(compositor);
+		mainWindow.draw();
+		return runScript(mainWindow, "grid", rounds, compositor, skip, outFile, 0);
+	}
+
+	auto panel = std::make_unique<Canvas>(20, 80, 600, 300);
+	panel->setCanvasBkColor(RGB(250, 250, 250));
+	Canvas* panelPtr = panel.get();
+	for (int i = 0; i < 3; ++i)
+	{
+		panel->addControl(std::make_unique<Button>(20 + i * 190, 20, 170, 40, "Action " + std::to_string(i + 1)));
+		panel->addControl(std::make_unique<Button>(20 + i * 190, 80, 170, 40, "Locked " + std::to_string(i + 1),
+			StellarX::ButtonMode::DISABLED, StellarX::ControlShape::ROUND_RECTANGLE));
+	}
+	std::vector<Label*> values;
+	for (int i = 0; i < 4; ++i)
+	{
+		auto value = std::make_unique<Label>(20, 150 + i * 28, "metric " + std::to_string(i + 1) + ": " + std::to_string(100 + i * 7),
+			BLACK, RGB(250, 250, 250));
+		values.push_back(value.get());
+		panel->addControl(std::move(value));
+	}
+	panel->addControl(std::make_unique<TextBox>(300, 150, 280, 36, "status: idle", StellarX::TextBoxmode::READONLY_MODE));
+	mainWindow.addControl(std::move(panel));
+
+	// 刷新：重新写入相同的数值，再把整块面板标脏并登记重绘——典型的虚假重绘
+	auto refresh = std::make_unique<Button>(20, 20, 140, 40, "Refresh");
+	int refreshes = 0;
+	refresh->setOnClickListener([&]()
+		{
+			++refreshes;
+			for (size_t i = 0; i < values.size(); ++i)
+				values[i]->setText("metric " + std::to_string(i + 1) + ": " + std::to_string(100 + (int)i * 7));
+			panelPtr->setDirty(true);
+			mainWindow.requestManagedRepaint(panelPtr);
+		});
+	mainWindow.addControl(std::move(refresh));
+
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+
+	// 脚本：禁用按钮间往返悬停（虚假）→ 可用按钮悬停（真实）→ 点击刷新（按钮真实 + 面板虚假）
+	namespace H = StellarX::Headless;
+	for (int i = 0; i < rounds; ++i)
+	{
+		H::postMouse(WM_MOUSEMOVE, 120, 180, 16);
+		H::postMouse(WM_MOUSEMOVE, 300, 180, 16);
+		H::postMouse(WM_MOUSEMOVE, 500, 180, 16);
+		H::postMouse(WM_MOUSEMOVE, 330, 60, 16);   // 面板内空白处：离开禁用按钮
+		H::postMouse(WM_MOUSEMOVE, 120, 120, 16);  // Action 1
+		H::postMouse(WM_MOUSEMOVE, 330, 60, 16);
+		H::postMouse(WM_MOUSEMOVE, 90, 40, 16);    // Refresh
+		H::postMouse(WM_LBUTTONDOWN, 90, 40, 16);
+		H::postMouse(WM_LBUTTONUP, 90, 40, 16);
+		H::postMouse(WM_MOUSEMOVE, 330, 60, 16);
+	}
+
+	return runScript(mainWindow, "panel", rounds, compositor, skip, outFile, refreshes);
+}
@@ -0,0 +1,163 @@
+﻿/**
+ * @file main.cpp
+ * @brief 事件循环空闲等待示例：输入延迟、空闲唤醒次数、提示框到点显示、跨线程唤醒。
+ * @description
+ *     1920x1080 窗口放一排按钮（其中一个带 500 ms 延时的提示框），最上层的探针控件记录每条
+ *     鼠标移动被分发时的虚拟时钟。脚本分三段：
+ *       1) 300 条间隔 3~25 ms 不等的鼠标移动：分发时刻减去到期时刻即输入延迟；
+ *       2) 移到带提示框的按钮上后静止：延时到期前 1 ms 与后 1 ms 各关一次窗看提示框是否出现，
+ *          再静止到 2 秒，统计空闲期间事件循环醒了几次；
+ *       3) 关闭自动 WM_CLOSE、消息队列为空，后台线程解码一张大图，解码完成的回调里再关窗：
+ *          统计等待期间事件循环空转了几轮。
+ *       - event：StellarX::EventLoop 阻塞到输入 / 到期时刻 / wake()（默认）；
+ *       - poll：EventLoop::setEnabled(false)，每轮固定 Sleep(10)（原有行为）。
+ *     无头后端的 Sleep 与等待只推进虚拟时钟，第 1、2 段的毫秒数是虚拟时钟口径。
+ *
+ *     用法: event-loop-bench [event|poll] [鼠标移动条数]
+ */
+
+#include "StellarX.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// 最上层、不可见、不吞消息：记录每条鼠标移动被分发时的虚拟时钟
+	class Probe : public Button
+	{
+	public:
+		Probe() : Button(0, 0, 1, 1, "") { setIsVisible(false); }
+		bool handleEvent(const ExMessage& msg) override
+		{
+			if (msg.message == WM_MOUSEMOVE)
+				stamps.push_back(StellarX::Headless::now());
+			return false;
+		}
+		bool model() const override { return false; }
+		std::vector<ULONGLONG> stamps;
+	};
+
+	bool writeImage(const std::string& path, int w, int h)
+	{
+		FILE* fp = std::fopen(path.c_str(), "wb");
+		if (!fp) return false;
+		std::fprintf(fp, "P6\n%d %d\n255\n", w, h);
+		std::vector<unsigned char> row((std::size_t)w * 3);
+		for (int y = 0; y < h; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				row[x * 3 + 0] = (unsigned char)(x * 255 / w);
+				row[x * 3 + 1] = (unsigned char)(y * 255 / h);
+				row[x * 3 + 2] = (unsigned char)((x / 16 + y / 16) % 2 ? 200 : 90);
+			}
+			std::fwrite(row.data(), 1, row.size(), fp);
+		}
+		std::fclose(fp);
+		return true;
+	}
+
+	void printLoop(const char* phase)
+	{
+		const auto& s = StellarX::EventLoop::stats();
+		std::printf("%-14s: %llu waits (%llu blocked), wakes input %llu / posted %llu / deadline %llu, %llu polls\n", phase,
+			(unsigned long long)s.waits, (unsigned long long)s.blocked, (unsigned long long)s.inputWakes,
+			(unsigned long long)s.postWakes, (unsigned long long)s.deadlineWakes, (unsigned long long)s.polls);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool poll = argc > 1 && std::strcmp(argv[1], "poll") == 0;
+	const int moves = argc > 2 ? (std::max)(1, std::atoi(argv[2])) : 300;
+
+	namespace H_ = StellarX::Headless;
+	namespace EL = StellarX::EventLoop;
+	EL::setEnabled(!poll);
+
+	Window mainWindow(1920, 1080, 0, RGB(235, 238, 242), "StellarX event loop bench");
+	for (int i = 0; i < 8; ++i)
+		mainWindow.addControl(std::make_unique<Button>(40 + i * 200, 40, 180, 48, "Button " + std::to_string(i)));
+	auto tipOwner = std::make_unique<Button>(40, 200, 220, 48, "Hover me");
+	Button* tipButton = tipOwner.get();
+	tipButton->enableTooltip(true);
+	tipButton->setTooltipDelay(500);
+	tipButton->setTooltipText("Shown after 500 ms");
+	mainWindow.addControl(std::move(tipOwner));
+	auto probeOwner = std::make_unique<Probe>();
+	Probe* probe = probeOwner.get();
+	mainWindow.addControl(std::move(probeOwner));
+	mainWindow.draw();
+
+	std::printf("mode          : %s\n", poll ? "poll (Sleep(10) per pass)" : "event (wait for input / deadline / wake)");
+
+	// 1) 输入延迟：间隔不等的鼠标移动，到期时刻按脚本累计
+	std::vector<ULONGLONG> due;
+	ULONGLONG t = H_::now();
+	for (int i = 0; i < moves; ++i)
+	{
+		const unsigned delay = 3 + (unsigned)(i * 7 % 23);
+		t += delay;
+		due.push_back(t);
+		H_::postMouse(WM_MOUSEMOVE, 600 + i % 400, 600 + i % 300, delay);
+	}
+	EL::resetStats();
+	mainWindow.runEventLoop();
+	double sum = 0, worst = 0;
+	const std::size_t n = (std::min)(due.size(), probe->stamps.size());
+	for (std::size_t i = 0; i < n; ++i)
+	{
+		const double late = (double)(probe->stamps[i] - due[i]);
+		sum += late;
+		worst = (std::max)(worst, late);
+	}
+	std::printf("input latency : %zu moves over %llu ms, mean %.2f ms, worst %.0f ms\n",
+		n, (unsigned long long)(due.back() - due.front()), n ? sum / n : 0.0, worst);
+	printLoop("  loop");
+
+	// 2) 悬停后静止：延时到期前 1 ms 与后 1 ms 各关一次窗看提示框是否出现（到期由定时器驱动，
+	//    不补发鼠标移动），再静止到 2 秒统计空闲唤醒次数
+	probe->stamps.clear();
+	H_::postMouse(WM_MOUSEMOVE, 150, 224, 10);
+	H_::postClose(499);
+	EL::resetStats();
+	mainWindow.runEventLoop();
+	const bool shownBefore = tipButton->isTooltipVisible();
+	H_::postClose(2);
+	mainWindow.runEventLoop();
+	const bool shownAfter = tipButton->isTooltipVisible();
+	H_::postClose(1499);
+	mainWindow.runEventLoop();
+	std::printf("tooltip       : %s at +499 ms, %s at +501 ms after hover (delay 500 ms), %llu timer callback(s), %zu mouse move(s)\n",
+		shownBefore ? "shown" : "hidden", shownAfter ? "shown" : "hidden",
+		(unsigned long long)EL::stats().timersRun, probe->stamps.size());
+	printLoop("  idle 2 s");
+
+	// 3) 跨线程唤醒：队列为空时等后台解码，完成回调里关窗
+	const std::string image = "event-loop-bench-image.ppm";
+	if (!writeImage(image, 3000, 2000))
+	{
+		std::fprintf(stderr, "failed to write %s\n", image.c_str());
+		return 1;
+	}
+	auto& cache = StellarX::ImageCache::Get();
+	cache.setAsync(true);
+	H_::setAutoClose(false);
+	EL::resetStats();
+	const ULONGLONG virtualStart = H_::now();
+	const auto t0 = std::chrono::steady_clock::now();
+	auto asset = cache.acquire(image, 300, 200);
+	asset->whenReady([] { StellarX::Headless::postClose(); });
+	mainWindow.runEventLoop();
+	const double realMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	std::printf("decode wake   : image %s after %.2f ms real, %llu ms virtual\n",
+		asset->pending() ? "pending" : "ready", realMs, (unsigned long long)(H_::now() - virtualStart));
+	printLoop("  loop");
+	std::remove(image.c_str());
+	return 0;
+}
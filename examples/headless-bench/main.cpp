@@ -0,0 +1,134 @@
+﻿/**
+ * @file main.cpp
+ * @brief 无头(Headless)后端示例：脚本化事件回放 + 帧缓冲导出 + 简单计时。
+ * @description
+ *     在没有 Windows / EasyX 的环境中构建一个包含按钮、标签、文本框、表格、
+ *     画布与选项卡的典型界面，用脚本化的鼠标消息驱动 runEventLoop，
+ *     结束后输出后端统计并把最终帧导出为 PPM，便于金样图比对。
+ *
+ *     用法: headless-bench [输出文件.ppm] [悬停往返次数] [snapshot|compositor] [拉伸次数]
+ *       snapshot   —— 默认，控件抓屏快照 + 回贴的局部重绘
+ *       compositor —— 窗口合成器，按损伤区在后台缓冲上重合成
+ *       拉伸次数   —— 悬停脚本之后追加的窗口尺寸往返次数（默认 0），用于观察快照表面池
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const std::string outFile = argc > 1 ? argv[1] : "headless-bench.ppm";
+	const int rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+	const bool compositor = argc > 3 && std::strcmp(argv[3], "compositor") == 0;
+	const int resizes = argc > 4 ? std::atoi(argv[4]) : 0;
+
+	Window mainWindow(800, 600, 0, RGB(240, 240, 240), "StellarX headless bench");
+
+	auto title = std::make_unique<Label>(20, 12, "StellarX Headless", RGB(0, 0, 128), RGB(240, 240, 240));
+	mainWindow.addControl(std::move(title));
+
+	auto ok = std::make_unique<Button>(20, 50, 140, 40, "OK", StellarX::ButtonMode::NORMAL, StellarX::ControlShape::ROUND_RECTANGLE);
+	auto cancel = std::make_unique<Button>(180, 50, 140, 40, "Cancel", StellarX::ButtonMode::NORMAL, StellarX::ControlShape::RECTANGLE);
+	auto toggle = std::make_unique<Button>(340, 50, 140, 40, "Toggle", StellarX::ButtonMode::TOGGLE, StellarX::ControlShape::ELLIPSE);
+	int clicks = 0;
+	ok->setOnClickListener([&clicks]() { ++clicks; });
+	mainWindow.addControl(std::move(ok));
+	mainWindow.addControl(std::move(cancel));
+	mainWindow.addControl(std::move(toggle));
+
+	auto box = std::make_unique<TextBox>(500, 50, 260, 40, "read only text box", StellarX::TextBoxmode::READONLY_MODE);
+	mainWindow.addControl(std::move(box));
+
+	auto table = std::make_unique<Table>(20, 110);
+	table->setHeaders({ "ID", "Name", "Score", "Note" });
+	for (int i = 0; i < 24; ++i)
+		table->setData({ std::to_string(i + 1), "row-" + std::to_string(i + 1), std::to_string(60 + i), "ok" });
+	table->setRowsPerPage(8);
+	mainWindow.addControl(std::move(table));
+
+	auto canvas = std::make_unique<Canvas>(420, 110, 340, 200);
+	canvas->setCanvasBkColor(RGB(255, 255, 255));
+	canvas->addControl(std::make_unique<Button>(20, 20, 120, 36, "In canvas"));
+	canvas->addControl(std::make_unique<Label>(20, 70, "Label in canvas", BLACK, RGB(255, 255, 255)));
+	mainWindow.addControl(std::move(canvas));
+
+	auto tabs = std::make_unique<TabControl>(20, 400, 740, 180);
+	tabs->add(std::make_pair(std::make_unique<Button>(0, 0, 100, 30, "Tab A"), std::make_unique<Canvas>(0, 0, 740, 150)));
+	tabs->add(std::make_pair(std::make_unique<Button>(0, 0, 100, 30, "Tab B"), std::make_unique<Canvas>(0, 0, 740, 150)));
+	tabs->add("Tab A", std::make_unique<Button>(20, 20, 120, 36, "A-1"));
+	tabs->add("Tab B", std::make_unique<Button>(20, 20, 120, 36, "B-1"));
+	mainWindow.addControl(std::move(tabs));
+
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+
+	// 脚本：在三个按钮之间往返悬停，最后点击 OK
+	namespace H = StellarX::Headless;
+	for (int i = 0; i < rounds; ++i)
+	{
+		H::postMouse(WM_MOUSEMOVE, 90, 70, 16);
+		H::postMouse(WM_MOUSEMOVE, 250, 70, 16);
+		H::postMouse(WM_MOUSEMOVE, 410, 70, 16);
+		H::postMouse(WM_MOUSEMOVE, 600, 350, 16);
+	}
+	// 尺寸往返：每次拉伸都会作废全部快照并在下一帧按新尺寸重抓
+	for (int i = 0; i < resizes; ++i)
+	{
+		H::postResize(i % 2 ? 800 : 860, i % 2 ? 600 : 640, 16);
+		H::postMouse(WM_MOUSEMOVE, 90, 70, 16);
+	}
+	if (resizes % 2)
+		H::postResize(800, 600, 16);
+	H::postMouse(WM_LBUTTONDOWN, 90, 70, 16);
+	H::postMouse(WM_LBUTTONUP, 90, 70, 16);
+
+	H::resetStats();
+	StellarX::SurfacePool::Get().resetStats();
+	StellarX::RenderState::Get().resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = H::stats();
+	const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	const int events = rounds * 4 + 2 + resizes * 2 + resizes % 2;
+	const auto& pool = StellarX::SurfacePool::Get().getStats();
+	const auto& tracker = StellarX::RenderState::Get();
+	const auto& rs = tracker.total();
+	const double frames = tracker.frameCount() ? (double)tracker.frameCount() : 1.0;
+	std::printf("repaint mode  : %s\n", compositor ? "compositor" : "snapshot");
+	std::printf("events        : %d\n", events);
+	std::printf("clicks        : %d\n", clicks);
+	std::printf("wall time     : %.3f ms (%.3f us/event)\n", ms, ms * 1000.0 / events);
+	std::printf("virtual time  : %llu ms\n", (unsigned long long)H::now());
+	std::printf("draw calls    : %llu\n", (unsigned long long)st.drawCalls);
+	std::printf("text calls    : %llu\n", (unsigned long long)st.textCalls);
+	std::printf("metric calls  : %llu\n", (unsigned long long)st.metricCalls);
+	std::printf("presents      : %llu\n", (unsigned long long)st.presents);
+	std::printf("bytes read    : %llu\n", (unsigned long long)st.bytesRead);
+	std::printf("bytes written : %llu\n", (unsigned long long)st.bytesWritten);
+	std::printf("read/event    : %llu\n", (unsigned long long)(st.bytesRead / events));
+	std::printf("written/event : %llu\n", (unsigned long long)(st.bytesWritten / events));
+	std::printf("surface allocs: %llu\n", (unsigned long long)st.surfaceAllocs);
+	std::printf("pool          : %zu B held (%zu in use, %zu cached), hit rate %.1f%% (%llu/%llu), evictions %llu, trims %llu\n",
+		pool.bytesHeld, pool.bytesInUse, pool.bytesCached, pool.hitRate() * 100.0,
+		(unsigned long long)pool.hits, (unsigned long long)pool.acquires,
+		(unsigned long long)pool.evictions, (unsigned long long)pool.trims);
+	std::printf("state changes : %llu issued, %llu elided (%.1f%%), fonts %llu issued / %llu elided, %llu saves\n",
+		(unsigned long long)rs.issued, (unsigned long long)rs.elided, rs.elidedRate() * 100.0,
+		(unsigned long long)rs.fontsIssued, (unsigned long long)rs.fontsElided, (unsigned long long)rs.pushes);
+	std::printf("state/frame   : %.1f issued, %.1f elided over %llu frames (last frame %llu / %llu)\n",
+		rs.issued / frames, rs.elided / frames, (unsigned long long)tracker.frameCount(),
+		(unsigned long long)tracker.lastFrame().issued, (unsigned long long)tracker.lastFrame().elided);
+
+	if (!H::dumpPPM(outFile))
+	{
+		std::fprintf(stderr, "failed to write %s\n", outFile.c_str());
+		return 1;
+	}
+	std::printf("frame         : %s\n", outFile.c_str());
+	return 0;
+}
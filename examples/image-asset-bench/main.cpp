@@ -0,0 +1,132 @@
+﻿/**
+ * @file main.cpp
+ * @brief 共享图像资产示例：多个按钮使用同一张纹理、窗口使用大背景图时的启动耗时与内存占用。
+ * @description
+ *     生成一张 256x64 的按钮纹理与一张 1920x1080 的背景图（PPM），1280x720 窗口放置若干个
+ *     以该纹理填充的按钮，并以背景图启动。分别统计：
+ *       - 启动耗时：从第一次 setFillIma 到首帧提交；
+ *       - 首帧中仍以纯色占位的按钮数、等待后台解码完成的耗时；
+ *       - 读盘解码次数、按钮实际持有的不同图像数与其字节数；
+ *     事件循环在按钮间悬停后结束，打印最终帧的哈希（三种模式应一致）。
+ *
+ *     用法: image-asset-bench [按钮数] [shared|sync|private] [画面.ppm]
+ *       shared  —— 默认，按 (路径, 尺寸) 共享，首次使用在后台线程解码
+ *       sync    —— 共享，但在 setFillIma / 首帧处同步解码
+ *       private —— 关闭 ImageCache，每个按钮各自 loadimage 一份（旧行为）
+ */
+
+#include "StellarX.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+	bool writeImage(const std::string& path, int w, int h, int seed)
+	{
+		FILE* fp = std::fopen(path.c_str(), "wb");
+		if (!fp) return false;
+		std::fprintf(fp, "P6\n%d %d\n255\n", w, h);
+		std::vector<unsigned char> row((std::size_t)w * 3);
+		for (int y = 0; y < h; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				row[x * 3 + 0] = (unsigned char)(x * 255 / w);
+				row[x * 3 + 1] = (unsigned char)(y * 255 / h);
+				row[x * 3 + 2] = (unsigned char)(((x + y * seed) / 8 % 2) ? 200 : 90);
+			}
+			std::fwrite(row.data(), 1, row.size(), fp);
+		}
+		std::fclose(fp);
+		return true;
+	}
+
+	double msSince(std::chrono::steady_clock::time_point t0)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int count = argc > 1 ? (std::max)(1, std::atoi(argv[1])) : 30;
+	const std::string mode = argc > 2 ? argv[2] : "shared";
+	const char* out = argc > 3 ? argv[3] : "image-asset.ppm";
+	const std::string texture = "image-asset-bench-texture.ppm";
+	const std::string backdrop = "image-asset-bench-background.ppm";
+
+	if (!writeImage(texture, 256, 64, 3) || !writeImage(backdrop, 1920, 1080, 1))
+	{
+		std::fprintf(stderr, "failed to write source images\n");
+		return 1;
+	}
+
+	auto& cache = StellarX::ImageCache::Get();
+	cache.setEnabled(mode != "private");
+	cache.setAsync(mode == "shared");
+	namespace H = StellarX::Headless;
+
+	Window mainWindow(1280, 720, 0, RGB(40, 44, 52), "StellarX image asset bench");
+	std::vector<Button*> buttons;
+	for (int i = 0; i < count; ++i)
+	{
+		auto b = std::make_unique<Button>(40 + (i % 6) * 200, 40 + (i / 6) % 10 * 64, 160, 44, "Button " + std::to_string(i));
+		b->setFillMode(StellarX::FillMode::DibPattern);
+		buttons.push_back(b.get());
+		mainWindow.addControl(std::move(b));
+	}
+
+	H::resetStats();
+	cache.resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	for (Button* b : buttons)
+		b->setFillIma(texture);
+	mainWindow.draw(backdrop);
+	const double startup = msSince(t0);
+
+	int placeholders = 0;
+	for (Button* b : buttons)
+		placeholders += b->getFillImaImage() ? 0 : 1;
+	const bool bkPending = mainWindow.getBkImage() == nullptr;
+
+	// 事件循环每轮 pump 一次；这里先等后台线程解码完，保证脚本回放的帧与机器快慢无关
+	const auto t1 = std::chrono::steady_clock::now();
+	StellarX::ThreadPool::Get().waitBackground();
+	const double decodeWait = msSince(t1);
+
+	for (int i = 0; i < count; ++i)
+		H::postMouse(WM_MOUSEMOVE, 120 + (i % 6) * 200, 62 + (i / 6) % 10 * 64, 16);
+	H::postMouse(WM_MOUSEMOVE, 1270, 710, 16);
+	mainWindow.runEventLoop();
+
+	std::set<IMAGE*> distinct;
+	std::size_t bytes = 0;
+	for (Button* b : buttons)
+		if (IMAGE* img = b->getFillImaImage())
+			if (distinct.insert(img).second)
+				bytes += (std::size_t)img->getwidth() * img->getheight() * 4;
+
+	const auto& cs = cache.getStats();
+	std::printf("mode          : %s, %d buttons\n", mode.c_str(), count);
+	std::printf("startup       : %.3f ms (to first frame)\n", startup);
+	std::printf("first frame   : %d placeholder buttons, background %s\n", placeholders, bkPending ? "placeholder" : "drawn");
+	std::printf("decode wait   : %.3f ms (background thread after first frame)\n", decodeWait);
+	std::printf("file decodes  : %llu (%llu on the background thread)\n",
+		(unsigned long long)(H::stats().imageLoads + cs.asyncDecodes), (unsigned long long)cs.asyncDecodes);
+	std::printf("button images : %zu distinct, %.1f KiB\n", distinct.size(), bytes / 1024.0);
+	std::printf("cache         : %llu acquires, %llu shared, %llu rescales, %.1f KiB held\n",
+		(unsigned long long)cs.acquires, (unsigned long long)cs.shared, (unsigned long long)cs.rescales, cs.bytesHeld / 1024.0);
+
+	SetWorkingImage(nullptr);
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash    : %016llx\n", (unsigned long long)hash);
+	const bool ok = H::dumpPPM(out);
+	std::printf("screenshot    : %s%s\n", out, ok ? "" : " (not written)");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+﻿/**
+ * @file main.cpp
+ * @brief 遮挡剔除示例：被不透明面板和对话框完全盖住的控件不参与重绘。
+ * @description
+ *     窗口铺满一片按钮网格，上面压一块实心画布面板（内含标签），
+ *     再用 MessageBox::showAsync 弹出两个互相重叠的非模态对话框。
+ *     脚本反复调整窗口尺寸（整窗重绘）并在可见按钮上悬停（合成损伤区）。
+ *     结束后输出剔除统计与后端统计，并打印最终帧的哈希。
+ *
+ *     用法: occlusion-bench [往返次数] [on|off] [输出文件.ppm]
+ *       on  —— 默认，开启遮挡剔除
+ *       off —— 关闭剔除，用于对比统计与帧哈希
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 100;
+	const bool cull = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+	const std::string outFile = argc > 3 ? argv[3] : "";
+
+	StellarX::Occlusion::setEnabled(cull);
+	Window mainWindow(800, 600, 0, RGB(240, 240, 240), "StellarX occlusion bench");
+
+	// 底层：10 x 12 的按钮网格铺满窗口
+	for (int row = 0; row < 12; ++row)
+		for (int col = 0; col < 10; ++col)
+			mainWindow.addControl(std::make_unique<Button>(10 + col * 78, 10 + row * 48, 70, 40,
+				"B" + std::to_string(row * 10 + col)));
+
+	// 中层：实心面板压住左下角，面板里的标签照常绘制
+	auto panel = std::make_unique<Canvas>(4, 296, 392, 290);
+	panel->setCanvasBkColor(RGB(250, 250, 250));
+	for (int i = 0; i < 6; ++i)
+		panel->addControl(std::make_unique<Label>(20, 20 + i * 36, "metric " + std::to_string(i + 1) + ": " + std::to_string(40 + i * 11),
+			BLACK, RGB(250, 250, 250)));
+	mainWindow.addControl(std::move(panel));
+
+	mainWindow.setCompositorEnabled(true);
+	mainWindow.draw();
+
+	// 上层：两个居中的非模态对话框，尺寸不同因而部分重叠
+	StellarX::MessageBox::showAsync(mainWindow,
+		"Build finished with warnings.\nOpen the log to review every message,\nor dismiss this notice to keep working.\n\nAll targets were linked successfully.",
+		"Build", StellarX::MessageBoxType::OKCancel);
+	StellarX::MessageBox::showAsync(mainWindow, "Sync complete.", "Sync", StellarX::MessageBoxType::OK);
+
+	// 脚本：整窗调整尺寸 ↔ 右上角按钮间悬停
+	namespace H = StellarX::Headless;
+	for (int i = 0; i < rounds; ++i)
+	{
+		H::postResize(i % 2 ? 800 : 820, i % 2 ? 600 : 620, 16);
+		H::postMouse(WM_MOUSEMOVE, 600, 30, 16);
+		H::postMouse(WM_MOUSEMOVE, 680, 30, 16);
+		H::postMouse(WM_MOUSEMOVE, 760, 80, 16);
+	}
+	if (rounds % 2)
+		H::postResize(800, 600, 16);
+
+	H::resetStats();
+	StellarX::Occlusion::resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = H::stats();
+	const auto& oc = StellarX::Occlusion::stats();
+	const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	std::printf("occlusion     : %s\n", cull ? "on" : "off");
+	std::printf("wall time     : %.3f ms\n", ms);
+	std::printf("culled        : %llu of %llu tested, %.2f per frame over %llu frames, last frame %llu\n",
+		(unsigned long long)oc.culled, (unsigned long long)oc.tested,
+		oc.frames ? (double)oc.culled / (double)oc.frames : 0.0,
+		(unsigned long long)oc.frames, (unsigned long long)oc.lastFrameCulled);
+	std::printf("draw calls    : %llu\n", (unsigned long long)st.drawCalls);
+	std::printf("text calls    : %llu\n", (unsigned long long)st.textCalls);
+	std::printf("presents      : %llu\n", (unsigned long long)st.presents);
+	std::printf("bytes written : %llu\n", (unsigned long long)st.bytesWritten);
+
+	// 最终帧哈希：on / off 两次运行必须相同
+	SetWorkingImage(nullptr);
+	std::printf("frame hash    : %016llx\n",
+		(unsigned long long)StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0));
+	if (!outFile.empty() && !H::dumpPPM(outFile))
+	{
+		std::fprintf(stderr, "failed to write %s\n", outFile.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,207 @@
+﻿/**
+ * @file main.cpp
+ * @brief 不透明快照示例：寄存器查看工具（examples/register-viewer）的场景，统计省下的快照字节。
+ * @description
+ *     按 register-viewer 的布局搭出同样的控件树：32 个实心矩形位按钮的选择区、
+ *     空心填充的功能区（三块圆角画布，内含文本框与按钮）、数值/二进制显示区和配置区。
+ *     脚本逐个切换位按钮、点击功能按钮刷新显示区，并反复隐藏/显示低 16 位按钮。
+ *     结束后输出快照表面的占用字节与不透明控件省下的字节，并检查可见帧与后台缓冲一致。
+ *
+ *     用法: opaque-snap-bench [往返次数] [on|off]
+ *       on  —— 默认，不透明控件只记录快照范围，不抓背景像素
+ *       off —— 所有控件照常抓屏，用于对比（两者帧哈希必须相同）
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 64;
+	const bool skip = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+
+	StellarX::SurfacePool::Get().setSkipOpaque(skip);
+	const COLORREF panel = RGB(202, 255, 255), hover = RGB(171, 196, 220), ink = RGB(226, 116, 152);
+	Window mainWindow(700, 510, 0, RGB(255, 255, 255), "StellarX opaque snapshot bench");
+
+	auto styleButton = [&](Button* b) {
+		b->textStyle.color = ink;
+		b->setButtonShape(StellarX::ControlShape::B_RECTANGLE);
+	};
+	auto styleBox = [&](TextBox* t, COLORREF bk) {
+		t->textStyle.color = ink;
+		t->setTextBoxBk(bk);
+		t->setTextBoxshape(StellarX::ControlShape::B_RECTANGLE);
+	};
+	auto roundCanvas = [&](int x, int y, int w, int h) {
+		auto c = std::make_unique<Canvas>(x, y, w, h);
+		c->setCanvasBkColor(panel);
+		c->setShape(StellarX::ControlShape::B_ROUND_RECTANGLE);
+		return c;
+	};
+	auto label = [](int x, int y, const char* text) {
+		auto l = std::make_unique<Label>(x, y, text);
+		l->setTextdisap(true);
+		return l;
+	};
+
+	// 选择区：32 个位按钮，下方低 16 位
+	auto selection = roundCanvas(10, 10, 680, 150);
+	std::vector<Button*> bits;
+	selection->addControl(label(18, 0, "32-bit select"));
+	for (int row = 0; row < 2; ++row)
+		for (int col = 0; col < 16; ++col)
+		{
+			const int x = col * 35 + 27 + 28 * (col / 4);
+			auto b = std::make_unique<Button>(x, row ? 120 : 58, 25, 30, "0", panel, hover, StellarX::ButtonMode::TOGGLE);
+			styleButton(b.get());
+			Button* p = b.get();
+			p->setOnToggleOnListener([p]() { p->setButtonText("1"); });
+			p->setOnToggleOffListener([p]() { p->setButtonText("0"); });
+			bits.push_back(p);
+			selection->addControl(std::move(b));
+			selection->addControl(label(x - 2, row ? 90 : 26, std::to_string(31 - row * 16 - col).c_str()));
+		}
+
+	// 功能区：空心填充的外框，内含三块圆角画布
+	auto function = std::make_unique<Canvas>(10, 170, 680, 70);
+	function->setCanvasfillMode(StellarX::FillMode::Null);
+	function->setShape(StellarX::ControlShape::B_ROUND_RECTANGLE);
+	std::vector<Button*> actions;
+	const char* names[3] = { "Invert", "Shl", "Shr" };
+	for (int i = 0; i < 3; ++i)
+	{
+		auto area = roundCanvas(i * 230, 0, 220, 70);
+		area->addControl(label(13, -10, names[i]));
+		if (i == 0)
+		{
+			for (int k = 0; k < 2; ++k)
+			{
+				auto t = std::make_unique<TextBox>(35 + k * 60, 35, 35, 30, "0");
+				styleBox(t.get(), RGB(244, 234, 142));
+				area->addControl(std::move(t));
+			}
+			area->addControl(label(30, 10, "lo"));
+			area->addControl(label(90, 10, "hi"));
+		}
+		else
+		{
+			auto t = std::make_unique<TextBox>(90, 30, 100, 30, "0");
+			styleBox(t.get(), RGB(244, 234, 142));
+			area->addControl(std::move(t));
+			area->addControl(label(198, 30, "bit"));
+		}
+		auto b = i == 0 ? std::make_unique<Button>(135, 35, 80, 30, names[i], panel, hover)
+			: std::make_unique<Button>(15, 30, 60, 30, names[i], panel, hover);
+		styleButton(b.get());
+		actions.push_back(b.get());
+		area->addControl(std::move(b));
+		function->addControl(std::move(area));
+	}
+
+	// 数值显示区与二进制显示区：只读文本框
+	auto numeric = roundCanvas(10, 255, 680, 70);
+	numeric->addControl(label(18, -10, "Value"));
+	auto hexBox = std::make_unique<TextBox>(110, 25, 200, 30, "0");
+	auto decBox = std::make_unique<TextBox>(400, 25, 200, 30, "0");
+	TextBox* hex = hexBox.get();
+	TextBox* dec = decBox.get();
+	for (auto* t : { hex, dec })
+	{
+		styleBox(t, RGB(141, 141, 141));
+		t->setMode(StellarX::TextBoxmode::READONLY_MODE);
+	}
+	numeric->addControl(std::move(hexBox));
+	numeric->addControl(std::move(decBox));
+
+	auto binary = roundCanvas(10, 335, 680, 110);
+	binary->addControl(label(18, -10, "Binary"));
+	auto lastBox = std::make_unique<TextBox>(110, 20, 520, 30, "0");
+	auto thisBox = std::make_unique<TextBox>(110, 67, 520, 30, "0");
+	TextBox* last = lastBox.get();
+	TextBox* cur = thisBox.get();
+	for (auto* t : { last, cur })
+	{
+		styleBox(t, RGB(141, 141, 141));
+		t->setMode(StellarX::TextBoxmode::READONLY_MODE);
+	}
+	binary->addControl(std::move(lastBox));
+	binary->addControl(std::move(thisBox));
+
+	// 配置区：“隐藏低位”开关反复隐藏/显示低 16 位按钮（不透明控件隐藏时由父容器重画）
+	auto config = roundCanvas(10, 455, 680, 40);
+	config->addControl(label(20, -10, "Config"));
+	auto hideLow = std::make_unique<Button>(420, 10, 90, 20, "Hide low", panel, hover, StellarX::ButtonMode::TOGGLE);
+	styleButton(hideLow.get());
+	hideLow->setOnToggleOnListener([&bits]() { for (int i = 16; i < 32; ++i) bits[i]->setIsVisible(false); });
+	hideLow->setOnToggleOffListener([&bits]() { for (int i = 16; i < 32; ++i) bits[i]->setIsVisible(true); });
+	config->addControl(std::move(hideLow));
+
+	auto refresh = [&bits, hex, dec, last, cur]() {
+		unsigned v = 0;
+		std::string text;
+		for (int i = 0; i < 32; ++i)
+		{
+			v = (v << 1) | (bits[i]->isClicked() ? 1u : 0u);
+			text += bits[i]->isClicked() ? '1' : '0';
+		}
+		char buf[16];
+		std::snprintf(buf, sizeof(buf), "%08X", v);
+		hex->setText(buf);
+		dec->setText(std::to_string(v));
+		last->setText(cur->getText());
+		cur->setText(text);
+	};
+	for (auto* a : actions)
+		a->setOnClickListener(refresh);
+
+	mainWindow.addControl(std::move(selection));
+	mainWindow.addControl(std::move(function));
+	mainWindow.addControl(std::move(numeric));
+	mainWindow.addControl(std::move(binary));
+	mainWindow.addControl(std::move(config));
+	mainWindow.draw();
+
+	namespace H_ = StellarX::Headless;
+	auto click = [](int x, int y) {
+		H_::postMouse(WM_MOUSEMOVE, x, y, 16);
+		H_::postMouse(WM_LBUTTONDOWN, x, y, 16);
+		H_::postMouse(WM_LBUTTONUP, x, y, 16);
+	};
+	for (int i = 0; i < rounds; ++i)
+	{
+		const int col = i % 16, row = (i / 16) % 2;
+		click(10 + col * 35 + 40 + 28 * (col / 4), 10 + (row ? 135 : 73));
+		click(10 + 175, 170 + 50);                      // 位取反按钮：刷新显示区
+		if (i % 8 == 7)
+			click(10 + 465, 455 + 20);                  // 隐藏/显示低 16 位
+	}
+	H_::postMouse(WM_MOUSEMOVE, 695, 505, 16);
+
+	H_::resetStats();
+	StellarX::SurfacePool::Get().resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& ps = StellarX::SurfacePool::Get().getStats();
+	std::printf("opaque skip    : %s\n", skip ? "on" : "off");
+	std::printf("wall time      : %.3f ms\n", std::chrono::duration<double, std::milli>(t1 - t0).count());
+	std::printf("snapshot bytes : %zu in use, %zu saved by opaque controls\n", ps.bytesInUse, ps.bytesSkipped);
+	std::printf("surface acquire: %llu (%llu opaque skips)\n",
+		(unsigned long long)ps.acquires, (unsigned long long)ps.opaqueSkips);
+	std::printf("bytes written  : %llu\n", (unsigned long long)H_::stats().bytesWritten);
+
+	// 可见帧必须与后台缓冲一致；on / off 的帧哈希也必须相同
+	SetWorkingImage(nullptr);
+	const auto back = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(H_::front());
+	const auto front = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(nullptr);
+	std::printf("frame hash     : %016llx (front buffer %s)\n", (unsigned long long)back, front == back ? "matches" : "DIFFERS");
+	return front == back ? 0 : 1;
+}
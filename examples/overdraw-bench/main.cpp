@@ -0,0 +1,89 @@
+﻿/**
+ * @file main.cpp
+ * @brief 过绘制示例：统计每帧屏幕像素被写了几次，并导出最近一帧的热力图。
+ * @description
+ *     窗口左侧是小按钮网格，右侧是一块带按钮与标签的画布，上面再叠一个非模态对话框。
+ *     开启 Headless::setOverdrawEnabled 后首帧整屏绘制，随后脚本在按钮间悬停、
+ *     点击画布里的按钮（快照模式下每次都是“还原快照 → 重绘”，对话框随之重画）。
+ *     每次提交结算一帧：输出该帧写过的像素数、平均/最大过绘制与写入字节数，
+ *     最后把最近一个有写入的帧导出为热力图 PPM。
+ *
+ *     用法: overdraw-bench [往返次数] [snapshot|compositor] [热力图.ppm]
+ */
+
+#include "StellarX.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 10;
+	const bool compositor = argc > 2 && std::strcmp(argv[2], "compositor") == 0;
+	const char* heatmap = argc > 3 ? argv[3] : "overdraw.ppm";
+
+	namespace H_ = StellarX::Headless;
+	const int W = 1280, H = 720;
+	Window mainWindow(W, H, 0, RGB(240, 240, 240), "StellarX overdraw bench");
+
+	for (int row = 0; row < 12; ++row)
+		for (int col = 0; col < 16; ++col)
+			mainWindow.addControl(std::make_unique<Button>(20 + col * 40, 20 + row * 40, 30, 30, std::to_string(row * 16 + col)));
+
+	auto canvas = std::make_unique<Canvas>(700, 20, 540, 480);
+	canvas->setCanvasBkColor(RGB(255, 255, 255));
+	for (int i = 0; i < 6; ++i)
+	{
+		canvas->addControl(std::make_unique<Button>(20, 20 + i * 60, 160, 40, "Canvas button " + std::to_string(i)));
+		canvas->addControl(std::make_unique<Label>(200, 30 + i * 60, "Label " + std::to_string(i), BLACK, RGB(255, 255, 255)));
+	}
+	mainWindow.addControl(std::move(canvas));
+
+	mainWindow.setCompositorEnabled(compositor);
+	H_::setOverdrawEnabled(true);
+	mainWindow.draw();
+	StellarX::MessageBox::showAsync(mainWindow, "Modeless dialog over the canvas.", "Overdraw", StellarX::MessageBoxType::OK);
+
+	for (int i = 0; i < rounds; ++i)
+	{
+		const int col = i % 16, row = (i / 16) % 12;
+		H_::postMouse(WM_MOUSEMOVE, 35 + col * 40, 35 + row * 40, 16);
+		H_::postMouse(WM_MOUSEMOVE, 800, 60 + (i % 6) * 60, 16);   // 画布里的按钮
+		if (i % 3 == 0)
+		{
+			H_::postMouse(WM_LBUTTONDOWN, 800, 60 + (i % 6) * 60, 16);
+			H_::postMouse(WM_LBUTTONUP, 800, 60 + (i % 6) * 60, 16);
+		}
+	}
+	H_::postMouse(WM_MOUSEMOVE, 1270, 710, 16);
+	mainWindow.runEventLoop();
+
+	const auto& frames = H_::overdrawFrames();
+	std::printf("repaint mode : %s\n", compositor ? "compositor" : "snapshot");
+	std::printf("%6s %10s %10s %8s %6s %12s %12s\n", "frame", "touched", "writes", "mean", "max", "screen B", "all B");
+	std::uint64_t touched = 0, writes = 0, bytes = 0;
+	std::uint32_t peak = 0;
+	std::size_t busy = 0;
+	for (const auto& f : frames)
+	{
+		if (!f.writes) continue;
+		++busy;
+		touched += f.pixelsTouched;
+		writes += f.writes;
+		bytes += f.bytesWritten;
+		peak = (std::max)(peak, f.maxWrites);
+		std::printf("%6llu %10llu %10llu %8.2f %6u %12llu %12llu\n",
+			(unsigned long long)f.frame, (unsigned long long)f.pixelsTouched, (unsigned long long)f.writes,
+			f.meanOverdraw(), f.maxWrites, (unsigned long long)f.screenBytes, (unsigned long long)f.bytesWritten);
+	}
+	std::printf("frames       : %zu presented, %zu with writes\n", frames.size(), busy);
+	std::printf("overall      : mean overdraw %.2f, max %u, %llu bytes written\n",
+		touched ? (double)writes / (double)touched : 0.0, peak, (unsigned long long)bytes);
+
+	SetWorkingImage(nullptr);
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash   : %016llx\n", (unsigned long long)hash);
+	const bool ok = H_::dumpOverdrawPPM(heatmap);
+	std::printf("heatmap      : %s%s\n", heatmap, ok ? "" : " (not written)");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+﻿/**
+ * @file main.cpp
+ * @brief 局部提交示例：1920x1080 窗口里悬停小按钮，只提交改动过的矩形。
+ * @description
+ *     窗口铺满 25x30 的小按钮，另有一块带按钮的画布和一个非模态对话框；
+ *     脚本在按钮之间来回悬停并点击画布里的按钮（每次只有一两个按钮改变外观）。
+ *     结束后输出每帧提交的字节数，并检查可见帧（Headless::front）与后台缓冲逐像素一致 ——
+ *     若局部提交漏掉了写过的像素，两者会不同。
+ *
+ *     用法: present-bench [往返次数] [on|off] [snapshot|compositor]
+ *       on  —— 默认，批量绘制结束时只提交写过的矩形
+ *       off —— 总是整屏提交，用于对比
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 100;
+	const bool partial = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+	const bool compositor = argc > 3 && std::strcmp(argv[3], "compositor") == 0;
+
+	StellarX::Present::setEnabled(partial);
+	const int W = 1920, H = 1080;
+	Window mainWindow(W, H, 0, RGB(240, 240, 240), "StellarX present bench");
+
+	// 上半部分：40 x 14 的小按钮网格
+	for (int row = 0; row < 14; ++row)
+		for (int col = 0; col < 40; ++col)
+			mainWindow.addControl(std::make_unique<Button>(20 + col * 40, 20 + row * 36, 25, 30, std::to_string(row * 40 + col)));
+
+	auto canvas = std::make_unique<Canvas>(20, 560, 600, 300);
+	canvas->setCanvasBkColor(RGB(255, 255, 255));
+	canvas->addControl(std::make_unique<Button>(20, 20, 120, 36, "In canvas"));
+	canvas->addControl(std::make_unique<Label>(20, 80, "Label in canvas", BLACK, RGB(255, 255, 255)));
+	mainWindow.addControl(std::move(canvas));
+
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+	StellarX::MessageBox::showAsync(mainWindow, "Modeless dialog over the grid.", "Present", StellarX::MessageBoxType::OK);
+
+	namespace H_ = StellarX::Headless;
+	for (int i = 0; i < rounds; ++i)
+	{
+		const int col = i % 40, row = (i / 40) % 14;
+		H_::postMouse(WM_MOUSEMOVE, 32 + col * 40, 35 + row * 36, 16);
+		H_::postMouse(WM_MOUSEMOVE, 80, 598, 16);          // 画布里的按钮
+		if (i % 10 == 0)
+		{
+			H_::postMouse(WM_LBUTTONDOWN, 80, 598, 16);
+			H_::postMouse(WM_LBUTTONUP, 80, 598, 16);
+		}
+	}
+	H_::postMouse(WM_MOUSEMOVE, 1900, 1060, 16);
+
+	H_::resetStats();
+	StellarX::Present::resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = H_::stats();
+	const auto& ps = StellarX::Present::stats();
+	const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	std::printf("partial present: %s (%s)\n", partial ? "on" : "off", compositor ? "compositor" : "snapshot");
+	std::printf("wall time      : %.3f ms\n", ms);
+	std::printf("presents       : %llu (%llu partial frames, %llu rects)\n",
+		(unsigned long long)st.presents, (unsigned long long)ps.partialFrames, (unsigned long long)ps.rects);
+	std::printf("bytes presented: %llu total, %.1f KiB/frame (full-frame presents: %.1f KiB/frame)\n",
+		(unsigned long long)st.bytesPresented,
+		ps.frames ? ps.bytesPresented / 1024.0 / ps.frames : 0.0,
+		ps.frames ? ps.fullBytes / 1024.0 / ps.frames : 0.0);
+	std::printf("bytes written  : %llu\n", (unsigned long long)st.bytesWritten);
+
+	// 可见帧必须与后台缓冲一致；on / off 的帧哈希也必须相同
+	SetWorkingImage(nullptr);
+	const auto back = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(H_::front());
+	const auto front = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(nullptr);
+	std::printf("frame hash     : %016llx (front buffer %s)\n", (unsigned long long)back, front == back ? "matches" : "DIFFERS");
+	return front == back ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+﻿/**
+ * @file main.cpp
+ * @brief 区域代数(StellarX::Region)校验与基准：与逐像素位图结果对拍，并测量各运算耗时。
+ * @description
+ *     1) 校验：随机生成矩形，对区域做并/交/差，与同尺寸布尔位图的结果逐像素比较，
+ *        同时检查表示法不变量（带有序、区间有序且不相邻、相邻同形带已合并）；
+ *     2) 场景：大画布两角各一个脏按钮 + 多个对话框，比较“外接矩形”与“区域”两种覆盖
+ *        的面积和需要补画的对话框数量；
+ *     3) 基准：累计并集、差集、相交查询的平均耗时。
+ *
+ *     不依赖任何绘图后端，任何平台都可运行。
+ *     用法: region-bench [校验轮数] [基准规模]
+ */
+
+#include "SxRegion.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using StellarX::Region;
+
+	constexpr int kW = 96;
+	constexpr int kH = 96;
+
+	struct Bitmap
+	{
+		std::vector<char> px = std::vector<char>(kW * kH, 0);
+		void fill(int l, int t, int r, int b, char v)
+		{
+			for (int y = (std::max)(t, 0); y < (std::min)(b, kH); ++y)
+				for (int x = (std::max)(l, 0); x < (std::min)(r, kW); ++x)
+					px[y * kW + x] = v;
+		}
+	};
+
+	Bitmap rasterize(const Region& rgn)
+	{
+		Bitmap bm;
+		rgn.forEachRect([&bm](int l, int t, int r, int b) { bm.fill(l, t, r, b, 1); });
+		return bm;
+	}
+
+	bool wellFormed(const Region& rgn)
+	{
+		const auto& bands = rgn.getBands();
+		const auto& spans = rgn.getSpans();
+		size_t next = 0;
+		for (size_t i = 0; i < bands.size(); ++i)
+		{
+			const auto& b = bands[i];
+			if (b.top >= b.bottom || b.count == 0 || b.first != next) return false;
+			next = b.first + b.count;
+			if (i > 0)
+			{
+				const auto& p = bands[i - 1];
+				if (p.bottom > b.top) return false;
+				if (p.bottom == b.top && p.count == b.count
+					&& std::equal(spans.begin() + p.first, spans.begin() + p.first + p.count, spans.begin() + b.first))
+					return false;   // 应已合并
+			}
+			for (size_t k = b.first; k < b.first + b.count; ++k)
+			{
+				if (spans[k].left >= spans[k].right) return false;
+				if (k > b.first && spans[k - 1].right >= spans[k].left) return false; // 重叠或相邻
+			}
+		}
+		return next == spans.size();
+	}
+
+	struct RandomRect { int l, t, r, b; };
+
+	RandomRect randomRect(std::mt19937& rng, int maxW, int maxH, int w, int h)
+	{
+		std::uniform_int_distribution<int> px(-4, w), py(-4, h), dw(1, maxW), dh(1, maxH);
+		const int l = px(rng), t = py(rng);
+		return { l, t, l + dw(rng), t + dh(rng) };
+	}
+
+	int verify(int rounds)
+	{
+		std::mt19937 rng(12345);
+		std::uniform_int_distribution<int> opPick(0, 2), count(1, 12);
+		for (int round = 0; round < rounds; ++round)
+		{
+			Region rgn;
+			Bitmap ref;
+			const int steps = count(rng);
+			for (int s = 0; s < steps; ++s)
+			{
+				const RandomRect rc = randomRect(rng, 40, 40, kW, kH);
+				Region other(rc.l, rc.t, rc.r, rc.b);
+				Bitmap mask;
+				mask.fill(rc.l, rc.t, rc.r, rc.b, 1);
+				switch (opPick(rng))
+				{
+				case 0:
+					rgn.unite(other);
+					for (int i = 0; i < kW * kH; ++i) ref.px[i] = ref.px[i] || mask.px[i];
+					break;
+				case 1:
+					rgn.intersect(other);
+					for (int i = 0; i < kW * kH; ++i) ref.px[i] = ref.px[i] && mask.px[i];
+					break;
+				default:
+					rgn.subtract(other);
+					for (int i = 0; i < kW * kH; ++i) ref.px[i] = ref.px[i] && !mask.px[i];
+					break;
+				}
+				// 只在位图范围内生成矩形的左上角，超出部分统一裁掉再比较
+				Region clipped = rgn;
+				clipped.intersect(Region(0, 0, kW, kH));
+				if (!wellFormed(rgn) || rasterize(clipped).px != ref.px)
+				{
+					std::fprintf(stderr, "mismatch at round %d step %d\n", round, s);
+					return 1;
+				}
+
+				long long refArea = 0;
+				for (char v : ref.px) refArea += v;
+				if (clipped.area() != refArea)
+				{
+					std::fprintf(stderr, "area mismatch at round %d step %d\n", round, s);
+					return 1;
+				}
+
+				const RandomRect q = randomRect(rng, 20, 20, kW, kH);
+				bool refHit = false;
+				for (int y = (std::max)(q.t, 0); y < (std::min)(q.b, kH) && !refHit; ++y)
+					for (int x = (std::max)(q.l, 0); x < (std::min)(q.r, kW) && !refHit; ++x)
+						refHit = ref.px[y * kW + x] != 0;
+				if (clipped.intersects(q.l, q.t, q.r, q.b) != refHit)
+				{
+					std::fprintf(stderr, "intersects mismatch at round %d step %d\n", round, s);
+					return 1;
+				}
+			}
+		}
+		return 0;
+	}
+
+	void scenario()
+	{
+		// 800x600 画布，左上与右下各一个 120x36 的脏按钮；三个对话框分布在中间与两侧
+		Region coverage(40, 40, 160, 76);
+		coverage.unite(640, 520, 760, 556);
+		int l, t, r, b;
+		coverage.getBounds(l, t, r, b);
+		const long long boxArea = (long long)(r - l) * (b - t);
+
+		const RandomRect dialogs[] = { { 250, 200, 550, 400 }, { 500, 60, 780, 180 }, { 20, 420, 300, 580 } };
+		int boxHits = 0, regionHits = 0;
+		for (const auto& d : dialogs)
+		{
+			if (d.l < r && d.r > l && d.t < b && d.b > t) ++boxHits;
+			if (coverage.intersects(d.l, d.t, d.r, d.b)) ++regionHits;
+		}
+		std::printf("scenario      : bounding box %lld px / %d dialogs, region %lld px / %d dialogs\n",
+			boxArea, boxHits, coverage.area(), regionHits);
+	}
+
+	template <class F>
+	double timeNs(int iterations, F&& f)
+	{
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) f(i);
+		const auto t1 = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+	}
+
+	void bench(int n)
+	{
+		std::mt19937 rng(777);
+		std::vector<RandomRect> rects;
+		for (int i = 0; i < n; ++i) rects.push_back(randomRect(rng, 160, 60, 800, 600));
+
+		Region acc;
+		const double uniteNs = timeNs(n, [&](int i) { acc.unite(rects[i].l, rects[i].t, rects[i].r, rects[i].b); });
+		std::printf("unite         : %.1f ns/op (%d rects -> %zu bands, %zu rects)\n",
+			uniteNs, n, acc.getBands().size(), acc.rectCount());
+
+		volatile int hits = 0;
+		const double queryNs = timeNs(n, [&](int i) { hits = hits + (acc.intersects(rects[i].l + 7, rects[i].t + 5, rects[i].r - 7, rects[i].b - 5) ? 1 : 0); });
+		std::printf("intersects    : %.1f ns/op\n", queryNs);
+
+		Region rest = acc;
+		const double subNs = timeNs(n, [&](int i) { rest.subtract(rects[i].l, rects[i].t, rects[i].l + 20, rects[i].t + 20); });
+		std::printf("subtract      : %.1f ns/op (%zu rects left)\n", subNs, rest.rectCount());
+
+		Region a = acc, window(100, 100, 700, 500);
+		const double andNs = timeNs(n, [&](int) { Region t = a; t.intersect(window); });
+		std::printf("intersect     : %.1f ns/op\n", andNs);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+	const int n = argc > 2 ? std::atoi(argv[2]) : 64;
+
+	if (verify(rounds) != 0)
+		return 1;
+	std::printf("verify        : ok (%d random sequences against a %dx%d bitmap)\n", rounds, kW, kH);
+	scenario();
+	bench(n);
+	return 0;
+}
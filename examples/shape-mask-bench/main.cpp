@@ -0,0 +1,144 @@
+﻿/**
+ * @file main.cpp
+ * @brief 形状掩码示例：圆角 / 圆形 / 椭圆按钮网格经抗锯齿覆盖率掩码缓存绘制。
+ * @description
+ *     1) 重放基准：在离屏 IMAGE 上反复重放一份显示列表（有边框与无边框的圆角矩形、圆、椭圆，
+ *        相同尺寸各出现多次），分别计时掩码开启与关闭（后端逐行光栅化）两种路径；
+ *     2) 场景：1280x720 窗口铺满圆角矩形、圆形、椭圆按钮，另有一块圆角画布，
+ *        脚本在按钮间悬停并点击；结束后输出掩码缓存的命中/计算次数与填充、混合的像素数，
+ *        并把最终画面导出为 PPM 便于查看边缘效果。
+ *
+ *     用法: shape-mask-bench [往返次数] [on|off] [snapshot|compositor] [画面.ppm]
+ *       on  —— 默认，曲边图元经掩码缓存绘制（抗锯齿）
+ *       off —— 后端非抗锯齿光栅化，用于对比
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+	// 一份与按钮网格相当的显示列表：三种尺寸 × 四种图元，每种重复若干次
+	void buildShapes(StellarX::DisplayList& dl)
+	{
+		dl.clear();
+		dl.setLineStyle(PS_SOLID, 1);
+		dl.setFillStyle(BS_SOLID);
+		dl.setLineColor(RGB(90, 110, 140));
+		for (int k = 0; k < 24; ++k)
+		{
+			const int x = 10 + (k % 6) * 150, y = 10 + (k / 6) * 110;
+			dl.setFillColor(RGB(200 + k, 220, 240 - k));
+			dl.fillRoundRect(x, y, x + 120, y + 40, 20, 20);
+			dl.solidRoundRect(x, y + 50, x + 80, y + 80, 12, 12);
+			dl.fillCircle(x + 110, y + 70, 18);
+			dl.fillEllipse(x + 130, y + 5, x + 145, y + 95);
+		}
+	}
+
+	double replayMs(const StellarX::DisplayList& dl, IMAGE& surface, int reps)
+	{
+		SetWorkingImage(&surface);
+		setbkcolor(RGB(240, 240, 240));
+		cleardevice();
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < reps; ++i)
+			dl.replay();
+		const auto t1 = std::chrono::steady_clock::now();
+		SetWorkingImage(nullptr);
+		return std::chrono::duration<double, std::milli>(t1 - t0).count();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 40;
+	const bool masks = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+	const bool compositor = argc > 3 && std::strcmp(argv[3], "compositor") == 0;
+	const char* out = argc > 4 ? argv[4] : "shape-mask.ppm";
+
+	auto& cache = StellarX::ShapeMaskCache::Get();
+	const COLORREF face = RGB(214, 228, 245), pressed = RGB(150, 180, 220), hover = RGB(186, 206, 235);
+	Window mainWindow(1280, 720, 0, RGB(246, 247, 250), "StellarX shape mask bench");
+
+	// 1) 重放基准：同一份列表分别走后端光栅化与掩码缓存
+	{
+		StellarX::DisplayList dl;
+		buildShapes(dl);
+		IMAGE surface(1000, 460);
+		const int reps = 1000;
+		cache.setEnabled(false);
+		const double raster = replayMs(dl, surface, reps);
+		cache.setEnabled(true);
+		cache.resetStats();
+		const double masked = replayMs(dl, surface, reps);
+		const auto& ms = cache.getStats();
+		std::printf("replay x%d     : raster %.3f ms, masks %.3f ms (%.2fx)\n", reps, raster, masked, masked > 0 ? raster / masked : 0.0);
+		std::printf("replay masks   : %llu draws, %llu builds, %llu hits, %zu bytes held\n",
+			(unsigned long long)ms.draws, (unsigned long long)ms.builds, (unsigned long long)ms.hits, ms.bytesHeld);
+	}
+
+	// 2) 场景：圆角 / 圆形 / 椭圆按钮网格 + 圆角画布
+	cache.setEnabled(masks);
+	cache.clear();
+	cache.resetStats();
+	const StellarX::ControlShape shapes[] = {
+		StellarX::ControlShape::ROUND_RECTANGLE, StellarX::ControlShape::CIRCLE,
+		StellarX::ControlShape::ELLIPSE, StellarX::ControlShape::B_ROUND_RECTANGLE };
+	for (int row = 0; row < 10; ++row)
+		for (int col = 0; col < 10; ++col)
+		{
+			const auto shape = shapes[(row + col) % 4];
+			const bool round = shape == StellarX::ControlShape::CIRCLE;
+			mainWindow.addControl(std::make_unique<Button>(20 + col * 80, 20 + row * 60, round ? 44 : 70, 44,
+				std::to_string(row * 10 + col), face, pressed, hover, StellarX::ButtonMode::NORMAL, shape));
+		}
+
+	auto panel = std::make_unique<Canvas>(840, 20, 420, 580);
+	panel->setCanvasBkColor(RGB(255, 255, 255));
+	panel->setShape(StellarX::ControlShape::ROUND_RECTANGLE);
+	for (int i = 0; i < 8; ++i)
+		panel->addControl(std::make_unique<Button>(30, 30 + i * 66, 360, 48, "Panel button " + std::to_string(i),
+			face, pressed, hover, StellarX::ButtonMode::NORMAL, StellarX::ControlShape::ROUND_RECTANGLE));
+	mainWindow.addControl(std::move(panel));
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+
+	namespace H_ = StellarX::Headless;
+	for (int i = 0; i < rounds; ++i)
+	{
+		const int col = i % 10, row = (i / 10) % 10;
+		H_::postMouse(WM_MOUSEMOVE, 50 + col * 80, 42 + row * 60, 16);
+		H_::postMouse(WM_MOUSEMOVE, 1050, 78 + (i % 8) * 66, 16);
+		if (i % 4 == 0)
+		{
+			H_::postMouse(WM_LBUTTONDOWN, 1050, 78 + (i % 8) * 66, 16);
+			H_::postMouse(WM_LBUTTONUP, 1050, 78 + (i % 8) * 66, 16);
+		}
+	}
+	H_::postMouse(WM_MOUSEMOVE, 1270, 710, 16);
+
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = cache.getStats();
+	std::printf("shape masks    : %s (%s)\n", masks ? "on" : "off", compositor ? "compositor" : "snapshot");
+	std::printf("event loop     : %.3f ms\n", std::chrono::duration<double, std::milli>(t1 - t0).count());
+	std::printf("mask draws     : %llu (%llu builds, %llu hits, %llu fallbacks, %llu evictions)\n",
+		(unsigned long long)st.draws, (unsigned long long)st.builds, (unsigned long long)st.hits,
+		(unsigned long long)st.fallbacks, (unsigned long long)st.evictions);
+	std::printf("mask pixels    : %llu filled, %llu blended, %zu bytes held\n",
+		(unsigned long long)st.pixelsFilled, (unsigned long long)st.pixelsBlended, st.bytesHeld);
+
+	SetWorkingImage(nullptr);
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash     : %016llx\n", (unsigned long long)hash);
+	const bool ok = H_::dumpPPM(out);
+	std::printf("screenshot     : %s%s\n", out, ok ? "" : " (not written)");
+	return ok ? 0 : 1;
+}
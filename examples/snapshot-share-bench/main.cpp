@@ -0,0 +1,111 @@
+﻿/**
+ * @file main.cpp
+ * @brief 快照共享与压缩示例：整窗选项卡里的大量子控件，统计每棵控件树的快照内存。
+ * @description
+ *     1600x900 窗口里放一个几乎铺满的 TabControl，4 个页面各有一格圆角按钮、
+ *     标签与文本框；另有一块带按钮的侧栏画布。脚本轮流切换页签并在按钮间悬停。
+ *     结束后逐棵控件树输出快照字节数（Control::snapshotBytes），并检查可见帧与后台缓冲一致。
+ *
+ *     用法: snapshot-share-bench [往返次数] [on|off]
+ *       on  —— 默认，子控件引用画布本体、大块均匀快照压缩存放
+ *       off —— 每个控件各自抓取原始像素，用于对比（两者帧哈希必须相同）
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 32;
+	const bool compact = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+
+	StellarX::SurfacePool::Get().setCompact(compact);
+	Window mainWindow(1600, 900, 0, RGB(240, 240, 240), "StellarX snapshot share bench");
+
+	// 整窗选项卡：4 页，每页 8 x 10 个圆角按钮、一列标签和两个文本框
+	const int pages = 4;
+	auto tabs = std::make_unique<TabControl>(10, 10, 1300, 880);
+	std::vector<Button*> tabButtons;
+	for (int p = 0; p < pages; ++p)
+	{
+		auto tab = std::make_unique<Button>(0, 0, 100, 30, "Page " + std::to_string(p + 1));
+		tabButtons.push_back(tab.get());
+		auto page = std::make_unique<Canvas>(0, 0, 1300, 850);
+		page->setCanvasBkColor(RGB(250, 250, 250));
+		tabs->add(std::make_pair(std::move(tab), std::move(page)));
+	}
+	for (int p = 0; p < pages; ++p)
+	{
+		const std::string name = "Page " + std::to_string(p + 1);
+		for (int row = 0; row < 10; ++row)
+		{
+			tabs->add(name, std::make_unique<Label>(20, 30 + row * 70, "row " + std::to_string(row + 1), BLACK, RGB(250, 250, 250)));
+			for (int col = 0; col < 8; ++col)
+				tabs->add(name, std::make_unique<Button>(110 + col * 135, 20 + row * 70, 120, 44,
+					std::to_string(p) + "-" + std::to_string(row * 8 + col), StellarX::ButtonMode::NORMAL, StellarX::ControlShape::ROUND_RECTANGLE));
+		}
+		tabs->add(name, std::make_unique<TextBox>(110, 730, 500, 36, "page " + std::to_string(p + 1), StellarX::TextBoxmode::READONLY_MODE,
+			StellarX::ControlShape::ROUND_RECTANGLE));
+		tabs->add(name, std::make_unique<TextBox>(650, 730, 500, 36, "status", StellarX::TextBoxmode::READONLY_MODE,
+			StellarX::ControlShape::ROUND_RECTANGLE));
+	}
+	TabControl* tabsPtr = tabs.get();
+	mainWindow.addControl(std::move(tabs));
+
+	// 侧栏画布：一列圆角按钮
+	auto side = std::make_unique<Canvas>(1320, 10, 270, 880);
+	side->setCanvasBkColor(RGB(230, 236, 245));
+	for (int i = 0; i < 12; ++i)
+		side->addControl(std::make_unique<Button>(20, 20 + i * 70, 230, 50, "Action " + std::to_string(i + 1),
+			StellarX::ButtonMode::NORMAL, StellarX::ControlShape::ROUND_RECTANGLE));
+	Canvas* sidePtr = side.get();
+	mainWindow.addControl(std::move(side));
+
+	mainWindow.draw();
+
+	namespace H_ = StellarX::Headless;
+	auto click = [](int x, int y) {
+		H_::postMouse(WM_MOUSEMOVE, x, y, 16);
+		H_::postMouse(WM_LBUTTONDOWN, x, y, 16);
+		H_::postMouse(WM_LBUTTONUP, x, y, 16);
+	};
+	for (int i = 0; i < rounds; ++i)
+	{
+		const Button* tab = tabButtons[i % pages];
+		click(tab->getX() + tab->getWidth() / 2, tab->getY() + tab->getHeight() / 2);
+		for (int k = 0; k < 8; ++k)
+			H_::postMouse(WM_MOUSEMOVE, 10 + 170 + k * 135, 10 + 30 + 42 + ((i + k) % 10) * 70, 16);
+		H_::postMouse(WM_MOUSEMOVE, 1320 + 135, 10 + 45 + (i % 12) * 70, 16);
+	}
+	H_::postMouse(WM_MOUSEMOVE, 1595, 895, 16);
+
+	H_::resetStats();
+	StellarX::SurfacePool::Get().resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& ps = StellarX::SurfacePool::Get().getStats();
+	const std::size_t tabBytes = tabsPtr->snapshotBytes(), sideBytes = sidePtr->snapshotBytes();
+	std::printf("compact snaps  : %s\n", compact ? "on" : "off");
+	std::printf("wall time      : %.3f ms\n", std::chrono::duration<double, std::milli>(t1 - t0).count());
+	std::printf("tree TabControl: %zu bytes (%.1f KiB)\n", tabBytes, tabBytes / 1024.0);
+	std::printf("tree side panel: %zu bytes (%.1f KiB)\n", sideBytes, sideBytes / 1024.0);
+	std::printf("snapshot total : %zu bytes (%.1f KiB)\n", tabBytes + sideBytes, (tabBytes + sideBytes) / 1024.0);
+	std::printf("surface pool   : %zu in use, %zu cached; %llu packed, %llu shared\n",
+		ps.bytesInUse, ps.bytesCached, (unsigned long long)ps.packs, (unsigned long long)ps.shares);
+	std::printf("bytes written  : %llu\n", (unsigned long long)H_::stats().bytesWritten);
+
+	// 可见帧必须与后台缓冲一致；on / off 的帧哈希也必须相同
+	SetWorkingImage(nullptr);
+	const auto back = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(H_::front());
+	const auto front = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	SetWorkingImage(nullptr);
+	std::printf("frame hash     : %016llx (front buffer %s)\n", (unsigned long long)back, front == back ? "matches" : "DIFFERS");
+	return front == back ? 0 : 1;
+}
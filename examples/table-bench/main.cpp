@@ -0,0 +1,89 @@
+﻿/**
+ * @file main.cpp
+ * @brief 表格绘制示例：20 列、每页 100 行的一整页反复重绘，统计每帧耗时与图元数。
+ * @description
+ *     1920x2800 窗口放一张 20 列 × 250 行、每页 100 行的 Table，强制整表重绘若干帧，
+ *     输出每帧耗时、每帧的绘制调用数（其中文本调用数）与最终帧哈希。
+ *     合成器模式下另外开启渐进重绘（128 像素见方的块），整场景按块裁剪重画一遍，
+ *     用来核对表格在裁剪下分块绘制的结果与整表绘制逐位一致：两种模式的帧哈希应相同。
+ *
+ *     用法: table-bench [帧数] [snapshot|compositor] [边框宽度] [solid|null 填充] [solid|dash|null 线型]
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 50;
+	const bool compositor = argc > 2 && std::strcmp(argv[2], "compositor") == 0;
+	const int borderWidth = argc > 3 ? std::atoi(argv[3]) : 1;
+	const char* fill = argc > 4 ? argv[4] : "solid";
+	const char* line = argc > 5 ? argv[5] : "solid";
+
+	namespace H_ = StellarX::Headless;
+	const COLORREF bk = RGB(240, 242, 245);
+	Window mainWindow(1920, 2800, 0, bk, "StellarX table bench");
+
+	auto tableOwner = std::make_unique<Table>(20, 20);
+	Table* table = tableOwner.get();
+	table->setHeaders({ "Id", "Name", "Region", "City", "Status", "Owner", "Type", "Created", "Updated", "Score",
+		"Rank", "Group", "Tag", "Level", "Count", "Amount", "Rate", "Flag", "Note", "Code" });
+	for (int r = 0; r < 250; ++r)
+	{
+		std::vector<std::string> row;
+		for (int c = 0; c < 20; ++c)
+			row.push_back(c == 0 ? std::to_string(r) : "r" + std::to_string(r) + "c" + std::to_string(c * 7 % 13));
+		table->setData(row);
+	}
+	table->setRowsPerPage(100);
+	table->setTableBorderWidth(borderWidth);
+	table->setTableBorder(RGB(90, 100, 120));
+	table->setTableBk(RGB(255, 255, 255));
+	if (std::strcmp(fill, "null") == 0)
+		table->setTableFillMode(StellarX::FillMode::Null);
+	if (std::strcmp(line, "dash") == 0)
+		table->setTableLineStyle(StellarX::LineStyle::Dash);
+	else if (std::strcmp(line, "null") == 0)
+		table->setTableLineStyle(StellarX::LineStyle::Null);
+	mainWindow.addControl(std::move(tableOwner));
+
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+
+	// 1) 整表强制重绘：每帧一整页（表头 + 100 行 × 20 列）
+	auto& hs = H_::stats();
+	H_::resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; ++i)
+	{
+		table->setDirty(true);
+		table->draw();
+	}
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	std::printf("table         : %dx%d px, %d cols, %d rows per page, border %d, fill %s, line %s\n",
+		table->getTableWidth(), table->getTableHeight(), 20, table->getRowsPerPage(), borderWidth, fill, line);
+	std::printf("page redraw   : %.3f ms per frame (%d frames)\n", frames > 0 ? ms / frames : 0.0, frames);
+	std::printf("per frame     : %llu draw calls, %llu text calls\n",
+		(unsigned long long)(frames > 0 ? hs.drawCalls / frames : 0), (unsigned long long)(frames > 0 ? hs.textCalls / frames : 0));
+
+	// 2) 合成器模式：按块裁剪重画整场景，结果应与整表绘制一致
+	if (compositor)
+	{
+		StellarX::RedrawScheduler::setEnabled(true);
+		StellarX::RedrawScheduler::setTileSize(128);
+		mainWindow.setBkcolor(bk);
+		H_::postMouse(WM_MOUSEMOVE, 1900, 2790, 16);
+		mainWindow.runEventLoop();
+		std::printf("tiled compose : %llu items\n", (unsigned long long)StellarX::RedrawScheduler::stats().items);
+	}
+
+	SetWorkingImage(nullptr);
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash    : %016llx\n", (unsigned long long)hash);
+	return 0;
+}
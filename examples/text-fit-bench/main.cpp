@@ -0,0 +1,123 @@
+﻿/**
+ * @file main.cpp
+ * @brief 文本适配(StellarX::fitTextPrefix)校验与基准：与逐字符线性扫描对拍，并比较度量次数与耗时。
+ * @description
+ *     1) 校验：随机生成 ASCII 与 GBK 混排文本、随机可用宽度，
+ *        二分结果必须与原按钮省略逻辑的逐字符线性扫描完全一致；
+ *     2) 基准：对不同长度的长标签求省略前缀，输出每次求解的 textwidth 调用次数与耗时。
+ *        基准期间关闭 TextMeasureCache，统计的是真实度量次数。
+ *
+ *     依赖无头后端的文本度量（后端统计 metricCalls）。
+ *     用法: text-fit-bench [校验轮数]
+ */
+
+#include "StellarX.h"
+#include "SxTextFit.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace
+{
+	namespace H = StellarX::Headless;
+
+	// 原按钮省略逻辑：逐字符延长前缀并整串重测，遇到第一个放不下的字符即停止
+	std::size_t linearFit(const std::string& text, int limit)
+	{
+		std::size_t i = 0, lastFit = 0;
+		while (i < text.size())
+		{
+			const std::size_t next = i + (std::size_t)StellarX::gbkCharLen(text, i);
+			const std::size_t j = text.size() < next ? text.size() : next;
+			if (textwidth(LPCTSTR(text.substr(0, j).c_str())) <= limit) { lastFit = j; i = j; }
+			else break;
+		}
+		return lastFit;
+	}
+
+	std::string randomText(std::mt19937& rng, int chars, bool gbk)
+	{
+		static const char* words[] = { "alpha", "beta", "gamma", "delta", "-", "_", "/", " ", ".", ":" };
+		std::uniform_int_distribution<int> pick(0, 9), lead(0xB0, 0xF7), trail(0xA1, 0xFE), coin(0, 3);
+		std::string s;
+		while ((int)StellarX::textCharEnds(s).size() < chars)
+		{
+			if (gbk && coin(rng) == 0)
+			{
+				s += (char)lead(rng);
+				s += (char)trail(rng);
+			}
+			else
+				s += words[pick(rng)];
+		}
+		return s;
+	}
+
+	int verify(int rounds)
+	{
+		std::mt19937 rng(2024);
+		std::uniform_int_distribution<int> len(0, 80), coin(0, 1);
+		for (int r = 0; r < rounds; ++r)
+		{
+			const std::string text = randomText(rng, len(rng), coin(rng) != 0);
+			const int full = textwidth(LPCTSTR(text.c_str()));
+			std::uniform_int_distribution<int> limit(-4, full + 8);
+			const int maxW = limit(rng);
+			if (StellarX::fitTextPrefix(text, maxW) != linearFit(text, maxW))
+			{
+				std::fprintf(stderr, "mismatch at round %d (maxW=%d): %s\n", r, maxW, text.c_str());
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+	void bench()
+	{
+		std::mt19937 rng(99);
+		for (int chars : { 16, 64, 256, 1024 })
+		{
+			const std::string text = randomText(rng, chars, false);
+			const int maxW = textwidth(LPCTSTR(text.c_str())) * 3 / 4;   // 约在四分之三处截断
+			const int iterations = chars >= 1024 ? 20 : 200;
+
+			std::size_t linearCut = 0, binaryCut = 0;
+			H::resetStats();
+			auto t0 = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; ++i) linearCut = linearFit(text, maxW);
+			auto t1 = std::chrono::steady_clock::now();
+			const auto linearCalls = H::stats().metricCalls / iterations;
+			const double linearUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+
+			H::resetStats();
+			t0 = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; ++i) binaryCut = StellarX::fitTextPrefix(text, maxW);
+			t1 = std::chrono::steady_clock::now();
+			const auto binaryCalls = H::stats().metricCalls / iterations;
+			const double binaryUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / iterations;
+
+			std::printf("%5d chars   : linear %5llu measures %9.1f us | binary %3llu measures %7.1f us | cut %s\n",
+				chars, (unsigned long long)linearCalls, linearUs, (unsigned long long)binaryCalls, binaryUs,
+				linearCut == binaryCut ? "same" : "DIFFERENT");
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+	initgraph(320, 240);
+	settextstyle(16, 0, "Consolas");
+	// 关闭度量缓存：校验与基准都针对真实度量
+	StellarX::TextMeasureCache::Get().setCapacity(0);
+
+	if (verify(rounds) != 0)
+		return 1;
+	std::printf("verify        : ok (%d random ASCII/GBK texts against the linear scan)\n", rounds);
+	bench();
+	closegraph();
+	return 0;
+}
@@ -0,0 +1,82 @@
+﻿/**
+ * @file main.cpp
+ * @brief 无头后端文本光栅化基准：逐像素光栅化 与 字形图集回放 在“整页表格”上的对比。
+ * @description
+ *     构建一个 6 列、每页 25 行、ASCII 与 GBK 混排的表格，强制重绘同一页若干次：
+ *       1) 关闭字形图集（每次 outtextxy 都逐像素缩放点阵、逐点裁剪写入）；
+ *       2) 开启字形图集（每个字形只光栅化一次，之后按行游程整段填充）。
+ *     两次的最终帧必须逐字节一致；输出每页耗时与图集命中统计。
+ *
+ *     用法: text-raster-bench [重绘页数]
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	namespace H = StellarX::Headless;
+
+	double drawPages(Table& table, int pages)
+	{
+		const auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < pages; ++i)
+		{
+			table.setDirty(true);
+			table.draw();
+		}
+		const auto t1 = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(t1 - t0).count() / pages;
+	}
+
+	std::vector<DWORD> frame()
+	{
+		IMAGE* s = H::screen();
+		const DWORD* px = GetImageBuffer(s);
+		return std::vector<DWORD>(px, px + (std::size_t)s->getwidth() * s->getheight());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int pages = argc > 1 ? std::atoi(argv[1]) : 200;
+
+	Window mainWindow(1000, 760, 0, RGB(240, 240, 240), "StellarX text raster bench");
+	auto table = std::make_unique<Table>(10, 10);
+	// 表头与部分单元格为 GBK 编码的中文
+	table->setHeaders({ "ID", "\xD0\xD5\xC3\xFB", "Department", "Score", "\xB1\xB8\xD7\xA2", "Updated" });
+	for (int i = 0; i < 25; ++i)
+	{
+		table->setData({ std::to_string(1000 + i), "user_" + std::to_string(i * 37 % 100),
+			i % 3 ? "Engineering" : "\xD1\xD0\xB7\xA2\xB2\xBF", std::to_string(50 + i * 7 % 50) + ".5",
+			i % 2 ? "ok" : "\xB4\xFD\xB8\xB4\xBA\xCB", "2024-0" + std::to_string(1 + i % 9) + "-1" + std::to_string(i % 10) });
+	}
+	table->setRowsPerPage(25);
+	Table& ref = *table;
+	mainWindow.addControl(std::move(table));
+	mainWindow.draw();
+
+	H::setGlyphAtlasEnabled(false);
+	H::resetStats();
+	const double perCallMs = drawPages(ref, pages);
+	const auto textCalls = H::stats().textCalls / pages;
+	const std::vector<DWORD> perCallFrame = frame();
+
+	H::setGlyphAtlasEnabled(true);
+	H::clearGlyphAtlas();
+	H::resetStats();
+	const double atlasMs = drawPages(ref, pages);
+	const auto& st = H::stats();
+	const bool same = frame() == perCallFrame;
+
+	std::printf("page          : %llu outtextxy calls\n", (unsigned long long)textCalls);
+	std::printf("per-call      : %.3f ms/page\n", perCallMs);
+	std::printf("glyph atlas   : %.3f ms/page (%.2fx)\n", atlasMs, perCallMs / atlasMs);
+	std::printf("atlas glyphs  : %llu rasterized, %llu hits\n", (unsigned long long)st.glyphMisses, (unsigned long long)st.glyphHits);
+	std::printf("frames        : %s\n", same ? "identical" : "DIFFERENT");
+	return same ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+﻿/**
+ * @file main.cpp
+ * @brief 分块光栅化示例：大窗口反复调整尺寸，整屏重绘在线程池上逐块并行。
+ * @description
+ *     2560x1440 的窗口铺满按钮、标签、文本框与若干实心面板（合成器模式），
+ *     脚本反复调整窗口尺寸，每次都触发 Window::redrawScene 整屏重绘。
+ *     结束后输出耗时、分块统计与后端统计，并打印最终帧的哈希。
+ *
+ *     用法: tile-raster-bench [调整次数] [on|off] [线程数] [块边长] [输出文件.ppm]
+ *       on  —— 默认，整屏重绘走分块帧
+ *       off —— 逐条立即光栅化，用于对比耗时与帧哈希
+ *       线程数 0 表示按硬件线程数（含 UI 线程）
+ */
+
+#include "StellarX.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const int resizes = argc > 1 ? std::atoi(argv[1]) : 20;
+	const bool tiled = !(argc > 2 && std::strcmp(argv[2], "off") == 0);
+	const unsigned threads = argc > 3 ? (unsigned)std::atoi(argv[3]) : 0;
+	const int tileSize = argc > 4 ? std::atoi(argv[4]) : 128;
+	const std::string outFile = argc > 5 ? argv[5] : "";
+
+	StellarX::TileRender::setEnabled(tiled);
+	StellarX::TileRender::setTileSize(tileSize);
+	StellarX::ThreadPool::Get().setThreadCount(threads);
+
+	// 初始尺寸即最小客户区：拉伸只能从它往大走，所以在 W×H 与 (W+40)×(H+40) 之间往返
+	const int W = 2560, H = 1440;
+	Window mainWindow(W, H, 0, RGB(236, 238, 242), "StellarX tile raster bench");
+
+	// 四块面板，每块里是按钮 / 标签 / 文本框交替的网格
+	for (int p = 0; p < 4; ++p)
+	{
+		const int px = 20 + (p % 2) * (W / 2), py = 20 + (p / 2) * (H / 2);
+		auto panel = std::make_unique<Canvas>(px, py, W / 2 - 40, H / 2 - 40);
+		panel->setCanvasBkColor(p % 2 ? RGB(250, 250, 250) : RGB(244, 247, 252));
+		const int cols = (W / 2 - 72) / 155, rows = (H / 2 - 72) / 50;
+		for (int row = 0; row < rows; ++row)
+			for (int col = 0; col < cols; ++col)
+			{
+				const int x = 16 + col * 155, y = 16 + row * 50;
+				const std::string tag = std::to_string(p) + "." + std::to_string(row * cols + col);
+				switch ((row + col) % 3)
+				{
+				case 0:
+					panel->addControl(std::make_unique<Button>(x, y, 140, 38, "Button " + tag,
+						StellarX::ButtonMode::NORMAL, (row % 2) ? StellarX::ControlShape::ROUND_RECTANGLE : StellarX::ControlShape::RECTANGLE));
+					break;
+				case 1:
+					panel->addControl(std::make_unique<Label>(x, y + 10, "value " + tag, RGB(40, 40, 40), RGB(250, 250, 250)));
+					break;
+				default:
+					panel->addControl(std::make_unique<TextBox>(x, y, 140, 38, "text " + tag, StellarX::TextBoxmode::READONLY_MODE));
+					break;
+				}
+			}
+		mainWindow.addControl(std::move(panel));
+	}
+
+	mainWindow.setCompositorEnabled(true);
+	mainWindow.draw();
+
+	namespace H_ = StellarX::Headless;
+	for (int i = 0; i < resizes; ++i)
+		H_::postResize(i % 2 ? W : W + 40, i % 2 ? H : H + 40, 16);
+	if (resizes % 2)
+		H_::postResize(W, H, 16);
+
+	H_::resetStats();
+	H_::resetTileStats();
+	StellarX::ThreadPool::Get().resetStats();
+	const auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const auto t1 = std::chrono::steady_clock::now();
+
+	const auto& st = H_::stats();
+	const auto& ts = H_::tileStats();
+	const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	std::printf("tiled         : %s, %u threads, %dpx tiles\n", tiled ? "on" : "off",
+		StellarX::ThreadPool::Get().threadCount(), StellarX::TileRender::tileSize());
+	std::printf("wall time     : %.3f ms (%.3f ms/resize)\n", ms, resizes ? ms / resizes : 0.0);
+	std::printf("tile frames   : %llu (%llu flushes, %llu forced mid-frame)\n",
+		(unsigned long long)ts.frames, (unsigned long long)ts.flushes, (unsigned long long)ts.syncFlushes);
+	std::printf("commands      : %llu recorded, %llu binned into %llu tile jobs, %llu stolen\n",
+		(unsigned long long)ts.commands, (unsigned long long)ts.binned,
+		(unsigned long long)ts.tileJobs, (unsigned long long)ts.steals);
+	std::printf("draw calls    : %llu\n", (unsigned long long)st.drawCalls);
+	std::printf("presents      : %llu\n", (unsigned long long)st.presents);
+	std::printf("bytes written : %llu\n", (unsigned long long)st.bytesWritten);
+
+	// 最终帧哈希：on / off 以及不同线程数必须相同
+	SetWorkingImage(nullptr);
+	std::printf("frame hash    : %016llx\n",
+		(unsigned long long)StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0));
+	if (!outFile.empty() && !H_::dumpPPM(outFile))
+	{
+		std::fprintf(stderr, "failed to write %s\n", outFile.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+﻿/**
+ * @file main.cpp
+ * @brief 半透明示例：整窗 50% 压暗层的预乘 alpha 合成开销，以及底图不变时的合成缓存。
+ * @description
+ *     1280x720 窗口铺满按钮网格，上面盖一块整窗黑色画布（setOpacity(128)，即 50% 压暗），
+ *     最上层是几个圆角按钮组成的“弹出菜单”。
+ *       1) 内核：整窗像素 premultiply + blendPremultiplied 一遍的耗时（逐个指令集）；
+ *       2) 强制重合成：每帧把压暗层的不透明度在 127 / 128 之间切换并提交重绘，
+ *          测每帧耗时（逐个指令集），最后停在 128；
+ *       3) 悬停：鼠标在弹出菜单的按钮上移入移出。合成器模式下损伤区穿过压暗层，
+ *          压暗层只合成损伤区那一块；底图没变（移出时）直接贴缓存的合成结果；
+ *       4) 校验：空白处的背景 240 经压暗为 120；输出最终帧哈希（两种模式应一致）。
+ *
+ *     用法: translucent-bench [每个指令集的帧数] [snapshot|compositor] [悬停往返次数]
+ */
+
+#include "StellarX.h"
+#include "SxPixelKernels.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	double msSince(std::chrono::steady_clock::time_point t0)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	std::vector<StellarX::Pixel::Isa> availableIsas()
+	{
+		using Isa = StellarX::Pixel::Isa;
+		std::vector<Isa> isas{ Isa::Scalar };
+		if ((int)StellarX::Pixel::bestIsa() >= (int)Isa::SSE2) isas.push_back(Isa::SSE2);
+		if ((int)StellarX::Pixel::bestIsa() >= (int)Isa::AVX2) isas.push_back(Isa::AVX2);
+		return isas;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int frames = argc > 1 ? (std::max)(2, std::atoi(argv[1])) : 20;
+	const bool compositor = argc > 2 && std::strcmp(argv[2], "compositor") == 0;
+	const int rounds = argc > 3 ? std::atoi(argv[3]) : 12;
+
+	namespace H_ = StellarX::Headless;
+	namespace Px = StellarX::Pixel;
+	const int W = 1280, H = 720;
+	Window mainWindow(W, H, 0, RGB(240, 240, 240), "StellarX translucent bench");
+
+	for (int row = 0; row < 12; ++row)
+		for (int col = 0; col < 16; ++col)
+			mainWindow.addControl(std::make_unique<Button>(20 + col * 40, 20 + row * 40, 30, 30, std::to_string(row * 16 + col)));
+
+	auto dimOwner = std::make_unique<Canvas>(0, 0, W, H);
+	Canvas* dim = dimOwner.get();
+	dim->setShape(StellarX::ControlShape::B_RECTANGLE);
+	dim->setCanvasBkColor(RGB(0, 0, 0));
+	dim->setOpacity(128);
+	mainWindow.addControl(std::move(dimOwner));
+
+	const int menuItems = 4;
+	for (int i = 0; i < menuItems; ++i)
+	{
+		auto item = std::make_unique<Button>(760, 200 + i * 60, 240, 44, "Menu item " + std::to_string(i), StellarX::ButtonMode::NORMAL, StellarX::ControlShape::ROUND_RECTANGLE);
+		mainWindow.addControl(std::move(item));
+	}
+
+	mainWindow.setCompositorEnabled(compositor);
+	mainWindow.draw();
+
+	// 1) 内核：整窗一遍
+	std::vector<std::uint32_t> under((std::size_t)W * H, 0x00F0F0F0u), layer((std::size_t)W * H, 0x00000000u), work(under.size());
+	const auto isas = availableIsas();
+	std::printf("%-10s %14s %16s\n", "isa", "kernel ms", "re-blend ms/frm");
+	auto& ts = Control::translucentStats();
+	std::uint64_t reblends = 0;
+	for (auto isa : isas)
+	{
+		Px::setIsa(isa);
+		const int passes = 20;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int p = 0; p < passes; ++p)
+		{
+			Px::copy(work.data(), under.data(), work.size());
+			Px::premultiply(layer.data(), layer.data(), layer.size(), 128);
+			Px::blendPremultiplied(work.data(), layer.data(), work.size());
+		}
+		const double kernelMs = msSince(t0) / passes;
+
+		// 2) 强制重合成：不透明度变化使内容键变化，每帧都要读回并混合
+		ts = Control::TranslucentStats{};
+		t0 = std::chrono::steady_clock::now();
+		for (int f = 0; f < frames; ++f)
+		{
+			dim->setOpacity(f % 2 ? 128 : 127);
+			mainWindow.requestManagedRepaint(dim);
+			mainWindow.flushManagedRepaint();
+		}
+		const double frameMs = msSince(t0) / frames;
+		reblends += ts.composited;
+		std::printf("%-10s %14.3f %16.3f\n", Px::isaName(isa), kernelMs, frameMs);
+	}
+	Px::setIsa(Px::bestIsa());
+
+	// 3) 悬停弹出菜单：移入、移到空白处，逐项往返
+	ts = Control::TranslucentStats{};
+	for (int i = 0; i < rounds; ++i)
+	{
+		const int item = i % menuItems;
+		H_::postMouse(WM_MOUSEMOVE, 880, 222 + item * 60, 16);
+		H_::postMouse(WM_MOUSEMOVE, 1200, 650, 16);
+	}
+	auto t0 = std::chrono::steady_clock::now();
+	mainWindow.runEventLoop();
+	const double hoverMs = msSince(t0);
+	const Control::TranslucentStats hover = ts;
+
+	// 4) 校验：网格与菜单之外的空白背景被压暗一半
+	SetWorkingImage(nullptr);
+	const COLORREF px = getpixel(1270, 700);
+	const bool ok = reblends == (std::uint64_t)frames * isas.size() && px == RGB(120, 120, 120);
+
+	std::printf("mode          : %s\n", compositor ? "compositor" : "snapshot");
+	std::printf("re-blend      : %llu composites over %d frames x %zu isa\n", (unsigned long long)reblends, frames, isas.size());
+	std::printf("hover         : %d moves in %.3f ms, composited %llu (%llu px), reused %llu\n", rounds * 2, hoverMs,
+		(unsigned long long)hover.composited, (unsigned long long)hover.pixels, (unsigned long long)hover.reused);
+	std::printf("verify        : %s (background pixel %06X)\n", ok ? "ok" : "FAILED", (unsigned)px);
+
+	const auto hash = StellarX::LayerCache::hashScreenRect(0, 0, getwidth(), getheight(), 0);
+	std::printf("frame hash    : %016llx\n", (unsigned long long)hash);
+	return ok ? 0 : 1;
+}
@@ -19,7 +19,8 @@
  ******************************************************************************/
 #pragma once
 #include "Control.h"
-#include"label.h"
+#include"Label.h"
+#include "SxImageCache.h"
 
 #define DISABLEDCOLOUR RGB(96, 96, 96) //禁用状态颜色
 #define TEXTMARGINS_X 6      
@@ -49,7 +50,8 @@ class Button : public Control
 
 	StellarX::FillMode    buttonFillMode = StellarX::FillMode::Solid;     //按钮填充模式
 	StellarX::FillStyle   buttonFillIma = StellarX::FillStyle::BDiagonal; //按钮填充图案
-	std::unique_ptr<IMAGE> buttonFileIMAGE;      //按钮填充图像
+	std::shared_ptr<StellarX::ImageAsset> buttonFileIMAGE; //按钮填充图像（经 ImageCache 共享，解码完成前以纯色占位）
+	std::uint64_t fillImageWaiter = 0;           //填充图像就绪回调的令牌
 
 	std::function<void()> onClickCallback;      //回调函数
 	std::function<void()> onToggleOnCallback;   //TOGGLE模式下的回调函数
@@ -70,6 +72,7 @@ class Button : public Control
 	int         tipOffsetX = 12;              // 相对鼠标偏移
 	int         tipOffsetY = 18;
 	ULONGLONG   tipHoverTick = 0;             // 开始悬停的时间戳
+	std::uint64_t tipTimer = 0;               // 延时到点的定时器（EventLoop::addTimer），0 表示未登记
 	int         lastMouseX = 0;               // 最新鼠标位置(用于定位)
 	int         lastMouseY = 0;
 
@@ -101,6 +104,16 @@ public:
 	void draw() override;
 	//按钮事件处理
 	bool handleEvent(const ExMessage& msg) override;
+	//合成器模式下的绘制范围（提示框可见时一并计入）
+	RECT getDamageRect() const override;
+	//显示列表与屏幕像素均未变化时可跳过重绘
+	bool isPresentationCurrent() override;
+	//实心填充的矩形按钮内部不透明（遮挡剔除）
+	void addOpaqueRegion(StellarX::Region& out) const override;
+	//实心填充的矩形按钮盖满整个快照范围（含右下边框），不必抓背景
+	bool isOpaque() const override;
+	//快照字节数含提示框
+	std::size_t snapshotBytes() const override;
 
 	//设置回调函数
 	void setOnClickListener(std::function<void()> callback);
@@ -169,6 +182,8 @@ public:
 	//设置提示框文本
 	void setTooltipText(const std::string& s) { tipTextClick = s; tipUserOverride = true; }
 	void setTooltipTextsForToggle(const std::string& onText, const std::string& offText);
+	//提示框当前是否显示
+	bool isTooltipVisible() const { return tipVisible; }
 private:
 	//初始化按钮
 	void initButton(const std::string text, StellarX::ButtonMode mode, StellarX::ControlShape shape, COLORREF ct, COLORREF cf, COLORREF ch);
@@ -180,8 +195,12 @@ private:
 	bool model() const override { return false; }
 	//文本截断
 	void cutButtonText();
+	//记录本次绘制的显示列表（样式随之生效）
+	void recordDisplayList();
 	// 统一隐藏&恢复背景
 	void hideTooltip();
+	// 悬停已满延时则显示提示框，否则登记到点的定时器
+	void showTooltipIfDue();
 	// 根据当前 click 状态选择文案
 	void refreshTooltipTextForState();
 };
@@ -34,12 +34,30 @@ protected:
 	COLORREF              canvasBorderClor = RGB(0, 0, 0);    //边框颜色
 	COLORREF              canvasBkClor = RGB(255, 255, 255);    //背景颜色
 
+	// 快照共享：画完本体（子控件之前）的屏幕像素，压缩留存；子控件的快照直接引用
+	StellarX::RleImage body;
+	int bodyX = 0, bodyY = 0;
+
 	// 清除所有子控件
 	void clearAllControls();
+	// 记录画布本体（边框、填充、形状）的显示列表
+	void recordDisplayList();
+	// 重放本体后调用：有子控件时抓取并压缩本体，压不下来则不留存
+	void captureBody();
+	// 是否有子控件会引用本体
+	virtual bool hasBodyChildren() const { return !controls.empty(); }
+	bool bodyCovers(int x, int y, int w, int h) const override;
+	bool sharesBody(const Control* child, int x, int y, int w, int h) const override;
+	void restoreBody(int x, int y, int w, int h) const override;
+	// 本体重画后子控件都要重画：只记整树代号（O(1)），不逐个 setDirty
+	void markChildrenDirty();
+	// 像素基线只含本体露出的部分，可见子控件的范围除外
+	std::uint64_t hashPresentedPixels() const override;
 public:
 	Canvas();
 	Canvas(int x, int y, int width, int height);
-	~Canvas() {}
+	// 子控件析构时可能从本体回贴背景，须先于本体销毁
+	~Canvas() { controls.clear(); }
 
 	void setX(int x)override;
 	void setY(int y)override;
@@ -71,6 +89,16 @@ public:
 	bool canCommitManagedPartialRepaint() const override; 
 	// 托管收口阶段执行 Canvas 的真正重绘
 	void commitManagedRepaint() override;                 
+	// 合成器模式：本体脏时整块登记，否则只登记脏的子控件
+	void collectDamageRects(std::vector<RECT>& out) const override;
+	// 本体显示列表与像素未变，且脏的子控件也都未变时可跳过重绘
+	bool isPresentationCurrent() override;
+	// 实心填充时本体（不含边框，圆角按十字臂）不透明
+	void addOpaqueRegion(StellarX::Region& out) const override;
+	// 本体 + 自身快照 + 全部子控件的快照字节数
+	std::size_t snapshotBytes() const override;
+	// 实心填充的矩形画布且线宽不超过 1（快照外扩的一圈从不绘制）时不必抓背景
+	bool isOpaque() const override;
 	//获取子控件列表
 	std::vector<std::unique_ptr<Control>>& getControls() { return controls; }
 private:
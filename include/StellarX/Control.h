@@ -5,10 +5,18 @@
  *     提供控件的基本属性和方法，包括位置、尺寸、重绘标记等。
  *     实现绘图状态保存和恢复机制，确保控件绘制不影响全局状态。
  *     同时提供“事件阶段登记、收口阶段统一提交”的托管重绘基础接口。
+ *     宿主窗口启用合成器时，背景快照只记录范围（不抓屏），由窗口按损伤区重合成。
+ *     快照像素缓冲由 StellarX::SurfacePool 统一借还，受全局字节预算约束。
+ *     控件可把绘制内容记录为显示列表（StellarX::DisplayList），列表与屏幕像素
+ *     都未变化时跳过重放，虚假重绘只花一次哈希比较。
+ *     脏标记按代号比较：容器整树标脏 / 清脏只记一个代号，后代查询时沿 parent 向上取最新者，
+ *     不再逐个递归设置。
+ *     setOpacity(<255) 使控件整体半透明：照常画出后读回，按预乘 alpha 与底图合成再贴回；
+ *     合成结果连同底图哈希缓存下来，底图与内容都没变时直接贴缓存，不再混合。
  *
  * @特性:
  *     - 定义控件基本属性（坐标、尺寸、脏标记）
- *     - 提供绘图状态管理（saveStyle/restoreStyle）
+ *     - 提供绘图状态管理（saveStyle/restoreStyle，经 StellarX::RenderState 栈式保存并消除重复设置）
  *     - 声明纯虚接口（draw、handleEvent等）
  *     - 禁止移动语义，禁止拷贝语义
  *
@@ -17,20 +25,16 @@
  * @作者: 我在人间做废物
  ******************************************************************************/
 #pragma once
-#ifndef _WIN32_WINNT
-#define _WIN32_WINNT 0x0600
-#endif
-#ifndef WINVER
-#define WINVER _WIN32_WINNT
-#endif
-#include <windows.h>
+#include "SxBackend.h"
+#include "SxDisplayList.h"
+#include "SxRegion.h"
+#include "SxRleImage.h"
 #include <vector>
 #include <memory>
-#include <easyx.h>
-#undef MessageBox
 #include <iostream>
 #include <string>
 #include <functional>
+#include <algorithm>
 #include "CoreTypes.h"
 
 class Window;
@@ -43,7 +47,32 @@ protected:
 	int localWidth, width, localHeight, height;  // 控件尺寸
 	Control* parent = nullptr;    // 父控件
 	Window* hostWindow = nullptr; // 宿主窗口（顶层由 Window 注入，子控件可沿 parent 回溯）
-	bool dirty = true; // 是否重绘
+public:
+	// 脏标记代号：每次标脏 / 清脏各取一个全局递增的代号，两者谁新决定当前状态
+	struct DirtyStamp
+	{
+		std::uint64_t marked = 0;   // 最近一次标脏的代号
+		std::uint64_t cleaned = 0;  // 最近一次清脏（画完或 setDirty(false)）的代号
+
+		explicit DirtyStamp(bool d = false) { if (d) marked = ++dirtyGeneration; }
+		DirtyStamp& operator=(bool d) { (d ? marked : cleaned) = ++dirtyGeneration; return *this; }
+		// 只看本身，不含祖先的整树标记；判断是否需要重绘用 isDirty()
+		explicit operator bool() const { return marked > cleaned; }
+		// 并入另一份代号（各取较新者）
+		void merge(const DirtyStamp& o) { marked = (std::max)(marked, o.marked); cleaned = (std::max)(cleaned, o.cleaned); }
+	};
+protected:
+	static std::uint64_t dirtyGeneration;
+
+	DirtyStamp dirty{ true };  // 自身版本：本控件状态变化时 dirty = true，画完 dirty = false
+	DirtyStamp subtree;        // 容器标记整棵子树时记下的整树代号，对全部后代生效
+	const DirtyStamp* sceneStamp = nullptr; // 顶层控件：宿主窗口整场景重绘的代号，相当于顶层之上的整树代号（Window 注入）
+	// 本控件与各级祖先整树代号的并：子控件的 isDirty 只与父控件的这份缓存比较。
+	// 显式整树标脏 / 清脏与换父容器时 subtreeEpoch 加一，缓存按需重算（均摊 O(1)）
+	mutable DirtyStamp chain;
+	mutable std::uint64_t chainEpoch = 0;
+	static std::uint64_t subtreeEpoch;
+	const DirtyStamp& subtreeChain() const;
 	bool show = true; // 是否显示
 	bool eventVisualChanged = false; // 最近一次 handleEvent 是否真的引发了视觉变化（用于上层判断是否需要登记重绘）
 
@@ -57,14 +86,34 @@ protected:
 	int saveBkX = 0, saveBkY = 0;      // 快照保存起始坐标
 	int saveWidth = 0, saveHeight = 0; // 快照保存尺寸
 	bool hasSnap = false;     //  当前是否持有有效快照
+	bool snapRetained = false; // 合成器模式：快照只记录范围，像素由窗口后台缓冲保留
+	bool snapOpaque = false;   // 不透明控件：快照只记录范围，绘制必定盖满，不抓像素
+	bool snapShared = false;   // 快照引用父容器画完本体时的像素（Canvas 本体），不另存
+	std::unique_ptr<StellarX::RleImage> packedBk; // 大块均匀快照压缩存放，此时不持有 saveBkImage
 
-	StellarX::RouRectangle rouRectangleSize; // 圆角矩形椭圆宽度和高度
+	/* == 不透明度 == */
+	struct TranslucentLayer
+	{
+		IMAGE composite;                 // 抓到的底图；合成后即贴到屏幕上的结果
+		int x = 0, y = 0, w = 0, h = 0;  // 合成范围（屏幕坐标，取快照范围）
+		std::uint64_t underHash = 0;     // 合成时底图的像素哈希
+		std::uint64_t contentKey = 0;    // 合成时的内容键；0 表示不可复用
+		std::uint8_t opacity = 255;
+		bool valid = false;              // composite 是可复用的合成结果
+		bool active = false;             // 已抓底图，等待 endTranslucent 合成
+	};
+	std::uint8_t opacity = 255;          // 整体不透明度：255 不透明（默认），0 完全透明
+	int translucentHold = 0;             // >0 时由外层 draw（Dialog / TabControl 的附加内容）负责合成收尾
+	std::unique_ptr<TranslucentLayer> translucentLayer; // 只在半透明时分配
+
+	/* == 显示列表 == */
+	StellarX::DisplayList displayList;          // 本次绘制记录的命令
+	bool presented = false;                     // 是否已按列表画到屏幕上
+	std::uint64_t presentedListHash = 0;        // 上次重放的列表哈希
+	std::uint64_t presentedPixelHash = 0;       // 上次重放后快照范围内的屏幕像素哈希
+	int presentedX = 0, presentedY = 0, presentedW = 0, presentedH = 0; // 上次计算像素哈希的范围
 
-	LOGFONT currentFont{};       // 保存当前字体样式和颜色
-	COLORREF currentColor{};
-	COLORREF currentBkColor{};  // 保存当前填充色
-	COLORREF currentBorderColor{}; // 边框颜色
-	LINESTYLE currentLineStyle{}; // 保存当前线型
+	StellarX::RouRectangle rouRectangleSize; // 圆角矩形椭圆宽度和高度
 
 	Control(const Control&) = delete;
 	Control& operator=(const Control&) = delete;
@@ -88,6 +137,8 @@ protected:
 	virtual void onRequestRepaintAsRoot();
 	// 当前是否处于 Window 托管分发阶段；若为真，则不应立即画
 	bool shouldDeferManagedRepaint() const;
+	// 宿主窗口是否启用了合成器（快照退化为范围记录）
+	bool usesCompositor() const;
 protected:
 	//保存背景快照
 	virtual void saveBackground(int x, int y, int w, int h);
@@ -95,6 +146,38 @@ protected:
 	virtual void restBackground();
 	// 回贴旧背景并释放快照
 	void discardBackground();
+	// 隐藏时擦除自己：回贴旧背景；不透明控件没有留底像素，改为请父容器重画
+	void eraseFromScreen();
+	// 不透明快照作废时旧范围里没有留底像素：标记父容器下次整块重画（只改标志，析构路径也安全）
+	void exposeToParent();
+	// 释放快照像素：表面归还给 SurfacePool（saveBkImage 随之置空），压缩快照与共享引用一并丢弃
+	void releaseSnapshotSurface();
+	// 快照是否持有可回贴的像素（自己的表面 / 压缩快照 / 父容器本体）
+	bool holdsSnapshotPixels() const { return hasSnap && (saveBkImage != nullptr || packedBk != nullptr || snapShared); }
+	// 快照共享：容器把画完本体（子控件之前）的像素压缩留存；范围被本体完全覆盖时为真
+	virtual bool bodyCovers(int, int, int, int) const { return false; }
+	// child 即将抓取 [x, x+w) × [y, y+h)：在本体内且底下没有先画的兄弟时可直接引用本体
+	virtual bool sharesBody(const Control*, int, int, int, int) const { return false; }
+	// 把本体的这块范围贴回屏幕
+	virtual void restoreBody(int, int, int, int) const {}
+	// 压缩屏幕矩形（须完全在屏幕内）；压不到原始大小的 1/4 时返回 false
+	static bool packScreenRect(StellarX::RleImage& out, int x, int y, int w, int h);
+	// 把压缩图像的 [sx, sx+w) × [sy, sy+h) 贴到屏幕 (dstX, dstY)
+	static void putPacked(const StellarX::RleImage& img, int dstX, int dstY, int sx, int sy, int w, int h);
+	// 刚记录的显示列表与上次重放相同，且快照范围内的屏幕像素仍是上次画完时的样子
+	bool displayListCurrent();
+	// 只比较屏幕像素：快照范围内仍是上次画完时的样子
+	bool presentedPixelsCurrent();
+	// 重放完成后调用：记下列表哈希与当前屏幕像素哈希
+	void markDisplayListPresented();
+	// 上次画完时记下、比较时重算的屏幕像素哈希（调用方已 SetWorkingImage(nullptr)）：默认取快照范围
+	virtual std::uint64_t hashPresentedPixels() const;
+	// 半透明绘制的前半段，在 restBackground 之后调用：抓取快照范围内的底图。
+	// 底图哈希与内容键（contentKey，0 表示不可复用）都与上次相同时直接贴上次的合成结果并返回 true，调用方跳过绘制
+	bool beginTranslucent(std::uint64_t contentKey);
+	// 半透明绘制的后半段，在内容（含子控件）画完之后、markDisplayListPresented 之前调用：
+	// 读回画好的像素，按 opacity 预乘后覆盖到底图上，再整块贴回
+	void endTranslucent();
 public:
 	// 仅作废快照，不回贴旧背景
 	void invalidateBackgroundSnapshot();
@@ -125,24 +208,49 @@ public:
 	virtual bool handleEvent(const ExMessage& msg) = 0;//返回true代表事件已消费
 	//设置是否显示
 	virtual void setIsVisible(bool show);
+	//设置整体不透明度（0~255），小于 255 时与底下的像素合成；半透明控件不参与遮挡剔除与不透明快照
+	void setOpacity(std::uint8_t opacity);
+	std::uint8_t getOpacity() const { return opacity; }
+	bool translucent() const { return opacity < 255; }
+	// 半透明合成统计（所有控件合计）
+	struct TranslucentStats
+	{
+		std::uint64_t composited = 0;  // 读回并混合的次数
+		std::uint64_t reused = 0;      // 底图与内容未变、直接贴缓存的次数
+		std::uint64_t pixels = 0;      // 混合的像素总数
+	};
+	static TranslucentStats& translucentStats();
 	//设置父容器指针
-	void setParent(Control* parent) { this->parent = parent; }
+	void setParent(Control* parent);
 	//设置宿主窗口（通常仅由顶层 Window/对话框注入）
 	virtual void setHostWindow(Window* host) { this->hostWindow = host; }
 	Window* getHostWindow() const;                         // 获取宿主 Window；子控件可沿 parent 向上回溯
 	RECT getBoundsRect() const;                           // 获取当前控件外接矩形，用于覆盖/相交判断
 	Control* getManagedRepaintRoot();                     // 找到本控件对应的托管重绘 root
-	bool hasValidBackgroundSnapshot() const { return hasSnap && saveBkImage != nullptr; } // 当前是否持有可用于局部恢复的快照
+	// 当前是否持有可用于局部恢复的快照
+	bool hasValidBackgroundSnapshot() const
+	{
+		return hasSnap && (saveBkImage != nullptr || packedBk != nullptr || snapRetained || (snapOpaque && isOpaque())
+			|| (snapShared && parent && parent->bodyCovers(saveBkX, saveBkY, saveWidth, saveHeight)));
+	}
+	virtual RECT getDamageRect() const;                   // 合成器模式：本控件当前占据的绘制范围（含边框/快照外扩）
+	virtual void collectDamageRects(std::vector<RECT>& out) const; // 合成器模式：收集本次需要重合成的区域；容器只收集脏子控件
 	virtual bool canCommitManagedPartialRepaint() const; // 当前 root 是否可安全做“局部提交”而非整 root 重画
 	virtual void commitManagedRepaint();                  // 托管收口阶段真正执行绘制的入口
-	//设置是否重绘
+	virtual bool isPresentationCurrent();                 // 屏幕上已是本控件当前应有的样子，重绘可跳过（默认不承诺）
+	virtual void addOpaqueRegion(StellarX::Region&) const {} // 遮挡剔除：把绘制后必定被不透明像素盖满的部分并入区域（默认透明）
+	virtual bool isOpaque() const { return false; }          // 快照分类：每次绘制都把快照范围整块盖满，不依赖底下的旧像素（默认否）
+	virtual std::size_t snapshotBytes() const;               // 本控件（容器含整棵子树）当前为背景快照占用的字节数
+	//设置是否重绘（容器同时标记整棵子树，O(1)）
 	virtual void setDirty(bool dirty) { this->dirty = dirty; }
+	//顶层控件：登记宿主窗口整场景重绘的代号（Window 注入）
+	void setSceneStamp(const DirtyStamp* stamp) { sceneStamp = stamp; }
 	//检查控件是否可见
 	bool IsVisible() const { return show; };
 	//获取控件id
 	std::string getId() const { return id; }
-	//检查是否为脏
-	bool isDirty() { return dirty; }
+	//检查是否为脏：自身与各级祖先的整树代号中，最近一次标脏晚于最近一次清脏（与父控件缓存的并比较，均摊 O(1)）
+	bool isDirty() const;
 	//获取控件最近一次事件处理是否引发了视觉变化
 	bool didEventAffectVisual() const { return eventVisualChanged; }
 	//用来检查对话框是否模态，其他控件不用实现
@@ -10,7 +10,7 @@
  ******************************************************************************/
 #pragma once
 
-#include "easyx.h"
+#include "SxBackend.h"
 
  /**
   * @命名空间: StellarX
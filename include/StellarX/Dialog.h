@@ -122,6 +122,9 @@ private:
 	void addControl(std::unique_ptr<Control> control);
 	bool canCommitManagedPartialRepaint() const override; // 判断当前 Dialog 是否可安全做局部提交
 	void commitManagedRepaint() override;                 // 托管收口阶段执行 Dialog 的真正重绘
+	bool isPresentationCurrent() override { return false; } // 标题与正文不在画布的显示列表里，不承诺可跳过
+	void addOpaqueRegion(StellarX::Region& out) const override; // 尚未按内容确定尺寸前不声明不透明
+	bool isOpaque() const override { return false; }            // 关闭时要回贴底下的场景，保留快照
 
 	// 清除所有控件
 	void clearControls();
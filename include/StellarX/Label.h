@@ -10,6 +10,7 @@
  *     - 完整的文本样式控制（字体、颜色、效果）
  *     - 自动适应文本内容
  *     - 轻量级无事件处理开销
+ *     - 可选图层缓存：内容不变时跳过字体设置、度量与文字光栅化
  *
  * @使用场景: 显示说明文字、标题、状态信息等静态内容
  * @所属框架: 星垣(StellarX) GUI框架
@@ -18,17 +19,28 @@
 
 #pragma once
 #include "Control.h"
+#include <cstdint>
 
 class Label : public Control
 {
 	std::string text;         //标签文本
 	COLORREF textBkColor; //标签背景颜色
 	bool textBkDisap = false;   //标签背景是否透明
+	bool layerCacheEnabled = false; //静态内容图层缓存（StellarX::LayerCache），默认关闭
+	std::uint64_t layerContentKey = 0; //上次绘制时的图层内容键（样式 + 文本），相同则尺寸不变
 
 	//标签事件处理（标签无事件）不实现具体代码
 	bool handleEvent(const ExMessage& msg) override { return false; }
 	//用来检查对话框是否模态,此控件不做实现
 	bool model() const override { return false; };
+	//把背景模式、颜色与字体样式应用到当前绘图设备
+	void applyTextStyle();
+	//图层缓存路径：命中则贴图，否则在离屏表面渲染后贴图并存入缓存
+	void drawLayer(std::uint64_t contentKey);
+	//图层的完整内容（文本、样式、背景、尺寸与底图哈希），缓存键碰撞时据此区分
+	std::string layerIdentity(std::uint64_t underlay) const;
+	//直接绘制路径：样式与文本记录到显示列表（样式随之生效）
+	void recordDisplayList();
 public:
 	StellarX::ControlText   textStyle;   //标签文本样式
 public:
@@ -36,6 +48,8 @@ public:
 	Label(int x, int y, std::string text = "标签", COLORREF textcolor = BLACK, COLORREF bkColor = RGB(255, 255, 255));
 
 	void draw() override;
+	//直接绘制路径下，显示列表与屏幕像素均未变化时可跳过重绘
+	bool isPresentationCurrent() override;
 	void hide();
 	//设置标签背景是否透明
 	void setTextdisap(bool key);
@@ -43,4 +57,7 @@ public:
 	void setTextBkColor(COLORREF color);
 	//设置标签文本
 	void setText(std::string text);
+	//设置是否启用图层缓存：内容不变时直接贴上次渲染的图层
+	void setLayerCacheEnabled(bool on);
+	bool isLayerCacheEnabled() const { return layerCacheEnabled; }
 };
@@ -33,6 +33,20 @@
 
 #include "CoreTypes.h"
 #include "SxLog.h"
+#include "SxSurfacePool.h"
+#include "SxLayerCache.h"
+#include "SxTextMetrics.h"
+#include "SxRenderState.h"
+#include "SxDisplayList.h"
+#include "SxOcclusion.h"
+#include "SxThreadPool.h"
+#include "SxTileRender.h"
+#include "SxImageCache.h"
+#include "SxPresent.h"
+#include "SxRleImage.h"
+#include "SxShapeMask.h"
+#include "SxRedrawScheduler.h"
+#include "SxEventLoop.h"
 #include "Control.h"
 #include"Canvas.h"
 #include"Window.h"
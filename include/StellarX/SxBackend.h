@@ -0,0 +1,43 @@
+﻿/*******************************************************************************
+ * @文件: SxBackend.h
+ * @摘要: 星垣(StellarX) 绘图后端选择头文件
+ * @描述:
+ *     框架内所有控件都通过 EasyX 风格的全局绘图接口（fillrectangle、outtextxy、
+ *     textwidth、getimage/putimage、BeginBatchDraw 等）以及少量 Win32 接口工作。
+ *     本文件负责在编译期选择这些接口的实际提供者：
+ *       - Windows 默认：<windows.h> + EasyX，行为与以往完全一致；
+ *       - 无头(Headless)：SxHeadless.h 提供同名同签名的软件实现，
+ *         绘制到内存中的 32 位帧缓冲，事件来自脚本化的 ExMessage 队列。
+ *
+ * @选择规则:
+ *     - 定义 SX_HEADLESS=1，或在非 Windows 平台编译时，使用无头后端；
+ *     - 否则使用 EasyX 后端。
+ *     选择结果通过 SX_BACKEND_HEADLESS（0/1）对外公开，供少量需要区分后端的代码使用。
+ *
+ * @备注:
+ *     控件源码只需包含本文件（通常经 Control.h / CoreTypes.h 间接包含），
+ *     无需关心当前使用的是哪个后端。
+ ******************************************************************************/
+#pragma once
+
+#if defined(SX_HEADLESS) && SX_HEADLESS
+#define SX_BACKEND_HEADLESS 1
+#elif !defined(_WIN32)
+#define SX_BACKEND_HEADLESS 1
+#else
+#define SX_BACKEND_HEADLESS 0
+#endif
+
+#if SX_BACKEND_HEADLESS
+#include "SxHeadless.h"
+#else
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#ifndef WINVER
+#define WINVER _WIN32_WINNT
+#endif
+#include <windows.h>
+#include <easyx.h>
+#undef MessageBox
+#endif
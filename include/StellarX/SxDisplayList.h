@@ -0,0 +1,124 @@
+﻿/*******************************************************************************
+ * @文件: SxDisplayList.h
+ * @摘要: 星垣(StellarX) 控件显示列表 —— 记录绘制命令、按哈希判断是否需要重放
+ * @描述:
+ *     控件的 draw() 不再直接调用后端绘图函数，而是先把本次要画的内容记录成
+ *     一串紧凑的命令（图元、矩形、颜色、文本句柄），再整体重放到屏幕上。
+ *     记录的同时累积一个 64 位哈希：两次记录的哈希相同，说明画出来的内容相同。
+ *
+ *     控件在每次真正重放后记下两项（Control::markDisplayListPresented）：
+ *       - 列表哈希：本次画了什么；
+ *       - 屏幕哈希：画完后控件快照范围内的屏幕像素；容器（Canvas）只取本体露出的部分，
+ *         可见子控件的范围除外——子控件各自比较，局部重画子控件时不读容器的像素。
+ *     下次重绘时若列表哈希不变、且屏幕像素仍与上次画完时一致，
+ *     屏幕上已经是正确的结果，重放与提交都可以跳过。悬停来回、
+ *     Canvas::setDirty 递归标脏等“虚假重绘”因此只花一次记录与哈希比较。
+ *     屏幕哈希是最终依据：被其它控件/对话框覆盖、快照回贴或背景重画过，
+ *     像素都会变化，不会误跳过。
+ *
+ *     状态类命令（颜色、线型、字体等）记录时立即经 RenderState 应用到设备——
+ *     文本度量依赖当前字体；重放时按顺序再设置一遍，通常都被 RenderState 消除。
+ *     绘制类命令只记录，等到重放才调用后端。
+ *
+ * @使用说明:
+ *     saveStyle();
+ *     displayList.clear();
+ *     displayList.setFillColor(bk);
+ *     displayList.fillRect(x, y, x + w, y + h);
+ *     displayList.text(tx, ty, text);
+ *     if (!displayListCurrent()) { restBackground(); displayList.replay(); markDisplayListPresented(); }
+ *     restoreStyle();
+ *
+ * @备注:
+ *     字体名与填充图案按指针记录，与 ControlText/IMAGE 的所有者同生命周期；
+ *     文本按内容记录并参与哈希。
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include "CoreTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace StellarX
+{
+	class DisplayList
+	{
+	public:
+		enum class Op : std::uint8_t
+		{
+			// 状态
+			FillColor, LineColor, TextColor, BkColor, BkMode, LineStyle, FillStyle, TextStyle,
+			// 图元
+			FillRect, SolidRect, FillRoundRect, SolidRoundRect,
+			FillCircle, SolidCircle, FillEllipse, SolidEllipse,
+			Text
+		};
+
+		// 一条命令：矩形四元组 + 两个附加整数 + 一个参数（颜色/模式/句柄）
+		struct Command
+		{
+			Op op;
+			std::int32_t l, t, r, b;
+			std::int32_t ex, ey;       // 圆角宽高 / 线宽 / 填充图案号
+			std::uint32_t arg;         // 颜色、模式或 texts/styles/patterns 中的下标
+		};
+
+		struct Stats
+		{
+			std::uint64_t recorded = 0;          // 记录的列表数
+			std::uint64_t compared = 0;          // 列表 + 屏幕哈希比较次数
+			std::uint64_t skipped = 0;           // 比较相同、跳过重放的次数
+			std::uint64_t replayed = 0;          // 实际重放的列表数
+			std::uint64_t commandsReplayed = 0;  // 实际重放的命令数
+			std::uint64_t pixelHashes = 0;       // 读屏幕像素求哈希的次数（比较与记录基线）
+			std::uint64_t pixelsHashed = 0;      // 其中读过的像素数
+		};
+
+		void clear();
+		std::size_t size() const { return commands.size(); }
+		bool empty() const { return commands.empty(); }
+		std::uint64_t hash() const { return hsh; }
+
+		// 状态命令：记录并立即应用
+		void setFillColor(COLORREF c);
+		void setLineColor(COLORREF c);
+		void setTextColor(COLORREF c);
+		void setBkColor(COLORREF c);
+		void setBkMode(int mode);
+		void setLineStyle(int style, int thickness = 1);
+		void setFillStyle(int style, long hatch = 0, IMAGE* ppattern = nullptr);
+		void setTextStyle(const ControlText& text);
+
+		// 图元命令：只记录
+		void fillRect(int l, int t, int r, int b);
+		void solidRect(int l, int t, int r, int b);
+		void fillRoundRect(int l, int t, int r, int b, int ew, int eh);
+		void solidRoundRect(int l, int t, int r, int b, int ew, int eh);
+		void fillCircle(int x, int y, int radius);
+		void solidCircle(int x, int y, int radius);
+		void fillEllipse(int l, int t, int r, int b);
+		void solidEllipse(int l, int t, int r, int b);
+		void text(int x, int y, const std::string& s);
+
+		// 按记录顺序把全部命令下发到当前绘图目标
+		void replay() const;
+
+		static Stats& stats();
+		static void resetStats();
+		// 关闭后 Control::displayListCurrent 总是返回 false（每次都重放），用于对拍
+		static void setSkipEnabled(bool on);
+		static bool skipEnabled();
+
+	private:
+		void push(Op op, int l, int t, int r, int b, int ex, int ey, std::uint32_t arg);
+
+		std::vector<Command> commands;
+		std::vector<std::string> texts;
+		std::vector<ControlText> styles;
+		std::vector<IMAGE*> patterns;
+		std::uint64_t hsh = 0;
+	};
+}
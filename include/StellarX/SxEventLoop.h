@@ -0,0 +1,79 @@
+﻿/*******************************************************************************
+ * @文件: SxEventLoop.h
+ * @摘要: 星垣(StellarX) 事件循环的空闲等待 —— 按最近到期时刻阻塞，输入与跨线程投递立即唤醒
+ * @描述:
+ *     Window::runEventLoop 与模态 Dialog::Show 以前每轮都无条件 Sleep(10)：
+ *     每个输入最多多等 10 ms，空闲时仍每秒唤醒 100 次。
+ *     现在一轮结束时调用 wait：本轮处理过消息则立即返回（后面可能还有积压）；
+ *     否则阻塞到下列任一情况：
+ *       1) 有输入或窗口消息；
+ *       2) 其它线程调用 wake()（后台解码完成等）；
+ *       3) 最早的 addTimer 定时器到期（提示框延时等）。
+ *     到期的定时器回调由事件循环（及模态对话框循环）的收尾 pump 在 UI 线程调用（runDueTimers），
+ *     与后台解码落地一样登记托管重绘；不会伪造任何输入消息。
+ *     渐进重绘未完成时事件循环不进入等待。
+ *
+ * @平台:
+ *     EasyX：MsgWaitForMultipleObjectsEx 同时等线程消息队列与一个自动复位事件；
+ *            窗口过程收到输入等消息时也会 wake()，窗口消息不在本线程时同样能唤醒。
+ *     无头：不真正休眠，把虚拟时钟推进到下一条脚本消息或到期时刻（Headless::waitMessage）；
+ *           再也等不到消息且没有到期时刻时，才真正阻塞到 wake()。
+ *
+ * @使用说明:
+ *     auto id = StellarX::EventLoop::addTimer(GetTickCount64() + 500, [this] { ... }); // UI 线程：500 ms 后回调一次
+ *     StellarX::EventLoop::cancelTimer(id);
+ *     StellarX::EventLoop::wake();                         // 任意线程：立即唤醒空闲的事件循环
+ *     StellarX::EventLoop::setEnabled(false);              // 退回旧的固定 Sleep(10) 轮询（对比用）
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace StellarX
+{
+	namespace EventLoop
+	{
+		// wait 的返回原因
+		enum class Wake
+		{
+			Busy,       // 本轮处理过消息，未等待
+			Input,      // 有输入或窗口消息
+			Posted,     // 被 wake() 唤醒
+			Deadline,   // 定时器到期（由 runDueTimers 处理）
+			Polled      // 关闭时：固定睡眠 10 ms 后返回
+		};
+
+		struct Stats
+		{
+			std::uint64_t waits = 0;         // 进入等待的次数（本轮无消息）
+			std::uint64_t blocked = 0;       // 其中真正阻塞（或推进了虚拟时钟）的次数
+			std::uint64_t inputWakes = 0;    // 因输入或窗口消息返回
+			std::uint64_t postWakes = 0;     // 因 wake() 返回
+			std::uint64_t deadlineWakes = 0; // 因到期返回
+			std::uint64_t timersRun = 0;     // 调用过的定时器回调数
+			std::uint64_t polls = 0;         // 关闭时的 Sleep(10) 次数
+			std::uint64_t idleMs = 0;        // 等待耗时（GetTickCount64 口径）
+		};
+
+		void setEnabled(bool on);            // 默认开启
+		bool enabled();
+
+		// UI 线程：登记一次性定时器（GetTickCount64 口径），到期后由 runDueTimers 调用 fn；返回 id（0 表示 fn 为空）
+		std::uint64_t addTimer(ULONGLONG tick, std::function<void()> fn);
+		void cancelTimer(std::uint64_t id);  // 已触发或不存在的 id 忽略
+		// UI 线程：按到期先后调用所有已到期的定时器，返回个数
+		std::size_t runDueTimers();
+		ULONGLONG nextDeadline();            // 最早的定时器到期时刻，0 表示没有
+		// 任意线程：唤醒正在等待的事件循环；尚未等待时下一次 wait 立即返回
+		void wake();
+
+		// 一轮事件循环结束时调用。handled：本轮是否处理过消息；filter：本循环取的消息类别（无头后端用）
+		Wake wait(BYTE filter, bool handled);
+
+		const Stats& stats();
+		void resetStats();
+	}
+}
@@ -0,0 +1,127 @@
+﻿/*******************************************************************************
+ * @文件: SxHash.h
+ * @摘要: 星垣(StellarX) 内部缓存使用的 64 位哈希工具
+ * @描述:
+ *     FNV-1a 64 位哈希，以及样式结构的哈希（只取影响绘制结果的字段，
+ *     字体名按字符串内容而非指针取值）。供图层缓存、文本度量缓存等生成键使用。
+ *     LOGFONT 只取影响字形度量的字段，不含颜色，因此同字体不同颜色的文本共享度量。
+ *     像素块另用按 64 位字、多路并行的 PixelHasher：逐字节的 FNV-1a 对整块屏幕区域太慢。
+ ******************************************************************************/
+#pragma once
+
+#include "CoreTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace StellarX
+{
+	constexpr std::uint64_t kHashSeed = 14695981039346656037ull;
+
+	inline std::uint64_t hashBytes(const void* data, std::size_t len, std::uint64_t h = kHashSeed)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < len; ++i)
+		{
+			h ^= p[i];
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// 32 位像素块的流式哈希：每次取 64 位（两个像素），八路独立累积，跨行不收尾，最后统一合并。
+	// 乘法链的延迟由多路并行摊薄，整块屏幕区域也只需几十微秒
+	class PixelHasher
+	{
+	public:
+		explicit PixelHasher(std::uint64_t seed = kHashSeed)
+		{
+			for (int i = 0; i < 8; ++i)
+				lane[i] = seed + (std::uint64_t)i * kMul;
+		}
+
+		void add(const std::uint32_t* px, std::size_t n)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= n; i += 16)
+			{
+				std::uint64_t w[8];
+				std::memcpy(w, px + i, sizeof(w));
+				for (int k = 0; k < 8; ++k)
+					lane[k] = mix(lane[k], w[k]);
+			}
+			for (; i < n; ++i)
+			{
+				const unsigned k = tail++ & 7u;
+				lane[k] = mix(lane[k], px[i]);
+			}
+			count += n;
+		}
+
+		std::uint64_t finish() const
+		{
+			std::uint64_t h = mix(kMul, count);
+			for (int i = 0; i < 8; ++i)
+				h = mix(h, lane[i]);
+			return h;
+		}
+
+	private:
+		static constexpr std::uint64_t kMul = 0x9E3779B97F4A7C15ull;
+		static std::uint64_t mix(std::uint64_t a, std::uint64_t w)
+		{
+			a = (a ^ w) * kMul;
+			return a ^ (a >> 29);
+		}
+
+		std::uint64_t lane[8];
+		std::uint64_t count = 0;
+		unsigned tail = 0;
+	};
+
+	template <class T>
+	inline std::uint64_t hashValue(const T& v, std::uint64_t h = kHashSeed)
+	{
+		return hashBytes(&v, sizeof(v), h);
+	}
+
+	inline std::uint64_t hashString(const std::string& s, std::uint64_t h = kHashSeed)
+	{
+		// 先混入长度，避免 "ab"+"c" 与 "a"+"bc" 相同
+		return hashBytes(s.data(), s.size(), hashValue(s.size(), h));
+	}
+
+	inline std::uint64_t hashCString(const char* s, std::uint64_t h = kHashSeed)
+	{
+		const std::size_t n = s ? std::strlen(s) : 0;
+		return hashBytes(s, n, hashValue(n, h));
+	}
+
+	inline std::uint64_t hashControlText(const ControlText& t, std::uint64_t h = kHashSeed)
+	{
+		h = hashCString(t.lpszFace, h);
+		h = hashValue(t.nHeight, h);
+		h = hashValue(t.nWidth, h);
+		h = hashValue(t.color, h);
+		h = hashValue(t.nEscapement, h);
+		h = hashValue(t.nOrientation, h);
+		h = hashValue(t.nWeight, h);
+		const unsigned char flags = (t.bItalic ? 1 : 0) | (t.bUnderline ? 2 : 0) | (t.bStrikeOut ? 4 : 0);
+		return hashValue(flags, h);
+	}
+
+	inline std::uint64_t hashLogFont(const LOGFONT& f, std::uint64_t h = kHashSeed)
+	{
+		std::size_t n = 0;
+		while (n < LF_FACESIZE && f.lfFaceName[n]) ++n;
+		h = hashBytes(f.lfFaceName, n * sizeof(f.lfFaceName[0]), hashValue(n, h));
+		h = hashValue(f.lfHeight, h);
+		h = hashValue(f.lfWidth, h);
+		h = hashValue(f.lfEscapement, h);
+		h = hashValue(f.lfOrientation, h);
+		h = hashValue(f.lfWeight, h);
+		const unsigned char bytes[] = { f.lfItalic, f.lfUnderline, f.lfStrikeOut, f.lfCharSet, f.lfQuality, f.lfPitchAndFamily };
+		return hashBytes(bytes, sizeof(bytes), h);
+	}
+}
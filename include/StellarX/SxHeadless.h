@@ -0,0 +1,571 @@
+﻿/*******************************************************************************
+ * @文件: SxHeadless.h
+ * @摘要: 星垣(StellarX) 无头(Headless)绘图后端 —— EasyX / Win32 兼容接口声明
+ * @描述:
+ *     在没有 Windows / EasyX 的环境（Linux CI、性能实验室）中，
+ *     以同名同签名的方式提供框架用到的 EasyX 绘图接口与少量 Win32 接口：
+ *       - 绘图原语：矩形/圆角矩形/圆/椭圆/线段/像素，线型与填充样式；
+ *       - IMAGE 表面：getimage/putimage/Resize/GetImageBuffer/SetWorkingImage；
+ *       - 裁剪：CreateRectRgn/CombineRgn/setcliprgn/clearcliprgn（仅作用于设置时的绘图目标）；
+ *       - 文本：内置 8x16 点阵字体，提供 textwidth/textheight/outtextxy；
+ *       - 事件：脚本化的 ExMessage 队列驱动 peekmessage/getmessage；
+ *       - 时钟：Sleep/GetTickCount64 走虚拟时钟，脚本回放不真正休眠。
+ *
+ *     所有绘制都落在内存中的 32 位帧缓冲（像素格式 0x00RRGGBB，与 EasyX
+ *     GetImageBuffer 一致），可通过 StellarX::Headless 命名空间导出为 PPM，
+ *     用于金样图(golden image)比对与基准测试。
+ *
+ * @使用说明:
+ *     不要直接包含本文件，包含 StellarX.h（经 SxBackend.h 选择后端）即可。
+ *     src/ 中的控件代码无需任何修改即可运行在本后端上。
+ *
+ * @所属框架: 星垣(StellarX) GUI框架
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+
+/* ========================= Win32 基础类型 ========================= */
+typedef int                BOOL;
+typedef unsigned char      BYTE;
+typedef unsigned short     WORD;
+typedef unsigned short     USHORT;
+typedef std::uint32_t      DWORD;
+typedef int                LONG;       // 与 Win32 一致：32 位
+typedef unsigned int       UINT;
+typedef std::intptr_t      LONG_PTR;
+typedef std::uintptr_t     ULONG_PTR;
+typedef std::uintptr_t     DWORD_PTR;
+typedef std::uintptr_t     WPARAM;
+typedef std::intptr_t      LPARAM;
+typedef std::intptr_t      LRESULT;
+typedef std::uint64_t      ULONGLONG;
+typedef char               TCHAR;
+typedef const char*        LPCTSTR;
+typedef char*              LPTSTR;
+typedef char*              LPSTR;
+typedef DWORD              COLORREF;
+typedef void*              HINSTANCE;
+
+struct SxHeadlessWindow;                 // 无头模式下唯一的虚拟窗口
+typedef SxHeadlessWindow*  HWND;
+struct SxHeadlessRegion;                 // 裁剪区域（矩形集合）
+typedef SxHeadlessRegion*  HRGN;
+typedef void*              HGDIOBJ;
+
+#define CALLBACK
+#define WINAPI
+#define _In_
+#define _In_opt_
+typedef LRESULT(CALLBACK* WNDPROC)(HWND, UINT, WPARAM, LPARAM);
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+struct RECT { LONG left; LONG top; LONG right; LONG bottom; };
+struct POINT { LONG x; LONG y; };
+struct MINMAXINFO { POINT ptReserved; POINT ptMaxSize; POINT ptMaxPosition; POINT ptMinTrackSize; POINT ptMaxTrackSize; };
+
+#define LF_FACESIZE 32
+struct LOGFONT
+{
+	LONG lfHeight = 0;
+	LONG lfWidth = 0;
+	LONG lfEscapement = 0;
+	LONG lfOrientation = 0;
+	LONG lfWeight = 0;
+	BYTE lfItalic = 0;
+	BYTE lfUnderline = 0;
+	BYTE lfStrikeOut = 0;
+	BYTE lfCharSet = 0;
+	BYTE lfOutPrecision = 0;
+	BYTE lfClipPrecision = 0;
+	BYTE lfQuality = 0;
+	BYTE lfPitchAndFamily = 0;
+	TCHAR lfFaceName[LF_FACESIZE] = {};
+};
+
+#define RGB(r,g,b)      ((COLORREF)(((BYTE)(r) | ((WORD)((BYTE)(g)) << 8)) | (((DWORD)(BYTE)(b)) << 16)))
+#define GetRValue(rgb)  ((BYTE)(rgb))
+#define GetGValue(rgb)  ((BYTE)(((WORD)(rgb)) >> 8))
+#define GetBValue(rgb)  ((BYTE)((rgb) >> 16))
+#define LOWORD(l)       ((WORD)(((DWORD_PTR)(l)) & 0xffff))
+#define HIWORD(l)       ((WORD)((((DWORD_PTR)(l)) >> 16) & 0xffff))
+#define MAKELPARAM(l,h) ((LPARAM)(DWORD)(((WORD)(l)) | (((DWORD)(WORD)(h)) << 16)))
+
+#ifndef NOMINMAX
+// windows.h 以宏提供 min/max；这里用模板函数代替，避免污染 std::min/std::max
+template<typename T> inline T max(T a, T b) { return a < b ? b : a; }
+template<typename T> inline T min(T a, T b) { return b < a ? b : a; }
+#endif
+
+/* ========================= Win32 消息与常量 ========================= */
+#define WM_MOVE            0x0003
+#define WM_SIZE            0x0005
+#define WM_ACTIVATE        0x0006
+#define WM_SETREDRAW       0x000B
+#define WM_PAINT           0x000F
+#define WM_CLOSE           0x0010
+#define WM_ERASEBKGND      0x0014
+#define WM_GETMINMAXINFO   0x0024
+#define WM_KEYDOWN         0x0100
+#define WM_KEYUP           0x0101
+#define WM_CHAR            0x0102
+#define WM_SYSKEYDOWN      0x0104
+#define WM_SYSKEYUP        0x0105
+#define WM_MOUSEMOVE       0x0200
+#define WM_LBUTTONDOWN     0x0201
+#define WM_LBUTTONUP       0x0202
+#define WM_LBUTTONDBLCLK   0x0203
+#define WM_RBUTTONDOWN     0x0204
+#define WM_RBUTTONUP       0x0205
+#define WM_RBUTTONDBLCLK   0x0206
+#define WM_MBUTTONDOWN     0x0207
+#define WM_MBUTTONUP       0x0208
+#define WM_MBUTTONDBLCLK   0x0209
+#define WM_MOUSEWHEEL      0x020A
+#define WM_SIZING          0x0214
+#define WM_ENTERSIZEMOVE   0x0231
+#define WM_EXITSIZEMOVE    0x0232
+
+#define SIZE_RESTORED      0
+#define SIZE_MINIMIZED     1
+#define SIZE_MAXIMIZED     2
+
+#define WMSZ_LEFT          1
+#define WMSZ_RIGHT         2
+#define WMSZ_TOP           3
+#define WMSZ_TOPLEFT       4
+#define WMSZ_TOPRIGHT      5
+#define WMSZ_BOTTOM        6
+#define WMSZ_BOTTOMLEFT    7
+#define WMSZ_BOTTOMRIGHT   8
+
+#define GWLP_WNDPROC       (-4)
+#define GWL_STYLE          (-16)
+#define GWL_EXSTYLE        (-20)
+#define GWLP_USERDATA      (-21)
+#define GCL_STYLE          (-26)
+
+#define WS_THICKFRAME      0x00040000
+
+#define INFINITE           0xFFFFFFFF   // 无限等待（EventLoop::wait 的超时）
+#define WS_MINIMIZEBOX     0x00020000
+#define WS_MAXIMIZEBOX     0x00010000
+#define WS_CLIPCHILDREN    0x02000000
+#define WS_CLIPSIBLINGS    0x04000000
+#define WS_EX_COMPOSITED   0x02000000
+
+#define SWP_NOSIZE         0x0001
+#define SWP_NOMOVE         0x0002
+#define SWP_NOZORDER       0x0004
+#define SWP_FRAMECHANGED   0x0020
+
+#define CS_VREDRAW         0x0001
+#define CS_HREDRAW         0x0002
+
+#define SM_CXSCREEN        0
+#define SM_CYSCREEN        1
+#define SM_CXVIRTUALSCREEN 78
+#define SM_CYVIRTUALSCREEN 79
+
+#define VK_BACK            0x08
+#define VK_TAB             0x09
+#define VK_RETURN          0x0D
+#define VK_ESCAPE          0x1B
+#define VK_SPACE           0x20
+#define VK_LEFT            0x25
+#define VK_UP              0x26
+#define VK_RIGHT           0x27
+#define VK_DOWN            0x28
+
+/* ========================= GDI 样式常量 ========================= */
+#define HS_HORIZONTAL      0
+#define HS_VERTICAL        1
+#define HS_FDIAGONAL       2
+#define HS_BDIAGONAL       3
+#define HS_CROSS           4
+#define HS_DIAGCROSS       5
+
+#define BS_SOLID           0
+#define BS_NULL            1
+#define BS_HOLLOW          BS_NULL
+#define BS_HATCHED         2
+#define BS_PATTERN         3
+#define BS_DIBPATTERN      5
+
+#define PS_SOLID           0
+#define PS_DASH            1
+#define PS_DOT             2
+#define PS_DASHDOT         3
+#define PS_DASHDOTDOT      4
+#define PS_NULL            5
+#define PS_USERSTYLE       7
+
+#define TRANSPARENT        1
+#define OPAQUE             2
+
+#define SRCCOPY            (DWORD)0x00CC0020
+#define SRCPAINT           (DWORD)0x00EE0086
+#define SRCAND             (DWORD)0x008800C6
+#define SRCINVERT          (DWORD)0x00660046
+
+#define RGN_AND            1
+#define RGN_OR             2
+#define RGN_XOR            3
+#define RGN_DIFF           4
+#define RGN_COPY           5
+#define ERROR              0
+#define NULLREGION         1
+#define SIMPLEREGION       2
+#define COMPLEXREGION      3
+
+#define FW_NORMAL          400
+#define FW_BOLD            700
+
+/* ========================= EasyX 常量 ========================= */
+#define EX_SHOWCONSOLE     1
+#define EX_NOCLOSE         2
+#define EX_NOMINIMIZE      4
+#define EX_DBLCLKS         8
+
+#define EX_MOUSE           1
+#define EX_KEY             2
+#define EX_CHAR            4
+#define EX_WINDOW          8
+
+#define BLACK              0
+#define BLUE               0xAA0000
+#define GREEN              0x00AA00
+#define CYAN               0xAAAA00
+#define RED                0x0000AA
+#define MAGENTA            0xAA00AA
+#define BROWN              0x0055AA
+#define LIGHTGRAY          0xAAAAAA
+#define DARKGRAY           0x555555
+#define LIGHTBLUE          0xFF5555
+#define LIGHTGREEN         0x55FF55
+#define LIGHTCYAN          0xFFFF55
+#define LIGHTRED           0x5555FF
+#define LIGHTMAGENTA       0xFF55FF
+#define YELLOW             0x55FFFF
+#define WHITE              0xFFFFFF
+
+// COLORREF(0x00BBGGRR) 与显存像素(0x00RRGGBB) 互转
+#define BGR(color)         ((((color) & 0xFF) << 16) | ((color) & 0xFF00FF00) | (((color) & 0xFF0000) >> 16))
+
+/* ========================= EasyX 类型 ========================= */
+
+// 图像表面：32 位像素，格式 0x00RRGGBB，行优先连续存储
+class IMAGE
+{
+public:
+	IMAGE(int width = 0, int height = 0);
+	int getwidth() const { return width; }
+	int getheight() const { return height; }
+
+private:
+	int width = 0;
+	int height = 0;
+	DWORD* pixels = nullptr;
+	std::size_t capacity = 0;
+
+public:
+	IMAGE(const IMAGE& other);
+	IMAGE& operator=(const IMAGE& other);
+	~IMAGE();
+
+	friend DWORD* GetImageBuffer(IMAGE* pImg);
+	friend void Resize(IMAGE* pImg, int width, int height);
+};
+
+struct LINESTYLE
+{
+	DWORD style = PS_SOLID;
+	DWORD thickness = 1;
+	DWORD* puserstyle = nullptr;
+	DWORD userstylecount = 0;
+};
+
+struct FILLSTYLE
+{
+	int style = BS_SOLID;
+	long hatch = 0;
+	IMAGE* ppattern = nullptr;
+};
+
+struct ExMessage
+{
+	USHORT message;
+	union
+	{
+		// 鼠标消息
+		struct
+		{
+			bool ctrl : 1;
+			bool shift : 1;
+			bool lbutton : 1;
+			bool mbutton : 1;
+			bool rbutton : 1;
+			short x;
+			short y;
+			short wheel;
+		};
+		// 按键消息
+		struct
+		{
+			BYTE vkcode;
+			BYTE scancode;
+			bool extended : 1;
+			bool prevdown : 1;
+		};
+		// 字符消息
+		TCHAR ch;
+		// 窗口消息
+		struct
+		{
+			WPARAM wParam;
+			LPARAM lParam;
+		};
+	};
+};
+
+/* ========================= EasyX 绘图接口 ========================= */
+HWND initgraph(int width, int height, int flag = 0);
+void closegraph();
+void cleardevice();
+HWND GetHWnd();
+
+void setbkcolor(COLORREF color);
+COLORREF getbkcolor();
+void setbkmode(int mode);
+int getbkmode();
+void setlinecolor(COLORREF color);
+COLORREF getlinecolor();
+void settextcolor(COLORREF color);
+COLORREF gettextcolor();
+void setfillcolor(COLORREF color);
+COLORREF getfillcolor();
+
+void getlinestyle(LINESTYLE* pstyle);
+void setlinestyle(const LINESTYLE* pstyle);
+void setlinestyle(int style, int thickness = 1, const DWORD* puserstyle = nullptr, DWORD userstylecount = 0);
+void getfillstyle(FILLSTYLE* pstyle);
+void setfillstyle(const FILLSTYLE* pstyle);
+void setfillstyle(int style, long hatch = 0, IMAGE* ppattern = nullptr);
+
+COLORREF getpixel(int x, int y);
+void putpixel(int x, int y, COLORREF color);
+void line(int x1, int y1, int x2, int y2);
+
+void rectangle(int left, int top, int right, int bottom);
+void fillrectangle(int left, int top, int right, int bottom);
+void solidrectangle(int left, int top, int right, int bottom);
+void clearrectangle(int left, int top, int right, int bottom);
+
+void circle(int x, int y, int radius);
+void fillcircle(int x, int y, int radius);
+void solidcircle(int x, int y, int radius);
+void clearcircle(int x, int y, int radius);
+
+void ellipse(int left, int top, int right, int bottom);
+void fillellipse(int left, int top, int right, int bottom);
+void solidellipse(int left, int top, int right, int bottom);
+void clearellipse(int left, int top, int right, int bottom);
+
+void roundrect(int left, int top, int right, int bottom, int ellipsewidth, int ellipseheight);
+void fillroundrect(int left, int top, int right, int bottom, int ellipsewidth, int ellipseheight);
+void solidroundrect(int left, int top, int right, int bottom, int ellipsewidth, int ellipseheight);
+void clearroundrect(int left, int top, int right, int bottom, int ellipsewidth, int ellipseheight);
+
+void outtextxy(int x, int y, LPCTSTR str);
+void outtextxy(int x, int y, TCHAR c);
+int textwidth(LPCTSTR str);
+int textwidth(TCHAR c);
+int textheight(LPCTSTR str);
+int textheight(TCHAR c);
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace);
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation, int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut);
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation, int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut, BYTE fbCharSet, BYTE fbOutPrecision, BYTE fbClipPrecision, BYTE fbQuality, BYTE fbPitchAndFamily);
+void settextstyle(const LOGFONT* font);
+void gettextstyle(LOGFONT* font);
+
+int loadimage(IMAGE* pDstImg, LPCTSTR pImgFile, int nWidth = 0, int nHeight = 0, bool bResize = false);
+void saveimage(LPCTSTR pImgFile, IMAGE* pImg = nullptr);
+void getimage(IMAGE* pDstImg, int srcX, int srcY, int srcWidth, int srcHeight);
+void putimage(int dstX, int dstY, const IMAGE* pSrcImg, DWORD dwRop = SRCCOPY);
+void putimage(int dstX, int dstY, int dstWidth, int dstHeight, const IMAGE* pSrcImg, int srcX, int srcY, DWORD dwRop = SRCCOPY);
+void Resize(IMAGE* pImg, int width, int height);
+DWORD* GetImageBuffer(IMAGE* pImg = nullptr);
+IMAGE* GetWorkingImage();
+// 当前绘图设备的宽高（与 EasyX 同名全局函数一致）
+int getwidth();
+int getheight();
+void SetWorkingImage(IMAGE* pImg = nullptr);
+
+void BeginBatchDraw();
+void FlushBatchDraw();
+void FlushBatchDraw(int left, int top, int right, int bottom);
+void EndBatchDraw();
+void EndBatchDraw(int left, int top, int right, int bottom);
+
+void setcliprgn(HRGN hrgn);              // hrgn 为 nullptr 时取消裁剪
+void clearcliprgn();                     // 与 EasyX 一致：以背景色填充裁剪区，不取消裁剪
+
+bool peekmessage(ExMessage* msg, BYTE filter = -1, bool removemsg = true);
+ExMessage getmessage(BYTE filter = -1);
+void flushmessage(BYTE filter = -1);
+
+bool InputBox(LPTSTR pString, int nMaxCount, LPCTSTR pPrompt = nullptr, LPCTSTR pTitle = nullptr,
+	LPCTSTR pDefault = nullptr, int width = 0, int height = 0, bool bOnlyOK = true);
+
+/* ========================= Win32 窗口接口（虚拟窗口） ========================= */
+LONG GetWindowLong(HWND hWnd, int nIndex);
+LONG SetWindowLong(HWND hWnd, int nIndex, LONG dwNewLong);
+LONG_PTR GetWindowLongPtr(HWND hWnd, int nIndex);
+LONG_PTR SetWindowLongPtr(HWND hWnd, int nIndex, LONG_PTR dwNewLong);
+ULONG_PTR GetClassLongPtr(HWND hWnd, int nIndex);
+ULONG_PTR SetClassLongPtr(HWND hWnd, int nIndex, LONG_PTR dwNewLong);
+BOOL SetWindowPos(HWND hWnd, HWND hWndInsertAfter, int X, int Y, int cx, int cy, UINT uFlags);
+BOOL SetWindowText(HWND hWnd, LPCTSTR lpString);
+BOOL AdjustWindowRectEx(RECT* lpRect, DWORD dwStyle, BOOL bMenu, DWORD dwExStyle);
+BOOL GetClientRect(HWND hWnd, RECT* lpRect);
+BOOL ValidateRect(HWND hWnd, const RECT* lpRect);
+BOOL InvalidateRect(HWND hWnd, const RECT* lpRect, BOOL bErase);
+LRESULT SendMessage(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+LRESULT CallWindowProc(WNDPROC lpPrevWndFunc, HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+LRESULT DefWindowProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+BOOL GetCursorPos(POINT* lpPoint);
+BOOL ScreenToClient(HWND hWnd, POINT* lpPoint);
+int GetSystemMetrics(int nIndex);
+void Sleep(DWORD dwMilliseconds);
+ULONGLONG GetTickCount64();
+DWORD GetTickCount();
+HRGN CreateRectRgn(int left, int top, int right, int bottom);
+int CombineRgn(HRGN hrgnDst, HRGN hrgnSrc1, HRGN hrgnSrc2, int iMode);
+BOOL DeleteObject(HGDIOBJ hObject);
+
+/* ========================= 无头后端专用接口 ========================= */
+namespace StellarX
+{
+	namespace Headless
+	{
+		// 后端统计：用于基准测试与回归比对（resetStats 清零）
+		struct Stats
+		{
+			std::uint64_t drawCalls = 0;     // 图元绘制调用次数（矩形/圆/椭圆/线/文本等）
+			std::uint64_t textCalls = 0;     // outtextxy 调用次数
+			std::uint64_t metricCalls = 0;   // textwidth/textheight 调用次数
+			std::uint64_t presents = 0;      // 批量绘制提交次数（FlushBatchDraw/EndBatchDraw）
+			std::uint64_t bytesPresented = 0; // 提交时从屏幕拷到可见帧的字节数（整屏或指定矩形）
+			std::uint64_t bytesRead = 0;     // 从表面读取的字节数（getimage 等）
+			std::uint64_t bytesWritten = 0;  // 写入表面的字节数
+			std::uint64_t surfaceAllocs = 0; // 像素缓冲分配次数（IMAGE 构造或扩容）
+			std::uint64_t glyphHits = 0;     // 字形图集命中次数（直接回放游程）
+			std::uint64_t glyphMisses = 0;   // 字形光栅化次数（首次出现的字号/样式/字符）
+			std::uint64_t imageLoads = 0;    // loadimage 读盘解码次数
+		};
+
+		// 分块光栅化统计（beginTiledFrame / endTiledFrame）
+		struct TileStats
+		{
+			std::uint64_t frames = 0;        // 结束的分块帧数
+			std::uint64_t flushes = 0;       // 并行光栅化批次数
+			std::uint64_t syncFlushes = 0;   // 帧内因回读屏幕/改写源表面而提前提交的批次数
+			std::uint64_t commands = 0;      // 录制的屏幕图元数
+			std::uint64_t tileJobs = 0;      // 执行的非空块任务数
+			std::uint64_t binned = 0;        // 图元 × 块 的分箱条目数（跨块图元计多次）
+			std::uint64_t steals = 0;        // 线程池窃取的块任务数
+		};
+
+		// 过绘制统计的一帧：两次提交(FlushBatchDraw/EndBatchDraw)之间屏幕像素的写入情况
+		struct OverdrawFrame
+		{
+			std::uint64_t frame = 0;         // 帧序号（自 resetOverdraw 起从 0 计）
+			std::uint64_t pixelsTouched = 0; // 至少被写入一次的屏幕像素数
+			std::uint64_t writes = 0;        // 屏幕像素写入总次数
+			std::uint32_t maxWrites = 0;     // 单个像素的最大写入次数
+			std::uint64_t screenBytes = 0;   // 写入屏幕的字节数（writes × 4）
+			std::uint64_t bytesWritten = 0;  // 本帧写入所有表面的字节数（含快照 getimage 等离屏写入）
+
+			// 平均过绘制：被写入的像素平均写了几次（1.0 表示每个像素恰好一次）
+			double meanOverdraw() const { return pixelsTouched ? (double)writes / (double)pixelsTouched : 0.0; }
+		};
+
+		// 屏幕帧缓冲（initgraph 之后有效，closegraph 之后为空）
+		IMAGE* screen();
+		// 可见帧：只在 FlushBatchDraw/EndBatchDraw 时按提交范围从屏幕拷入（首次提交前为空）；
+		// 局部提交(present)漏掉的像素会表现为可见帧与屏幕不一致
+		IMAGE* front();
+		// 将图像（默认屏幕）导出为二进制 PPM(P6)，用于金样图比对
+		bool dumpPPM(const std::string& path, const IMAGE* img = nullptr);
+		// 只读盘解码（PPM P6/P5）到 0x00RRGGBB 像素，不分配 IMAGE、不计入 stats；
+		// 可在任意线程调用，供后台解码（ImageCache::acquire）使用
+		bool decodeImage(const std::string& path, std::vector<DWORD>& px, int& w, int& h);
+
+		// —— 脚本化事件源 ——
+		// delayMs：相对上一条脚本消息的延迟（虚拟时钟毫秒）；到期前 peekmessage 取不到该消息
+		void postMessage(const ExMessage& msg, unsigned delayMs = 0);
+		void postMouse(UINT message, int x, int y, unsigned delayMs = 0);
+		void postKey(UINT message, BYTE vkcode, unsigned delayMs = 0);
+		void postChar(TCHAR ch, unsigned delayMs = 0);
+		// 程序化尺寸变化（最大化/还原等），对应 WM_SIZE
+		void postResize(int width, int height, unsigned delayMs = 0);
+		// 交互式拖拽尺寸变化：WM_ENTERSIZEMOVE → 客户区变化 → WM_EXITSIZEMOVE（经窗口过程分发）
+		void postSizeMove(int width, int height, unsigned delayMs = 0);
+		void postClose(unsigned delayMs = 0);
+		std::size_t pendingMessages();
+		void clearMessages();
+		// 脚本耗尽后，请求 EX_WINDOW 类消息时自动投递 WM_CLOSE（默认开启），使 runEventLoop 自然退出
+		void setAutoClose(bool on);
+		// 文本是否经字形图集绘制（默认开启；关闭后逐像素光栅化，仅用于对比与基准）
+		void setGlyphAtlasEnabled(bool on);
+		void clearGlyphAtlas();
+		// 预置 InputBox 的回答；队列为空时 InputBox 视为“取消”
+		void pushInputBoxReply(const std::string& text, bool ok = true);
+
+		// —— 分块光栅化 ——
+		// 帧内以屏幕为目标的图元只录制（连同绘图状态与裁剪的快照），不立即光栅化；
+		// endTiledFrame 时按 tileSize 见方的屏幕块分箱，在 StellarX::ThreadPool 上逐块并行光栅化，
+		// 结果与逐条立即绘制逐位一致。帧内读取屏幕（getimage/getpixel/GetImageBuffer）、
+		// 改写被引用的源表面或 FlushBatchDraw 时，先提交已录制的部分
+		void beginTiledFrame(int tileSize = 128);
+		void endTiledFrame();
+		bool tiledFrameActive();
+		TileStats& tileStats();
+		void resetTileStats();
+
+		// —— 过绘制统计 ——
+		// 开启后后端为屏幕每个像素维护写入计数（填充、描边、文本、putimage 等所有光栅化路径，
+		// 含分块光栅化）；每次提交结算为一帧写入 overdrawFrames。应用经 GetImageBuffer 直接改写的像素不计。
+		// 关闭时每段写入只多一次空指针判断
+		void setOverdrawEnabled(bool on);
+		bool overdrawEnabled();
+		const std::vector<OverdrawFrame>& overdrawFrames();
+		void resetOverdraw();
+		// 导出最近一个有写入的帧的热力图（PPM）：未写入处为变暗的可见帧，写入处按次数着色
+		bool dumpOverdrawPPM(const std::string& path);
+
+		// —— 虚拟时钟 ——
+		ULONGLONG now();
+		void advanceClock(ULONGLONG ms);
+		// 模拟阻塞等待消息（供 EventLoop::wait 使用）：把虚拟时钟推进到下一条符合 filter 的脚本消息
+		// 到期或 timeoutMs 之后（先到者），返回是否有消息可取。
+		// 队列里再也等不到符合的消息且 timeoutMs 为 INFINITE 时立即返回 false，不推进时钟
+		bool waitMessage(DWORD timeoutMs, BYTE filter = -1);
+
+		// —— 统计 ——
+		Stats& stats();
+		void resetStats();
+	}
+}
@@ -0,0 +1,204 @@
+﻿/*******************************************************************************
+ * @文件: SxImageCache.h
+ * @摘要: 星垣(StellarX) 解码图像缓存 —— 按 (路径, 目标尺寸) 共享图像，后台解码，内存预算
+ * @描述:
+ *     Window 的背景图过去在每次尺寸变化时都调用 loadimage(…, width, height)，
+ *     即拉伸 / 最大化一次就重新读文件、重新解码、再缩放。本缓存把这三步拆开：
+ *       - 每个文件只解码一次，原尺寸像素常驻内存；
+ *       - 缩小超过 2 倍时先按 2×2 盒式降采样逐级生成 mip 级（按需、只生成一次），
+ *         再从不小于目标尺寸的最小一级做双线性缩放（SIMD，见 Pixel::scaleBilinear）；
+ *       - 每个文件保留最近用过的若干个输出尺寸，窗口在几种尺寸间往返时直接命中。
+ *     因此尺寸变化后的重绘路径不访问文件系统。
+ *
+ * @共享资产:
+ *     acquire(path, w, h) 返回引用计数的 ImageAsset：同一 (路径, 尺寸) 在仍被持有期间
+ *     总是同一个资产、同一份像素（30 个同纹理按钮只解码一次、只占一份内存）。
+ *     源图尚未解码时，读盘与解码投递到 ThreadPool 的后台线程，资产先处于 Pending，
+ *     调用方以纯色等占位绘制；UI 线程每轮事件循环调用 pump() 接收解码结果、
+ *     缩放到各资产的尺寸并回调 whenReady 登记的函数（控件据此标脏、请求重绘）。
+ *
+ * @预算:
+ *     缓存自身持有的源像素 / mip 级 / 输出尺寸合计超过 budget 时，按最久未用整条丢弃，
+ *     最近使用的一条总会保留。已交给资产的图像由持有者引用，丢弃缓存条目不影响其显示。
+ *
+ * @失效:
+ *     缓存不检查文件是否在磁盘上被改写；Window::setBkImage / draw(imagePath) 换图时
+ *     会先 evict 该路径，保证显式换图总是重新读盘（之后 acquire 也不再复用旧资产）。
+ *
+ * @线程:
+ *     除后台解码外，所有接口只在 UI 线程调用；回调也在 UI 线程（pump 内）执行。
+ *     EasyX 未声明 loadimage 线程安全，后台线程改用 WIC 解码（每个线程各自初始化 COM），
+ *     只写像素数组；WIC 解不了的文件由 pump 在 UI 线程用 loadimage 再试一次。
+ *
+ * @使用说明:
+ *     auto img = StellarX::ImageCache::Get().scaled("bk.jpg", 1920, 1080);
+ *     if (img) putimage(0, 0, img.get());
+ *
+ *     auto asset = StellarX::ImageCache::Get().acquire("tex.jpg", 120, 40);
+ *     asset->whenReady([this] { dirty = true; requestRepaint(parent); });
+ *     if (asset->ready()) putimage(x, y, asset->image().get());
+ *
+ *     StellarX::ImageCache::Get().setEnabled(false);   // 退回逐次 loadimage，用于对比
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace StellarX
+{
+	// (路径, 尺寸) 对应的共享图像；由 ImageCache::acquire 创建，UI 线程使用
+	class ImageAsset
+	{
+	public:
+		enum class State { Pending, Ready, Failed };
+
+		State state() const { return state_; }
+		bool ready() const { return state_ == State::Ready; }
+		bool pending() const { return state_ == State::Pending; }
+		// 就绪前为空；内容不会再被修改，可被多个控件共享
+		const std::shared_ptr<IMAGE>& image() const { return img; }
+		const std::string& path() const { return path_; }
+		int width() const { return w; }
+		int height() const { return h; }
+
+		// 就绪或失败时调用 fn（UI 线程，ImageCache::pump 内）；已不再 Pending 时立即调用并返回 0。
+		// 返回值用于 cancel：持有者先于资产析构时必须取消，回调通常捕获了持有者
+		std::uint64_t whenReady(std::function<void()> fn);
+		void cancel(std::uint64_t token);
+
+	private:
+		friend class ImageCache;
+		ImageAsset(const std::string& path, int w, int h) : path_(path), w(w), h(h) {}
+		void resolve(std::shared_ptr<IMAGE> image);
+
+		std::string path_;
+		int w, h;
+		State state_ = State::Pending;
+		std::shared_ptr<IMAGE> img;
+		std::vector<std::pair<std::uint64_t, std::function<void()>>> waiters;
+		std::uint64_t nextToken = 1;
+	};
+
+	class ImageCache
+	{
+	public:
+		struct Stats
+		{
+			std::uint64_t decodes = 0;      // 读盘解码次数（含后台解码）
+			std::uint64_t hits = 0;         // 命中已缓存输出尺寸的次数
+			std::uint64_t rescales = 0;     // 从内存中的源像素缩放出新尺寸的次数
+			std::uint64_t mipLevels = 0;    // 生成的 mip 级数
+			std::size_t   bytesHeld = 0;    // 源像素 + mip 级 + 输出尺寸占用的字节数
+			std::uint64_t acquires = 0;     // acquire 调用次数
+			std::uint64_t shared = 0;       // acquire 直接返回仍被持有的同一资产的次数
+			std::uint64_t asyncDecodes = 0; // 投递到后台线程的解码数
+			std::uint64_t evictions = 0;    // 因超出预算丢弃的缓存条目数
+		};
+
+		// 获取全局单例
+		static ImageCache& Get();
+
+		// 关闭后 Window 退回每次尺寸变化都 loadimage 的旧路径（默认开启）
+		void setEnabled(bool on) { on_ = on; }
+		bool enabled() const { return on_; }
+
+		// 每个文件保留的输出尺寸数（默认 4，最少 1）
+		void setMaxSizes(std::size_t n);
+		std::size_t maxSizes() const { return maxSizes_; }
+
+		// 缓存自身持有字节数的上限（默认 128 MiB）；超出时按最久未用丢弃整条
+		void setBudget(std::size_t bytes);
+		std::size_t budget() const { return budget_; }
+
+		// 源图未解码时 acquire 是否投递到后台线程（默认开启）；关闭后在调用处同步解码
+		void setAsync(bool on) { async_ = on; }
+		bool async() const { return async_; }
+
+		// path 缩放到 w×h 的图像；解码失败返回空。返回的图像内容不会再被修改
+		std::shared_ptr<IMAGE> scaled(const std::string& path, int w, int h);
+		// path 缩放到 w×h 的共享资产（总是非空）；源图已在内存中或同步模式下返回时即已就绪
+		std::shared_ptr<ImageAsset> acquire(const std::string& path, int w, int h);
+		// UI 线程：接收已完成的后台解码并解析等待中的资产；返回本次就绪 / 失败的资产数
+		std::size_t pump();
+		// 阻塞直到已投递的解码全部完成，再 pump 一次（基准与批处理用）
+		std::size_t finishPending();
+		// 仍在后台解码的文件数
+		std::size_t pendingDecodes() const { return inflight.size(); }
+
+		// 丢弃 path 的源像素与全部输出尺寸（已被外部持有的输出与资产不受影响）
+		void evict(const std::string& path);
+		void clear();
+
+		const Stats& getStats() const { return stats; }
+		void resetStats();
+
+	private:
+		ImageCache() = default;
+		ImageCache(const ImageCache&) = delete;
+		ImageCache& operator=(const ImageCache&) = delete;
+
+		struct Entry
+		{
+			std::unique_ptr<IMAGE> source;                 // 原尺寸像素
+			std::vector<std::unique_ptr<IMAGE>> mips;      // mips[k] 为源的 1/2^(k+1)
+			std::list<std::shared_ptr<IMAGE>> outputs;     // 前端为最近使用
+			std::uint64_t lastUse = 0;                     // 预算淘汰用的访问序号
+		};
+
+		// 后台解码的结果（后台线程只写本结构，交回时加锁）
+		struct Decode
+		{
+			std::string path;
+			std::uint64_t gen = 0;
+			std::vector<DWORD> px;
+			int w = 0, h = 0;
+			bool ok = false;
+		};
+
+		struct Inflight
+		{
+			std::uint64_t gen = 0;
+			std::vector<std::weak_ptr<ImageAsset>> waiting;
+		};
+
+		using AssetKey = std::tuple<std::string, int, int>;
+
+		// UI 线程读盘解码（loadimage）；失败返回空
+		static std::unique_ptr<IMAGE> loadOnUiThread(const std::string& path);
+		// 已解码的源图登记为条目
+		Entry& install(const std::string& path, std::unique_ptr<IMAGE> src);
+		// 从条目取 w×h 的输出（命中或缩放）
+		std::shared_ptr<IMAGE> outputFor(Entry& e, int w, int h);
+		// 不小于 w×h 的最小一级（源本身或某个 mip 级）
+		IMAGE* levelFor(Entry& e, int w, int h);
+		void drop(Entry& e);
+		void trim(const Entry* keep);
+
+		bool on_ = true;
+		bool async_ = true;
+		std::size_t maxSizes_ = 4;
+		std::size_t budget_ = (std::size_t)128 << 20;
+		std::uint64_t tick = 0;
+		std::unordered_map<std::string, Entry> entries;
+		std::map<AssetKey, std::weak_ptr<ImageAsset>> assets;
+
+		std::uint64_t decodeGen = 0;
+		std::unordered_map<std::string, Inflight> inflight;
+		std::mutex doneLock;
+		std::vector<std::unique_ptr<Decode>> done;
+
+		Stats stats;
+	};
+}
@@ -0,0 +1,84 @@
+﻿/*******************************************************************************
+ * @文件: SxLayerCache.h
+ * @摘要: 星垣(StellarX) 静态内容图层缓存
+ * @描述:
+ *     容器重绘时会把所有子控件标脏并逐个 draw（见 Canvas::draw），
+ *     对内容从未变化的静态控件来说，每次都要重新设置字体、度量文本、光栅化文字。
+ *     开启图层缓存的控件首次绘制时把结果渲染到离屏表面，之后只要“样式 + 文本 + 尺寸
+ *     （以及透明背景下的底图）”的哈希不变，就直接贴图，不再走文字管线。
+ *
+ *     - 缓存按内容哈希键共享：文本与样式完全相同的多个控件共用同一份图层；
+ *       条目同时保存完整内容（identity），查找时逐字节比较，哈希碰撞不会贴出别的控件的图层；
+ *     - 全局字节上限，超出时按最近最少使用淘汰；
+ *     - 统计命中/未命中/淘汰次数与当前占用。
+ *
+ * @使用说明:
+ *     控件侧通过 Label::setLayerCacheEnabled(true) 开启；
+ *     调整上限：StellarX::LayerCache::Get().setCapacity(4 << 20);
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace StellarX
+{
+	class LayerCache
+	{
+	public:
+		struct Stats
+		{
+			std::uint64_t hits = 0;       // 直接贴图的次数
+			std::uint64_t misses = 0;     // 需要重新渲染图层的次数
+			std::uint64_t evictions = 0;  // 因超出上限被淘汰的图层数
+			std::size_t   bytes = 0;      // 当前图层占用字节
+			std::size_t   entries = 0;    // 当前图层个数
+			double hitRate() const { return hits + misses ? (double)hits / (double)(hits + misses) : 0.0; }
+		};
+
+		// 获取全局单例
+		static LayerCache& Get();
+
+		// 图层内存上限（默认 8 MiB）；0 表示不缓存
+		void setCapacity(std::size_t bytes);
+		std::size_t getCapacity() const { return capacity; }
+
+		// 查找图层：key 为 identity 的哈希，identity 为决定图层像素的完整内容。
+		// 键与内容都相同时记一次 hit 并返回图层，否则记一次 miss 并返回 nullptr
+		const IMAGE* find(std::uint64_t key, const std::string& identity);
+		// 存入刚渲染好的图层（同键的旧条目被替换）；单个图层超过上限时直接丢弃
+		void store(std::uint64_t key, std::string identity, std::unique_ptr<IMAGE> layer);
+		void clear();
+
+		const Stats& getStats() const { return stats; }
+		void resetStats();
+
+		// 屏幕上 (x, y, w, h) 范围内像素的哈希（越界部分不参与），用于透明背景图层的底图键
+		static std::uint64_t hashScreenRect(int x, int y, int w, int h, std::uint64_t seed);
+
+	private:
+		LayerCache() = default;
+		LayerCache(const LayerCache&) = delete;
+		LayerCache& operator=(const LayerCache&) = delete;
+
+		struct Entry
+		{
+			std::uint64_t key;
+			std::string identity;
+			std::unique_ptr<IMAGE> layer;
+			std::size_t bytes;
+		};
+
+		void shrinkTo(std::size_t limit);
+
+		std::size_t capacity = 8u << 20;
+		std::list<Entry> lru;                                          // 前端为最近使用
+		std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+		Stats stats;
+	};
+}
@@ -0,0 +1,58 @@
+﻿/*******************************************************************************
+ * @文件: SxOcclusion.h
+ * @摘要: 星垣(StellarX) 遮挡剔除 —— 被上层不透明控件完全盖住的控件不画
+ * @描述:
+ *     Window::redrawScene 与容器的整块绘制按 z 序从下往上把每个控件都画一遍，
+ *     即使上面压着一个不透明的对话框或实心画布，下面的控件也照画不误。
+ *     cull() 按 z 序从上往下走一遍：
+ *       - 用“已覆盖区域”减去控件的绘制范围（getDamageRect），减空说明完全被遮住，标记剔除；
+ *       - 未被剔除的控件把自己确定不透明的部分（Control::addOpaqueRegion）并入已覆盖区域。
+ *     只有实心填充的 Canvas / Dialog / 矩形 Button 声明不透明部分；边框像素不计入，
+ *     圆角按两条十字臂计入，其余控件一律视为透明，不会遮挡任何东西。
+ *     判定先逐块做包含测试（被整个压在一个对话框/面板下是常见情况），跨多块时才并成区域做减法。
+ *
+ * @限制:
+ *     只在合成器模式下使用：抓屏快照模式下，上层控件的背景快照必须抓到下层控件的像素
+ *     （对话框关闭时回贴），下层不画，快照里就缺了它们。
+ *
+ * @使用说明:
+ *     std::vector<Control*> layers = { ... };   // 按绘制顺序，底层在前
+ *     std::vector<char> culled;
+ *     StellarX::Occlusion::cull(layers, &damage, culled);   // damage 可为空：不限范围
+ *     for (i...) culled[i] ? layers[i]->setDirty(false) : layers[i]->draw();
+ *     统计按帧（beginFrame 划分）与累计两种口径。
+ ******************************************************************************/
+#pragma once
+
+#include "SxRegion.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Control;
+
+namespace StellarX
+{
+	namespace Occlusion
+	{
+		struct Stats
+		{
+			std::uint64_t tested = 0;          // 参与判定的可见控件数（累计）
+			std::uint64_t culled = 0;          // 被剔除的控件数（累计）
+			std::uint64_t frameCulled = 0;     // 当前帧已剔除数
+			std::uint64_t lastFrameCulled = 0; // 上一帧剔除数
+			std::uint64_t frames = 0;          // beginFrame 次数
+		};
+
+		// layers 按绘制顺序（底层在前）；limit 非空时只看与其相交的部分（合成损伤区）。
+		// culled 与 layers 等长，被完全遮住的置 1；返回剔除个数。关闭时全部为 0
+		std::size_t cull(const std::vector<Control*>& layers, const Region* limit, std::vector<char>& culled);
+
+		void setEnabled(bool on);
+		bool enabled();
+
+		void beginFrame();
+		const Stats& stats();
+		void resetStats();
+	}
+}
@@ -0,0 +1,68 @@
+﻿/*******************************************************************************
+ * @文件: SxPixelKernels.h
+ * @摘要: 星垣(StellarX) 32 位像素批量操作内核（SSE2 / AVX2 / 标量，运行时分派）
+ * @描述:
+ *     快照保存/回贴（getimage/putimage）、矩形填充、窗口背景绘制本质上都是
+ *     大块 32 位像素的搬运与填充。本文件提供这些操作的向量化实现：
+ *       - copy / copyRect：行拷贝与矩形拷贝；
+ *       - fill / fillRect：实心填充；
+ *       - fillRectBordered：带边框的不透明矩形，一次遍历写完边框与内部；
+ *       - blendSourceOver：源覆盖(source-over)混合，源为非预乘 alpha（最高字节）；
+ *       - blendCoverage：按逐像素覆盖率把单一颜色混合到目标（抗锯齿形状边缘）；
+ *       - premultiply / blendPremultiplied：预乘 alpha 图层的生成与合成（控件不透明度）；
+ *       - scaleBilinear / halve：背景图缩放（双线性）与 2×2 盒式降采样（mip 级）。
+ *
+ *     首次调用时按 CPU 支持选择 AVX2 → SSE2 → 标量；可用 setIsa 强制降级以便对比。
+ *     各实现逐位一致（混合的除以 255 采用同一个精确整数公式）。
+ *
+ * @备注:
+ *     不依赖绘图后端：像素按 std::uint32_t 处理，与 IMAGE 缓冲(DWORD)布局相同；
+ *     非 x86 平台只有标量实现。
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace StellarX
+{
+	namespace Pixel
+	{
+		enum class Isa { Scalar, SSE2, AVX2 };
+
+		// 当前使用的指令集 / CPU 支持的最高指令集
+		Isa activeIsa();
+		Isa bestIsa();
+		// 强制使用指定指令集（超出 CPU 支持时取 bestIsa()），用于基准与对拍
+		void setIsa(Isa isa);
+		const char* isaName(Isa isa);
+
+		void copy(std::uint32_t* dst, const std::uint32_t* src, std::size_t n);
+		void fill(std::uint32_t* dst, std::size_t n, std::uint32_t px);
+		void blendSourceOver(std::uint32_t* dst, const std::uint32_t* src, std::size_t n);
+		// dst[i] = px × cov[i]/255 + dst[i] × (1 − cov[i]/255)，四个字节通道相同处理；
+		// cov 为 255 时写入 px，为 0 时不改动
+		void blendCoverage(std::uint32_t* dst, const std::uint8_t* cov, std::size_t n, std::uint32_t px);
+		// 预乘：dst[i] 的颜色通道 = src[i] × alpha/255（四舍五入），alpha 字节写为 alpha
+		void premultiply(std::uint32_t* dst, const std::uint32_t* src, std::size_t n, std::uint8_t alpha);
+		// 预乘源覆盖：dst[i] 的颜色通道 = src[i] + dst[i] × (255 − src 的 alpha)/255，dst 的 alpha 字节保持不变；
+		// src 为 0 的像素不改动
+		void blendPremultiplied(std::uint32_t* dst, const std::uint32_t* src, std::size_t n);
+
+		// 矩形版本：stride 以像素计
+		void copyRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h);
+		void fillRect(std::uint32_t* dst, std::ptrdiff_t stride, int w, int h, std::uint32_t px);
+		// w×h 的矩形：外圈 borderWidth 像素为 border，内部为 fill（borderWidth 不小于 1）
+		void fillRectBordered(std::uint32_t* dst, std::ptrdiff_t stride, int w, int h, std::uint32_t fill, std::uint32_t border, int borderWidth);
+		void blendRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h);
+		void premultiplyRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h, std::uint8_t alpha);
+		void blendPremultipliedRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h);
+
+		// 双线性缩放：sw×sh 的 src 缩放为 dw×dh 写入 dst；像素中心对齐，7 位定点权重，
+		// 四个字节通道一视同仁。缩小超过 2 倍会混叠，应先用 halve 降到 2 倍以内
+		void scaleBilinear(std::uint32_t* dst, std::ptrdiff_t dstStride, int dw, int dh,
+			const std::uint32_t* src, std::ptrdiff_t srcStride, int sw, int sh);
+		// 2×2 盒式降采样：dst 为 (sw/2)×(sh/2)，奇数尺寸的最后一行/列舍弃
+		void halve(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int sw, int sh);
+	}
+}
@@ -0,0 +1,56 @@
+﻿/*******************************************************************************
+ * @文件: SxPresent.h
+ * @摘要: 星垣(StellarX) 局部提交(partial present) —— 批量绘制结束时只提交改动过的矩形
+ * @描述:
+ *     EndBatchDraw() 会把整个后台缓冲提交到窗口：1920x1080 的窗口里悬停一个 25x30 的按钮，
+ *     也要搬运整窗约 8 MB 像素。Window::flushManagedRepaint 已知道本轮实际重画的范围
+ *     （合成器的损伤区，或抓屏模式下各 root 的绘制范围 + 补画的对话框），
+ *     用 endBatch(touched, …) 结束批量绘制即可只提交这些矩形：
+ *       - EasyX：逐矩形 FlushBatchDraw(l, t, r, b)，最后一个矩形用 EndBatchDraw(l, t, r, b)；
+ *       - 无头后端：逐矩形拷贝到可见帧（Headless::front），并计入 bytesPresented。
+ *     矩形过多时退化为外接矩形；覆盖面积超过屏幕一半时直接整屏提交，避免零碎提交反而更慢。
+ *
+ * @注意:
+ *     touched 必须覆盖本批次写过的全部屏幕像素，否则窗口上会残留旧内容；
+ *     整场景重绘（redrawScene）仍用 EndBatchDraw() 整屏提交。
+ *
+ * @使用说明:
+ *     BeginBatchDraw();
+ *     ...                                                   // 只在 touched 内绘制
+ *     StellarX::Present::endBatch(touched, width, height);
+ *     StellarX::Present::setEnabled(false);                 // 总是整屏提交，用于对比
+ ******************************************************************************/
+#pragma once
+
+#include "SxRegion.h"
+#include <cstdint>
+
+namespace StellarX
+{
+	namespace Present
+	{
+		struct Stats
+		{
+			std::uint64_t frames = 0;          // endBatch 调用次数
+			std::uint64_t partialFrames = 0;   // 按矩形提交的帧数（其余为整屏）
+			std::uint64_t rects = 0;           // 提交的矩形数（整屏计 1）
+			std::uint64_t bytesPresented = 0;  // 提交的像素字节数
+			std::uint64_t fullBytes = 0;       // 同样的帧全部整屏提交时的字节数（对比用）
+			std::uint64_t lastFrameBytes = 0;  // 最近一帧提交的字节数
+		};
+
+		// 默认开启；关闭后 endBatch 总是整屏提交
+		void setEnabled(bool on);
+		bool enabled();
+		// 单帧最多提交的矩形数（默认 8），超出时合并为外接矩形
+		void setMaxRects(int n);
+		int maxRects();
+
+		// 结束批量绘制并提交 touched（屏幕坐标、半开区间，会裁剪到 screenW × screenH）；
+		// touched 为空时不提交任何像素
+		void endBatch(const Region& touched, int screenW, int screenH);
+
+		const Stats& stats();
+		void resetStats();
+	}
+}
@@ -0,0 +1,64 @@
+﻿/*******************************************************************************
+ * @文件: SxRedrawScheduler.h
+ * @摘要: 星垣(StellarX) 按帧预算分片的渐进式整场景重绘
+ * @描述:
+ *     尺寸调整收口、对话框开关、setBkImage 都会整场景重绘，在 runEventLoop 的一轮里同步画完；
+ *     4K 窗口上一次要几十到上百毫秒，期间输入得不到处理。
+ *     开启后（且窗口启用了合成器），整场景重绘只登记为一组带优先级的工作项：
+ *       1) 光标下的顶层控件、最上层的可见对话框（按给定顺序）；
+ *       2) 其余可见区域按 tileSize 见方切块，离光标近的先画。
+ *     事件循环每轮取一条消息后执行一帧：依次合成工作项（Window::composeRegion，裁剪到该项），
+ *     累计耗时按已完成项的平均耗时预估，下一项会超出帧预算即停，本帧只提交画过的范围。
+ *     每帧至少完成一项，保证有界完成；再次登记时与未完成的部分合并后重新规划。
+ *
+ * @限制:
+ *     只用于合成器模式：抓屏快照模式下控件必须按 z 序整块绘制（上层快照要抓到下层像素），
+ *     不能按区域乱序分片，Window 会退回同步的 redrawScene。
+ *
+ * @使用说明:
+ *     StellarX::RedrawScheduler::setEnabled(true);       // 默认关闭
+ *     StellarX::RedrawScheduler::setFrameBudget(8.0);    // 每帧绘制预算（毫秒）
+ *     StellarX::RedrawScheduler::setTileSize(256);       // 切块边长（像素）
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include "SxRegion.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace StellarX
+{
+	namespace RedrawScheduler
+	{
+		struct Stats
+		{
+			std::uint64_t redraws = 0;       // 完成的渐进重绘次数
+			std::uint64_t frames = 0;        // 执行的帧数（累计）
+			std::uint64_t items = 0;         // 合成的工作项数（累计）
+			double maxFrameMs = 0;           // 最长一帧的绘制耗时（累计口径）
+			std::uint64_t lastFrames = 0;    // 最近一次完成的重绘用了几帧
+			double lastWorkMs = 0;           // 最近一次完成的重绘的绘制总耗时
+			double lastMaxFrameMs = 0;       // 最近一次完成的重绘中最长一帧
+		};
+
+		void setEnabled(bool on);
+		bool enabled();
+		void setFrameBudget(double ms);
+		double frameBudget();
+		void setTileSize(int px);
+		int tileSize();
+
+		// 登记整块区域：priority 中的矩形依次优先，其余按块、按到 focus 的距离由近及远
+		void schedule(const Region& area, const std::vector<RECT>& priority, POINT focus);
+		bool pending();
+		void cancel();
+		// 执行一帧：对本帧取出的每个工作项调用 compose(item)；返回本帧画过的范围。
+		// compose 内可再次 schedule（补画合成中新出现的损伤），并入当前这次重绘
+		Region runFrame(const std::function<void(const Region&)>& compose);
+
+		const Stats& stats();
+		void resetStats();
+	}
+}
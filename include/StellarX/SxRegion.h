@@ -0,0 +1,91 @@
+﻿/*******************************************************************************
+ * @文件: SxRegion.h
+ * @摘要: 星垣(StellarX) 区域代数 —— y 分带的不相交矩形集合
+ * @描述:
+ *     用于托管重绘的覆盖范围累计、对话框补画判定与合成器损伤区。
+ *     与“一个外接矩形”相比，区域能精确表达“画布两角各有一个脏按钮”这类情形，
+ *     不会把中间大片未变化的区域（以及压在上面的对话框）一并卷入重绘。
+ *
+ * @表示法:
+ *     - 区域由若干“带(Band)”组成，带按 top 递增排列且互不重叠；
+ *     - 每个带内是按 left 递增、互不相交也不相邻的水平区间(Span)；
+ *       所有区间连续存放在一个数组中，带只记录自己的起始下标与个数（避免逐带分配）；
+ *     - 上下相邻且区间完全相同的带会被合并，因此同一区域的表示唯一，可直接比较相等；
+ *     - 所有坐标均为半开区间：[left, right) × [top, bottom)。
+ *
+ * @备注:
+ *     本文件不依赖任何绘图后端（只用 int），可在任何平台单独编译与测试；
+ *     与 RECT / HRGN 的互转由使用方完成。
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace StellarX
+{
+	class Region
+	{
+	public:
+		struct Span
+		{
+			int left;
+			int right;
+			bool operator==(const Span& o) const { return left == o.left && right == o.right; }
+		};
+
+		struct Band
+		{
+			int top;
+			int bottom;
+			std::size_t first;   // 在 getSpans() 中的起始下标
+			std::size_t count;   // 区间个数（至少 1）
+		};
+
+		Region() = default;
+		// 单个矩形；宽或高不为正时得到空区域
+		Region(int left, int top, int right, int bottom);
+
+		bool isEmpty() const { return bands.empty(); }
+		void clear() { bands.clear(); spans.clear(); }
+
+		// —— 布尔运算 ——（就地修改并返回自身）
+		Region& unite(const Region& other);
+		Region& intersect(const Region& other);
+		Region& subtract(const Region& other);
+		Region& unite(int left, int top, int right, int bottom) { return unite(Region(left, top, right, bottom)); }
+		Region& subtract(int left, int top, int right, int bottom) { return subtract(Region(left, top, right, bottom)); }
+
+		// —— 查询 ——
+		bool intersects(int left, int top, int right, int bottom) const;
+		bool intersects(const Region& other) const;
+		bool contains(int x, int y) const;
+		long long area() const;
+		std::size_t rectCount() const;
+		// 外接矩形；空区域返回 false 且不修改输出
+		bool getBounds(int& left, int& top, int& right, int& bottom) const;
+		const std::vector<Band>& getBands() const { return bands; }
+		const std::vector<Span>& getSpans() const { return spans; }
+
+		// 逐个枚举组成区域的不相交矩形：f(left, top, right, bottom)
+		template <class F>
+		void forEachRect(F&& f) const
+		{
+			for (const Band& b : bands)
+				for (std::size_t k = b.first; k < b.first + b.count; ++k)
+					f(spans[k].left, b.top, spans[k].right, b.bottom);
+		}
+
+		bool operator==(const Region& o) const;
+		bool operator!=(const Region& o) const { return !(*this == o); }
+
+	private:
+		enum class Op { Union, Intersect, Subtract };
+		static Region combine(const Region& a, const Region& b, Op op);
+		// 把 spans 末尾从 first 开始的区间收为一个新带；与上一个带相邻且区间相同则直接延长
+		void closeBand(int top, int bottom, std::size_t first);
+
+		std::vector<Band> bands;
+		std::vector<Span> spans;
+	};
+}
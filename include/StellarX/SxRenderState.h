@@ -0,0 +1,133 @@
+﻿/*******************************************************************************
+ * @文件: SxRenderState.h
+ * @摘要: 星垣(StellarX) 绘图状态跟踪器 —— 消除重复的状态设置
+ * @描述:
+ *     每个控件的 draw() 都会 saveStyle()/restoreStyle()，并重新设置字体、颜色、线型与画刷；
+ *     Table::draw 一次调用里同一字体会设置三次，而 restoreStyle 总是 settextstyle(&LOGFONT)，
+ *     在 EasyX 下每次都会重建 GDI 字体。
+ *     本跟踪器保存设备的当前状态（影子状态）：
+ *       - set* 与影子状态相同则直接丢弃，不调用后端；
+ *       - push/pop 只在栈上复制影子状态，pop 时仅重新设置与栈顶不同的项；
+ *       - 绘制遍历（DrawPass）内最外层的 pop 延后执行：相邻兄弟控件往往字体、颜色相同，
+ *         下一个控件的设置可直接被消除；遍历结束时补上恢复。遍历之外（事件分发里单独重画
+ *         某个控件）最外层 pop 立即恢复，之后运行的应用代码（如 onClick 里的 outtextxy）
+ *         看到的仍是进入控件前的字体与颜色；
+ *       - 最外层 push 与栈外设置前先从设备读回状态：应用代码绕过跟踪器
+ *         直接调用 setfillcolor 等接口时以应用的设置为准，不会被误判或覆盖。
+ *     计数器区分“实际下发”与“被消除”的设置次数，按帧与累计两种口径统计。
+ *
+ * @使用说明:
+ *     控件绘制时经 Control::saveStyle/restoreStyle 入栈出栈，状态设置改为：
+ *         auto& rs = StellarX::RenderState::Get();
+ *         rs.setFillColor(bk);
+ *         rs.setTextStyle(textStyle);
+ *     Window 的事件循环每轮调用一次 beginFrame() 划分帧。
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstdint>
+#include <vector>
+
+namespace StellarX
+{
+	struct ControlText;
+
+	class RenderState
+	{
+	public:
+		struct Counters
+		{
+			std::uint64_t issued = 0;      // 实际调用后端 set* 的次数
+			std::uint64_t elided = 0;      // 与当前状态相同而被丢弃的次数
+			std::uint64_t fontsIssued = 0; // 其中字体设置（EasyX 下需重建 GDI 字体）的下发次数
+			std::uint64_t fontsElided = 0;
+			std::uint64_t pushes = 0;      // saveStyle 次数
+			std::uint64_t syncs = 0;       // 从设备读回状态的次数
+			double elidedRate() const { return issued + elided ? (double)elided / (double)(issued + elided) : 0.0; }
+		};
+
+		// 获取全局单例
+		static RenderState& Get();
+
+		void setTextStyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation,
+			int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut);
+		void setTextStyle(const ControlText& text);   // 字体部分，不含颜色
+		void setTextColor(COLORREF c);
+		void setFillColor(COLORREF c);
+		void setLineColor(COLORREF c);
+		void setBkColor(COLORREF c);
+		void setBkMode(int mode);
+		void setLineStyle(int style, int thickness = 1);
+		void setFillStyle(int style, long hatch = 0, IMAGE* ppattern = nullptr);
+
+		// 保存 / 恢复（栈式，必须成对调用）。最外层的恢复只在绘制遍历（DrawPass）内延后，遍历外立即执行
+		void push();
+		void pop();
+
+		// 一次绘制遍历（Window 重画场景 / 合成损伤区 / 提交托管重绘，Canvas 局部重画子控件）：
+		// 遍历内兄弟控件之间延后最外层恢复，最外层遍历结束时补上。可嵌套
+		class DrawPass
+		{
+		public:
+			DrawPass();
+			~DrawPass();
+			DrawPass(const DrawPass&) = delete;
+			DrawPass& operator=(const DrawPass&) = delete;
+		};
+
+		// 丢弃影子状态：外部直接改动了设备状态（如重建绘图窗口）后调用，下次使用时重新读回
+		void invalidate() { known = false; }
+
+		// 开始新的一帧：补上延后的恢复；上一帧有状态设置时记入 lastFrame
+		void beginFrame();
+		const Counters& currentFrame() const { return frame; }
+		const Counters& lastFrame() const { return last; }
+		const Counters& total() const { return sum; }
+		std::uint64_t frameCount() const { return frames; }   // 有状态设置的帧数
+		void resetStats();
+
+	private:
+		RenderState() = default;
+		RenderState(const RenderState&) = delete;
+		RenderState& operator=(const RenderState&) = delete;
+
+		struct State
+		{
+			LOGFONT font{};
+			COLORREF textColor = 0;
+			COLORREF fillColor = 0;
+			COLORREF lineColor = 0;
+			COLORREF bkColor = 0;
+			int bkMode = 0;
+			LINESTYLE lineStyle;
+			FILLSTYLE fillStyle;
+		};
+
+		void sync();
+		void prepare();
+		void flush();
+		void put(const State& s);
+		bool count(bool changed, bool font = false);
+		static bool equals(const State& a, const State& b);
+
+		// 与影子状态比较后按需下发，不做读回 / 补恢复
+		void putFont(const LOGFONT& f);
+		void putTextColor(COLORREF c);
+		void putFillColor(COLORREF c);
+		void putLineColor(COLORREF c);
+		void putBkColor(COLORREF c);
+		void putBkMode(int mode);
+		void putLineStyle(const LINESTYLE& ls);
+		void putFillStyle(int style, long hatch, IMAGE* ppattern);
+
+		State cur;                 // 设备当前状态
+		bool known = false;
+		std::vector<State> stack;
+		State restore;             // 延后执行的最外层恢复
+		bool pending = false;
+		int passDepth = 0;         // 嵌套的 DrawPass 层数；为 0 时最外层 pop 立即恢复
+		Counters frame, last, sum;
+		std::uint64_t frames = 0;
+	};
+}
@@ -0,0 +1,60 @@
+﻿/*******************************************************************************
+ * @文件: SxRleImage.h
+ * @摘要: 星垣(StellarX) 行游程压缩图像 —— 大块均匀背景快照的紧凑存储
+ * @描述:
+ *     控件背景快照里大多是纯色：窗口底色、画布的实心填充，外加几条边框。
+ *     RleImage 按行把像素压成“从 x 开始的同色游程”，并让与上一行完全相同的行
+ *     直接共用上一行的游程，实心矩形（含边框）因此只需几十字节。
+ *     解码支持任意子矩形：逐行二分定位起始游程后批量填充（Pixel::fill）。
+ *
+ *     encode 在压缩后超过 maxBytes 时放弃（返回 false），调用方继续使用原始像素；
+ *     含文字、图片的区域通常压不下来，不值得付出解码开销。
+ *
+ * @备注:
+ *     像素按 std::uint32_t 处理，与 IMAGE 缓冲(DWORD)布局相同，不依赖绘图后端。
+ *
+ * @使用说明:
+ *     StellarX::RleImage rle;
+ *     if (rle.encode(GetImageBuffer(&img), img.getwidth(), w, h, w * h))   // 至少压到 1/4
+ *         rle.decode(dst, dstStride, sx, sy, sw, sh);
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace StellarX
+{
+	class RleImage
+	{
+	public:
+		// 压缩 w×h 像素（行跨度 stride 个像素）；结果超过 maxBytes 时放弃并清空，返回 false
+		bool encode(const std::uint32_t* src, int stride, int w, int h, std::size_t maxBytes);
+		// 把 [sx, sx+w) × [sy, sy+h) 解到 dst（行跨度 dstStride 个像素）；范围须在图像内
+		void decode(std::uint32_t* dst, int dstStride, int sx, int sy, int w, int h) const;
+		void clear();
+
+		bool empty() const { return rows.empty(); }
+		int width() const { return imgW; }
+		int height() const { return imgH; }
+		// 压缩后占用的字节数
+		std::size_t bytes() const { return runs.size() * sizeof(Run) + rows.size() * sizeof(Row); }
+
+	private:
+		struct Run
+		{
+			std::int32_t x;        // 游程起点（行内坐标），持续到下一游程起点或行尾
+			std::uint32_t color;
+		};
+		struct Row
+		{
+			std::uint32_t begin;   // 本行首个游程在 runs 中的下标
+			std::uint32_t end;
+		};
+
+		std::vector<Run> runs;
+		std::vector<Row> rows;     // 与上一行相同的行指向同一段游程
+		int imgW = 0, imgH = 0;
+	};
+}
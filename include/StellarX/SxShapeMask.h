@@ -0,0 +1,114 @@
+﻿/*******************************************************************************
+ * @文件: SxShapeMask.h
+ * @摘要: 星垣(StellarX) 抗锯齿形状覆盖率掩码缓存 —— 圆角矩形 / 圆 / 椭圆
+ * @描述:
+ *     Button 的 ROUND_RECTANGLE / CIRCLE / ELLIPSE 与 Canvas、TextBox 的圆角样式
+ *     每次重绘都经 fillroundrect / fillcircle / fillellipse 从头光栅化，且边缘没有抗锯齿。
+ *     本缓存按 (形状, 宽, 高, 圆角宽高, 线宽) 为每种形状只计算一次覆盖率掩码
+ *     （每像素 4×4 超采样，0~255）：
+ *       - outer：整个形状（含边框）的覆盖率；
+ *       - inner：去掉边框后内部的覆盖率（无边框形状没有这一层）；
+ *       - 每行记下非零范围与全覆盖范围。
+ *     绘制时每行分三段：全覆盖的内部直接 Pixel::fill，两端的边缘经 Pixel::blendCoverage
+ *     先按 outer 混入线条色、再按 inner 混入填充色（SSE2/AVX2）。
+ *     因此一格圆角按钮的重绘只是若干次实心填充加上很短的边缘混合，不再逐行开方。
+ *
+ *     几何与后端的非抗锯齿光栅化一致：右/下边界为闭区间，粗线按 (线宽-1)/2 向外扩展；
+ *     掩码按最近最少使用淘汰，总字节数不超过 budget。
+ *
+ * @限制:
+ *     只处理实心画刷（阴影线/图案画刷退回后端）与实线或空画笔；
+ *     直接写入当前绘图目标的像素缓冲（GetImageBuffer），因此合成器的裁剪区需经 setClip 告知。
+ *     默认关闭：开启后形状边缘与 EasyX 的非抗锯齿结果不再逐像素相同。
+ *     无头后端的过绘制统计不计入经掩码写入的像素。
+ *
+ * @使用说明:
+ *     StellarX::ShapeMaskCache::Get().setEnabled(true);
+ *     // 之后 DisplayList 重放 fillRoundRect / fillCircle / fillEllipse 等命令时自动经掩码绘制
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include "SxRegion.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace StellarX
+{
+	class ShapeMaskCache
+	{
+	public:
+		struct Stats
+		{
+			std::uint64_t draws = 0;         // 经掩码绘制的形状数
+			std::uint64_t hits = 0;          // 命中已缓存掩码的次数
+			std::uint64_t builds = 0;        // 计算掩码的次数
+			std::uint64_t fallbacks = 0;     // 开启时因状态不支持而退回后端的次数
+			std::uint64_t evictions = 0;     // 超出预算被淘汰的掩码数
+			std::uint64_t pixelsFilled = 0;  // 全覆盖、直接填充的像素数
+			std::uint64_t pixelsBlended = 0; // 边缘按覆盖率混合的像素数（含边框两层）
+			std::size_t   bytesHeld = 0;     // 当前缓存的掩码字节数
+		};
+
+		// 获取全局单例
+		static ShapeMaskCache& Get();
+
+		// 默认关闭；关闭时 draw* 直接返回 false，由调用方走后端光栅化
+		void setEnabled(bool on) { on_ = on; }
+		bool enabled() const { return on_; }
+
+		// 掩码总字节预算（默认 2 MiB）；最近使用的一个掩码总是保留
+		void setBudget(std::size_t bytes);
+		std::size_t budget() const { return budget_; }
+		void clear();
+
+		// 当前绘图目标上的裁剪区（屏幕坐标、半开区间）；nullptr 表示不裁剪。
+		// 只对设置时的绘图目标生效，与 setcliprgn 的语义一致
+		void setClip(const Region* clip);
+
+		// 以当前填充色/线条色/线宽绘制；border 为 false 时只填充（solid*）。
+		// 返回 false 表示未绘制（未开启、画刷或画笔不支持、尺寸超限），调用方应退回后端
+		bool drawRoundRect(int l, int t, int r, int b, int ew, int eh, bool border);
+		bool drawEllipse(int l, int t, int r, int b, bool border);
+
+		const Stats& getStats() const { return stats; }
+		void resetStats();
+
+	private:
+		ShapeMaskCache() = default;
+		ShapeMaskCache(const ShapeMaskCache&) = delete;
+		ShapeMaskCache& operator=(const ShapeMaskCache&) = delete;
+
+		struct Row
+		{
+			std::int16_t x0, x1;   // 非零覆盖范围 [x0, x1)
+			std::int16_t f0, f1;   // 全覆盖范围 [f0, f1)，f0 == f1 表示没有
+		};
+
+		struct Mask
+		{
+			int w = 0;
+			int h = 0;
+			std::vector<std::uint8_t> outer, inner;
+			std::vector<Row> outerRows, innerRows;
+			std::list<std::uint64_t>::iterator lru;
+			std::size_t bytes() const;
+		};
+
+		bool draw(bool ellipse, int l, int t, int r, int b, int ew, int eh, bool border);
+		const Mask& maskFor(bool ellipse, int w, int h, int ew, int eh, int pen);
+		void trim();
+
+		bool on_ = false;
+		std::size_t budget_ = 2u << 20;
+		std::unordered_map<std::uint64_t, Mask> masks;
+		std::list<std::uint64_t> order;      // 前端为最近使用
+		std::vector<RECT> clip;
+		bool clipping = false;
+		IMAGE* clipTarget = nullptr;
+		Stats stats;
+	};
+}
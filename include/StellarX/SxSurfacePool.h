@@ -0,0 +1,126 @@
+﻿/*******************************************************************************
+ * @文件: SxSurfacePool.h
+ * @摘要: 星垣(StellarX) 背景快照表面池
+ * @描述:
+ *     控件的背景快照（Control::saveBkImage）不再各自 new/delete IMAGE，
+ *     而是从本池按尺寸借出、用完归还：
+ *       - 归还的表面按“最近使用”顺序缓存，下次同尺寸（或同一尺寸档）的快照直接复用；
+ *       - 窗口拉伸时所有控件先作废快照、下一帧再按新尺寸重抓，
+ *         大部分尺寸不变的控件会命中缓存，不再反复分配/释放像素缓冲；
+ *       - 全局字节预算：超出时先丢弃最久未用的缓存表面，
+ *         仍超出则回收“隐藏控件”持有的快照（最久未用者优先）；可见控件的快照从不回收。
+ *
+ * @尺寸档:
+ *     像素数按 2 的幂分档。优先精确匹配宽高；否则复用同档表面并 Resize，
+ *     在无头后端中 Resize 不超过原容量时不会重新分配。
+ *
+ * @不透明控件:
+ *     Control::isOpaque() 为真的控件每次绘制都会把快照范围整块盖满，回贴旧像素纯属浪费；
+ *     开启 setSkipOpaque（默认开启）时它们不借表面，只通过 skip() 登记范围，
+ *     省下的字节计入 Stats::bytesSkipped。
+ *
+ * @共享与压缩:
+ *     开启 setCompact（默认开启）时：
+ *       - 画布把画完本体（子控件之前）的像素按行游程压缩留存（StellarX::RleImage），
+ *         完全落在本体内、底下没有先画兄弟的子控件直接引用它，不另抓像素；
+ *       - 其余不小于 64×64 的快照抓屏后尝试压缩，压到原始大小 1/4 以内就归还表面、只留压缩数据。
+ *     整棵控件树实际占用的快照字节见 Control::snapshotBytes()。
+ *
+ * @使用说明:
+ *     框架内部使用；应用侧通常只需要调整预算或读取统计：
+ *         StellarX::SurfacePool::Get().setBudget(32 << 20);
+ *         auto st = StellarX::SurfacePool::Get().getStats();
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+class Control;
+
+namespace StellarX
+{
+	class SurfacePool
+	{
+	public:
+		struct Stats
+		{
+			std::size_t   bytesHeld = 0;    // 池管理的全部表面字节数（在用 + 缓存）
+			std::size_t   bytesInUse = 0;   // 控件正在持有的快照字节数
+			std::size_t   bytesCached = 0;  // 已归还、等待复用的表面字节数
+			std::uint64_t acquires = 0;     // 借出次数
+			std::uint64_t hits = 0;         // 命中缓存（复用已有表面）的次数
+			std::uint64_t misses = 0;       // 新分配表面的次数
+			std::uint64_t evictions = 0;    // 因超预算被回收的隐藏控件快照数
+			std::uint64_t trims = 0;        // 因超预算被丢弃的缓存表面数
+			std::uint64_t opaqueSkips = 0;  // 不透明控件跳过抓屏的次数
+			std::size_t   bytesSkipped = 0; // 不透明控件当前省下的快照字节数（只登记范围、不借表面）
+			std::uint64_t packs = 0;        // 抓屏后压缩存放的快照数
+			std::uint64_t shares = 0;       // 直接引用父容器本体的快照数
+			double hitRate() const { return acquires ? (double)hits / (double)acquires : 0.0; }
+		};
+
+		// 获取全局单例
+		static SurfacePool& Get();
+
+		// 全局字节预算（默认 64 MiB）；0 表示不缓存任何归还的表面
+		void setBudget(std::size_t bytes);
+		std::size_t getBudget() const { return budget; }
+
+		// 为 owner 借出一个 w×h 的表面；owner 此前借出的表面应已归还
+		std::unique_ptr<IMAGE> acquire(Control* owner, int w, int h);
+		// 归还 owner 的表面（img 可为空，仅注销 owner）
+		void release(Control* owner, std::unique_ptr<IMAGE> img);
+		// 记录一次使用（回贴快照时调用），用于 LRU 排序
+		void touch(const Control* owner);
+		// 丢弃全部缓存表面（在用的快照不受影响）
+		void trim();
+
+		// 不透明控件跳过抓屏（默认开启）；关闭后它们与其它控件一样抓取背景像素
+		void setSkipOpaque(bool on) { skipOpaqueSnaps = on; }
+		bool skipOpaque() const { return skipOpaqueSnaps; }
+		// 登记 owner 的快照只记录 w×h 范围、不持有像素；owner 此前借出的表面应已归还，release 时注销
+		void skip(Control* owner, int w, int h);
+		// 快照共享与压缩（默认开启）；关闭后每个控件各自抓取原始像素
+		void setCompact(bool on) { compactSnaps = on; }
+		bool compact() const { return compactSnaps; }
+		void notePacked() { ++stats.packs; }
+		void noteShared() { ++stats.shares; }
+
+		const Stats& getStats() const { return stats; }
+		void resetStats();
+
+	private:
+		SurfacePool() = default;
+		SurfacePool(const SurfacePool&) = delete;
+		SurfacePool& operator=(const SurfacePool&) = delete;
+
+		struct InUse
+		{
+			std::size_t bytes;
+			std::uint64_t lastUse;
+		};
+		struct Cached
+		{
+			std::unique_ptr<IMAGE> img;
+			std::size_t bytes;
+		};
+
+		void enforceBudget(const Control* keep);
+		void dropCached(std::list<Cached>::iterator it);
+
+		std::size_t budget = 64u << 20;
+		std::uint64_t tick = 0;
+		bool enforcing = false;                              // 回收过程中控件会再次归还表面，防止重入
+		bool skipOpaqueSnaps = true;
+		bool compactSnaps = true;
+		std::unordered_map<const Control*, InUse> inUse;
+		std::unordered_map<const Control*, std::size_t> skipped; // 不透明控件 -> 省下的字节
+		std::list<Cached> cached;                            // 前端为最近归还
+		Stats stats;
+	};
+}
@@ -0,0 +1,43 @@
+﻿/*******************************************************************************
+ * @文件: SxTextFit.h
+ * @摘要: 星垣(StellarX) 文本适配工具 —— 省略/截断时的二分查找裁切点
+ * @描述:
+ *     按钮省略号与文本框截断原先逐字符延长（或逐字节回退）前缀并整串重测，
+ *     n 个字符的文本需要 O(n) 次度量、每次度量 O(n) 个字符。
+ *     这里先一次性求出所有字符边界（GBK/MBCS 双字节不会被撕开），
+ *     再在边界上二分查找“能放下的最长前缀”，只需 O(log n) 次度量。
+ *
+ * @备注:
+ *     逐字符 advance 之和与整串度量在字距调整/斜体悬伸下并不总相等，
+ *     为保证与整串度量完全一致，二分的每一步仍度量真实前缀（经 TextMeasureCache）；
+ *     前缀宽度随长度单调不减，因此结果与线性扫描相同。
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace StellarX
+{
+	// GBK/MBCS：位置 i 处字符的字节数（1 或 2；非法序列按 1 字节容错）
+	inline int gbkCharLen(const std::string& s, std::size_t i)
+	{
+		unsigned char b = (unsigned char)s[i];
+		if (b <= 0x7F) return 1; // ASCII
+		if (b >= 0x81 && b <= 0xFE && i + 1 < s.size())
+		{
+			unsigned char b2 = (unsigned char)s[i + 1];
+			if (b2 >= 0x40 && b2 <= 0xFE && b2 != 0x7F) return 2; // 合法双字节
+		}
+		return 1; // 容错
+	}
+
+	// 所有字符的结束字节偏移（第 k 个元素为前 k+1 个字符的字节长度）
+	std::vector<std::size_t> textCharEnds(const std::string& text);
+
+	// 当前字体下宽度不超过 maxW 的最长整字符前缀的字节长度；一个字符都放不下时返回 0
+	std::size_t fitTextPrefix(const std::string& text, int maxW);
+	std::size_t fitTextPrefix(const std::string& text, const std::vector<std::size_t>& charEnds, int maxW, std::uint64_t fontKey);
+}
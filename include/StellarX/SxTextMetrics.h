@@ -0,0 +1,92 @@
+﻿/*******************************************************************************
+ * @文件: SxTextMetrics.h
+ * @摘要: 星垣(StellarX) 文本度量缓存
+ * @描述:
+ *     textwidth/textheight 在表格初始化、按钮截断、文本框省略、对话框排版中
+ *     会对同一批字符串反复调用；每次调用在 EasyX 下都是一次 GDI 文本度量。
+ *     本缓存以“当前字体 + 字符串字节”为键保存宽高：
+ *       - 字体键取自当前绘图设备的 LOGFONT（即控件通过 settextstyle 应用的 ControlText），
+ *         不含颜色，同字体不同颜色的文本共享度量；
+ *       - 命中时再比对字体键与原串，哈希碰撞不会返回错误结果；
+ *       - 宽、高分别按需度量，只要宽度的调用不会多付一次 textheight；
+ *       - 按近似字节数限额，超出时按最近最少使用淘汰。
+ *
+ * @使用说明:
+ *     直接替换 textwidth/textheight：
+ *         int w = StellarX::measureTextWidth(text);
+ *     循环内同一字体下多次度量时先取字体键，避免逐次读取当前字体：
+ *         auto& tm = StellarX::TextMeasureCache::Get();
+ *         const auto font = tm.activeFontKey();
+ *         for (...) w = tm.width(font, cell);
+ ******************************************************************************/
+#pragma once
+
+#include "SxBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace StellarX
+{
+	class TextMeasureCache
+	{
+	public:
+		struct Stats
+		{
+			std::uint64_t hits = 0;       // 命中（未调用 textwidth/textheight）的次数
+			std::uint64_t misses = 0;     // 实际调用 textwidth/textheight 的次数
+			std::uint64_t evictions = 0;  // 因超出限额被淘汰的条目数
+			std::size_t   bytes = 0;      // 当前近似占用字节
+			std::size_t   entries = 0;    // 当前条目数
+			double hitRate() const { return hits + misses ? (double)hits / (double)(hits + misses) : 0.0; }
+		};
+
+		// 获取全局单例
+		static TextMeasureCache& Get();
+
+		// 近似内存限额（默认 2 MiB，约一万五千条）；0 表示不缓存
+		void setCapacity(std::size_t bytes);
+		std::size_t getCapacity() const { return capacity; }
+
+		// 当前绘图设备字体的键
+		std::uint64_t activeFontKey() const;
+
+		// 度量当前字体下 text 的宽/高；fontKey 必须与当前字体一致
+		int width(std::uint64_t fontKey, const std::string& text);
+		int height(std::uint64_t fontKey, const std::string& text);
+		int width(const std::string& text) { return width(activeFontKey(), text); }
+		int height(const std::string& text) { return height(activeFontKey(), text); }
+
+		void clear();
+		const Stats& getStats() const { return stats; }
+		void resetStats();
+
+	private:
+		TextMeasureCache() = default;
+		TextMeasureCache(const TextMeasureCache&) = delete;
+		TextMeasureCache& operator=(const TextMeasureCache&) = delete;
+
+		struct Entry
+		{
+			std::uint64_t key;
+			std::uint64_t fontKey;
+			std::string text;
+			int w = -1;          // -1 表示尚未度量
+			int h = -1;
+			std::size_t bytes;
+		};
+
+		Entry& lookup(std::uint64_t fontKey, const std::string& text);
+		void shrinkTo(std::size_t limit);
+
+		std::size_t capacity = 2u << 20;
+		std::list<Entry> lru;                                          // 前端为最近使用
+		std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+		Stats stats;
+	};
+
+	inline int measureTextWidth(const std::string& text) { return TextMeasureCache::Get().width(text); }
+	inline int measureTextHeight(const std::string& text) { return TextMeasureCache::Get().height(text); }
+}
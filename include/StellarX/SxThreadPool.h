@@ -0,0 +1,107 @@
+﻿/*******************************************************************************
+ * @文件: SxThreadPool.h
+ * @摘要: 星垣(StellarX) 工作窃取线程池 —— 分块光栅化等批量并行任务
+ * @描述:
+ *     parallelFor(count, fn) 把 [0, count) 个任务按连续区段分给各线程的任务队列，
+ *     每个线程从自己队列的头部取任务；自己的做完后从其它线程队列的尾部“窃取”，
+ *     这样相邻任务（相邻屏幕块）尽量留在同一线程上，负载不均时又能自动摊平。
+ *     调用线程本身作为 0 号线程参与执行，parallelFor 返回时所有任务均已完成。
+ *
+ *     另有一条独立的后台线程（首次 post 时启动），按投递顺序逐个执行耗时的单个任务
+ *     （如图像解码，见 ImageCache::acquire），不占用 parallelFor 的工作线程。
+ *
+ * @线程:
+ *     threadCount 含调用线程；为 1 时不启动任何工作线程，任务在调用线程上顺序执行。
+ *     parallelFor 只能由同一个线程（UI 线程）调用，不可重入。
+ *     post 投递的任务在后台线程上运行，不得调用绘图接口或访问控件；结果应交回 UI 线程处理。
+ *
+ * @使用说明:
+ *     auto& pool = StellarX::ThreadPool::Get();
+ *     pool.parallelFor(tiles.size(), [&](std::size_t task, unsigned worker) { ... });
+ ******************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace StellarX
+{
+	class ThreadPool
+	{
+	public:
+		struct Stats
+		{
+			std::uint64_t batches = 0;   // parallelFor 调用次数
+			std::uint64_t tasks = 0;     // 执行的任务总数
+			std::uint64_t steals = 0;    // 从其它线程队列窃取的任务数
+			std::uint64_t posted = 0;    // post 投递的后台任务数
+		};
+
+		// 获取全局单例（首次调用时按硬件线程数创建，最多 8 个）
+		static ThreadPool& Get();
+
+		// 调整线程数（含调用线程）；0 表示按硬件线程数。不可在 parallelFor 执行期间调用
+		void setThreadCount(unsigned n);
+		unsigned threadCount() const { return (unsigned)queues.size(); }
+
+		// 执行 fn(task, worker)：task ∈ [0, count)，worker ∈ [0, threadCount)
+		void parallelFor(std::size_t count, const std::function<void(std::size_t, unsigned)>& fn);
+
+		// 投递到后台线程（先进先出，立即返回）
+		void post(std::function<void()> task);
+		// 阻塞直到已投递的后台任务全部执行完
+		void waitBackground();
+		// 尚未执行完的后台任务数（含正在执行的）
+		std::size_t backgroundPending();
+
+		const Stats& getStats() const { return stats; }
+		void resetStats() { stats = Stats{}; }
+
+	private:
+		ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		struct Queue
+		{
+			std::mutex lock;
+			std::deque<std::size_t> tasks;
+		};
+
+		void stopWorkers();
+		void workerMain(unsigned self, std::uint64_t seenBatch);
+		// 执行任务直到所有队列为空；返回本线程窃取的任务数
+		std::uint64_t drain(unsigned self);
+		bool popOwn(unsigned self, std::size_t& task);
+		bool steal(unsigned self, std::size_t& task);
+		void backgroundMain();
+
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+
+		std::mutex batchLock;
+		std::condition_variable batchReady;
+		std::condition_variable batchDone;
+		std::uint64_t batch = 0;                 // 批次号：工作线程据此判断是否有新任务
+		unsigned busy = 0;                       // 仍在执行本批次的工作线程数
+		bool quit = false;
+		const std::function<void(std::size_t, unsigned)>* job = nullptr;
+		std::uint64_t batchSteals = 0;
+
+		std::thread background;                  // 后台线程（首次 post 时启动，随进程结束）
+		std::mutex bgLock;
+		std::condition_variable bgReady;
+		std::condition_variable bgIdle;
+		std::deque<std::function<void()>> bgTasks;
+		bool bgRunning = false;                  // 后台线程正在执行一个任务
+
+		Stats stats;
+	};
+}
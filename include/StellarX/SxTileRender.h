@@ -0,0 +1,45 @@
+﻿/*******************************************************************************
+ * @文件: SxTileRender.h
+ * @摘要: 星垣(StellarX) 分块并行的整屏重绘（软件后端）
+ * @描述:
+ *     Window::redrawScene 在尺寸变化、对话框开关、setBkImage 时整屏重画：背景 + 所有控件，
+ *     单线程执行，耗时随窗口面积 × 控件数增长，4K 最大化时尤其明显。
+ *     开启后，合成器模式下的整屏重绘改为一个“分块帧”：
+ *       - UI 线程照常调用各控件的 draw()，后端只录制屏幕图元（连同绘图状态快照）；
+ *         控件树与场景状态只在 UI 线程读写，帧内工作线程不会触碰；
+ *       - 帧结束时后端按屏幕块对图元分箱，在工作窃取线程池（StellarX::ThreadPool）上
+ *         逐块并行光栅化到同一帧缓冲，随后由 Window 照常一次提交(present)。
+ *     帧内需要读屏幕像素的逻辑（显示列表的像素校验）延后到光栅化完成后执行（afterFrame）。
+ *
+ * @限制:
+ *     只有无头软件后端支持；EasyX 后端下 beginFrame 总是返回 false，一切照旧。
+ *     抓屏快照模式下每个控件绘制前都要 getimage 抓取背景，帧会被逐控件打断，因此只用于合成器模式。
+ *
+ * @使用说明:
+ *     StellarX::TileRender::setEnabled(true);             // 默认关闭
+ *     StellarX::TileRender::setTileSize(128);             // 块边长（像素）
+ *     StellarX::ThreadPool::Get().setThreadCount(4);      // 线程数（含 UI 线程）
+ ******************************************************************************/
+#pragma once
+
+#include <functional>
+
+namespace StellarX
+{
+	namespace TileRender
+	{
+		void setEnabled(bool on);
+		bool enabled();
+		void setTileSize(int px);
+		int tileSize();
+
+		// 开启且后端支持时开始一个分块帧并返回 true；帧不可嵌套
+		bool beginFrame();
+		// 并行光栅化本帧录制的图元，再依次执行 afterFrame 登记的回调
+		void endFrame();
+		// 当前是否处于分块帧中（屏幕像素尚未画出，不可回读）
+		bool recording();
+		// 分块帧中登记到帧结束后执行；不在帧中时立即执行
+		void afterFrame(std::function<void()> fn);
+	}
+}
@@ -39,6 +39,10 @@ private:
 	// 初始化页签按钮位置和尺寸
 	inline void initTabBar();
 	inline void initTabPage();
+protected:
+	// 绘制顺序为全部页签、再全部页面；相邻页签与页面的边框会压住一像素，按此顺序检查
+	bool hasBodyChildren() const override { return !controls.empty(); }
+	bool sharesBody(const Control* child, int x, int y, int w, int h) const override;
 public:
 	TabControl();
 	TabControl(int x, int y, int width, int height);
@@ -70,10 +74,11 @@ public:
 	int count() const;
 	//通过页签文本返回索引
 	int indexOf(const std::string& tabText) const;
-	//设置脏区并请求重绘
-	void setDirty(bool dirty) override;
 	//请求父控件重绘
 	void requestRepaint(Control* parent)override;          // 托管模式下登记为 root；非托管模式下局部更新脏按钮/脏页面
 	bool canCommitManagedPartialRepaint() const override;  // 判断当前 TabControl 是否可安全做局部提交
 	void commitManagedRepaint() override;                  // 托管收口阶段执行 TabControl 的真正重绘
+	bool isPresentationCurrent() override { return false; } // 页签与页面不在画布的显示列表里，不承诺可跳过
+	void collectDamageRects(std::vector<RECT>& out) const override; // 合成器模式：只登记脏页签/脏页面
+	std::size_t snapshotBytes() const override;            // 本体 + 页签 + 全部页面的快照字节数
 };
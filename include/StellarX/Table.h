@@ -35,6 +35,7 @@
 #define TABLE_FOOTER_PAD            16   // 页脚额外高度（底部留白）
 #define TABLE_FOOTER_BLANK           8   // 页脚顶部留白
 #define TABLE_PAGE_TEXT_OFFSET_X   (-40) // 页码文本的临时水平修正
+#define TABLE_BATCH_PIXELS     (1 << 18) // 合批时一组行的像素上限（底色、网格、文本按组下发，组内像素仍在缓存中）
 
 // === Table defaults (theme) ===
 #define TABLE_DEFAULT_ROWS_PER_PAGE  5
@@ -60,6 +61,9 @@ private:
 
 	std::vector<int> colWidths;                // 每列的宽度
 	std::vector<int> lineHeights;			   // 每行的高度
+	std::vector<int> minColWidths;             // 按文本算出的列宽（含内边距），列宽小于它时文本会越出单元格
+	std::vector<int> colX;                     // 各列左边相对内容区左边的偏移，末项为内容总宽（列宽变化时重算）
+	bool cellsFitText = true;                  // 文本都落在各自单元格内：可整页铺底色或网格线后统一出文本
 
 	int rowsPerPage = TABLE_DEFAULT_ROWS_PER_PAGE;  // 每页显示的行数
 	int currentPage = 1;                        // 当前页码
@@ -74,9 +78,6 @@ private:
 	std::unique_ptr<Button> nextButton;	    // 下一页按钮
 	std::unique_ptr<Label> pageNum;            //页码文本
 
-	int dX = x, dY = y;							// 单元格的开始坐标
-	int uX = x, uY = y;							// 单元格的结束坐标
-
 	int pX = 0;                                 //标签左上角坐标
 	int pY = 0;                                 //标签左上角坐标
 
@@ -89,8 +90,11 @@ private:
 	void initButton();   //初始化翻页按钮
 	void initPageNum();  //初始化页码标签
 
-	void drawTable();    //绘制当前页
-	void drawHeader();   //绘制表头
+	void layoutColumns(); //由列宽计算各列偏移
+	bool canBatchPage() const; //表头与当前页能否合批（按行组记录：底色带 → 网格 → 文本）
+	void drawRows(const std::vector<const std::vector<std::string>*>& rows, int top, int rowH, bool batched); //绘制（合批时记录）若干等高的行
+	void drawTable(bool batched);  //绘制当前页
+	void drawHeader(bool batched); //绘制表头
 	void drawPageNum();  //绘制页码信息
 	void drawButton();   //绘制翻页按钮
 private:
@@ -138,6 +142,8 @@ public:
 	void resetTable();
 	//窗口变化丢快照+标脏
 	void onWindowResize() override;
+	//快照字节数含翻页按钮与页码
+	std::size_t snapshotBytes() const override;
 
 	//************************** 获取属性 *****************************/
 
@@ -34,6 +34,10 @@ public:
 	TextBox(int x, int y, int width, int height, std::string text = "", StellarX::TextBoxmode mode = StellarX::TextBoxmode::INPUT_MODE, StellarX::ControlShape shape = StellarX::ControlShape::RECTANGLE);
 	void draw() override;
 	bool handleEvent(const ExMessage& msg) override;
+	//显示列表与屏幕像素均未变化时可跳过重绘
+	bool isPresentationCurrent() override;
+	//矩形文本框的填充盖满整个快照范围，不必抓背景
+	bool isOpaque() const override;
 	//设置模式
 	void setMode(StellarX::TextBoxmode mode);
 	//设置可输入最大字符长度
@@ -53,4 +57,6 @@ public:
 private:
 	//用来检查对话框是否模态,此控件不做实现
 	bool model() const override { return false; };
+	//记录本次绘制的显示列表（样式随之生效）
+	void recordDisplayList();
 };
@@ -12,6 +12,8 @@
  *  - WM_SIZING：只做“最小尺寸夹紧”，不回滚矩形、不做对齐；把其余交给系统。
  *  - WM_GETMINMAXINFO：按最小“客户区”换算到“窗口矩形”，提供系统层最小轨迹值。
  *  - runEventLoop：输入事件先分发给对话框/控件，控件只登记重绘请求；真正绘制在分发或 resize 收口时统一处理。
+ *  - 合成器（可选）：控件不再抓屏做背景快照，只登记损伤区；收口时在批量绘制缓冲上按损伤区裁剪，
+ *    依次重画窗口背景、相交的顶层控件与对话框，缓冲本身即保留的后台帧。
  */
  //fuck windows 
  //fuck win32
@@ -19,10 +21,13 @@
 #pragma once
 
 #include "Control.h"
+#include "SxRegion.h"
 #include <string>
 #include <vector>
 #include <memory>
-#include <windows.h>
+#include <unordered_map>
+
+namespace StellarX { class ImageAsset; }
 
 class Window
 {
@@ -35,7 +40,7 @@ class Window
 	int           pendingH;              // 待应用高
 	int           minClientW;            // 业务设定的最小客户区宽（用于 GETMINMAXINFO 与 SIZING 夹紧）
 	int           minClientH;            // 业务设定的最小客户区高
-	int           windowMode = NULL;     // EasyX 初始化模式（EX_SHOWCONSOLE/EX_TOPMOST/...）
+	int           windowMode = 0;        // EasyX 初始化模式（EX_SHOWCONSOLE/EX_TOPMOST/...）
 	bool          needResizeDirty = false; // 统一收口重绘标志（置位后在事件环末尾处理）
 	bool          isSizing = false;      // 是否处于拖拽阶段（ENTER/EXIT SIZEMOVE 切换）
 
@@ -49,8 +54,23 @@ class Window
 	bool          useComposited = true;  // 是否启用 WS_EX_COMPOSITED（部分机器可能增加一帧观感延迟）
 	std::string   headline;              // 窗口标题文本
 	COLORREF      wBkcolor = BLACK;      // 纯色背景（无背景图时使用）
-	std::unique_ptr<IMAGE> background;  // 背景图对象指针（存在时优先绘制）
+	std::shared_ptr<IMAGE> background;  // 当前尺寸的背景图（存在时优先绘制；与 ImageCache 共享）
 	std::string   bkImageFile;           // 背景图文件路径（loadimage 用）
+	std::shared_ptr<StellarX::ImageAsset> bkAsset; // 背景图的共享资产（后台解码期间以 wBkcolor 占位）
+	std::uint64_t bkAssetWaiter = 0;     // bkAsset 就绪回调的令牌
+	bool          bkImageArrived = false; // 背景图解码完成：事件循环据此整场景重绘一次
+
+	// —— 合成器 ——（启用后快照只记录范围；声明在控件容器之前，保证控件析构时仍可访问）
+	bool          useCompositor = false; // 是否启用损伤区合成（默认关闭，保持快照回贴路径）
+	bool          compositing = false;   // 正在合成：期间新登记的损伤区在同一次收口内追加处理
+	const StellarX::Region* composeClipRegion = nullptr; // composeRegion 期间的裁剪区域（本块损伤区）
+	StellarX::Region damageRegion;       // 待重合成的损伤区（精确并集，不再退化为外接矩形）
+	std::vector<Control*> composeExtraRoots; // 未注册在窗口中的重绘 root（如模态对话框），合成时最后补画
+	POINT         progressiveFocus{ -1, -1 }; // 渐进重绘登记时的光标位置（后续并入的区域按它排序）
+
+	// —— 整场景标脏 ——（顶层控件的 isDirty 与之比较；声明在控件容器之前，控件析构时仍有效）
+	Control::DirtyStamp sceneControls;   // 普通控件的整场景代号
+	Control::DirtyStamp sceneDialogs;    // 对话框的整场景代号
 
 	// —— 控件/对话框 ——（容器内的普通控件与非模态对话框）
 	std::vector<std::unique_ptr<Control>> controls; // 普通顶层控件；绘制顺序也决定层级顺序
@@ -60,9 +80,10 @@ class Window
 	struct ManagedRepaintItem  // 托管重绘项：记录由哪个控件发起、需要重绘的根控件和覆盖范围（用于后续判断哪些对话框需要补画）
 	{
 		Control* root = nullptr;      // 顶层重绘根（直接挂在 Window 下的控件，或 Dialog 自身）
-		RECT     coverage{};          // 本轮脏区覆盖范围；用于判断哪些上层 Dialog 需要补画
+		StellarX::Region coverage;    // 本轮脏区覆盖范围（区域并集）；用于判断哪些上层 Dialog 需要补画
 	};
 	std::vector<ManagedRepaintItem> managedRepaintItems; // 本轮事件分发累计的重绘项
+	std::unordered_map<Control*, size_t> managedRepaintIndex; // root -> managedRepaintItems 下标
 
 public:
 	bool dialogClose = false;            // 项目内使用的状态位,对话框关闭标志
@@ -113,15 +134,41 @@ public:
 	void requestManagedRepaint(Control* source);  
 	// 在事件收口阶段提交本轮登记的 root 重绘
 	void flushManagedRepaint();                   
+	// 模态 Dialog 每轮调用：与事件循环共用 pumpAsyncWork，再提交托管重绘、推进渐进重绘一帧。
+	// progressiveFrames 为本轮开始时 RedrawScheduler 的帧数；返回是否画过（模态据此把自己补画到最上层）
+	bool pumpPendingWork(std::uint64_t progressiveFrames);
+
+	// —— 合成器 ——（按损伤区重合成，取代逐控件的抓屏快照）
+
+	// 启用/关闭合成器；切换时作废所有快照并整场景重绘一次
+	void setCompositorEnabled(bool on);
+	bool isCompositorEnabled() const;
+	// 登记一块需要重合成的区域（客户区坐标，右/下为开区间）；未启用合成器时忽略
+	void invalidateRect(const RECT& rc);
+	// 正在按损伤区重画时返回该区域（绘制被裁剪到其中），否则为 nullptr；半透明控件据此只合成这一块
+	const StellarX::Region* composeClip() const { return composeClipRegion; }
 private:
 	void adaptiveLayout(std::unique_ptr<Control>& c, const int finalH, const int finalW);
 	// resize / 初次绘制 / 对话框开关这类全局场景的整场景重绘
 	void redrawScene(bool forceControlsDirty, bool forceDialogsDirty);
+	// 整场景重绘，自行开始并结束批量绘制（调用方不要 BeginBatchDraw）：开启渐进重绘且启用合成器时
+	// 只登记工作项并画第一帧，其余帧由事件循环逐帧完成（见 SxRedrawScheduler.h）
+	void redrawSceneProgressive();
+	// 渐进重绘的一帧：在帧预算内合成若干工作项，只提交画过的范围
+	void runProgressiveFrame();
+	// 消息分发之外的异步待办（事件循环与模态循环共用）：后台解码落地、到期定时器、
+	// 背景图就绪后的整场景重绘。返回是否做过整场景重绘
+	bool pumpAsyncWork();
 	void drawWindowBackground();
+	// 放弃当前背景资产（撤销就绪回调）
+	void releaseBkAsset();
 	// 合成 WM_MOUSEMOVE，用于同步底层 hover 状态
 	void dispatchSyntheticMouseMoveToControls(short x, short y); 
 	// 清空本轮托管重绘登记
 	void clearManagedRepaintState();                                  
-	// 找出需要补画到最上层的对话框
-	void collectManagedDialogOverlays(Control* repaintRoot, const RECT& coverage, std::vector<Control*>& overlays); 
+	// 找出需要补画到最上层的对话框（overlayMask 与 dialogs 下标一一对应）
+	void collectManagedDialogOverlays(Control* repaintRoot, const StellarX::Region& coverage, std::vector<char>& overlayMask); 
+	// 合成器：处理全部损伤区（返回实际重画的范围）/ 在一块损伤区域内重画背景与相交控件
+	StellarX::Region composeDamage();
+	void composeRegion(const StellarX::Region& damage);
 };
@@ -1,6 +1,11 @@
 ﻿#include "Button.h"
 #include "SxLog.h"
+#include "SxRenderState.h"
+#include "SxTextMetrics.h"
+#include "SxTextFit.h"
+#include "SxEventLoop.h"
 #include "Window.h"
+#include <algorithm>
 
 Button::Button(int x, int y, int width, int height, const std::string text, StellarX::ButtonMode mode, StellarX::ControlShape shape)
 	: Control(x, y, width, height)
@@ -19,19 +24,7 @@ Button::Button(int x, int y, int width, int height, const std::string text, COLO
 {
 	initButton(text, mode, shape, ct, cf, ch);
 }
-// ====== GBK/MBCS 安全：字符边界与省略号裁切 ======
-static inline int gbk_char_len(const std::string& s, size_t i)
-{
-	unsigned char b = (unsigned char)s[i];
-	if (b <= 0x7F) return 1; // ASCII
-	if (b >= 0x81 && b <= 0xFE && i + 1 < s.size())
-	{
-		unsigned char b2 = (unsigned char)s[i + 1];
-		if (b2 >= 0x40 && b2 <= 0xFE && b2 != 0x7F) return 2; // 合法双字节
-	}
-	return 1; // 容错
-}
-
+// ====== GBK/MBCS 安全：字符边界与省略号裁切（字符边界见 SxTextFit.h 的 gbkCharLen） ======
 static inline void rtrim_spaces_gbk(std::string& s)
 {
 	while (!s.empty() && s.back() == ' ') s.pop_back();           // ASCII 空格
@@ -59,28 +52,22 @@ static inline bool is_word_boundary_char(unsigned char c)
 static std::string ellipsize_ascii_pref(const std::string& text, int maxW)
 {
 	if (maxW <= 0) return "";
-	if (textwidth(LPCTSTR(text.c_str())) <= maxW) return text;
+	auto& metrics = StellarX::TextMeasureCache::Get();
+	const std::uint64_t font = metrics.activeFontKey();
+	if (metrics.width(font, text) <= maxW) return text;
 
 	const std::string ell = "...";
-	int ellW = textwidth(LPCTSTR(ell.c_str()));
+	int ellW = metrics.width(font, ell);
 	if (ellW > maxW)
 	{ // 连 ... 都放不下
 		std::string e = ell;
-		while (!e.empty() && textwidth(LPCTSTR(e.c_str())) > maxW) e.pop_back();
+		while (!e.empty() && metrics.width(font, e) > maxW) e.pop_back();
 		return e; // 可能是 ".."、"." 或 ""
 	}
 	const int limit = maxW - ellW;
 
-	// 先找到能放下的最长前缀
-	size_t i = 0, lastFit = 0;
-	while (i < text.size())
-	{
-		int clen = gbk_char_len(text, i);
-		size_t j = text.size() < i + (size_t)clen ? text.size() : i + (size_t)clen;
-		int w = textwidth(LPCTSTR(text.substr(0, j).c_str()));
-		if (w <= limit) { lastFit = j; i = j; }
-		else break;
-	}
+	// 先找到能放下的最长前缀（在字符边界上二分）
+	const size_t lastFit = StellarX::fitTextPrefix(text, StellarX::textCharEnds(text), limit, font);
 	if (lastFit == 0) return ell;
 
 	// 在已适配前缀范围内，向左找最近的词边界
@@ -101,27 +88,21 @@ static std::string ellipsize_ascii_pref(const std::string& text, int maxW)
 static std::string ellipsize_cjk_pref(const std::string& text, int maxW, const char* ellipsis = "…")
 {
 	if (maxW <= 0) return "";
-	if (textwidth(LPCTSTR(text.c_str())) <= maxW) return text;
+	auto& metrics = StellarX::TextMeasureCache::Get();
+	const std::uint64_t font = metrics.activeFontKey();
+	if (metrics.width(font, text) <= maxW) return text;
 
 	std::string ell = ellipsis ? ellipsis : "…";
-	int ellW = textwidth(LPCTSTR(ell.c_str()));
+	int ellW = metrics.width(font, ell);
 	if (ellW > maxW)
 	{ // 连省略号都放不下
 		std::string e = ell;
-		while (!e.empty() && textwidth(LPCTSTR(e.c_str())) > maxW) e.pop_back();
+		while (!e.empty() && metrics.width(font, e) > maxW) e.pop_back();
 		return e;
 	}
 	const int limit = maxW - ellW;
 
-	size_t i = 0, lastFit = 0;
-	while (i < text.size())
-	{
-		int clen = gbk_char_len(text, i);
-		size_t j = text.size() < i + (size_t)clen ? text.size() : i + (size_t)clen;
-		int w = textwidth(LPCTSTR(text.substr(0, j).c_str()));
-		if (w <= limit) { lastFit = j; i = j; }
-		else break;
-	}
+	const size_t lastFit = StellarX::fitTextPrefix(text, StellarX::textCharEnds(text), limit, font);
 	if (lastFit == 0) return ell;
 
 	std::string head = text.substr(0, lastFit);
@@ -165,38 +146,83 @@ void Button::initButton(const std::string text, StellarX::ButtonMode mode, Stell
 	tipLabel.textStyle = this->textStyle;  // 复用按钮字体样式
 }
 
-Button::~Button() = default;
+Button::~Button()
+{
+	// 共享的填充图像可能比按钮活得久：撤销就绪回调
+	if (buttonFileIMAGE && fillImageWaiter)
+		buttonFileIMAGE->cancel(fillImageWaiter);
+	if (tipTimer)
+		StellarX::EventLoop::cancelTimer(tipTimer);
+}
 
 void Button::draw()
 {
-	if (!dirty || !show)return;
+	if (!isDirty() || !show)return;
 
 	//保存当前样式和颜色
 	saveStyle();
+	recordDisplayList();
+
+	// 画出来的内容与屏幕都没变（如禁用按钮的悬停切换）：不必回贴与重放
+	if (!displayListCurrent())
+	{
+		// 快照含右下边框，尺寸要与抓取时一致地比较，否则每次都会把按钮自己上次画的样子当背景重抓
+		if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width + bordWith) || (saveHeight != this->height + bordHeight) || !hasValidBackgroundSnapshot())
+			saveBackground(this->x, this->y, (this->width + bordWith), (this->height + bordHeight));
+		// 恢复背景（清除旧内容）
+		restBackground();
+		if (!beginTranslucent(displayList.hash()))
+		{
+			displayList.replay();
+			endTranslucent();
+		}
+		markDisplayListPresented();
+	}
+
+	restoreStyle();//恢复默认字体样式和颜色
+	dirty = false;     //标记按钮不需要重绘
+
+	if (tipEnabled && tipVisible)
+		tipLabel.draw();
+}
+
+bool Button::isPresentationCurrent()
+{
+	// 提示框不在显示列表里，可见时总要重画
+	if (!show || (tipEnabled && tipVisible))
+		return false;
+	saveStyle();
+	recordDisplayList();
+	const bool current = displayListCurrent();
+	restoreStyle();
+	return current;
+}
 
+// 把按钮本次要画的内容记录到显示列表：样式随记录立即生效（文本度量依赖当前字体）
+void Button::recordDisplayList()
+{
+	displayList.clear();
 	if (StellarX::ButtonMode::DISABLED == mode)   //设置禁用按钮色
 	{
-		setfillcolor(DISABLEDCOLOUR);
+		displayList.setFillColor(DISABLEDCOLOUR);
 		textStyle.bStrikeOut = true;
 	}
 	else
 	{
 		// 点击状态优先级最高，然后是悬停状态，最后是默认状态
 		COLORREF col = click ? buttonTrueColor : (hover ? buttonHoverColor : buttonFalseColor);
-		setfillcolor(col);
+		displayList.setFillColor(col);
 	}
 	//
 	//设置字体背景色透明
-	setbkmode(TRANSPARENT);
+	displayList.setBkMode(TRANSPARENT);
 	//边框颜色
-	setlinecolor(buttonBorderColor);
+	displayList.setLineColor(buttonBorderColor);
 
 	//设置字体颜色
-	settextcolor(textStyle.color);
+	displayList.setTextColor(textStyle.color);
 	//设置字体样式
-	settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-		textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-		textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
+	displayList.setTextStyle(textStyle);
 
 	if (needCutText)
 		cutButtonText();
@@ -207,72 +233,59 @@ void Button::draw()
 	{
 		if (isUseCutText)
 		{
-			this->oldtext_width = this->text_width = textwidth(LPCTSTR(this->cutText.c_str()));
-			this->oldtext_height = this->text_height = textheight(LPCTSTR(this->cutText.c_str()));
+			this->oldtext_width = this->text_width = StellarX::measureTextWidth(this->cutText);
+			this->oldtext_height = this->text_height = StellarX::measureTextHeight(this->cutText);
 		}
 		else
 		{
-			this->oldtext_width = this->text_width = textwidth(LPCTSTR(this->text.c_str()));
-			this->oldtext_height = this->text_height = textheight(LPCTSTR(this->text.c_str()));
+			this->oldtext_width = this->text_width = StellarX::measureTextWidth(this->text);
+			this->oldtext_height = this->text_height = StellarX::measureTextHeight(this->text);
 		}
 	}
 
 	//设置按钮填充模式
-	setfillstyle((int)buttonFillMode, (int)buttonFillIma, buttonFileIMAGE.get());
-	if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width) || (saveHeight != this->height) || !saveBkImage)
-		saveBackground(this->x, this->y, (this->width + bordWith), (this->height + bordHeight));
-	// 恢复背景（清除旧内容）
-	restBackground();
+	// 填充图像尚未解码完成（或解码失败）时，以当前状态色纯色占位
+	IMAGE* fillImage = buttonFileIMAGE ? buttonFileIMAGE->image().get() : nullptr;
+	const bool imageFill = buttonFillMode == StellarX::FillMode::Pattern || buttonFillMode == StellarX::FillMode::DibPattern;
+	const int fillMode = (imageFill && buttonFileIMAGE && !fillImage) ? BS_SOLID : (int)buttonFillMode;
+	displayList.setFillStyle(fillMode, (int)buttonFillIma, fillImage);
+	const std::string& label = isUseCutText ? cutText : text;
 	//根据按钮形状绘制
 	switch (shape)
 	{
 	case StellarX::ControlShape::RECTANGLE://有边框填充矩形
-		fillrectangle(x, y, x + width, y + height);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.fillRect(x, y, x + width, y + height);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	case StellarX::ControlShape::B_RECTANGLE://无边框填充矩形
-		solidrectangle(x, y, x + width, y + height);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.solidRect(x, y, x + width, y + height);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	case StellarX::ControlShape::ROUND_RECTANGLE://有边框填充圆角矩形
-		fillroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.fillRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	case StellarX::ControlShape::B_ROUND_RECTANGLE://无边框填充圆角矩形
-		solidroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.solidRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	case StellarX::ControlShape::CIRCLE://有边框填充圆形
-		fillcircle(x + width / 2, y + height / 2, min(width, height) / 2);
-		isUseCutText ? outtextxy(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, LPCTSTR(cutText.c_str()))
-			: outtextxy(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, LPCTSTR(text.c_str()));
+		displayList.fillCircle(x + width / 2, y + height / 2, min(width, height) / 2);
+		displayList.text(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, label);
 		break;
 	case StellarX::ControlShape::B_CIRCLE://无边框填充圆形
-		solidcircle(x + width / 2, y + height / 2, min(width, height) / 2);
-		isUseCutText ? outtextxy(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, LPCTSTR(cutText.c_str()))
-			: outtextxy(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, LPCTSTR(text.c_str()));
+		displayList.solidCircle(x + width / 2, y + height / 2, min(width, height) / 2);
+		displayList.text(x + width / 2 - text_width / 2, y + height / 2 - text_height / 2, label);
 		break;
 	case StellarX::ControlShape::ELLIPSE://有边框填充椭圆
-		fillellipse(x, y, x + width, y + height);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.fillEllipse(x, y, x + width, y + height);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	case StellarX::ControlShape::B_ELLIPSE://无边框填充椭圆
-		solidellipse(x, y, x + width, y + height);
-		isUseCutText ? outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(cutText.c_str()))
-			: outtextxy((x + (width - text_width) / 2), (y + (height - text_height) / 2), LPCTSTR(text.c_str()));
+		displayList.solidEllipse(x, y, x + width, y + height);
+		displayList.text((x + (width - text_width) / 2), (y + (height - text_height) / 2), label);
 		break;
 	}
-
-	restoreStyle();//恢复默认字体样式和颜色
-	dirty = false;     //标记按钮不需要重绘
-
-	if (tipEnabled && tipVisible)
-		tipLabel.draw();
 }
 // 处理鼠标事件，检测点击和悬停状态
 // 根据按钮模式和形状进行不同的处理
@@ -392,33 +405,7 @@ bool Button::handleEvent(const ExMessage& msg)
 			hideTooltip();
 		}
 		if (hover && !tipVisible)
-		{
-			// 到点就显示
-			if (GetTickCount64() - tipHoverTick >= (ULONGLONG)tipDelayMs)
-			{
-				tipVisible = true;
-
-				// 定位（跟随鼠标 or 相对按钮）
-				int tipX = tipFollowCursor ? (lastMouseX + tipOffsetX) : lastMouseX;
-				int tipY = tipFollowCursor ? (lastMouseY + tipOffsetY) : y + height;
-				// 设置文本（用户可能动态改了提示文本
-				if (tipUserOverride)
-				{
-					if (mode == StellarX::ButtonMode::NORMAL)
-						tipLabel.setText(tipTextClick);
-					else if (mode == StellarX::ButtonMode::TOGGLE)
-						tipLabel.setText(click ? tipTextOn : tipTextOff);
-				}
-				else
-					if (mode == StellarX::ButtonMode::TOGGLE)
-						tipLabel.setText(click ? tipTextOn : tipTextOff);
-				// 设置位置
-				tipLabel.setX(tipX);
-				tipLabel.setY(tipY);
-				// 标记需要绘制
-				tipLabel.setDirty(true);
-			}
-		}
+			showTooltipIfDue();
 	}
 
 	// 如果状态发生变化，标记需要重绘
@@ -507,10 +494,19 @@ void Button::setFillIma(std::string imaNAme)
 {
 	if (buttonFileIMAGE)
 	{
+		buttonFileIMAGE->cancel(fillImageWaiter);
 		buttonFileIMAGE.reset();
 	}
-	buttonFileIMAGE = std::make_unique<IMAGE>();
-	loadimage(buttonFileIMAGE.get(), imaNAme.c_str(), width, height);
+	fillImageWaiter = 0;
+	// 同一 (文件, 尺寸) 的按钮共享一份像素；首次使用时在后台解码，完成后回调重绘
+	buttonFileIMAGE = StellarX::ImageCache::Get().acquire(imaNAme, width, height);
+	if (buttonFileIMAGE->pending())
+		fillImageWaiter = buttonFileIMAGE->whenReady([this]
+			{
+				fillImageWaiter = 0;
+				this->dirty = true;
+				requestRepaint(parent);
+			});
 	this->dirty = true;
 }
 
@@ -529,8 +525,8 @@ void Button::setButtonFalseColor(COLORREF color)
 void Button::setButtonText(const char* text)
 {
 	this->text = std::string(text);
-	this->text_width = textwidth(LPCTSTR(this->text.c_str()));
-	this->text_height = textheight(LPCTSTR(this->text.c_str()));
+	this->text_width = StellarX::measureTextWidth(this->text);
+	this->text_height = StellarX::measureTextHeight(this->text);
 	this->dirty = true;
 	this->needCutText = true;
 	if (!tipUserOverride)
@@ -540,8 +536,8 @@ void Button::setButtonText(const char* text)
 void Button::setButtonText(std::string text)
 {
 	this->text = text;
-	this->text_width = textwidth(LPCTSTR(this->text.c_str()));
-	this->text_height = textheight(LPCTSTR(this->text.c_str()));
+	this->text_width = StellarX::measureTextWidth(this->text);
+	this->text_height = StellarX::measureTextHeight(this->text);
 	this->dirty = true; // 标记需要重绘
 	this->needCutText = true;
 	if (!tipUserOverride)
@@ -610,7 +606,7 @@ StellarX::FillStyle Button::getFillIma() const
 
 IMAGE* Button::getFillImaImage() const
 {
-	return this->buttonFileIMAGE.get();
+	return this->buttonFileIMAGE ? this->buttonFileIMAGE->image().get() : nullptr;
 }
 
 COLORREF Button::getButtonBorder() const
@@ -658,7 +654,7 @@ void Button::cutButtonText()
 {
 	const int contentW = 1 > this->width - 2 * padX ? 1 : this->width - 2 * padX;
 	// 放得下：不截断，直接用原文
-	if (textwidth(LPCTSTR(this->text.c_str())) <= contentW) {
+	if (StellarX::measureTextWidth(this->text) <= contentW) {
 		isUseCutText = false;
 		needCutText = false;
 		cutText.clear();
@@ -678,12 +674,105 @@ void Button::cutButtonText()
 	needCutText = false;
 }
 
+RECT Button::getDamageRect() const
+{
+	RECT rc = Control::getDamageRect();
+	if (tipEnabled && tipVisible)
+	{
+		const RECT tip = tipLabel.getBoundsRect();
+		rc.left = (std::min)(rc.left, tip.left);
+		rc.top = (std::min)(rc.top, tip.top);
+		rc.right = (std::max)(rc.right, tip.right);
+		rc.bottom = (std::max)(rc.bottom, tip.bottom);
+	}
+	return rc;
+}
+
+void Button::addOpaqueRegion(StellarX::Region& out) const
+{
+	if (!show || translucent() || StellarX::FillMode::Solid != buttonFillMode)
+		return;
+	if (shape != StellarX::ControlShape::RECTANGLE && shape != StellarX::ControlShape::B_RECTANGLE)
+		return;
+	// 边框不计入，只取内部
+	if (width > 1 && height > 1)
+		out.unite(x + 1, y + 1, x + width, y + height);
+}
+
+std::size_t Button::snapshotBytes() const
+{
+	return Control::snapshotBytes() + tipLabel.snapshotBytes();
+}
+
+bool Button::isOpaque() const
+{
+	// 快照为 [x, x+width] × [y, y+height]（含右下边框），实心矩形填充恰好整块盖满
+	return !translucent() && StellarX::FillMode::Solid == buttonFillMode
+		&& (shape == StellarX::ControlShape::RECTANGLE || shape == StellarX::ControlShape::B_RECTANGLE);
+}
+
+void Button::showTooltipIfDue()
+{
+	// 未到点：登记定时器，鼠标静止时由事件循环到点回调，不必等下一条鼠标消息
+	if (GetTickCount64() - tipHoverTick < (ULONGLONG)tipDelayMs)
+	{
+		if (!tipTimer)
+			tipTimer = StellarX::EventLoop::addTimer(tipHoverTick + (ULONGLONG)tipDelayMs, [this]
+				{
+					tipTimer = 0;
+					if (!tipEnabled || !hover || tipVisible || !show)
+						return;
+					showTooltipIfDue();
+					if (tipVisible)
+					{
+						this->dirty = true;
+						requestRepaint(parent);
+					}
+				});
+		return;
+	}
+
+	tipVisible = true;
+
+	// 定位（跟随鼠标 or 相对按钮）
+	int tipX = tipFollowCursor ? (lastMouseX + tipOffsetX) : lastMouseX;
+	int tipY = tipFollowCursor ? (lastMouseY + tipOffsetY) : y + height;
+	// 设置文本（用户可能动态改了提示文本
+	if (tipUserOverride)
+	{
+		if (mode == StellarX::ButtonMode::NORMAL)
+			tipLabel.setText(tipTextClick);
+		else if (mode == StellarX::ButtonMode::TOGGLE)
+			tipLabel.setText(click ? tipTextOn : tipTextOff);
+	}
+	else
+		if (mode == StellarX::ButtonMode::TOGGLE)
+			tipLabel.setText(click ? tipTextOn : tipTextOff);
+	// 设置位置
+	tipLabel.setX(tipX);
+	tipLabel.setY(tipY);
+	// 标记需要绘制
+	tipLabel.setDirty(true);
+}
+
 void Button::hideTooltip()
 {
+	if (tipTimer)
+	{
+		StellarX::EventLoop::cancelTimer(tipTimer);
+		tipTimer = 0;
+	}
 	if (tipVisible)
 	{
 		tipVisible = false;
-		if (auto* host = getHostWindow(); host && host->isManagedDispatchActive())
+		Window* host = getHostWindow();
+		if (host && host->isCompositorEnabled())
+		{
+			// 提示框不在控件树中：由按钮把它占据的范围登记为损伤区
+			host->invalidateRect(tipLabel.getBoundsRect());
+			tipLabel.invalidateBackgroundSnapshot();
+		}
+		else if (host && host->isManagedDispatchActive())
 			tipLabel.invalidateBackgroundSnapshot();
 		else
 			tipLabel.hide(); // 还原快照+作废，防止残影
@@ -1,6 +1,12 @@
 ﻿#include "Canvas.h"
 #include "SxLog.h"
 #include "Window.h"
+#include "SxOcclusion.h"
+#include "SxHash.h"
+#include "SxLayerCache.h"
+#include "SxRenderState.h"
+#include "SxSurfacePool.h"
+#include <algorithm>
 
 static bool SxIsNoisyMsg(UINT m)
 {
@@ -61,7 +67,7 @@ void Canvas::clearAllControls()
 
 void Canvas::draw()
 {
-	if (!dirty || !show)
+	if (!isDirty() || !show)
 	{
 		for (auto& control : controls)
 			if (auto c = dynamic_cast<Table*>(control.get()))
@@ -69,11 +75,7 @@ void Canvas::draw()
 		return;
 	}
 	saveStyle();
-	setlinecolor(canvasBorderClor);//设置线色
-	if (StellarX::FillMode::Null != canvasFillMode)
-		setfillcolor(canvasBkClor);//设置填充色
-	setfillstyle((int)canvasFillMode);//设置填充模式
-	setlinestyle((int)canvasLineStyle, canvaslinewidth);
+	recordDisplayList();
 
 	// 在绘制画布之前，先恢复并更新背景快照：
 	// 1. 如果已有快照，则先回贴旧快照以清除之前的内容。
@@ -84,7 +86,7 @@ void Canvas::draw()
 		// 恢复旧快照，清除上一次绘制
 		restBackground();
 		// 如果位置或尺寸变了，或没有有效缓存，则重新抓取
-		if (!saveBkImage || saveBkX != this->x - margin || saveBkY != this->y - margin || saveWidth != this->width + margin * 2 || saveHeight != this->height + margin * 2)
+		if (!hasValidBackgroundSnapshot() || saveBkX != this->x - margin || saveBkY != this->y - margin || saveWidth != this->width + margin * 2 || saveHeight != this->height + margin * 2)
 		{
 			invalidateBackgroundSnapshot();
 			saveBackground(this->x - margin, this->y - margin, this->width + margin * 2, this->height + margin * 2);
@@ -97,31 +99,216 @@ void Canvas::draw()
 	}
 	// 再次恢复最新快照，确保绘制区域干净
 	restBackground();
+	// 半透明画布连同子控件整体合成；有子控件时内容无法用本体列表概括，不复用上次的合成结果
+	if (beginTranslucent(controls.empty() ? displayList.hash() : 0))
+	{
+		markDisplayListPresented();
+		restoreStyle();
+		dirty = false;
+		return;
+	}
 	//根据画布形状绘制
+	displayList.replay();
+	captureBody();
+	// 绘制所有子控件；合成器模式下被后面的实心子控件完全盖住的不画
+	std::vector<char> culled;
+	if (usesCompositor() && controls.size() > 1)
+	{
+		std::vector<Control*> layers;
+		layers.reserve(controls.size());
+		for (auto& control : controls)
+			layers.push_back(control.get());
+		StellarX::Occlusion::cull(layers, nullptr, culled);
+	}
+	markChildrenDirty();
+	// 合成器按块重画时与裁剪区不相交的子控件同样不画（画了也写不到屏幕上）
+	const Window* host = getHostWindow();
+	const StellarX::Region* clip = host ? host->composeClip() : nullptr;
+	for (size_t i = 0; i < controls.size(); ++i)
+	{
+		const RECT rc = clip ? controls[i]->getDamageRect() : RECT{};
+		if ((i < culled.size() && culled[i]) || (clip && !clip->intersects(rc.left, rc.top, rc.right, rc.bottom)))
+		{
+			controls[i]->setDirty(false);
+			continue;
+		}
+		controls[i]->draw();
+	}
+	endTranslucent();
+	// 画布的像素哈希包含子控件
+	markDisplayListPresented();
+
+	restoreStyle();
+	dirty = false;	 //标记画布不需要重绘
+}
+
+// 画布本体的显示列表：边框、填充与形状（样式随之生效）
+void Canvas::recordDisplayList()
+{
+	displayList.clear();
+	displayList.setLineColor(canvasBorderClor);//设置线色
+	if (StellarX::FillMode::Null != canvasFillMode)
+		displayList.setFillColor(canvasBkClor);//设置填充色
+	displayList.setFillStyle((int)canvasFillMode);//设置填充模式
+	displayList.setLineStyle((int)canvasLineStyle, canvaslinewidth);
 	switch (shape)
 	{
 	case StellarX::ControlShape::RECTANGLE:
-		fillrectangle(x, y, x + width, y + height);//有边框填充矩形
+		displayList.fillRect(x, y, x + width, y + height);//有边框填充矩形
 		break;
 	case StellarX::ControlShape::B_RECTANGLE:
-		solidrectangle(x, y, x + width, y + height);//无边框填充矩形
+		displayList.solidRect(x, y, x + width, y + height);//无边框填充矩形
 		break;
 	case StellarX::ControlShape::ROUND_RECTANGLE:
-		fillroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//有边框填充圆角矩形
+		displayList.fillRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//有边框填充圆角矩形
+		break;
+	case StellarX::ControlShape::B_ROUND_RECTANGLE:
+		displayList.solidRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//无边框填充圆角矩形
+		break;
+	}
+}
+
+// 画布的像素基线不含可见子控件所占的范围（见 hashPresentedPixels），子控件各自比较自己范围内的像素。
+// 画布本体不脏：本体像素仍是上次画完的样子，不读画布的像素，只确认脏的可见子控件（局部重画的常见情形）；
+// 画布本体脏：本体列表与像素都未变，且每个可见子控件也确认未变，整块画布才无需重画。
+bool Canvas::isPresentationCurrent()
+{
+	if (!show)
+		return false;
+	const bool whole = isDirty();
+	if (whole)
+	{
+		saveStyle();
+		recordDisplayList();
+		const bool current = displayListCurrent();
+		restoreStyle();
+		if (!current)
+			return false;
+	}
+	for (auto& control : controls)
+		if (control->IsVisible() && (whole || control->isDirty()) && !control->isPresentationCurrent())
+			return false;
+	return true;
+}
+
+// 只哈希本体露出的部分：快照范围减去各可见子控件的损伤范围，子控件的范围计入种子（布局变化即不同）。
+// 子控件局部重画只改写自己的范围，画布的基线因此保持有效，不必为此重读整块画布
+std::uint64_t Canvas::hashPresentedPixels() const
+{
+	std::uint64_t seed = presentedListHash;
+	StellarX::Region children;
+	for (auto& control : controls)
+		if (control->IsVisible())
+		{
+			const RECT rc = control->getDamageRect();
+			children.unite(rc.left, rc.top, rc.right, rc.bottom);
+			seed = StellarX::hashValue(rc, seed);
+		}
+	StellarX::Region exposed(saveBkX, saveBkY, saveBkX + saveWidth, saveBkY + saveHeight);
+	exposed.subtract(children);
+
+	auto& st = StellarX::DisplayList::stats();
+	++st.pixelHashes;
+	st.pixelsHashed += (std::uint64_t)exposed.area();
+	const auto& spans = exposed.getSpans();
+	for (const auto& band : exposed.getBands())
+		for (std::size_t i = band.first; i < band.first + band.count; ++i)
+			seed = StellarX::LayerCache::hashScreenRect(spans[i].left, band.top, spans[i].right - spans[i].left, band.bottom - band.top, seed);
+	return seed;
+}
+
+void Canvas::addOpaqueRegion(StellarX::Region& out) const
+{
+	if (!show || translucent() || StellarX::FillMode::Solid != canvasFillMode)
+		return;
+	// 边框可能是虚线或空笔，只计内部
+	const int l = x + 1, t = y + 1, r = x + width, b = y + height;
+	if (r <= l || b <= t)
+		return;
+	switch (shape)
+	{
+	case StellarX::ControlShape::RECTANGLE:
+	case StellarX::ControlShape::B_RECTANGLE:
+		out.unite(l, t, r, b);
 		break;
+	case StellarX::ControlShape::ROUND_RECTANGLE:
 	case StellarX::ControlShape::B_ROUND_RECTANGLE:
-		solidroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//无边框填充圆角矩形
+	{
+		// 四角是 1/4 椭圆，横竖两条臂一定被填满
+		const int rx = (rouRectangleSize.ROUND_RECTANGLEwidth + 1) / 2;
+		const int ry = (rouRectangleSize.ROUND_RECTANGLEheight + 1) / 2;
+		if (l + rx < r - rx)
+			out.unite(l + rx, t, r - rx, b);
+		if (t + ry < b - ry)
+			out.unite(l, t + ry, r, b - ry);
+		break;
+	}
+	default:
 		break;
 	}
-	// 绘制所有子控件
+}
+
+void Canvas::captureBody()
+{
+	body.clear();
+	if (usesCompositor() || !StellarX::SurfacePool::Get().compact() || !hasBodyChildren())
+		return;
+	// 本体范围 [x, x+width] × [y, y+height]（含右下边框），裁到屏幕内
+	SetWorkingImage(nullptr);
+	const int l = (std::max)(x, 0), t = (std::max)(y, 0);
+	const int r = (std::min)(x + width + 1, getwidth()), b = (std::min)(y + height + 1, getheight());
+	if (r <= l || b <= t)
+		return;
+	if (packScreenRect(body, l, t, r - l, b - t))
+	{
+		bodyX = l;
+		bodyY = t;
+	}
+}
+
+bool Canvas::bodyCovers(int x, int y, int w, int h) const
+{
+	return !body.empty() && x >= bodyX && y >= bodyY
+		&& x + w <= bodyX + body.width() && y + h <= bodyY + body.height();
+}
+
+bool Canvas::sharesBody(const Control* child, int x, int y, int w, int h) const
+{
+	if (!bodyCovers(x, y, w, h))
+		return false;
+	// 先画的兄弟与这块范围相交时，屏幕上的像素已不只是本体
 	for (auto& control : controls)
 	{
-		control->setDirty(true);
-		control->draw();
+		if (control.get() == child)
+			return true;
+		if (!control->IsVisible())
+			continue;
+		const RECT rc = control->getDamageRect();
+		if (rc.left < x + w && x < rc.right && rc.top < y + h && y < rc.bottom)
+			return false;
 	}
+	return false;
+}
 
-	restoreStyle();
-	dirty = false;	 //标记画布不需要重绘
+void Canvas::restoreBody(int x, int y, int w, int h) const
+{
+	if (bodyCovers(x, y, w, h))
+		putPacked(body, x, y, x - bodyX, y - bodyY, w, h);
+}
+
+std::size_t Canvas::snapshotBytes() const
+{
+	std::size_t bytes = Control::snapshotBytes() + body.bytes();
+	for (auto& control : controls)
+		bytes += control->snapshotBytes();
+	return bytes;
+}
+
+bool Canvas::isOpaque() const
+{
+	// 快照向外扩 margin 一圈；线宽为 1 时这一圈从不绘制，其余部分被实心矩形整块盖满
+	return !translucent() && StellarX::FillMode::Solid == canvasFillMode && canvaslinewidth <= 1
+		&& (shape == StellarX::ControlShape::RECTANGLE || shape == StellarX::ControlShape::B_RECTANGLE);
 }
 
 bool Canvas::handleEvent(const ExMessage& msg)
@@ -159,6 +346,9 @@ bool Canvas::handleEvent(const ExMessage& msg)
 
 	if (anyDirty)
 	{
+		// 半透明画布的像素是整体合成的结果，子控件不能单独重画：整块重画
+		if (translucent())
+			dirty = true;
 		// 只要任一子控件因本次事件进入 dirty，就把这笔重绘继续向上汇报。
 		// 在托管模式下，这不会立即绘制，而是登记为 Canvas 对应的重绘 root。
 		if (!SxIsNoisyMsg(msg.message))
@@ -252,14 +442,26 @@ void Canvas::setIsVisible(bool visible)
 		control->setIsVisible(visible);
 	}
 	if (!visible)
-		discardBackground();
+	{
+		eraseFromScreen();
+		body.clear();
+	}
 }
 
 void Canvas::setDirty(bool dirty)
 {
+	// 只记整树代号：子控件在 isDirty() 中与祖先的代号比较，不必逐个递归；各级缓存随之作废
 	this->dirty = dirty;
-	for (auto& control : controls)
-		control->setDirty(dirty);
+	subtree = dirty;
+	++subtreeEpoch;
+}
+
+void Canvas::markChildrenDirty()
+{
+	// 绘制途中不作废整棵树的缓存，只更新本层：子控件随即被画，
+	// 子容器画自己时再标记下一层；被剔除的子控件 setDirty(false) 连同子树清脏
+	subtree = true;
+	chain.merge(subtree);
 }
 
 void Canvas::onWindowResize()
@@ -451,12 +653,18 @@ void Canvas::requestRepaint(Control* parent)
 		// 关键护栏：
 		// - Canvas 自己是脏的 / 没有快照 / 缓存图为空
 		//   => 禁止局部重绘，直接升级为一次完整 draw（先把 dirty 置真，避免 draw() 早退）
-		if (dirty || !hasSnap || !saveBkImage)
+		// 整块标脏（如 setDirty 递归）但画出来的内容与屏幕都没变：只清脏标记
+		if (isDirty() && isPresentationCurrent())
+		{
+			setDirty(false);
+			return;
+		}
+		if (isDirty() || !hasValidBackgroundSnapshot() || translucent())
 		{
 			SX_LOG_TRACE("Dirty")
 				<< SX_T("Canvas 局部重绘降级为全量重绘: id=", "Canvas partial->full draw: id=")
 				<< id
-				<< " dirty=" << (dirty ? 1 : 0)
+				<< " dirty=" << (isDirty() ? 1 : 0)
 				<< " hasSnap=" << (hasSnap ? 1 : 0);
 
 			this->dirty = true;
@@ -466,6 +674,8 @@ void Canvas::requestRepaint(Control* parent)
 
 		SX_LOG_TRACE("Dirty") << SX_T("Canvas 请求局部重绘：id=", "Canvas::requestRepaint(partial): id=") << id;
 
+		// 子控件只改写自己的范围，不在画布的像素基线里：画布的基线照旧有效，不读画布的像素
+		StellarX::RenderState::DrawPass pass;
 		for (auto& control : controls)
 			if (control->isDirty() && control->IsVisible())
 				control->draw();
@@ -477,11 +687,24 @@ void Canvas::requestRepaint(Control* parent)
 	onRequestRepaintAsRoot();
 }
 
+void Canvas::collectDamageRects(std::vector<RECT>& out) const
+{
+	// 画布本体脏或尚未绘制过：整块重合成；否则只有脏的可见子控件需要重合成
+	if (isDirty() || !hasSnap || translucent())
+	{
+		Control::collectDamageRects(out);
+		return;
+	}
+	for (auto& control : controls)
+		if (control->IsVisible() && control->isDirty())
+			control->collectDamageRects(out);
+}
+
 bool Canvas::canCommitManagedPartialRepaint() const
 {
 	// Canvas 只有在“自己本体不脏 + 仍持有有效背景快照”时，
 	// 才能安全地做局部提交（即只更新内部脏子控件）。
-	return show && !dirty && hasValidBackgroundSnapshot();
+	return show && !isDirty() && hasValidBackgroundSnapshot() && !translucent();
 }
 
 void Canvas::commitManagedRepaint()
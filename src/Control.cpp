@@ -2,6 +2,32 @@
 #include "SxLog.h"
 #include<assert.h>
 #include "Window.h"
+#include "SxSurfacePool.h"
+#include "SxLayerCache.h"
+#include "SxPixelKernels.h"
+#include "SxRenderState.h"
+#include "SxTileRender.h"
+#include <algorithm>
+
+namespace
+{
+	// 不小于 64×64 的快照才尝试压缩：小快照解码开销不划算
+	constexpr int kPackMinPixels = 64 * 64;
+
+	// 压缩快照回贴时的中转表面；有意不析构（可能晚于绘图后端关闭）
+	IMAGE& packScratch()
+	{
+		static IMAGE* img = new IMAGE(1, 1);
+		return *img;
+	}
+
+	// 半透明控件读回绘制结果的中转表面，所有控件共用；同样有意不析构
+	IMAGE& translucentScratch()
+	{
+		static IMAGE* img = new IMAGE(1, 1);
+		return *img;
+	}
+}
 
 StellarX::ControlText& StellarX::ControlText::operator=(const ControlText& text)
 {
@@ -44,6 +70,43 @@ bool StellarX::ControlText::operator!=(const ControlText& text)
 		return true;
 	return false;
 }
+std::uint64_t Control::dirtyGeneration = 0;
+std::uint64_t Control::subtreeEpoch = 1;
+
+const Control::DirtyStamp& Control::subtreeChain() const
+{
+	if (chainEpoch != subtreeEpoch)
+	{
+		// 父控件的缓存先就绪（至多沿祖先链重算一次），本控件只并一层
+		chain = subtree;
+		if (parent)
+			chain.merge(parent->subtreeChain());
+		else if (sceneStamp)
+			chain.merge(*sceneStamp);
+		chainEpoch = subtreeEpoch;
+	}
+	return chain;
+}
+
+bool Control::isDirty() const
+{
+	DirtyStamp s = dirty;
+	if (parent)
+		s.merge(parent->subtreeChain());
+	else if (sceneStamp)
+		s.merge(*sceneStamp);
+	return (bool)s;
+}
+
+void Control::setParent(Control* parent)
+{
+	// 换父容器后祖先的整树代号随之改变：待重绘状态要保留下来（重新记为最新的标脏）
+	if (isDirty())
+		dirty = true;
+	this->parent = parent;
+	++subtreeEpoch;
+}
+
 void Control::setIsVisible(bool show)
 {
 	SX_LOGD("Control") << SX_T("重置可见状态: id=", "setIsVisible: id=")
@@ -59,7 +122,7 @@ void Control::setIsVisible(bool show)
 	if (!show)
 	{
 		// 隐藏：擦除自己在屏幕上的内容，并释放快照
-		discardBackground();
+		eraseFromScreen();
 		return;
 	}
 
@@ -99,27 +162,17 @@ StellarX::LayoutMode Control::getLayoutMode() const
 {
 	return this->layoutMode;
 }
-// 保存当前的绘图状态（字体、颜色、线型等）
-// 在控件绘制前调用，确保不会影响全局绘图状态
+// 保存当前的绘图状态（字体、颜色、线型、画刷等）
+// 在控件绘制前调用，确保不会影响全局绘图状态；状态保存在 RenderState 的栈上
 void Control::saveStyle()
 {
-
-	gettextstyle(&currentFont); // 获取当前字体样式
-	currentColor = gettextcolor(); // 获取当前字体颜色
-	currentBorderColor = getlinecolor(); //保存当前边框颜色
-	getlinestyle(&currentLineStyle); //保存当前线型
-	currentBkColor = getfillcolor(); //保存当前填充色
+	StellarX::RenderState::Get().push();
 }
-// 恢复之前保存的绘图状态
+// 恢复之前保存的绘图状态：只重新设置与保存时不同的项
 // 在控件绘制完成后调用，恢复全局绘图状态
 void Control::restoreStyle()
 {
-	settextstyle(&currentFont); // 恢复默认字体样式
-	settextcolor(currentColor); // 恢复默认字体颜色
-	setfillcolor(currentBkColor);
-	setlinestyle(&currentLineStyle);
-	setlinecolor(currentBorderColor);
-	setfillstyle(BS_SOLID);//恢复填充
+	StellarX::RenderState::Get().pop();
 }
 
 void Control::requestRepaint(Control* parent)
@@ -179,7 +232,14 @@ void Control::onRequestRepaintAsRoot()
 bool Control::shouldDeferManagedRepaint() const
 {
 	Window* host = getHostWindow();
-	return host && host->isManagedDispatchActive();
+	// 合成器模式下任何重绘请求都只登记损伤区，由 Window 统一合成
+	return host && (host->isManagedDispatchActive() || host->isCompositorEnabled());
+}
+
+bool Control::usesCompositor() const
+{
+	Window* host = getHostWindow();
+	return host && host->isCompositorEnabled();
 }
 
 // 获取宿主 Window：
@@ -214,6 +274,26 @@ RECT Control::getBoundsRect() const
 	return rc;
 }
 
+// 绘制范围：已有快照时以快照范围为准（包含边框外扩），
+// 位置/尺寸在上次绘制后又变化时，再并上当前外接矩形（右/下各留 1 像素闭区间边框）。
+RECT Control::getDamageRect() const
+{
+	RECT rc{ x, y, x + width + 1, y + height + 1 };
+	if (hasSnap && saveWidth > 0 && saveHeight > 0)
+	{
+		rc.left = (std::min)(rc.left, (LONG)saveBkX);
+		rc.top = (std::min)(rc.top, (LONG)saveBkY);
+		rc.right = (std::max)(rc.right, (LONG)(saveBkX + saveWidth));
+		rc.bottom = (std::max)(rc.bottom, (LONG)(saveBkY + saveHeight));
+	}
+	return rc;
+}
+
+void Control::collectDamageRects(std::vector<RECT>& out) const
+{
+	out.push_back(getDamageRect());
+}
+
 bool Control::canCommitManagedPartialRepaint() const
 {
 	// 基类默认不承诺自己能安全做局部提交；
@@ -226,15 +306,228 @@ void Control::commitManagedRepaint()
 	if (!show)
 		return;
 	// 基类兜底：如果没有更具体的容器实现，就按根级重绘处理。
-	if (dirty)
+	if (isDirty())
 		onRequestRepaintAsRoot();
 }
 
+bool Control::isPresentationCurrent()
+{
+	// 未采用显示列表的控件无法判断自己画出来的内容是否变化
+	return false;
+}
+
+// 判断依据以屏幕像素为准：列表哈希只说明“要画的东西没变”，
+// 只有快照范围内的像素也与上次画完时相同，才能确定屏幕上已是正确结果
+bool Control::displayListCurrent()
+{
+	auto& st = StellarX::DisplayList::stats();
+	++st.compared;
+	if (!StellarX::DisplayList::skipEnabled() || displayList.hash() != presentedListHash)
+		return false;
+	// 合成器按块重画、快照范围完全在裁剪区外：重放也画不到屏幕上，不必读像素
+	const Window* host = getHostWindow();
+	const bool outsideClip = presented && host && host->composeClip()
+		&& !host->composeClip()->intersects(saveBkX, saveBkY, saveBkX + saveWidth, saveBkY + saveHeight);
+	if (!outsideClip && !presentedPixelsCurrent())
+		return false;
+	++st.skipped;
+	return true;
+}
+
+bool Control::presentedPixelsCurrent()
+{
+	if (!presented || !hasValidBackgroundSnapshot()
+		|| presentedX != saveBkX || presentedY != saveBkY || presentedW != saveWidth || presentedH != saveHeight)
+		return false;
+	// 分块帧中屏幕像素尚未画出，无从比对：照常重放
+	if (StellarX::TileRender::recording())
+		return false;
+	SetWorkingImage(nullptr);
+	return hashPresentedPixels() == presentedPixelHash;
+}
+
+void Control::markDisplayListPresented()
+{
+	if (StellarX::TileRender::recording())
+	{
+		StellarX::TileRender::afterFrame([this] { markDisplayListPresented(); });
+		return;
+	}
+	presented = hasValidBackgroundSnapshot();
+	// 合成器按块重画时只画了裁剪区内的部分：此时的屏幕像素不是完整的“画过的样子”，不能作为跳过依据
+	const Window* host = getHostWindow();
+	if (presented && host && host->composeClip()
+		&& !StellarX::Region(saveBkX, saveBkY, saveBkX + saveWidth, saveBkY + saveHeight).subtract(*host->composeClip()).isEmpty())
+		presented = false;
+	if (!presented)
+		return;
+	presentedListHash = displayList.hash();
+	presentedX = saveBkX; presentedY = saveBkY; presentedW = saveWidth; presentedH = saveHeight;
+	SetWorkingImage(nullptr);
+	presentedPixelHash = hashPresentedPixels();
+}
+
+std::uint64_t Control::hashPresentedPixels() const
+{
+	auto& st = StellarX::DisplayList::stats();
+	++st.pixelHashes;
+	st.pixelsHashed += (std::uint64_t)saveWidth * (std::uint64_t)saveHeight;
+	return StellarX::LayerCache::hashScreenRect(saveBkX, saveBkY, saveWidth, saveHeight, presentedListHash);
+}
+
+Control::TranslucentStats& Control::translucentStats()
+{
+	static TranslucentStats st;
+	return st;
+}
+
+void Control::setOpacity(std::uint8_t opacity)
+{
+	if (this->opacity == opacity)
+		return;
+	// 不透明快照没有留底像素，变成半透明后无从合成：作废并请父容器重画底图
+	if (opacity < 255 && hasSnap && snapOpaque)
+		invalidateBackgroundSnapshot();
+	this->opacity = opacity;
+	if (opacity == 255)
+		translucentLayer.reset();
+	presented = false;
+	dirty = true;
+}
+
+bool Control::beginTranslucent(std::uint64_t contentKey)
+{
+	if (!translucent())
+		return false;
+	if (!translucentLayer)
+		translucentLayer = std::make_unique<TranslucentLayer>();
+	TranslucentLayer& t = *translucentLayer;
+	if (t.active)
+		return false;   // 外层 draw 已经开始（Dialog / TabControl 调用 Canvas::draw）
+	if (translucentHold > 0)
+		contentKey = 0; // 外层还要画附加内容，内容键不完整
+
+	// 合成范围取快照范围；合成器按损伤区重画时只合成与之相交的外接矩形，区域外的像素不会被写
+	int l = hasSnap ? saveBkX : x, tp = hasSnap ? saveBkY : y;
+	int r = l + (hasSnap ? saveWidth : width), b = tp + (hasSnap ? saveHeight : height);
+	const Window* host = getHostWindow();
+	int cl, ct, cr, cb;
+	if (host && host->composeClip() && host->composeClip()->getBounds(cl, ct, cr, cb))
+	{
+		l = (std::max)(l, cl); tp = (std::max)(tp, ct);
+		r = (std::min)(r, cr); b = (std::min)(b, cb);
+	}
+	const int lx = l, ly = tp, lw = r - l, lh = b - tp;
+	if (lw <= 0 || lh <= 0)
+		return false;
+	SetWorkingImage(nullptr);
+	const std::uint64_t under = StellarX::LayerCache::hashScreenRect(lx, ly, lw, lh, opacity);
+	if (contentKey && t.valid && t.contentKey == contentKey && t.underHash == under && t.opacity == opacity
+		&& t.x == lx && t.y == ly && t.w == lw && t.h == lh)
+	{
+		++translucentStats().reused;
+		putimage(lx, ly, &t.composite);
+		return true;
+	}
+	getimage(&t.composite, lx, ly, lw, lh);
+	t.x = lx; t.y = ly; t.w = lw; t.h = lh;
+	t.underHash = under;
+	t.contentKey = contentKey;
+	t.opacity = opacity;
+	t.valid = false;
+	t.active = true;
+	return false;
+}
+
+void Control::endTranslucent()
+{
+	if (!translucentLayer || !translucentLayer->active || translucentHold > 0)
+		return;
+	TranslucentLayer& t = *translucentLayer;
+	t.active = false;
+
+	// 画好的像素 × opacity 覆盖到底图上：未绘制处读回的就是底图，合成后保持原样
+	IMAGE& layer = translucentScratch();
+	SetWorkingImage(nullptr);
+	getimage(&layer, t.x, t.y, t.w, t.h);
+	std::uint32_t* src = reinterpret_cast<std::uint32_t*>(GetImageBuffer(&layer));
+	std::uint32_t* dst = reinterpret_cast<std::uint32_t*>(GetImageBuffer(&t.composite));
+	const std::size_t n = (std::size_t)t.w * t.h;
+	if (src && dst)
+	{
+		StellarX::Pixel::premultiply(src, src, n, t.opacity);
+		StellarX::Pixel::blendPremultiplied(dst, src, n);
+	}
+	putimage(t.x, t.y, &t.composite);
+	t.valid = t.contentKey != 0;
+	auto& st = translucentStats();
+	++st.composited;
+	st.pixels += n;
+}
+
 void Control::saveBackground(int x, int y, int w, int h)
 {
 	
 	if (w <= 0 || h <= 0) return;
+	if (usesCompositor())
+	{
+		// 合成器模式：不抓屏，只记录范围；范围变化时旧区域与新区域都需要重合成
+		Window* host = getHostWindow();
+		if (!hasSnap || saveBkX != x || saveBkY != y || saveWidth != w || saveHeight != h)
+		{
+			if (hasSnap)
+				host->invalidateRect(RECT{ saveBkX, saveBkY, saveBkX + saveWidth, saveBkY + saveHeight });
+			host->invalidateRect(RECT{ x, y, x + w, y + h });
+		}
+		releaseSnapshotSurface();
+		saveBkX = x; saveBkY = y; saveWidth = w; saveHeight = h;
+		hasSnap = true;
+		snapRetained = true;
+		snapOpaque = false;
+		return;
+	}
+	snapRetained = false;
+	// 不透明控件：重画必定把整块范围盖满，回贴旧像素纯属浪费，只记录范围。
+	// 隐藏时没有像素可回贴，要靠父容器重画，因此顶层控件仍然抓屏。
+	if (parent && StellarX::SurfacePool::Get().skipOpaque() && isOpaque())
+	{
+		releaseSnapshotSurface();
+		StellarX::SurfacePool::Get().skip(this, w, h);
+		saveBkX = x; saveBkY = y; saveWidth = w; saveHeight = h;
+		hasSnap = true;
+		snapOpaque = true;
+		return;
+	}
+	// 不再不透明（如改成空心填充）：范围里是自己上次画的像素，不能当背景用
+	if (hasSnap && snapOpaque)
+		exposeToParent();
+	snapOpaque = false;
 	saveBkX = x; saveBkY = y; saveWidth = w; saveHeight = h;
+	auto& pool = StellarX::SurfacePool::Get();
+	// 父容器本体完全盖住这块范围、底下也没有先画的兄弟：屏幕上就是本体的像素，直接引用
+	if (parent && pool.compact() && parent->sharesBody(this, x, y, w, h))
+	{
+		releaseSnapshotSurface();
+		pool.noteShared();
+		hasSnap = true;
+		snapShared = true;
+		return;
+	}
+	packedBk.reset();
+	snapShared = false;
+	// 大块均匀背景（纯色底、实心画布）直接从屏幕压缩存放，不借表面
+	if (pool.compact() && w * h >= kPackMinPixels)
+	{
+		auto packed = std::make_unique<StellarX::RleImage>();
+		if (packScreenRect(*packed, x, y, w, h))
+		{
+			releaseSnapshotSurface();
+			packedBk = std::move(packed);
+			pool.notePacked();
+			hasSnap = true;
+			return;
+		}
+	}
 	if (saveBkImage)
 	{
 		//尺寸变了才重建，避免反复 new/delete
@@ -242,47 +535,135 @@ void Control::saveBackground(int x, int y, int w, int h)
 		{
 			SX_LOGD("Snap") <<SX_T("重新保存背景快照：id=", "saveBackground rebuild: id=") << id << " size=(" << w << "x" << h << ")";
 
-			saveBkImage.reset();
+			releaseSnapshotSurface();
 		}
 	}
 	else
 		SX_LOGD("Snap") << SX_T("保存背景快照：id=", "saveBackground rebuild: id=") << id << " size=(" << w << "x" << h << ")";
-	if (!saveBkImage) saveBkImage = std::make_unique<IMAGE>(w, h);
+	if (!saveBkImage) saveBkImage = StellarX::SurfacePool::Get().acquire(this, w, h);
+	else StellarX::SurfacePool::Get().touch(this);
 
 	SetWorkingImage(nullptr);                 // ★抓屏幕
 	getimage(saveBkImage.get(), x, y, w, h);
 	hasSnap = true;
 }
 
+bool Control::packScreenRect(StellarX::RleImage& out, int x, int y, int w, int h)
+{
+	// 直接读屏幕缓冲，省去一次整块拷贝；范围须完全在屏幕内
+	SetWorkingImage(nullptr);
+	const int sw = getwidth(), sh = getheight();
+	if (w <= 0 || h <= 0 || x < 0 || y < 0 || x + w > sw || y + h > sh)
+		return false;
+	const std::uint32_t* screen = reinterpret_cast<const std::uint32_t*>(GetImageBuffer(nullptr));
+	return screen && out.encode(screen + (std::size_t)y * sw + x, sw, w, h, (std::size_t)w * h);
+}
+
+void Control::putPacked(const StellarX::RleImage& img, int dstX, int dstY, int sx, int sy, int w, int h)
+{
+	if (w <= 0 || h <= 0)
+		return;
+	IMAGE& scratch = packScratch();
+	if (scratch.getwidth() < w || scratch.getheight() < h)
+		Resize(&scratch, (std::max)(w, scratch.getwidth()), (std::max)(h, scratch.getheight()));
+	img.decode(reinterpret_cast<std::uint32_t*>(GetImageBuffer(&scratch)), scratch.getwidth(), sx, sy, w, h);
+	SetWorkingImage(nullptr);
+	putimage(dstX, dstY, w, h, &scratch, 0, 0);
+}
+
 void Control::restBackground()
 {
-	if (!hasSnap || !saveBkImage) return;
+	// 合成器模式下旧像素可能早于开启合成器时抓取，一律不回贴
+	if (!hasSnap || usesCompositor()) return;
+	if (snapShared)
+	{
+		if (parent)
+			parent->restoreBody(saveBkX, saveBkY, saveWidth, saveHeight);
+		return;
+	}
+	if (packedBk)
+	{
+		putPacked(*packedBk, saveBkX, saveBkY, 0, 0, saveWidth, saveHeight);
+		return;
+	}
+	if (!saveBkImage) return;
 	// 直接回贴屏幕（与抓取一致）
 	SetWorkingImage(nullptr);
 	putimage(saveBkX, saveBkY, saveBkImage.get());
+	StellarX::SurfacePool::Get().touch(this);
 }
 
-void Control::discardBackground()
+void Control::releaseSnapshotSurface()
 {
+	// 即使没有像素也要通知池，注销本控件的在用登记
+	StellarX::SurfacePool::Get().release(this, std::move(saveBkImage));
+	packedBk.reset();
+	snapShared = false;
+}
+
+std::size_t Control::snapshotBytes() const
+{
+	std::size_t bytes = 0;
 	if (saveBkImage)
+		bytes += (std::size_t)saveBkImage->getwidth() * (std::size_t)saveBkImage->getheight() * 4;
+	if (packedBk)
+		bytes += packedBk->bytes();
+	return bytes;
+}
+
+void Control::discardBackground()
+{
+	if (hasSnap && usesCompositor())
+	{
+		// 合成器模式：不回贴像素，改为把旧范围登记为损伤区
+		getHostWindow()->invalidateRect(RECT{ saveBkX, saveBkY, saveBkX + saveWidth, saveBkY + saveHeight });
+	}
+	else if (holdsSnapshotPixels())
 	{
 		restBackground();
 		SX_LOGD("Snap") << SX_T("丢弃背景快照：id=","discardBackground: id=") << id << " hasSnap=" << (hasSnap ? 1 : 0);
-		saveBkImage.reset();
 	}
-	hasSnap = false; saveWidth = saveHeight = 0;
+	else if (hasSnap && snapOpaque)
+		exposeToParent();
+	releaseSnapshotSurface();
+	hasSnap = false; snapRetained = false; snapOpaque = false; saveWidth = saveHeight = 0;
+	presented = false;
+}
+
+void Control::exposeToParent()
+{
+	if (!parent)
+		return;
+	parent->dirty = true;
+	parent->presented = false;
+}
+
+void Control::eraseFromScreen()
+{
+	const bool pixelless = hasSnap && snapOpaque && !usesCompositor();
+	discardBackground();
+	if (pixelless && parent)
+	{
+		SX_LOGD("Snap") << SX_T("不透明控件隐藏，请父容器重画：id=", "opaque control hidden, repaint parent: id=") << id;
+		parent->requestRepaint(parent);
+	}
 }
 
 void Control::invalidateBackgroundSnapshot()
 {
-	if (saveBkImage)
+	if (saveBkImage || packedBk)
 	{
 		SX_LOGD("Snap") << SX_T("作废背景快照：id=", "invalidateBackgroundSnapshot: id=") << id
 			<< " hasSnap=" << (hasSnap ? 1 : 0);
-		saveBkImage.reset();
 	}
+	if (hasSnap && snapOpaque && !isOpaque())
+		exposeToParent();
+	releaseSnapshotSurface();
 	hasSnap = false;
+	snapRetained = false;
+	snapOpaque = false;
 	saveBkX = saveBkY = 0;
 	saveWidth = saveHeight = 0;
+	presented = false;
 }
 
@@ -1,5 +1,8 @@
 ﻿#include "Dialog.h"
 #include "SxLog.h"
+#include "SxRenderState.h"
+#include "SxTextMetrics.h"
+#include "SxEventLoop.h"
 
 Dialog::Dialog(Window& h, std::string text, std::string message, StellarX::MessageBoxType type, bool modal)
 	: Canvas(), message(message), type(type), modal(modal), hWnd(h), titleText(text)
@@ -31,35 +34,42 @@ void Dialog::draw()
 		needsInitialization = false;
 	}
 
-	if (dirty && show)
+	if (isDirty() && show)
 	{
 		// 保存当前绘图状态
 		saveStyle();
+		auto& rs = StellarX::RenderState::Get();
 
 		Canvas::setBorderColor(this->borderColor);
 		Canvas::setLinewidth(BorderWidth);
 		Canvas::setCanvasBkColor(this->backgroundColor);
 		Canvas::setShape(StellarX::ControlShape::ROUND_RECTANGLE);
 
+		// 半透明时标题与正文也要一起合成：Canvas::draw 不收尾，画完文本再合成
+		++translucentHold;
 		Canvas::draw();
+		--translucentHold;
 
 		//绘制消息文本
-		settextcolor(textStyle.color);
-		setbkmode(TRANSPARENT);
+		rs.setTextColor(textStyle.color);
+		rs.setBkMode(TRANSPARENT);
 
 		//设置字体样式
-		settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-			textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-			textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
+		rs.setTextStyle(textStyle);
 
 		outtextxy(x + 5, y + 5, LPCTSTR(titleText.c_str()));
 
 		int ty = y + closeButtonHeight + titleToTextMargin; // 文本起始Y坐标
 		for (auto& line : lines)
 		{
-			int tx = this->x + ((this->width - textwidth(line.c_str())) / 2); // 文本起始X坐标
+			int tx = this->x + ((this->width - StellarX::measureTextWidth(line)) / 2); // 文本起始X坐标
 			outtextxy(tx, ty, LPCTSTR(line.c_str()));
-			ty = ty + textheight(LPCTSTR(line.c_str())) + 5; // 每行文本高度加5像素间距
+			ty = ty + StellarX::measureTextHeight(line) + 5; // 每行文本高度加5像素间距
+		}
+		if (translucent())
+		{
+			endTranslucent();
+			markDisplayListPresented();
 		}
 
 		// 恢复绘图状态
@@ -69,6 +79,14 @@ void Dialog::draw()
 	}
 }
 
+void Dialog::addOpaqueRegion(StellarX::Region& out) const
+{
+	// 首次绘制时才按文本计算尺寸、设定圆角形状与背景色，之前的几何不可信
+	if (needsInitialization || pendingCleanup)
+		return;
+	Canvas::addOpaqueRegion(out);
+}
+
 bool Dialog::handleEvent(const ExMessage& msg)
 {
 	bool consume = false;
@@ -177,6 +195,8 @@ void Dialog::Show()
 
 		while (show)
 		{
+			const std::uint64_t progressiveFrames = StellarX::RedrawScheduler::stats().frames;
+
 			// ① 轮询窗口尺寸（不依赖 WM_SIZE）
 			RECT rc;
 			GetClientRect(hWnd.getHwnd(), &rc);
@@ -201,15 +221,21 @@ void Dialog::Show()
 
 			// ② 处理这只对话框的鼠标/键盘（沿用原来 EX_MOUSE | EX_KEY）
 			ExMessage msg;
-			if (peekmessage(&msg, EX_MOUSE | EX_KEY))
+			const bool handled = peekmessage(&msg, EX_MOUSE | EX_KEY);
+			if (handled)
 			{
 				handleEvent(msg);
 				if (!show)
 					break;
 			}
 
-			// ③ 最后一笔：只画这只模态，保证永远在最上层
-			if (dirty)
+			// ③ 与事件循环共用的异步待办：后台解码落地、到期定时器（提示框延时等）、托管重绘、渐进重绘。
+			// 宿主画过就把这只模态补画到最上层
+			if (hWnd.pumpPendingWork(progressiveFrames))
+				dirty = true;
+
+			// ④ 最后一笔：只画这只模态，保证永远在最上层
+			if (isDirty())
 			{
 				BeginBatchDraw();
 				this->draw();   // 注意：不要 requestRepaint(parent)，只画自己
@@ -217,7 +243,12 @@ void Dialog::Show()
 				dirty = false;
 			}
 
-			Sleep(10);
+			// ⑤ 空闲等待：输入、跨线程唤醒或定时器到期时返回。
+			// 尺寸刚在 ② 的消息分发中被拖拽改变、或渐进重绘未完成时不等，下一轮立即处理
+			GetClientRect(hWnd.getHwnd(), &rc);
+			if (rc.right - rc.left != lastW || rc.bottom - rc.top != lastH)
+				continue;
+			StellarX::EventLoop::wait(EX_MOUSE | EX_KEY, handled || StellarX::RedrawScheduler::pending());
 		}
 
 		if (pendingCleanup && !isCleaning)
@@ -534,15 +565,13 @@ void Dialog::splitMessageLines()
 void Dialog::getTextSize()
 {
 	saveStyle();
-	settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-		textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-		textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
+	StellarX::RenderState::Get().setTextStyle(textStyle);
 	this->textHeight = 0;
 	this->textWidth = 0;
 	for (auto& text : lines)
 	{
-		int w = textwidth(LPCTSTR(text.c_str()));
-		int h = textheight(LPCTSTR(text.c_str()));
+		int w = StellarX::measureTextWidth(text);
+		int h = StellarX::measureTextHeight(text);
 		if (this->textHeight < h)
 			this->textHeight = h;
 		if (this->textWidth < w)
@@ -603,10 +632,8 @@ void Dialog::initDialogSize()
 	// 计算文本区域宽度（包括边距）
 	int textAreaWidth = textWidth + textToBorderMargin * 2;
 	saveStyle();
-	settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-		textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-		textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
-	int titleAreaWidth = textwidth(LPCTSTR(titleText.c_str())) + textToBorderMargin * 2 + closeButtonWidth + buttonMargin;
+	StellarX::RenderState::Get().setTextStyle(textStyle);
+	int titleAreaWidth = StellarX::measureTextWidth(titleText) + textToBorderMargin * 2 + closeButtonWidth + buttonMargin;
 	restoreStyle();
 
 	// 对话框宽度取文本、标题和按钮区域中的较大值，并确保最小宽度
@@ -655,13 +682,13 @@ void Dialog::performDelayedCleanup()
 	// 重置指针
 	closeButton = nullptr;
 	// 释放背景图像资源
-	if (saveBkImage && hasSnap)
+	if (holdsSnapshotPixels())
 	{
 		restBackground();
 		FlushBatchDraw();
 		invalidateBackgroundSnapshot();
 	}
-	if (!(saveBkImage && hasSnap))
+	if (!holdsSnapshotPixels())
 	{
 		// 没有背景快照：强制一次完整重绘，立即擦掉残影
 		hWnd.pumpResizeIfNeeded(); // 如果正好有尺寸标志，顺便统一收口
@@ -670,7 +697,7 @@ void Dialog::performDelayedCleanup()
 		// 背景
 		if (hWnd.getBkImage() && !hWnd.getBkImageFile().empty())
 			putimage(0, 0, hWnd.getBkImage());
-		else { setbkcolor(hWnd.getBkcolor()); cleardevice(); }
+		else { StellarX::RenderState::Get().setBkColor(hWnd.getBkcolor()); cleardevice(); }
 		// 所有普通控件
 		for (auto& c : hWnd.getControls()) c->draw();
 		// 其他对话框（this 已经 show=false，会早退不绘）
@@ -736,6 +763,13 @@ void Dialog::requestRepaint(Control* parent)
 
 	if (this == parent)
 	{
+		// 半透明时按钮与底板是整体合成的，不能单独重画
+		if (translucent())
+		{
+			dirty = true;
+			draw();
+			return;
+		}
 		for (auto& control : controls)
 			if (control->isDirty() && control->IsVisible())
 				control->draw();
@@ -748,7 +782,7 @@ bool Dialog::canCommitManagedPartialRepaint() const
 {
 	// Dialog 只有在“自身底板不脏 + 仍持有有效背景快照”时，
 	// 才能安全地只更新内部按钮，而不重画整个对话框底板。
-	return show && !dirty && hasValidBackgroundSnapshot();
+	return show && !isDirty() && hasValidBackgroundSnapshot() && !translucent();
 }
 
 void Dialog::commitManagedRepaint()
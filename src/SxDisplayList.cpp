@@ -0,0 +1,170 @@
+﻿#include "SxDisplayList.h"
+#include "SxHash.h"
+#include "SxRenderState.h"
+#include "SxShapeMask.h"
+
+namespace StellarX
+{
+	DisplayList::Stats& DisplayList::stats()
+	{
+		static Stats s;
+		return s;
+	}
+
+	void DisplayList::resetStats()
+	{
+		stats() = Stats{};
+	}
+
+	namespace
+	{
+		bool gSkipEnabled = true;
+	}
+
+	void DisplayList::setSkipEnabled(bool on)
+	{
+		gSkipEnabled = on;
+	}
+
+	bool DisplayList::skipEnabled()
+	{
+		return gSkipEnabled;
+	}
+
+	void DisplayList::clear()
+	{
+		// 保留容量：控件每次重绘的命令数基本不变，不反复分配
+		commands.clear();
+		texts.clear();
+		styles.clear();
+		patterns.clear();
+		hsh = kHashSeed;
+		++stats().recorded;
+	}
+
+	void DisplayList::push(Op op, int l, int t, int r, int b, int ex, int ey, std::uint32_t arg)
+	{
+		commands.push_back(Command{ op, l, t, r, b, ex, ey, arg });
+		// 逐字段混入，不对结构体整体取字节（避免填充字节参与哈希）
+		hsh = hashValue((std::uint8_t)op, hsh);
+		const std::int32_t v[6] = { l, t, r, b, ex, ey };
+		hsh = hashBytes(v, sizeof(v), hsh);
+		hsh = hashValue(arg, hsh);
+	}
+
+	void DisplayList::setFillColor(COLORREF c)
+	{
+		push(Op::FillColor, 0, 0, 0, 0, 0, 0, (std::uint32_t)c);
+		RenderState::Get().setFillColor(c);
+	}
+
+	void DisplayList::setLineColor(COLORREF c)
+	{
+		push(Op::LineColor, 0, 0, 0, 0, 0, 0, (std::uint32_t)c);
+		RenderState::Get().setLineColor(c);
+	}
+
+	void DisplayList::setTextColor(COLORREF c)
+	{
+		push(Op::TextColor, 0, 0, 0, 0, 0, 0, (std::uint32_t)c);
+		RenderState::Get().setTextColor(c);
+	}
+
+	void DisplayList::setBkColor(COLORREF c)
+	{
+		push(Op::BkColor, 0, 0, 0, 0, 0, 0, (std::uint32_t)c);
+		RenderState::Get().setBkColor(c);
+	}
+
+	void DisplayList::setBkMode(int mode)
+	{
+		push(Op::BkMode, 0, 0, 0, 0, 0, 0, (std::uint32_t)mode);
+		RenderState::Get().setBkMode(mode);
+	}
+
+	void DisplayList::setLineStyle(int style, int thickness)
+	{
+		push(Op::LineStyle, 0, 0, 0, 0, thickness, 0, (std::uint32_t)style);
+		RenderState::Get().setLineStyle(style, thickness);
+	}
+
+	void DisplayList::setFillStyle(int style, long hatch, IMAGE* ppattern)
+	{
+		// 图案按指针区分：同一 IMAGE 对象视为同一图案
+		const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ppattern);
+		hsh = hashValue(p, hsh);
+		push(Op::FillStyle, 0, 0, 0, 0, (int)hatch, 0, (std::uint32_t)style);
+		commands.back().ey = (std::int32_t)patterns.size();
+		patterns.push_back(ppattern);
+		RenderState::Get().setFillStyle(style, hatch, ppattern);
+	}
+
+	void DisplayList::setTextStyle(const ControlText& text)
+	{
+		// 字体名按内容混入哈希，命令里只存下标
+		hsh = hashControlText(text, hsh);
+		push(Op::TextStyle, 0, 0, 0, 0, 0, 0, (std::uint32_t)styles.size());
+		styles.push_back(text);
+		RenderState::Get().setTextStyle(text);
+	}
+
+	void DisplayList::fillRect(int l, int t, int r, int b) { push(Op::FillRect, l, t, r, b, 0, 0, 0); }
+	void DisplayList::solidRect(int l, int t, int r, int b) { push(Op::SolidRect, l, t, r, b, 0, 0, 0); }
+	void DisplayList::fillRoundRect(int l, int t, int r, int b, int ew, int eh) { push(Op::FillRoundRect, l, t, r, b, ew, eh, 0); }
+	void DisplayList::solidRoundRect(int l, int t, int r, int b, int ew, int eh) { push(Op::SolidRoundRect, l, t, r, b, ew, eh, 0); }
+	void DisplayList::fillCircle(int x, int y, int radius) { push(Op::FillCircle, x, y, radius, 0, 0, 0, 0); }
+	void DisplayList::solidCircle(int x, int y, int radius) { push(Op::SolidCircle, x, y, radius, 0, 0, 0, 0); }
+	void DisplayList::fillEllipse(int l, int t, int r, int b) { push(Op::FillEllipse, l, t, r, b, 0, 0, 0); }
+	void DisplayList::solidEllipse(int l, int t, int r, int b) { push(Op::SolidEllipse, l, t, r, b, 0, 0, 0); }
+
+	void DisplayList::text(int x, int y, const std::string& s)
+	{
+		hsh = hashString(s, hsh);
+		push(Op::Text, x, y, 0, 0, 0, 0, (std::uint32_t)texts.size());
+		texts.push_back(s);
+	}
+
+	void DisplayList::replay() const
+	{
+		auto& rs = RenderState::Get();
+		auto& masks = ShapeMaskCache::Get();
+		for (const Command& c : commands)
+		{
+			switch (c.op)
+			{
+			case Op::FillColor: rs.setFillColor((COLORREF)c.arg); break;
+			case Op::LineColor: rs.setLineColor((COLORREF)c.arg); break;
+			case Op::TextColor: rs.setTextColor((COLORREF)c.arg); break;
+			case Op::BkColor:   rs.setBkColor((COLORREF)c.arg); break;
+			case Op::BkMode:    rs.setBkMode((int)c.arg); break;
+			case Op::LineStyle: rs.setLineStyle((int)c.arg, c.ex); break;
+			case Op::FillStyle: rs.setFillStyle((int)c.arg, c.ex, patterns[c.ey]); break;
+			case Op::TextStyle: rs.setTextStyle(styles[c.arg]); break;
+			case Op::FillRect:       fillrectangle(c.l, c.t, c.r, c.b); break;
+			case Op::SolidRect:      solidrectangle(c.l, c.t, c.r, c.b); break;
+			// 曲边图元优先经抗锯齿掩码缓存绘制（未开启或状态不支持时退回后端）
+			case Op::FillRoundRect:
+				if (!masks.drawRoundRect(c.l, c.t, c.r, c.b, c.ex, c.ey, true)) fillroundrect(c.l, c.t, c.r, c.b, c.ex, c.ey);
+				break;
+			case Op::SolidRoundRect:
+				if (!masks.drawRoundRect(c.l, c.t, c.r, c.b, c.ex, c.ey, false)) solidroundrect(c.l, c.t, c.r, c.b, c.ex, c.ey);
+				break;
+			case Op::FillCircle:
+				if (!masks.drawEllipse(c.l - c.r, c.t - c.r, c.l + c.r, c.t + c.r, true)) fillcircle(c.l, c.t, c.r);
+				break;
+			case Op::SolidCircle:
+				if (!masks.drawEllipse(c.l - c.r, c.t - c.r, c.l + c.r, c.t + c.r, false)) solidcircle(c.l, c.t, c.r);
+				break;
+			case Op::FillEllipse:
+				if (!masks.drawEllipse(c.l, c.t, c.r, c.b, true)) fillellipse(c.l, c.t, c.r, c.b);
+				break;
+			case Op::SolidEllipse:
+				if (!masks.drawEllipse(c.l, c.t, c.r, c.b, false)) solidellipse(c.l, c.t, c.r, c.b);
+				break;
+			case Op::Text:           outtextxy(c.l, c.t, LPCTSTR(texts[c.arg].c_str())); break;
+			}
+		}
+		++stats().replayed;
+		stats().commandsReplayed += commands.size();
+	}
+}
@@ -0,0 +1,209 @@
+﻿#include "SxEventLoop.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace StellarX
+{
+	namespace EventLoop
+	{
+		namespace
+		{
+			bool gEnabled = true;
+			std::atomic<bool> gWoken{ false };
+
+			struct Timer
+			{
+				std::uint64_t id;
+				ULONGLONG due;
+				std::function<void()> fn;
+			};
+			std::vector<Timer> gTimers;              // 只在 UI 线程访问；数量很少，线性查找
+			std::uint64_t gNextTimerId = 0;
+
+			Stats& mutableStats()
+			{
+				static Stats s;
+				return s;
+			}
+
+#if SX_BACKEND_HEADLESS
+			std::mutex& wakeLock()
+			{
+				static std::mutex* m = new std::mutex();
+				return *m;
+			}
+
+			std::condition_variable& wakeSignal()
+			{
+				static std::condition_variable* cv = new std::condition_variable();
+				return *cv;
+			}
+#else
+			HANDLE wakeEvent()
+			{
+				// 自动复位：一次 wake 只唤醒一次等待
+				static HANDLE h = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+				return h;
+			}
+#endif
+
+			bool deadlineDue()
+			{
+				const ULONGLONG due = nextDeadline();
+				return due != 0 && GetTickCount64() >= due;
+			}
+
+			Wake finish(Wake why, ULONGLONG start)
+			{
+				Stats& s = mutableStats();
+				switch (why)
+				{
+				case Wake::Input:    ++s.inputWakes; break;
+				case Wake::Posted:   ++s.postWakes; break;
+				case Wake::Deadline: ++s.deadlineWakes; break;
+				default: break;
+				}
+				s.idleMs += GetTickCount64() - start;
+				return why;
+			}
+		}
+
+		void setEnabled(bool on)
+		{
+			gEnabled = on;
+		}
+
+		bool enabled()
+		{
+			return gEnabled;
+		}
+
+		std::uint64_t addTimer(ULONGLONG tick, std::function<void()> fn)
+		{
+			if (!fn)
+				return 0;
+			gTimers.push_back(Timer{ ++gNextTimerId, (std::max)(tick, (ULONGLONG)1), std::move(fn) });
+			return gNextTimerId;
+		}
+
+		void cancelTimer(std::uint64_t id)
+		{
+			gTimers.erase(std::remove_if(gTimers.begin(), gTimers.end(), [id](const Timer& t) { return t.id == id; }), gTimers.end());
+		}
+
+		std::size_t runDueTimers()
+		{
+			if (gTimers.empty())
+				return 0;
+			// 先摘出到期项再调用：回调里可以再登记或取消定时器
+			const ULONGLONG now = GetTickCount64();
+			std::vector<Timer> due;
+			for (auto it = gTimers.begin(); it != gTimers.end();)
+			{
+				if (it->due <= now)
+				{
+					due.push_back(std::move(*it));
+					it = gTimers.erase(it);
+				}
+				else
+					++it;
+			}
+			std::sort(due.begin(), due.end(), [](const Timer& a, const Timer& b) { return a.due != b.due ? a.due < b.due : a.id < b.id; });
+			for (Timer& t : due)
+				t.fn();
+			mutableStats().timersRun += due.size();
+			return due.size();
+		}
+
+		ULONGLONG nextDeadline()
+		{
+			ULONGLONG due = 0;
+			for (const Timer& t : gTimers)
+				if (due == 0 || t.due < due)
+					due = t.due;
+			return due;
+		}
+
+		void wake()
+		{
+#if SX_BACKEND_HEADLESS
+			{
+				std::lock_guard<std::mutex> lk(wakeLock());
+				gWoken = true;
+			}
+			wakeSignal().notify_all();
+#else
+			gWoken = true;
+			SetEvent(wakeEvent());
+#endif
+		}
+
+		Wake wait(BYTE filter, bool handled)
+		{
+			Stats& s = mutableStats();
+			const ULONGLONG start = GetTickCount64();
+			if (!gEnabled)
+			{
+				++s.polls;
+				Sleep(10);
+				s.idleMs += GetTickCount64() - start;
+				return Wake::Polled;
+			}
+			// 处理过消息：后面可能还有积压的输入（EasyX 一次可能取走多条），不等待
+			if (handled)
+				return Wake::Busy;
+
+			++s.waits;
+			if (gWoken.exchange(false))
+				return finish(Wake::Posted, start);
+			if (deadlineDue())
+				return finish(Wake::Deadline, start);
+
+			const ULONGLONG now = GetTickCount64();
+			const ULONGLONG deadline = nextDeadline();
+			const DWORD timeout = deadline ? (DWORD)(std::min)(deadline - now, (ULONGLONG)0x7FFFFFFF) : INFINITE;
+			++s.blocked;
+
+#if SX_BACKEND_HEADLESS
+			if (Headless::waitMessage(timeout, filter))
+				return finish(Wake::Input, start);
+			if (timeout != INFINITE)
+				return finish(Wake::Deadline, start);
+			// 再也等不到脚本消息：只剩其它线程能唤醒，真正阻塞
+			std::unique_lock<std::mutex> lk(wakeLock());
+			wakeSignal().wait(lk, [] { return gWoken.load(); });
+			gWoken = false;
+			return finish(Wake::Posted, start);
+#else
+			(void)filter;
+			HANDLE h = wakeEvent();
+			// MWMO_INPUTAVAILABLE：队列里已有（之前看过但未取走的）输入也立即返回
+			const DWORD r = MsgWaitForMultipleObjectsEx(1, &h, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+			if (r == WAIT_OBJECT_0)
+			{
+				gWoken = false;
+				return finish(Wake::Posted, start);
+			}
+			if (r == WAIT_TIMEOUT)
+				return finish(Wake::Deadline, start);
+			if (r == WAIT_FAILED)
+				Sleep(10);                         // 事件创建失败等异常：退回轮询，避免空转
+			return finish(Wake::Input, start);
+#endif
+		}
+
+		const Stats& stats()
+		{
+			return mutableStats();
+		}
+
+		void resetStats()
+		{
+			mutableStats() = Stats{};
+		}
+	}
+}
@@ -0,0 +1,2510 @@
+﻿#include "SxBackend.h"
+#include "SxPixelKernels.h"
+#include "SxRegion.h"
+#include "SxThreadPool.h"
+
+/********************************************************************************
+ * @文件: SxHeadless.cpp
+ * @摘要: 星垣(StellarX) 无头(Headless)绘图后端实现
+ * @描述:
+ *     以纯软件方式实现 SxHeadless.h 中声明的 EasyX / Win32 兼容接口：
+ *     1) 表面：IMAGE 为连续的 32 位像素缓冲，屏幕本身也是一个 IMAGE；
+ *     2) 光栅化：所有图形都按“逐行区间(span)”生成，边框 = 外轮廓区间 − 内轮廓区间，
+ *        线型(虚线/点线)与填充样式(实心/阴影线/图案)在区间写入时统一处理；
+ *     3) 文本：内置 8x16 点阵字体（ASCII 0x20~0x7E），按字号最近邻缩放；
+ *        双字节字符（GBK / UTF-8 多字节）按全角宽度绘制为占位方框；
+ *        每个 (字号, 字宽, 粗体, 斜体, 字符) 的字形只光栅化一次，按行压成水平游程存入字形图集，
+ *        绘制字符串即逐字形回放游程（见 glyphFor）；
+ *     4) 裁剪：setcliprgn 设置的矩形集合只作用于设置时的绘图目标，
+ *        所有区间写入与 putimage 都按裁剪矩形分段；
+ *     5) 事件：脚本队列 + 虚拟时钟，peekmessage 只返回“已到期且类别匹配”的消息，
+ *        WM_ENTERSIZEMOVE / WM_SIZING / WM_EXITSIZEMOVE 经已安装的窗口过程分发。
+ *     6) 分块帧：beginTiledFrame 之后屏幕上的图元只记录（附带绘图状态与裁剪快照），
+ *        flushTiles 按包围盒分箱到方块，在线程池上逐块回放；每块只写自己的矩形，
+ *        块内保持记录顺序，结果与逐条绘制逐像素一致。任何读回屏幕的接口都会先刷新（见 syncImage）。
+ *
+ * @实现难点提示:
+ *     - 坐标语义与 EasyX 一致：矩形/椭圆的 right/bottom 为闭区间
+ *     - 所有写入都要裁剪到当前工作表面，getimage 越界部分按黑色补齐
+ *     - Sleep 只推进虚拟时钟，保证脚本回放可重复、与机器快慢无关
+ *
+ * @备注:
+ *     整个文件只在 SX_BACKEND_HEADLESS 为 1 时参与编译；EasyX 构建下为空翻译单元。
+ ********************************************************************************/
+
+#if SX_BACKEND_HEADLESS
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct SxHeadlessRegion
+{
+	StellarX::Region region;             // 右/下边界为开区间（与 Win32 区域一致）
+};
+
+struct SxHeadlessWindow
+{
+	int clientW = 0;
+	int clientH = 0;
+	std::string title;
+	std::map<int, LONG_PTR> longs;       // GetWindowLong/SetWindowLong 存储
+	LONG_PTR classStyle = CS_HREDRAW | CS_VREDRAW;
+};
+
+namespace
+{
+	// 8x16 单色点阵（ASCII 0x20~0x7E），每字节一行，最高位为最左像素，基线位于第 12 行。
+	// 由 DejaVu Sans Mono 14px 栅格化得到。
+	const unsigned char kFont8x16[95][16] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ' '
+		{ 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 }, // '!'
+		{ 0x00, 0x00, 0x14, 0x14, 0x14, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+		{ 0x00, 0x00, 0x12, 0x12, 0x16, 0x7F, 0x24, 0x24, 0xFE, 0x28, 0x48, 0x48, 0x00, 0x00, 0x00, 0x00 }, // '#'
+		{ 0x00, 0x08, 0x08, 0x3E, 0x49, 0x48, 0x68, 0x3E, 0x0B, 0x09, 0x49, 0x3E, 0x08, 0x08, 0x00, 0x00 }, // '$'
+		{ 0x00, 0x00, 0x60, 0x90, 0x90, 0x62, 0x0C, 0x30, 0x46, 0x09, 0x09, 0x06, 0x00, 0x00, 0x00, 0x00 }, // '%'
+		{ 0x00, 0x00, 0x1C, 0x20, 0x20, 0x30, 0x30, 0x49, 0x45, 0x45, 0x62, 0x3D, 0x00, 0x00, 0x00, 0x00 }, // '&'
+		{ 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '\''
+		{ 0x00, 0x0C, 0x08, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x08, 0x04, 0x00, 0x00, 0x00 }, // '('
+		{ 0x00, 0x30, 0x10, 0x10, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x10, 0x10, 0x30, 0x00, 0x00, 0x00 }, // ')'
+		{ 0x00, 0x00, 0x08, 0x49, 0x3E, 0x1C, 0x6B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '*'
+		{ 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x7F, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '+'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x20, 0x00, 0x00 }, // ','
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '-'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // '.'
+		{ 0x00, 0x00, 0x02, 0x04, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x20, 0x20, 0x20, 0x40, 0x00, 0x00 }, // '/'
+		{ 0x00, 0x00, 0x1C, 0x22, 0x41, 0x41, 0x49, 0x41, 0x41, 0x41, 0x22, 0x1C, 0x00, 0x00, 0x00, 0x00 }, // '0'
+		{ 0x00, 0x00, 0x18, 0x28, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // '1'
+		{ 0x00, 0x00, 0x3E, 0x43, 0x01, 0x01, 0x02, 0x06, 0x0C, 0x10, 0x20, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // '2'
+		{ 0x00, 0x00, 0x3E, 0x41, 0x01, 0x03, 0x1C, 0x03, 0x01, 0x01, 0x43, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // '3'
+		{ 0x00, 0x00, 0x06, 0x0A, 0x1A, 0x12, 0x22, 0x42, 0x7F, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00 }, // '4'
+		{ 0x00, 0x00, 0x7E, 0x40, 0x40, 0x7C, 0x42, 0x01, 0x01, 0x01, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // '5'
+		{ 0x00, 0x00, 0x1E, 0x31, 0x60, 0x40, 0x5E, 0x63, 0x41, 0x41, 0x23, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // '6'
+		{ 0x00, 0x00, 0x7F, 0x03, 0x02, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x20, 0x00, 0x00, 0x00, 0x00 }, // '7'
+		{ 0x00, 0x00, 0x3E, 0x41, 0x41, 0x41, 0x3E, 0x63, 0x41, 0x41, 0x63, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // '8'
+		{ 0x00, 0x00, 0x3C, 0x62, 0x41, 0x41, 0x63, 0x3D, 0x01, 0x03, 0x46, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // '9'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // ':'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x20, 0x00, 0x00 }, // ';'
+		{ 0x00, 0x00, 0x00, 0x00, 0x01, 0x0E, 0x38, 0x40, 0x38, 0x0E, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '<'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '='
+		{ 0x00, 0x00, 0x00, 0x00, 0x40, 0x38, 0x0E, 0x01, 0x0E, 0x38, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '>'
+		{ 0x00, 0x00, 0x38, 0x44, 0x04, 0x0C, 0x18, 0x10, 0x10, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00 }, // '?'
+		{ 0x00, 0x00, 0x1E, 0x33, 0x21, 0x47, 0x49, 0x49, 0x49, 0x49, 0x47, 0x20, 0x30, 0x0E, 0x00, 0x00 }, // '@'
+		{ 0x00, 0x00, 0x08, 0x14, 0x14, 0x14, 0x14, 0x22, 0x3E, 0x22, 0x41, 0x41, 0x00, 0x00, 0x00, 0x00 }, // 'A'
+		{ 0x00, 0x00, 0x7E, 0x41, 0x41, 0x41, 0x7E, 0x43, 0x41, 0x41, 0x43, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // 'B'
+		{ 0x00, 0x00, 0x1E, 0x21, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x21, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // 'C'
+		{ 0x00, 0x00, 0x7C, 0x42, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x42, 0x7C, 0x00, 0x00, 0x00, 0x00 }, // 'D'
+		{ 0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x7F, 0x40, 0x40, 0x40, 0x40, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // 'E'
+		{ 0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x7F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00 }, // 'F'
+		{ 0x00, 0x00, 0x1E, 0x21, 0x40, 0x40, 0x40, 0x43, 0x41, 0x41, 0x21, 0x1E, 0x00, 0x00, 0x00, 0x00 }, // 'G'
+		{ 0x00, 0x00, 0x41, 0x41, 0x41, 0x41, 0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00, 0x00, 0x00, 0x00 }, // 'H'
+		{ 0x00, 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // 'I'
+		{ 0x00, 0x00, 0x1E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x46, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // 'J'
+		{ 0x00, 0x00, 0x42, 0x44, 0x48, 0x50, 0x70, 0x48, 0x4C, 0x44, 0x42, 0x41, 0x00, 0x00, 0x00, 0x00 }, // 'K'
+		{ 0x00, 0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // 'L'
+		{ 0x00, 0x00, 0x63, 0x63, 0x55, 0x55, 0x55, 0x49, 0x41, 0x41, 0x41, 0x41, 0x00, 0x00, 0x00, 0x00 }, // 'M'
+		{ 0x00, 0x00, 0x61, 0x61, 0x51, 0x51, 0x49, 0x49, 0x45, 0x45, 0x43, 0x43, 0x00, 0x00, 0x00, 0x00 }, // 'N'
+		{ 0x00, 0x00, 0x1C, 0x22, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x22, 0x1C, 0x00, 0x00, 0x00, 0x00 }, // 'O'
+		{ 0x00, 0x00, 0x7E, 0x43, 0x41, 0x41, 0x43, 0x7E, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00 }, // 'P'
+		{ 0x00, 0x00, 0x1C, 0x22, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x22, 0x1E, 0x06, 0x02, 0x00, 0x00 }, // 'Q'
+		{ 0x00, 0x00, 0x7E, 0x43, 0x41, 0x41, 0x43, 0x7C, 0x42, 0x41, 0x41, 0x40, 0x00, 0x00, 0x00, 0x00 }, // 'R'
+		{ 0x00, 0x00, 0x1E, 0x61, 0x40, 0x40, 0x30, 0x0E, 0x01, 0x01, 0x43, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // 'S'
+		{ 0x00, 0x00, 0x7F, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 }, // 'T'
+		{ 0x00, 0x00, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x63, 0x3E, 0x00, 0x00, 0x00, 0x00 }, // 'U'
+		{ 0x00, 0x00, 0x41, 0x41, 0x22, 0x22, 0x22, 0x14, 0x14, 0x14, 0x14, 0x08, 0x00, 0x00, 0x00, 0x00 }, // 'V'
+		{ 0x00, 0x00, 0x81, 0x81, 0x81, 0x99, 0x5A, 0x5A, 0x5A, 0x24, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00 }, // 'W'
+		{ 0x00, 0x00, 0x41, 0x22, 0x14, 0x14, 0x08, 0x14, 0x14, 0x22, 0x22, 0x41, 0x00, 0x00, 0x00, 0x00 }, // 'X'
+		{ 0x00, 0x00, 0x41, 0x22, 0x22, 0x14, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00 }, // 'Y'
+		{ 0x00, 0x00, 0x7F, 0x03, 0x02, 0x04, 0x08, 0x08, 0x10, 0x20, 0x60, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // 'Z'
+		{ 0x00, 0x1C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x00, 0x00, 0x00 }, // '['
+		{ 0x00, 0x00, 0x40, 0x20, 0x20, 0x20, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x04, 0x02, 0x00, 0x00 }, // '\\'
+		{ 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x00 }, // ']'
+		{ 0x00, 0x00, 0x08, 0x14, 0x22, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '^'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00 }, // '_'
+		{ 0x30, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '`'
+		{ 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x02, 0x3E, 0x42, 0x42, 0x46, 0x3A, 0x00, 0x00, 0x00, 0x00 }, // 'a'
+		{ 0x00, 0x40, 0x40, 0x40, 0x7C, 0x64, 0x42, 0x42, 0x42, 0x42, 0x64, 0x5C, 0x00, 0x00, 0x00, 0x00 }, // 'b'
+		{ 0x00, 0x00, 0x00, 0x00, 0x1C, 0x22, 0x40, 0x40, 0x40, 0x40, 0x22, 0x1C, 0x00, 0x00, 0x00, 0x00 }, // 'c'
+		{ 0x00, 0x02, 0x02, 0x02, 0x3E, 0x26, 0x42, 0x42, 0x42, 0x42, 0x26, 0x3A, 0x00, 0x00, 0x00, 0x00 }, // 'd'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3C, 0x26, 0x42, 0x7E, 0x40, 0x40, 0x22, 0x1C, 0x00, 0x00, 0x00, 0x00 }, // 'e'
+		{ 0x00, 0x0E, 0x10, 0x10, 0x7E, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00 }, // 'f'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3A, 0x26, 0x42, 0x42, 0x42, 0x42, 0x26, 0x3A, 0x02, 0x22, 0x1C, 0x00 }, // 'g'
+		{ 0x00, 0x40, 0x40, 0x40, 0x5C, 0x62, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00, 0x00 }, // 'h'
+		{ 0x00, 0x08, 0x08, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // 'i'
+		{ 0x00, 0x08, 0x08, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x70, 0x00 }, // 'j'
+		{ 0x00, 0x40, 0x40, 0x40, 0x44, 0x48, 0x50, 0x70, 0x48, 0x48, 0x44, 0x42, 0x00, 0x00, 0x00, 0x00 }, // 'k'
+		{ 0x00, 0xF0, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0E, 0x00, 0x00, 0x00, 0x00 }, // 'l'
+		{ 0x00, 0x00, 0x00, 0x00, 0x7E, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00, 0x00, 0x00, 0x00 }, // 'm'
+		{ 0x00, 0x00, 0x00, 0x00, 0x5C, 0x62, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00, 0x00 }, // 'n'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3C, 0x66, 0x42, 0x42, 0x42, 0x42, 0x66, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // 'o'
+		{ 0x00, 0x00, 0x00, 0x00, 0x5C, 0x64, 0x42, 0x42, 0x42, 0x42, 0x64, 0x7C, 0x40, 0x40, 0x40, 0x00 }, // 'p'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3A, 0x26, 0x42, 0x42, 0x42, 0x42, 0x26, 0x3A, 0x02, 0x02, 0x02, 0x00 }, // 'q'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3C, 0x32, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00 }, // 'r'
+		{ 0x00, 0x00, 0x00, 0x00, 0x3C, 0x42, 0x40, 0x70, 0x0E, 0x02, 0x42, 0x3C, 0x00, 0x00, 0x00, 0x00 }, // 's'
+		{ 0x00, 0x00, 0x10, 0x10, 0x7E, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x0E, 0x00, 0x00, 0x00, 0x00 }, // 't'
+		{ 0x00, 0x00, 0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x46, 0x3A, 0x00, 0x00, 0x00, 0x00 }, // 'u'
+		{ 0x00, 0x00, 0x00, 0x00, 0x42, 0x42, 0x24, 0x24, 0x24, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00 }, // 'v'
+		{ 0x00, 0x00, 0x00, 0x00, 0x81, 0x81, 0x5A, 0x5A, 0x5A, 0x5A, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00 }, // 'w'
+		{ 0x00, 0x00, 0x00, 0x00, 0x42, 0x24, 0x18, 0x18, 0x18, 0x24, 0x24, 0x42, 0x00, 0x00, 0x00, 0x00 }, // 'x'
+		{ 0x00, 0x00, 0x00, 0x00, 0x42, 0x22, 0x24, 0x24, 0x14, 0x18, 0x08, 0x08, 0x08, 0x10, 0x30, 0x00 }, // 'y'
+		{ 0x00, 0x00, 0x00, 0x00, 0x7E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x7E, 0x00, 0x00, 0x00, 0x00 }, // 'z'
+		{ 0x00, 0x06, 0x08, 0x08, 0x08, 0x08, 0x08, 0x30, 0x08, 0x08, 0x08, 0x08, 0x08, 0x06, 0x00, 0x00 }, // '{'
+		{ 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00 }, // '|'
+		{ 0x00, 0x30, 0x08, 0x08, 0x08, 0x08, 0x08, 0x06, 0x08, 0x08, 0x08, 0x08, 0x08, 0x30, 0x00, 0x00 }, // '}'
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x46, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '~'
+	};
+
+	// 脚本消息：due 为虚拟时钟到期时间；viaWndProc 表示经窗口过程分发而非进入 EasyX 队列
+	struct ScriptMsg
+	{
+		ExMessage msg;
+		ULONGLONG due;
+		bool viaWndProc;
+	};
+
+	// 光栅化所需的全部绘图状态：分块帧录制图元时按值快照，工作线程只读快照
+	struct DrawState
+	{
+		COLORREF lineColor = WHITE;
+		COLORREF fillColor = WHITE;
+		COLORREF textColor = WHITE;
+		COLORREF bkColor = BLACK;
+		int bkMode = OPAQUE;
+		LINESTYLE lineStyle;
+		std::vector<DWORD> userStyle;        // PS_USERSTYLE 的段长副本
+		FILLSTYLE fillStyle;
+		LOGFONT font;
+		bool glyphAtlas = true;              // 文本经字形图集绘制（关闭时逐像素光栅化，用于对比）
+
+		DrawState()
+		{
+			font.lfHeight = 16;
+			font.lfWeight = FW_NORMAL;
+		}
+
+		bool sameAs(const DrawState& o) const
+		{
+			return lineColor == o.lineColor && fillColor == o.fillColor && textColor == o.textColor && bkColor == o.bkColor
+				&& bkMode == o.bkMode && lineStyle.style == o.lineStyle.style && lineStyle.thickness == o.lineStyle.thickness
+				&& userStyle == o.userStyle && fillStyle.style == o.fillStyle.style && fillStyle.hatch == o.fillStyle.hatch
+				&& fillStyle.ppattern == o.fillStyle.ppattern && std::memcmp(&font, &o.font, sizeof(LOGFONT)) == 0
+				&& glyphAtlas == o.glyphAtlas;
+		}
+	};
+
+	enum class ShapeKind { Rect, Ellipse, RoundRect };
+
+	// 闭区间外接框 + 圆角椭圆的直径（仅 RoundRect 使用）
+	struct Shape
+	{
+		ShapeKind kind;
+		int l, t, r, b;
+		double ew, eh;
+	};
+
+	// 分块帧中录制的一条屏幕图元
+	struct DeferredCmd
+	{
+		enum class Kind : std::uint8_t { Shape, Line, Text, Pixel, Image, Clear };
+		Kind kind = Kind::Shape;
+		bool fill = false, border = false, clear = false;
+		std::uint32_t state = 0;             // TileBatch::states 下标
+		std::int32_t clip = -1;              // TileBatch::clips 下标；-1 表示不裁剪
+		RECT bounds{ 0, 0, 0, 0 };           // 可能写到的屏幕范围（半开），用于分箱
+		Shape shape{ ShapeKind::Rect, 0, 0, 0, 0, 0, 0 };
+		int a = 0, b = 0, c = 0, d = 0;      // Line: x1,y1,x2,y2；Text/Pixel: x,y；Image: dstX,dstY,w,h
+		int srcX = 0, srcY = 0;
+		std::uint32_t text = 0, textLen = 0; // TileBatch::text 中的区段
+		const IMAGE* image = nullptr;
+		DWORD value = 0;                     // Pixel: 像素值；Image: 光栅操作码
+	};
+
+	// 分块帧：UI 线程录制屏幕图元，提交时按块分箱、线程池并行光栅化
+	struct TileBatch
+	{
+		bool active = false;
+		bool flushing = false;
+		int tileSize = 128;
+		std::vector<DeferredCmd> cmds;
+		std::vector<DrawState> states;
+		std::vector<std::vector<RECT>> clips;
+		std::string text;
+		std::vector<const IMAGE*> sources;   // 待执行图元引用的源表面（putimage 源、图案画刷）
+		std::vector<std::vector<std::uint32_t>> bins;
+		StellarX::Headless::TileStats stats;
+	};
+
+	// 过绘制统计：开启后屏幕上每个像素一个写入计数器，每次提交(present)结算为一帧
+	struct OverdrawState
+	{
+		bool enabled = false;
+		int w = 0;
+		int h = 0;
+		std::vector<std::uint32_t> heat;     // 当前帧的逐像素写入次数
+		std::vector<std::uint32_t> last;     // 最近一个有写入的帧（dumpOverdrawPPM 导出）
+		int lastW = 0;
+		int lastH = 0;
+		std::uint64_t bytesAtFrameStart = 0; // 帧开始时的 Stats::bytesWritten
+		std::vector<StellarX::Headless::OverdrawFrame> frames;
+	};
+
+	struct HeadlessState : DrawState
+	{
+		TileBatch tiles;                     // 放在 screen 之前：析构 screen 时仍可查询
+		OverdrawState overdraw;
+		SxHeadlessWindow window;
+		bool windowOpen = false;
+		std::unique_ptr<IMAGE> screen;
+		std::unique_ptr<IMAGE> front;        // 已提交(present)的可见帧：FlushBatchDraw/EndBatchDraw 时按提交矩形从 screen 拷入
+		IMAGE* working = nullptr;            // nullptr 表示屏幕
+
+		bool batching = false;
+
+		bool clipping = false;
+		IMAGE* clipTarget = nullptr;         // 裁剪所属的表面（设置时的绘图目标）
+		std::vector<RECT> clip;
+
+		std::deque<ScriptMsg> queue;
+		ULONGLONG lastDue = 0;
+		ULONGLONG clock = 0;
+		bool autoClose = true;
+		bool lbutton = false;
+		bool mbutton = false;
+		bool rbutton = false;
+		POINT cursor{ 0, 0 };
+		std::deque<std::pair<std::string, bool>> inputReplies;
+
+		StellarX::Headless::Stats stats;
+	};
+
+	HeadlessState& state()
+	{
+		static HeadlessState s;
+		return s;
+	}
+
+	// 当前绘制目标的裸视图
+	struct Surface
+	{
+		DWORD* px;
+		int w;
+		int h;
+		const std::vector<RECT>* clip;   // nullptr 表示不裁剪
+		RECT window;                     // 可写窗口（半开）：默认整个表面，分块光栅化时为当前块
+		StellarX::Headless::Stats* stats;
+		std::uint32_t* heat;             // 过绘制计数（与 px 同尺寸）；仅屏幕且统计开启时非空
+	};
+
+	// 屏幕的过绘制计数缓冲；统计关闭或 img 不是屏幕时返回 nullptr。屏幕尺寸变化时清零重建
+	std::uint32_t* heatFor(const IMAGE* img)
+	{
+		auto& st = state();
+		auto& od = st.overdraw;
+		if (!od.enabled || !img || img != st.screen.get()) return nullptr;
+		if (od.w != img->getwidth() || od.h != img->getheight())
+		{
+			od.w = img->getwidth();
+			od.h = img->getheight();
+			od.heat.assign((std::size_t)od.w * od.h, 0);
+		}
+		return od.heat.empty() ? nullptr : od.heat.data();
+	}
+
+	Surface surfaceOf(IMAGE* img)
+	{
+		if (!img) return { nullptr, 0, 0, nullptr, RECT{ 0, 0, 0, 0 }, &state().stats, nullptr };
+		return { GetImageBuffer(img), img->getwidth(), img->getheight(), nullptr,
+			RECT{ 0, 0, img->getwidth(), img->getheight() }, &state().stats, heatFor(img) };
+	}
+
+	// 记录 y 行 [a, b] 被写入一次（过绘制统计关闭时为空操作）
+	inline void countSpan(const Surface& s, int y, int a, int b)
+	{
+		if (!s.heat) return;
+		std::uint32_t* h = s.heat + (std::size_t)y * s.w;
+		for (int x = a; x <= b; ++x) ++h[x];
+	}
+
+	void flushTiles();
+
+	// 表面即将被直接读写：若仍有引用它（或屏幕）的待执行分块图元，先全部光栅化
+	void syncImage(const IMAGE* img)
+	{
+		auto& tb = state().tiles;
+		if (tb.cmds.empty() || tb.flushing) return;
+		if (img == state().screen.get() || std::find(tb.sources.begin(), tb.sources.end(), img) != tb.sources.end())
+			flushTiles();
+	}
+
+	// 立即执行的绘制目标（分块帧中的屏幕图元不经此处，而是录制）
+	Surface target()
+	{
+		auto& st = state();
+		IMAGE* img = st.working ? st.working : st.screen.get();
+		syncImage(img);
+		Surface s = surfaceOf(img);
+		if (st.clipping && img == st.clipTarget) s.clip = &st.clip;
+		return s;
+	}
+
+	inline DWORD toPixel(COLORREF c) { return (DWORD)BGR(c) & 0x00FFFFFF; }
+	inline COLORREF toColor(DWORD p) { return (COLORREF)BGR(p) & 0x00FFFFFF; }
+
+	inline bool clipSpan(const Surface& s, int y, int& x0, int& x1)
+	{
+		if (!s.px || y < s.window.top || y >= s.window.bottom) return false;
+		if (x0 < s.window.left) x0 = s.window.left;
+		if (x1 >= s.window.right) x1 = s.window.right - 1;
+		return x0 <= x1;
+	}
+
+	// 把 [x0, x1] 按表面边界与裁剪矩形切成若干段，逐段回调 f(a, b)
+	template <class F>
+	void forClipped(const Surface& s, int y, int x0, int x1, F&& f)
+	{
+		if (!clipSpan(s, y, x0, x1)) return;
+		if (!s.clip)
+		{
+			f(x0, x1);
+			return;
+		}
+		for (const RECT& r : *s.clip)
+		{
+			if (y < r.top || y >= r.bottom) continue;
+			const int a = (std::max)(x0, (int)r.left);
+			const int b = (std::min)(x1, (int)r.right - 1);
+			if (a <= b) f(a, b);
+		}
+	}
+
+	void fillSpan(const Surface& s, int y, int x0, int x1, DWORD px)
+	{
+		DWORD* row = s.px + (std::size_t)y * s.w;
+		forClipped(s, y, x0, x1, [&](int a, int b)
+			{
+				StellarX::Pixel::fill(row + a, (std::size_t)(b - a + 1), px);
+				s.stats->bytesWritten += (std::uint64_t)(b - a + 1) * 4;
+				countSpan(s, y, a, b);
+			});
+	}
+
+	inline bool inClip(const Surface& s, int x, int y)
+	{
+		if (!s.clip) return true;
+		for (const RECT& r : *s.clip)
+			if (x >= r.left && x < r.right && y >= r.top && y < r.bottom) return true;
+		return false;
+	}
+
+	inline void plot(const Surface& s, int x, int y, DWORD px)
+	{
+		if (!s.px || x < s.window.left || y < s.window.top || x >= s.window.right || y >= s.window.bottom || !inClip(s, x, y)) return;
+		s.px[(std::size_t)y * s.w + x] = px;
+		s.stats->bytesWritten += 4;
+		if (s.heat) ++s.heat[(std::size_t)y * s.w + x];
+	}
+
+	/* ---------------- 画刷（填充样式） ---------------- */
+
+	inline bool hatchHit(long hatch, int x, int y)
+	{
+		switch (hatch)
+		{
+		case HS_HORIZONTAL: return (y & 7) == 0;
+		case HS_VERTICAL:   return (x & 7) == 0;
+		case HS_FDIAGONAL:  return ((x - y) & 7) == 0;
+		case HS_BDIAGONAL:  return ((x + y) & 7) == 0;
+		case HS_CROSS:      return (x & 7) == 0 || (y & 7) == 0;
+		case HS_DIAGCROSS:  return ((x - y) & 7) == 0 || ((x + y) & 7) == 0;
+		default:            return false;
+		}
+	}
+
+	// 用当前画刷填充一行区间；clear=true 时以背景色实心填充（clear* 系列）
+	void brushSpan(const Surface& s, const DrawState& st, int y, int x0, int x1, bool clear)
+	{
+		if (clear)
+		{
+			fillSpan(s, y, x0, x1, toPixel(st.bkColor));
+			return;
+		}
+		const FILLSTYLE& fs = st.fillStyle;
+		if (fs.style == BS_NULL) return;
+		if (fs.style == BS_HATCHED)
+		{
+			const DWORD fg = toPixel(st.fillColor);
+			const DWORD bg = toPixel(st.bkColor);
+			const bool opaque = st.bkMode == OPAQUE;
+			DWORD* row = s.px + (std::size_t)y * s.w;
+			forClipped(s, y, x0, x1, [&](int a, int b)
+				{
+					for (int x = a; x <= b; ++x)
+					{
+						if (hatchHit(fs.hatch, x, y)) { row[x] = fg; s.stats->bytesWritten += 4; }
+						else if (opaque) { row[x] = bg; s.stats->bytesWritten += 4; }
+						else continue;
+						if (s.heat) ++s.heat[(std::size_t)y * s.w + x];
+					}
+				});
+			return;
+		}
+		if ((fs.style == BS_PATTERN || fs.style == BS_DIBPATTERN) && fs.ppattern
+			&& fs.ppattern->getwidth() > 0 && fs.ppattern->getheight() > 0)
+		{
+			// 与 GDI 一致：图案画刷以设备原点(0,0)为对齐基准平铺
+			const int pw = fs.ppattern->getwidth(), ph = fs.ppattern->getheight();
+			const DWORD* prow = GetImageBuffer(fs.ppattern) + (std::size_t)(y % ph) * pw;
+			DWORD* row = s.px + (std::size_t)y * s.w;
+			forClipped(s, y, x0, x1, [&](int a, int b)
+				{
+					for (int x = a; x <= b; ++x)
+						row[x] = prow[x % pw];
+					s.stats->bytesWritten += (std::uint64_t)(b - a + 1) * 4;
+					s.stats->bytesRead += (std::uint64_t)(b - a + 1) * 4;
+					countSpan(s, y, a, b);
+				});
+			return;
+		}
+		fillSpan(s, y, x0, x1, toPixel(st.fillColor));
+	}
+
+	/* ---------------- 画笔（线型） ---------------- */
+
+	// 返回当前线型的段长序列（亮/暗交替）；实线返回空
+	const std::vector<DWORD>& dashPattern(const DrawState& st)
+	{
+		static const std::vector<DWORD> kNone;
+		static const std::vector<DWORD> kDash{ 12, 4 };
+		static const std::vector<DWORD> kDot{ 2, 2 };
+		static const std::vector<DWORD> kDashDot{ 8, 3, 2, 3 };
+		static const std::vector<DWORD> kDashDotDot{ 8, 3, 2, 3, 2, 3 };
+		switch (st.lineStyle.style & 0x0F)
+		{
+		case PS_DASH:       return kDash;
+		case PS_DOT:        return kDot;
+		case PS_DASHDOT:    return kDashDot;
+		case PS_DASHDOTDOT: return kDashDotDot;
+		case PS_USERSTYLE:  return st.userStyle;
+		default:            return kNone;
+		}
+	}
+
+	inline bool dashOn(const std::vector<DWORD>& pat, int pos)
+	{
+		if (pat.empty()) return true;
+		DWORD period = 0;
+		for (DWORD d : pat) period += d;
+		if (period == 0) return true;
+		DWORD p = (DWORD)(((long long)pos % period + period) % period);
+		for (std::size_t i = 0; i < pat.size(); ++i)
+		{
+			if (p < pat[i]) return (i & 1) == 0;
+			p -= pat[i];
+		}
+		return true;
+	}
+
+	inline bool penNull(const DrawState& st) { return (st.lineStyle.style & 0x0F) == PS_NULL; }
+	inline int penWidth(const DrawState& st) { return (std::max)(1, (int)st.lineStyle.thickness); }
+
+	// 以画笔颜色写一段边框；pos 决定虚线相位（水平边用 x，竖直边用 y）
+	void penSpan(const Surface& s, const DrawState& st, int y, int x0, int x1, bool horizontal)
+	{
+		const auto& pat = dashPattern(st);
+		const DWORD px = toPixel(st.lineColor);
+		if (pat.empty())
+		{
+			fillSpan(s, y, x0, x1, px);
+			return;
+		}
+		for (int x = x0; x <= x1; ++x)
+			if (dashOn(pat, horizontal ? x : y))
+				plot(s, x, y, px);
+	}
+
+	/* ---------------- 形状：逐行区间 ---------------- */
+
+	Shape inflate(const Shape& sh, int d)
+	{
+		Shape o = sh;
+		o.l -= d; o.t -= d; o.r += d; o.b += d;
+		if (o.kind == ShapeKind::RoundRect)
+		{
+			o.ew = (std::max)(0.0, o.ew + 2.0 * d);
+			o.eh = (std::max)(0.0, o.eh + 2.0 * d);
+		}
+		return o;
+	}
+
+	// 计算形状在第 y 行覆盖的像素区间 [xl, xr]（以像素中心是否落入形状判定）
+	bool rowSpan(const Shape& sh, int y, int& xl, int& xr)
+	{
+		if (sh.l > sh.r || sh.t > sh.b || y < sh.t || y > sh.b) return false;
+
+		if (sh.kind == ShapeKind::Rect)
+		{
+			xl = sh.l; xr = sh.r;
+			return true;
+		}
+
+		if (sh.kind == ShapeKind::Ellipse)
+		{
+			const double A = (sh.r - sh.l + 1) / 2.0;
+			const double B = (sh.b - sh.t + 1) / 2.0;
+			const double cx = (sh.l + sh.r) / 2.0;
+			const double cy = (sh.t + sh.b) / 2.0;
+			const double dy = (y - cy) / B;
+			const double half = A * std::sqrt((std::max)(0.0, 1.0 - dy * dy));
+			xl = (int)std::ceil(cx - half);
+			xr = (int)std::floor(cx + half);
+			if (xl > xr) xl = xr = (int)std::lround(cx);
+			return true;
+		}
+
+		// RoundRect：四角为半轴 (ew/2, eh/2) 的椭圆弧
+		const double rx = (std::min)(sh.ew, (double)(sh.r - sh.l + 1)) / 2.0;
+		const double ry = (std::min)(sh.eh, (double)(sh.b - sh.t + 1)) / 2.0;
+		xl = sh.l; xr = sh.r;
+		if (rx <= 0.0 || ry <= 0.0) return true;
+
+		const double topC = sh.t + ry - 0.5;
+		const double botC = sh.b - ry + 0.5;
+		double dy = 0.0;
+		if (y < topC) dy = topC - y;
+		else if (y > botC) dy = y - botC;
+		if (dy <= 0.0) return true;
+
+		const double k = dy / ry;
+		const double half = rx * std::sqrt((std::max)(0.0, 1.0 - k * k));
+		xl = (int)std::ceil((sh.l + rx - 0.5) - half);
+		xr = (int)std::floor((sh.r - rx + 0.5) + half);
+		if (xl > xr) xl = xr = (sh.l + sh.r) / 2;
+		return true;
+	}
+
+	// 绘制形状：fill 用画刷（或背景色）填充内部，border 用画笔描边
+	void rasterShape(const Surface& s, const DrawState& st, const Shape& sh, bool fill, bool border, bool clear)
+	{
+		// 快速路径：实心画刷 + 实线边框的矩形（按钮/面板背景），无裁剪时
+		// 外框内每个像素只写一次：外圈 penWidth 像素为边框，其余为填充
+		if (sh.kind == ShapeKind::Rect && fill && border && !s.clip && !penNull(st) && dashPattern(st).empty()
+			&& (clear || st.fillStyle.style == BS_SOLID) && sh.l <= sh.r && sh.t <= sh.b)
+		{
+			const int w = penWidth(st);
+			const Shape outer = inflate(sh, (w - 1) / 2);
+			const int ow = outer.r - outer.l + 1, oh = outer.b - outer.t + 1;
+			const DWORD fillPx = toPixel(clear ? st.bkColor : st.fillColor), linePx = toPixel(st.lineColor);
+			const RECT& win = s.window;
+			if (outer.l >= win.left && outer.t >= win.top && outer.r < win.right && outer.b < win.bottom)
+			{
+				StellarX::Pixel::fillRectBordered(s.px + (std::size_t)outer.t * s.w + outer.l, s.w, ow, oh, fillPx, linePx, w);
+				s.stats->bytesWritten += (std::uint64_t)ow * oh * 4;
+				for (int y = outer.t; s.heat && y <= outer.b; ++y)
+					countSpan(s, y, outer.l, outer.r);
+				return;
+			}
+			// 跨出可写窗口（贴边或跨块）：按同样的边框/内部划分，只写窗口内的部分
+			const int xa = (std::max)(outer.l, (int)win.left), xb = (std::min)(outer.r, (int)win.right - 1);
+			std::uint64_t bytes = 0;
+			for (int y = (std::max)(outer.t, (int)win.top); xa <= xb && y <= (std::min)(outer.b, (int)win.bottom - 1); ++y)
+			{
+				DWORD* row = s.px + (std::size_t)y * s.w;
+				auto segment = [&](int a, int b, DWORD px)
+					{
+						a = (std::max)(a, xa);
+						b = (std::min)(b, xb);
+						if (a > b) return;
+						StellarX::Pixel::fill(row + a, (std::size_t)(b - a + 1), px);
+						bytes += (std::uint64_t)(b - a + 1) * 4;
+						countSpan(s, y, a, b);
+					};
+				if (y - outer.t < w || outer.b - y < w || ow <= 2 * w)
+				{
+					segment(outer.l, outer.r, linePx);
+					continue;
+				}
+				segment(outer.l, outer.l + w - 1, linePx);
+				segment(outer.l + w, outer.r - w, fillPx);
+				segment(outer.r - w + 1, outer.r, linePx);
+			}
+			s.stats->bytesWritten += bytes;
+			return;
+		}
+
+		// 快速路径：只填充不描边的实心矩形（表格底色与网格线等），无裁剪时逐行直接写，不经区间裁剪回调
+		if (sh.kind == ShapeKind::Rect && fill && (!border || penNull(st)) && !s.clip
+			&& (clear || st.fillStyle.style == BS_SOLID))
+		{
+			const RECT& win = s.window;
+			const int l = (std::max)(sh.l, (int)win.left), t = (std::max)(sh.t, (int)win.top);
+			const int r = (std::min)(sh.r, (int)win.right - 1), b = (std::min)(sh.b, (int)win.bottom - 1);
+			if (l > r || t > b) return;
+			StellarX::Pixel::fillRect(s.px + (std::size_t)t * s.w + l, s.w, r - l + 1, b - t + 1, toPixel(clear ? st.bkColor : st.fillColor));
+			s.stats->bytesWritten += (std::uint64_t)(r - l + 1) * (b - t + 1) * 4;
+			for (int y = t; s.heat && y <= b; ++y)
+				countSpan(s, y, l, r);
+			return;
+		}
+
+		// 快速路径：只描边、不填充的实线矩形（表格网格），四条边各按实心矩形直接写。
+		// 与下面的逐行描边像素相同：外框向外 (w-1)/2，每侧共 w 像素；内部放不下时整块都是边框。
+		// 裁剪区域由互不重叠的矩形组成，逐个求交即可
+		if (sh.kind == ShapeKind::Rect && border && !penNull(st) && dashPattern(st).empty()
+			&& (!fill || (!clear && st.fillStyle.style == BS_NULL)) && sh.l <= sh.r && sh.t <= sh.b)
+		{
+			const int w = penWidth(st);
+			const Shape outer = inflate(sh, (w - 1) / 2);
+			const DWORD linePx = toPixel(st.lineColor);
+			auto write = [&](int l, int t, int r, int b, const RECT& lim)
+				{
+					l = (std::max)(l, (int)lim.left); t = (std::max)(t, (int)lim.top);
+					r = (std::min)(r, (int)lim.right - 1); b = (std::min)(b, (int)lim.bottom - 1);
+					if (l > r || t > b) return;
+					StellarX::Pixel::fillRect(s.px + (std::size_t)t * s.w + l, s.w, r - l + 1, b - t + 1, linePx);
+					s.stats->bytesWritten += (std::uint64_t)(r - l + 1) * (b - t + 1) * 4;
+					for (int y = t; s.heat && y <= b; ++y)
+						countSpan(s, y, l, r);
+				};
+			auto band = [&](int l, int t, int r, int b)
+				{
+					const RECT& win = s.window;
+					l = (std::max)(l, (int)win.left); t = (std::max)(t, (int)win.top);
+					r = (std::min)(r, (int)win.right - 1); b = (std::min)(b, (int)win.bottom - 1);
+					if (!s.clip) { write(l, t, r, b, win); return; }
+					for (const RECT& c : *s.clip)
+						write(l, t, r, b, c);
+				};
+			if (outer.r - outer.l + 1 <= 2 * w || outer.b - outer.t + 1 <= 2 * w)
+				band(outer.l, outer.t, outer.r, outer.b);
+			else
+			{
+				band(outer.l, outer.t, outer.r, outer.t + w - 1);
+				band(outer.l, outer.b - w + 1, outer.r, outer.b);
+				band(outer.l, outer.t + w, outer.l + w - 1, outer.b - w);
+				band(outer.r - w + 1, outer.t + w, outer.r, outer.b - w);
+			}
+			return;
+		}
+
+		if (fill)
+		{
+			for (int y = (std::max)(sh.t, (int)s.window.top); y <= (std::min)(sh.b, (int)s.window.bottom - 1); ++y)
+			{
+				int xl, xr;
+				if (rowSpan(sh, y, xl, xr)) brushSpan(s, st, y, xl, xr, clear);
+			}
+		}
+
+		if (!border || penNull(st)) return;
+
+		// 线宽以轮廓为中心：向外 (w-1)/2，向内其余部分
+		const int w = penWidth(st);
+		const int out = (w - 1) / 2;
+		const int in = w - 1 - out;
+		const Shape outer = inflate(sh, out);
+		const Shape inner = inflate(sh, -(in + 1));
+
+		for (int y = (std::max)(outer.t, (int)s.window.top); y <= (std::min)(outer.b, (int)s.window.bottom - 1); ++y)
+		{
+			int ol, orr;
+			if (!rowSpan(outer, y, ol, orr)) continue;
+			int il, ir;
+			if (!rowSpan(inner, y, il, ir) || il > ir)
+			{
+				penSpan(s, st, y, ol, orr, true);
+				continue;
+			}
+			// 保证每侧至少 1 像素，避免陡峭弧段出现断点
+			if (il <= ol) il = ol + 1;
+			if (ir >= orr) ir = orr - 1;
+			penSpan(s, st, y, ol, il - 1, false);
+			penSpan(s, st, y, ir + 1, orr, false);
+		}
+	}
+
+	void rasterLine(const Surface& s, const DrawState& st, int x1, int y1, int x2, int y2)
+	{
+		const auto& pat = dashPattern(st);
+		const DWORD px = toPixel(st.lineColor);
+		const int w = penWidth(st);
+		const int lo = -(w - 1) / 2;
+		const int hi = lo + w - 1;
+
+		// Bresenham；线宽按方形笔刷展开
+		const int dx = std::abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+		const int dy = -std::abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+		int err = dx + dy;
+		int step = 0;
+		for (;;)
+		{
+			if (dashOn(pat, step))
+			{
+				if (w == 1) plot(s, x1, y1, px);
+				else for (int oy = lo; oy <= hi; ++oy) fillSpan(s, y1 + oy, x1 + lo, x1 + hi, px);
+			}
+			if (x1 == x2 && y1 == y2) break;
+			const int e2 = 2 * err;
+			if (e2 >= dy) { err += dy; x1 += sx; }
+			if (e2 <= dx) { err += dx; y1 += sy; }
+			++step;
+		}
+	}
+
+	// 以背景色填满可写窗口（受裁剪约束）：cleardevice 与 clearcliprgn 共用
+	void rasterClear(const Surface& s, const DrawState& st)
+	{
+		const DWORD px = toPixel(st.bkColor);
+		for (int y = s.window.top; y < s.window.bottom; ++y)
+			fillSpan(s, y, s.window.left, s.window.right - 1, px);
+	}
+
+	/* ---------------- 文本 ---------------- */
+
+	struct FontMetrics
+	{
+		int h;       // 字符单元高度
+		int narrow;  // 半角字符宽度（全角为其两倍）
+	};
+
+	FontMetrics fontMetrics(const LOGFONT& f)
+	{
+		FontMetrics m;
+		m.h = f.lfHeight != 0 ? std::abs((int)f.lfHeight) : 16;
+		m.narrow = f.lfWidth > 0 ? (int)f.lfWidth : (std::max)(1, (m.h + 1) / 2);
+		return m;
+	}
+
+	FontMetrics fontMetrics() { return fontMetrics(state().font); }
+
+	// 解码一个字符，返回其字节数；wide 表示全角。
+	// 规则：ASCII 单字节；合法的 3/4 字节 UTF-8 序列整体为一个全角字符；
+	//       其余高位字节按 GBK 双字节处理（首字节 0x81~0xFE，尾字节 0x40~0xFE 且非 0x7F）。
+	std::size_t decodeChar(const unsigned char* p, std::size_t n, bool& wide, unsigned& code)
+	{
+		const unsigned char c = p[0];
+		if (c < 0x80)
+		{
+			wide = false; code = c;
+			return 1;
+		}
+		auto cont = [&](std::size_t i) { return i < n && (p[i] & 0xC0) == 0x80; };
+		if ((c & 0xF0) == 0xE0 && cont(1) && cont(2))
+		{
+			wide = true; code = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+			return 3;
+		}
+		if ((c & 0xF8) == 0xF0 && cont(1) && cont(2) && cont(3))
+		{
+			wide = true; code = ((c & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+			return 4;
+		}
+		if (c >= 0x81 && c <= 0xFE && n >= 2 && p[1] >= 0x40 && p[1] <= 0xFE && p[1] != 0x7F)
+		{
+			wide = true; code = (c << 8) | p[1];
+			return 2;
+		}
+		wide = false; code = '?';
+		return 1;
+	}
+
+	int measure(const char* str, std::size_t n, const FontMetrics& m)
+	{
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+		int w = 0;
+		std::size_t i = 0;
+		while (i < n)
+		{
+			bool wide; unsigned code;
+			i += decodeChar(p + i, n - i, wide, code);
+			w += wide ? m.narrow * 2 : m.narrow;
+		}
+		return w;
+	}
+
+	int measure(const char* str, std::size_t n) { return measure(str, n, fontMetrics()); }
+
+	void drawGlyph(const Surface& s, const DrawState& st, int x, int y, unsigned code, bool wide, const FontMetrics& m, DWORD px)
+	{
+		const LOGFONT& f = st.font;
+		const bool bold = f.lfWeight >= 600;
+		const int adv = wide ? m.narrow * 2 : m.narrow;
+
+		for (int py = 0; py < m.h; ++py)
+		{
+			const int shear = f.lfItalic ? (m.h - 1 - py) / 5 : 0;
+			if (wide)
+			{
+				// 全角字符：以占位方框表示（内缩 1 像素的空心框）
+				if (py == 1 || py == m.h - 2)
+				{
+					for (int px_ = 1; px_ < adv - 1; ++px_) plot(s, x + px_ + shear, y + py, px);
+				}
+				else if (py > 1 && py < m.h - 2)
+				{
+					plot(s, x + 1 + shear, y + py, px);
+					plot(s, x + adv - 2 + shear, y + py, px);
+				}
+				continue;
+			}
+			if (code < 0x21 || code > 0x7E) continue;
+			const unsigned char bits = kFont8x16[code - 0x20][py * 16 / m.h];
+			if (!bits) continue;
+			for (int gx = 0; gx < adv; ++gx)
+			{
+				if (bits & (0x80 >> (gx * 8 / adv)))
+				{
+					plot(s, x + gx + shear, y + py, px);
+					if (bold) plot(s, x + gx + shear + 1, y + py, px);
+				}
+			}
+		}
+	}
+
+	/* ---------------- 字形图集 ---------------- */
+
+	// 字形覆盖按行压成的水平游程：相对字形原点，[x0, x1] 为闭区间
+	struct GlyphRun
+	{
+		int dy;
+		int x0;
+		int x1;
+	};
+
+	struct Glyph
+	{
+		std::uint32_t first;   // 在 GlyphAtlas::runs 中的起始下标
+		std::uint32_t count;
+		int advance;
+		int extent;            // 覆盖的最大宽度（含斜体错切与粗体外扩）
+	};
+
+	struct GlyphAtlas
+	{
+		std::unordered_map<std::uint64_t, Glyph> glyphs;
+		std::vector<GlyphRun> runs;
+	};
+
+	GlyphAtlas& glyphAtlas()
+	{
+		static GlyphAtlas atlas;
+		return atlas;
+	}
+
+	constexpr std::size_t kMaxAtlasRuns = 1u << 20;   // 约 12 MiB；超出时整体清空重建
+
+	// 与 drawGlyph 完全相同的覆盖，只是写入行掩码而非表面，再压成游程
+	Glyph rasterizeGlyph(GlyphAtlas& atlas, unsigned code, bool wide, const FontMetrics& m, bool bold, bool italic)
+	{
+		const int adv = wide ? m.narrow * 2 : m.narrow;
+		const int maxShear = italic ? (m.h - 1) / 5 : 0;
+		std::vector<char> row((std::size_t)adv + maxShear + 2);
+
+		Glyph g{ (std::uint32_t)atlas.runs.size(), 0, adv, (int)row.size() };
+		for (int py = 0; py < m.h; ++py)
+		{
+			std::fill(row.begin(), row.end(), 0);
+			const int shear = italic ? (m.h - 1 - py) / 5 : 0;
+			if (wide)
+			{
+				if (py == 1 || py == m.h - 2)
+				{
+					for (int px_ = 1; px_ < adv - 1; ++px_) row[px_ + shear] = 1;
+				}
+				else if (py > 1 && py < m.h - 2)
+				{
+					row[1 + shear] = 1;
+					if (adv - 2 >= 0) row[adv - 2 + shear] = 1;
+				}
+			}
+			else if (code >= 0x21 && code <= 0x7E)
+			{
+				const unsigned char bits = kFont8x16[code - 0x20][py * 16 / m.h];
+				for (int gx = 0; bits && gx < adv; ++gx)
+				{
+					if (bits & (0x80 >> (gx * 8 / adv)))
+					{
+						row[gx + shear] = 1;
+						if (bold) row[gx + shear + 1] = 1;
+					}
+				}
+			}
+
+			for (int gx = 0; gx < (int)row.size();)
+			{
+				if (!row[gx]) { ++gx; continue; }
+				int end = gx;
+				while (end + 1 < (int)row.size() && row[end + 1]) ++end;
+				atlas.runs.push_back(GlyphRun{ py, gx, end });
+				++g.count;
+				gx = end + 1;
+			}
+		}
+		return g;
+	}
+
+	std::uint64_t glyphKey(const DrawState& st, unsigned code, bool wide, const FontMetrics& m)
+	{
+		const bool bold = st.font.lfWeight >= 600;
+		const bool italic = st.font.lfItalic != 0;
+		// 全角字符统一绘制为占位方框，与具体码位无关，共用同一字形
+		return ((std::uint64_t)(m.h & 0xFFFF) << 48) | ((std::uint64_t)(m.narrow & 0xFFFF) << 32)
+			| ((std::uint64_t)bold << 31) | ((std::uint64_t)italic << 30) | ((std::uint64_t)wide << 29)
+			| (wide ? 0u : (code & 0x1FFFFFFFu));
+	}
+
+	// 查找或光栅化字形（只在 UI 线程调用：可能插入图集）
+	const Glyph& glyphFor(const DrawState& st, unsigned code, bool wide, const FontMetrics& m)
+	{
+		auto& stats = state().stats;
+		auto& atlas = glyphAtlas();
+		const std::uint64_t key = glyphKey(st, code, wide, m);
+		auto it = atlas.glyphs.find(key);
+		if (it != atlas.glyphs.end())
+		{
+			++stats.glyphHits;
+			return it->second;
+		}
+		// 分块帧中已录制的文本引用着现有字形：帧内不清空，留到帧外再说
+		if (atlas.runs.size() > kMaxAtlasRuns && !state().tiles.active)
+		{
+			atlas.glyphs.clear();
+			atlas.runs.clear();
+		}
+		++stats.glyphMisses;
+		return atlas.glyphs.emplace(key, rasterizeGlyph(atlas, code, wide, m, st.font.lfWeight >= 600, st.font.lfItalic != 0)).first->second;
+	}
+
+	// 录制文本时在 UI 线程预先备好全部字形，工作线程只读图集；统计与直接绘制一致
+	void prepareGlyphs(const DrawState& st, const char* str, std::size_t n)
+	{
+		if (!st.glyphAtlas) return;
+		const FontMetrics m = fontMetrics(st.font);
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+		std::size_t i = 0;
+		while (i < n)
+		{
+			bool wide; unsigned code;
+			i += decodeChar(p + i, n - i, wide, code);
+			glyphFor(st, code, wide, m);
+		}
+	}
+
+	// prepared 为 true 时字形已由 prepareGlyphs 备好，只查图集（可在工作线程执行）
+	void rasterText(const Surface& s, const DrawState& st, int x, int y, const char* str, std::size_t n, bool prepared)
+	{
+		const FontMetrics m = fontMetrics(st.font);
+		const int total = measure(str, n, m);
+		if (st.bkMode == OPAQUE && total > 0)
+		{
+			for (int yy = y; yy < y + m.h; ++yy)
+				fillSpan(s, yy, x, x + total - 1, toPixel(st.bkColor));
+		}
+
+		const DWORD px = toPixel(st.textColor);
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+		const RECT& win = s.window;
+		int cx = x;
+		std::size_t i = 0;
+		while (i < n)
+		{
+			bool wide; unsigned code;
+			i += decodeChar(p + i, n - i, wide, code);
+			if (st.glyphAtlas)
+			{
+				const Glyph& g = prepared ? glyphAtlas().glyphs.find(glyphKey(st, code, wide, m))->second : glyphFor(st, code, wide, m);
+				const GlyphRun* run = glyphAtlas().runs.data() + g.first;
+				if (!s.clip && cx >= win.left && y >= win.top && cx + g.extent <= win.right && y + m.h <= win.bottom)
+				{
+					// 字形整体落在可写窗口内且无裁剪：直接整段写入
+					std::uint64_t bytes = 0;
+					for (std::uint32_t k = 0; k < g.count; ++k, ++run)
+					{
+						std::fill(s.px + (std::size_t)(y + run->dy) * s.w + cx + run->x0, s.px + (std::size_t)(y + run->dy) * s.w + cx + run->x1 + 1, px);
+						bytes += (std::uint64_t)(run->x1 - run->x0 + 1) * 4;
+						countSpan(s, y + run->dy, cx + run->x0, cx + run->x1);
+					}
+					s.stats->bytesWritten += bytes;
+				}
+				else
+				{
+					for (std::uint32_t k = 0; k < g.count; ++k, ++run)
+						fillSpan(s, y + run->dy, cx + run->x0, cx + run->x1, px);
+				}
+				cx += g.advance;
+			}
+			else
+			{
+				drawGlyph(s, st, cx, y, code, wide, m, px);
+				cx += wide ? m.narrow * 2 : m.narrow;
+			}
+		}
+
+		if (st.font.lfUnderline && total > 0)
+			fillSpan(s, y + m.h * 13 / 16, x, x + total - 1, px);
+		if (st.font.lfStrikeOut && total > 0)
+			fillSpan(s, y + m.h / 2, x, x + total - 1, px);
+	}
+
+	/* ---------------- 图像 ---------------- */
+
+	// 读取 PPM(P6/P5)；成功时返回像素（0x00RRGGBB）
+	bool readPNM(const char* path, std::vector<DWORD>& px, int& w, int& h)
+	{
+		if (!path) return false;
+		FILE* fp = std::fopen(path, "rb");
+		if (!fp) return false;
+
+		auto readToken = [&](int& v) -> bool
+			{
+				int c = std::fgetc(fp);
+				while (c != EOF && (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#'))
+				{
+					if (c == '#') while (c != EOF && c != '\n') c = std::fgetc(fp);
+					c = std::fgetc(fp);
+				}
+				if (c == EOF || c < '0' || c > '9') return false;
+				v = 0;
+				while (c != EOF && c >= '0' && c <= '9') { v = v * 10 + (c - '0'); c = std::fgetc(fp); }
+				return true; // 已消费数字后的单个空白
+			};
+
+		char magic[2] = {};
+		int maxv = 0;
+		bool ok = std::fread(magic, 1, 2, fp) == 2 && magic[0] == 'P' && (magic[1] == '6' || magic[1] == '5')
+			&& readToken(w) && readToken(h) && readToken(maxv) && w > 0 && h > 0 && maxv > 0 && maxv < 256;
+		if (ok)
+		{
+			const int ch = magic[1] == '6' ? 3 : 1;
+			std::vector<unsigned char> raw((std::size_t)w * h * ch);
+			ok = std::fread(raw.data(), 1, raw.size(), fp) == raw.size();
+			if (ok)
+			{
+				px.resize((std::size_t)w * h);
+				for (std::size_t i = 0; i < px.size(); ++i)
+				{
+					const unsigned char* q = &raw[i * ch];
+					const DWORD r = q[0] * 255 / maxv;
+					const DWORD g = q[ch == 3 ? 1 : 0] * 255 / maxv;
+					const DWORD b = q[ch == 3 ? 2 : 0] * 255 / maxv;
+					px[i] = (r << 16) | (g << 8) | b;
+				}
+			}
+		}
+		std::fclose(fp);
+		return ok;
+	}
+
+	bool writePPM(const char* path, const IMAGE* img)
+	{
+		if (!path || !img || img->getwidth() <= 0 || img->getheight() <= 0) return false;
+		FILE* fp = std::fopen(path, "wb");
+		if (!fp) return false;
+		const int w = img->getwidth(), h = img->getheight();
+		std::fprintf(fp, "P6\n%d %d\n255\n", w, h);
+		const DWORD* src = GetImageBuffer(const_cast<IMAGE*>(img));
+		std::vector<unsigned char> row((std::size_t)w * 3);
+		bool ok = true;
+		for (int y = 0; y < h && ok; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				const DWORD p = src[(std::size_t)y * w + x];
+				row[x * 3 + 0] = (unsigned char)(p >> 16);
+				row[x * 3 + 1] = (unsigned char)(p >> 8);
+				row[x * 3 + 2] = (unsigned char)p;
+			}
+			ok = std::fwrite(row.data(), 1, row.size(), fp) == row.size();
+		}
+		std::fclose(fp);
+		return ok;
+	}
+
+	// 按光栅操作码合成一个像素
+	inline DWORD rop(DWORD dst, DWORD src, DWORD code)
+	{
+		switch (code)
+		{
+		case SRCAND:    return dst & src;
+		case SRCPAINT:  return dst | src;
+		case SRCINVERT: return dst ^ src;
+		default:        return src;
+		}
+	}
+
+	void rasterImage(const Surface& d, int dstX, int dstY, int dstWidth, int dstHeight, const IMAGE* src, int srcX, int srcY, DWORD dwRop)
+	{
+		const DWORD* spx = GetImageBuffer(const_cast<IMAGE*>(src));
+		const int sw = src->getwidth(), sh = src->getheight();
+		if (!spx) return;
+
+		// 源与目标同时裁剪
+		int w = (std::min)(dstWidth, sw - srcX);
+		int h = (std::min)(dstHeight, sh - srcY);
+		if (srcX < 0) { dstX -= srcX; w += srcX; srcX = 0; }
+		if (srcY < 0) { dstY -= srcY; h += srcY; srcY = 0; }
+		if (dstX < 0) { srcX -= dstX; w += dstX; dstX = 0; }
+		if (dstY < 0) { srcY -= dstY; h += dstY; dstY = 0; }
+		w = (std::min)(w, d.w - dstX);
+		h = (std::min)(h, d.h - dstY);
+		if (w <= 0 || h <= 0) return;
+
+		std::uint64_t bytes = 0;
+		const int y0 = (std::max)(0, (int)d.window.top - dstY), y1 = (std::min)(h, (int)d.window.bottom - dstY);
+		for (int y = y0; y < y1; ++y)
+		{
+			const DWORD* sp = spx + (std::size_t)(srcY + y) * sw + srcX;
+			DWORD* dp = d.px + (std::size_t)(dstY + y) * d.w + dstX;
+			forClipped(d, dstY + y, dstX, dstX + w - 1, [&](int a, int b)
+				{
+					const int o = a - dstX, n = b - a + 1;
+					if (dwRop == SRCCOPY)
+						StellarX::Pixel::copy(dp + o, sp + o, (std::size_t)n);
+					else
+						for (int x = o; x < o + n; ++x) dp[x] = rop(dp[x], sp[x], dwRop);
+					bytes += (std::uint64_t)n * 4;
+					countSpan(d, dstY + y, a, b);
+				});
+		}
+		d.stats->bytesRead += dwRop == SRCCOPY ? bytes : bytes * 2;
+		d.stats->bytesWritten += bytes;
+	}
+
+	/* ---------------- 分块帧 ---------------- */
+
+	// 分块帧进行中、绘制目标为屏幕时，屏幕图元只录制不光栅化
+	bool deferring()
+	{
+		auto& st = state();
+		return st.tiles.active && !st.tiles.flushing && !st.working && st.screen;
+	}
+
+	bool sameRects(const std::vector<RECT>& a, const std::vector<RECT>& b)
+	{
+		if (a.size() != b.size()) return false;
+		for (std::size_t i = 0; i < a.size(); ++i)
+			if (a[i].left != b[i].left || a[i].top != b[i].top || a[i].right != b[i].right || a[i].bottom != b[i].bottom)
+				return false;
+		return true;
+	}
+
+	// 录制一条屏幕图元：绘图状态与裁剪按值快照（与上一条相同时共用），bounds 为可能写到的范围
+	DeferredCmd& record(DeferredCmd::Kind kind, RECT bounds, bool usesBrush)
+	{
+		auto& st = state();
+		auto& tb = st.tiles;
+		DeferredCmd c;
+		c.kind = kind;
+		if (tb.states.empty() || !tb.states.back().sameAs(st))
+			tb.states.push_back(static_cast<const DrawState&>(st));
+		c.state = (std::uint32_t)(tb.states.size() - 1);
+		if (st.clipping && st.clipTarget == st.screen.get())
+		{
+			if (tb.clips.empty() || !sameRects(tb.clips.back(), st.clip))
+				tb.clips.push_back(st.clip);
+			c.clip = (std::int32_t)(tb.clips.size() - 1);
+			RECT box{ 0, 0, 0, 0 };
+			for (const RECT& r : st.clip)
+			{
+				if (box.left >= box.right) box = r;
+				else
+				{
+					box.left = (std::min)(box.left, r.left);
+					box.top = (std::min)(box.top, r.top);
+					box.right = (std::max)(box.right, r.right);
+					box.bottom = (std::max)(box.bottom, r.bottom);
+				}
+			}
+			bounds.left = (std::max)(bounds.left, box.left);
+			bounds.top = (std::max)(bounds.top, box.top);
+			bounds.right = (std::min)(bounds.right, box.right);
+			bounds.bottom = (std::min)(bounds.bottom, box.bottom);
+		}
+		if (usesBrush && st.fillStyle.ppattern && std::find(tb.sources.begin(), tb.sources.end(), st.fillStyle.ppattern) == tb.sources.end())
+			tb.sources.push_back(st.fillStyle.ppattern);
+		c.bounds = bounds;
+		tb.cmds.push_back(c);
+		return tb.cmds.back();
+	}
+
+	void execute(const Surface& s, const DrawState& ds, const DeferredCmd& c, const std::string& text)
+	{
+		switch (c.kind)
+		{
+		case DeferredCmd::Kind::Shape: rasterShape(s, ds, c.shape, c.fill, c.border, c.clear); break;
+		case DeferredCmd::Kind::Line:  rasterLine(s, ds, c.a, c.b, c.c, c.d); break;
+		case DeferredCmd::Kind::Text:  rasterText(s, ds, c.a, c.b, text.data() + c.text, c.textLen, true); break;
+		case DeferredCmd::Kind::Pixel: plot(s, c.a, c.b, c.value); break;
+		case DeferredCmd::Kind::Image: rasterImage(s, c.a, c.b, c.c, c.d, c.image, c.srcX, c.srcY, c.value); break;
+		case DeferredCmd::Kind::Clear: rasterClear(s, ds); break;
+		}
+	}
+
+	// 把录制的图元按屏幕块分箱，每块在线程池上按录制顺序光栅化（块内裁剪到块范围）。
+	// 各块像素互不重叠，逐块执行与逐条执行结果逐位一致
+	void flushTiles()
+	{
+		auto& st = state();
+		auto& tb = st.tiles;
+		if (tb.cmds.empty() || tb.flushing) return;
+		tb.flushing = true;
+		if (tb.active) ++tb.stats.syncFlushes;
+
+		IMAGE* scr = st.screen.get();
+		DWORD* px = scr ? GetImageBuffer(scr) : nullptr;
+		if (px)
+		{
+			const int W = scr->getwidth(), H = scr->getheight();
+			const int ts = (std::max)(16, tb.tileSize);
+			const int cols = (W + ts - 1) / ts, rows = (H + ts - 1) / ts;
+			tb.bins.resize((std::size_t)cols * rows);
+			for (auto& bin : tb.bins) bin.clear();
+
+			std::uint64_t binned = 0;
+			for (std::size_t i = 0; i < tb.cmds.size(); ++i)
+			{
+				const RECT& b = tb.cmds[i].bounds;
+				const int l = (std::max)(0, (int)b.left), t = (std::max)(0, (int)b.top);
+				const int r = (std::min)(W, (int)b.right), btm = (std::min)(H, (int)b.bottom);
+				if (l >= r || t >= btm) continue;
+				for (int ty = t / ts; ty <= (btm - 1) / ts; ++ty)
+					for (int tx = l / ts; tx <= (r - 1) / ts; ++tx)
+					{
+						tb.bins[(std::size_t)ty * cols + tx].push_back((std::uint32_t)i);
+						++binned;
+					}
+			}
+
+			std::vector<std::uint32_t> jobs;
+			for (std::size_t t = 0; t < tb.bins.size(); ++t)
+				if (!tb.bins[t].empty()) jobs.push_back((std::uint32_t)t);
+
+			auto& pool = StellarX::ThreadPool::Get();
+			const std::uint64_t stealsBefore = pool.getStats().steals;
+			std::vector<StellarX::Headless::Stats> local(pool.threadCount());
+			std::uint32_t* heat = heatFor(scr);   // 各块只写自己的矩形，计数缓冲同样无竞争
+			pool.parallelFor(jobs.size(), [&](std::size_t job, unsigned worker)
+				{
+					const std::uint32_t t = jobs[job];
+					const int tx = (int)(t % cols), ty = (int)(t / cols);
+					Surface s{ px, W, H, nullptr,
+						RECT{ tx * ts, ty * ts, (std::min)(W, (tx + 1) * ts), (std::min)(H, (ty + 1) * ts) }, &local[worker], heat };
+					for (std::uint32_t i : tb.bins[t])
+					{
+						const DeferredCmd& c = tb.cmds[i];
+						s.clip = c.clip >= 0 ? &tb.clips[c.clip] : nullptr;
+						execute(s, tb.states[c.state], c, tb.text);
+					}
+				});
+			for (const auto& l : local)
+			{
+				st.stats.bytesRead += l.bytesRead;
+				st.stats.bytesWritten += l.bytesWritten;
+			}
+
+			++tb.stats.flushes;
+			tb.stats.commands += tb.cmds.size();
+			tb.stats.tileJobs += jobs.size();
+			tb.stats.binned += binned;
+			tb.stats.steals += pool.getStats().steals - stealsBefore;
+		}
+
+		tb.cmds.clear();
+		tb.states.clear();
+		tb.clips.clear();
+		tb.text.clear();
+		tb.sources.clear();
+		tb.flushing = false;
+	}
+
+	/* ---------------- 接口层：直接光栅化或录制 ---------------- */
+
+	void drawShape(const Shape& sh, bool fill, bool border, bool clear = false)
+	{
+		auto& st = state();
+		if (deferring())
+		{
+			++st.stats.drawCalls;
+			const int pad = (border ? penWidth(st) : 0) + 1;
+			DeferredCmd& c = record(DeferredCmd::Kind::Shape, RECT{ sh.l - pad, sh.t - pad, sh.r + pad + 1, sh.b + pad + 1 }, fill && !clear);
+			c.shape = sh;
+			c.fill = fill;
+			c.border = border;
+			c.clear = clear;
+			return;
+		}
+		Surface s = target();
+		if (!s.px) return;
+		++st.stats.drawCalls;
+		rasterShape(s, st, sh, fill, border, clear);
+	}
+
+	void drawText(int x, int y, const char* str, std::size_t n)
+	{
+		auto& st = state();
+		if (deferring())
+		{
+			++st.stats.textCalls;
+			++st.stats.drawCalls;
+			prepareGlyphs(st, str, n);
+			const FontMetrics m = fontMetrics(st.font);
+			const int total = measure(str, n, m);
+			// 斜体错切向右至多 h/5，粗体再外扩 1 像素
+			DeferredCmd& c = record(DeferredCmd::Kind::Text, RECT{ x, y, x + total + m.h / 5 + 2, y + m.h }, false);
+			c.a = x;
+			c.b = y;
+			c.text = (std::uint32_t)st.tiles.text.size();
+			c.textLen = (std::uint32_t)n;
+			st.tiles.text.append(str, n);
+			return;
+		}
+		Surface s = target();
+		if (!s.px) return;
+		++st.stats.textCalls;
+		++st.stats.drawCalls;
+		rasterText(s, st, x, y, str, n, false);
+	}
+
+	/* ---------------- 事件 ---------------- */
+
+	int categoryOf(UINT m)
+	{
+		if (m >= WM_MOUSEMOVE && m <= WM_MOUSEWHEEL) return EX_MOUSE;
+		if (m == WM_KEYDOWN || m == WM_KEYUP || m == WM_SYSKEYDOWN || m == WM_SYSKEYUP) return EX_KEY;
+		if (m == WM_CHAR) return EX_CHAR;
+		return EX_WINDOW;
+	}
+
+	void enqueue(const ExMessage& msg, unsigned delayMs, bool viaWndProc)
+	{
+		auto& st = state();
+		const ULONGLONG due = (std::max)(st.lastDue, st.clock) + delayMs;
+		st.lastDue = due;
+		st.queue.push_back({ msg, due, viaWndProc });
+	}
+
+	WNDPROC currentProc()
+	{
+		auto& w = state().window;
+		auto it = w.longs.find(GWLP_WNDPROC);
+		return it == w.longs.end() ? nullptr : reinterpret_cast<WNDPROC>(it->second);
+	}
+
+	// 模拟系统把消息直接投递给窗口过程（不进入 EasyX 消息队列）
+	void dispatchToWndProc(const ExMessage& msg)
+	{
+		auto& st = state();
+		HWND h = &st.window;
+		WNDPROC proc = currentProc();
+		if (msg.message == WM_SIZING)
+		{
+			RECT rc{ 0, 0, (LONG)LOWORD(msg.lParam), (LONG)HIWORD(msg.lParam) };
+			if (proc) proc(h, WM_SIZING, msg.wParam, reinterpret_cast<LPARAM>(&rc));
+			st.window.clientW = rc.right - rc.left;
+			st.window.clientH = rc.bottom - rc.top;
+			return;
+		}
+		if (proc) proc(h, msg.message, msg.wParam, msg.lParam);
+	}
+
+	// 出队时的副作用：同步光标、按键状态与客户区尺寸
+	void onDequeue(const ExMessage& msg)
+	{
+		auto& st = state();
+		if (categoryOf(msg.message) == EX_MOUSE)
+		{
+			st.cursor = { msg.x, msg.y };
+		}
+		else if (msg.message == WM_SIZE && msg.wParam != SIZE_MINIMIZED)
+		{
+			st.window.clientW = LOWORD(msg.lParam);
+			st.window.clientH = HIWORD(msg.lParam);
+		}
+	}
+
+	ExMessage makeWindowMessage(UINT m, WPARAM w = 0, LPARAM l = 0)
+	{
+		ExMessage msg{};
+		msg.message = (USHORT)m;
+		msg.wParam = w;
+		msg.lParam = l;
+		return msg;
+	}
+}
+
+/* ========================= IMAGE ========================= */
+
+IMAGE::IMAGE(int w, int h)
+{
+	Resize(this, w, h);
+}
+
+IMAGE::IMAGE(const IMAGE& other)
+{
+	*this = other;
+}
+
+IMAGE& IMAGE::operator=(const IMAGE& other)
+{
+	if (this == &other) return *this;
+	syncImage(this);
+	syncImage(&other);
+	Resize(this, other.width, other.height);
+	if (pixels && other.pixels)
+		std::memcpy(pixels, other.pixels, (std::size_t)width * height * sizeof(DWORD));
+	return *this;
+}
+
+IMAGE::~IMAGE()
+{
+	syncImage(this);
+	delete[] pixels;
+}
+
+void Resize(IMAGE* pImg, int w, int h)
+{
+	auto& st = state();
+	if (!pImg)
+	{
+		// 与 EasyX 一致：Resize(NULL, ...) 调整绘图窗口（屏幕表面与客户区）
+		if (!st.screen) return;
+		syncImage(st.screen.get());
+		st.window.clientW = (std::max)(0, w);
+		st.window.clientH = (std::max)(0, h);
+		pImg = st.screen.get();
+	}
+	else
+		syncImage(pImg);
+	w = (std::max)(0, w);
+	h = (std::max)(0, h);
+	const std::size_t need = (std::size_t)w * h;
+	if (need > pImg->capacity)
+	{
+		delete[] pImg->pixels;
+		pImg->pixels = new DWORD[need];
+		pImg->capacity = need;
+		++st.stats.surfaceAllocs;
+	}
+	pImg->width = w;
+	pImg->height = h;
+	if (need) std::memset(pImg->pixels, 0, need * sizeof(DWORD));
+}
+
+DWORD* GetImageBuffer(IMAGE* pImg)
+{
+	if (!pImg) pImg = state().screen.get();
+	// 调用方可能直接读写像素：先提交仍引用它的分块图元
+	syncImage(pImg);
+	return pImg ? pImg->pixels : nullptr;
+}
+
+IMAGE* GetWorkingImage()
+{
+	auto& st = state();
+	return st.working ? st.working : st.screen.get();
+}
+
+void SetWorkingImage(IMAGE* pImg)
+{
+	auto& st = state();
+	st.working = (pImg == st.screen.get()) ? nullptr : pImg;
+}
+
+int getwidth()
+{
+	const IMAGE* img = GetWorkingImage();
+	return img ? img->getwidth() : 0;
+}
+
+int getheight()
+{
+	const IMAGE* img = GetWorkingImage();
+	return img ? img->getheight() : 0;
+}
+
+/* ========================= 窗口与设备 ========================= */
+
+HWND initgraph(int width, int height, int /*flag*/)
+{
+	auto& st = state();
+	flushTiles();
+	st.screen.reset(new IMAGE(width, height));
+	st.front.reset();
+	st.working = nullptr;
+	st.clipping = false;
+	st.clipTarget = nullptr;
+	st.clip.clear();
+	st.window.clientW = width;
+	st.window.clientH = height;
+	st.window.longs.clear();
+	st.window.longs[GWL_STYLE] = WS_MINIMIZEBOX | WS_CLIPCHILDREN;
+	st.window.longs[GWLP_WNDPROC] = reinterpret_cast<LONG_PTR>(&DefWindowProc);
+	st.windowOpen = true;
+
+	st.lineColor = WHITE;
+	st.fillColor = WHITE;
+	st.textColor = WHITE;
+	st.bkColor = BLACK;
+	st.bkMode = OPAQUE;
+	st.lineStyle = LINESTYLE{};
+	st.userStyle.clear();
+	st.fillStyle = FILLSTYLE{};
+	st.font = LOGFONT{};
+	st.font.lfHeight = 16;
+	st.font.lfWeight = FW_NORMAL;
+	st.batching = false;
+	return &st.window;
+}
+
+void closegraph()
+{
+	auto& st = state();
+	flushTiles();
+	st.screen.reset();
+	st.front.reset();
+	st.working = nullptr;
+	st.clipping = false;
+	st.clipTarget = nullptr;
+	st.windowOpen = false;
+}
+
+HWND GetHWnd()
+{
+	auto& st = state();
+	return st.windowOpen ? &st.window : nullptr;
+}
+
+void cleardevice()
+{
+	if (deferring())
+	{
+		record(DeferredCmd::Kind::Clear, RECT{ 0, 0, state().screen->getwidth(), state().screen->getheight() }, false);
+		return;
+	}
+	Surface s = target();
+	if (!s.px) return;
+	rasterClear(s, state());
+}
+
+void setbkcolor(COLORREF color) { state().bkColor = color; }
+COLORREF getbkcolor() { return state().bkColor; }
+void setbkmode(int mode) { state().bkMode = mode; }
+int getbkmode() { return state().bkMode; }
+void setlinecolor(COLORREF color) { state().lineColor = color; }
+COLORREF getlinecolor() { return state().lineColor; }
+void settextcolor(COLORREF color) { state().textColor = color; }
+COLORREF gettextcolor() { return state().textColor; }
+void setfillcolor(COLORREF color) { state().fillColor = color; }
+COLORREF getfillcolor() { return state().fillColor; }
+
+void getlinestyle(LINESTYLE* pstyle)
+{
+	if (pstyle) *pstyle = state().lineStyle;
+}
+
+void setlinestyle(const LINESTYLE* pstyle)
+{
+	if (!pstyle) return;
+	setlinestyle((int)pstyle->style, (int)pstyle->thickness, pstyle->puserstyle, pstyle->userstylecount);
+}
+
+void setlinestyle(int style, int thickness, const DWORD* puserstyle, DWORD userstylecount)
+{
+	auto& st = state();
+	st.userStyle.assign(puserstyle, puserstyle ? puserstyle + userstylecount : puserstyle);
+	st.lineStyle.style = (DWORD)style;
+	st.lineStyle.thickness = (DWORD)(std::max)(1, thickness);
+	st.lineStyle.puserstyle = st.userStyle.empty() ? nullptr : st.userStyle.data();
+	st.lineStyle.userstylecount = (DWORD)st.userStyle.size();
+}
+
+void getfillstyle(FILLSTYLE* pstyle)
+{
+	if (pstyle) *pstyle = state().fillStyle;
+}
+
+void setfillstyle(const FILLSTYLE* pstyle)
+{
+	if (pstyle) state().fillStyle = *pstyle;
+}
+
+void setfillstyle(int style, long hatch, IMAGE* ppattern)
+{
+	auto& fs = state().fillStyle;
+	fs.style = style;
+	fs.hatch = hatch;
+	fs.ppattern = ppattern;
+}
+
+/* ========================= 图元 ========================= */
+
+COLORREF getpixel(int x, int y)
+{
+	Surface s = target();
+	if (!s.px || x < 0 || y < 0 || x >= s.w || y >= s.h) return 0;
+	state().stats.bytesRead += 4;
+	return toColor(s.px[(std::size_t)y * s.w + x]);
+}
+
+void putpixel(int x, int y, COLORREF color)
+{
+	if (deferring())
+	{
+		DeferredCmd& c = record(DeferredCmd::Kind::Pixel, RECT{ x, y, x + 1, y + 1 }, false);
+		c.a = x;
+		c.b = y;
+		c.value = toPixel(color);
+		return;
+	}
+	plot(target(), x, y, toPixel(color));
+}
+
+void line(int x1, int y1, int x2, int y2)
+{
+	auto& st = state();
+	if (penNull(st)) return;
+	if (deferring())
+	{
+		++st.stats.drawCalls;
+		const int w = penWidth(st);
+		DeferredCmd& c = record(DeferredCmd::Kind::Line,
+			RECT{ (std::min)(x1, x2) - w, (std::min)(y1, y2) - w, (std::max)(x1, x2) + w + 1, (std::max)(y1, y2) + w + 1 }, false);
+		c.a = x1; c.b = y1; c.c = x2; c.d = y2;
+		return;
+	}
+	Surface s = target();
+	if (!s.px) return;
+	++st.stats.drawCalls;
+	rasterLine(s, st, x1, y1, x2, y2);
+}
+
+void rectangle(int l, int t, int r, int b) { drawShape({ ShapeKind::Rect, l, t, r, b, 0, 0 }, false, true); }
+void fillrectangle(int l, int t, int r, int b) { drawShape({ ShapeKind::Rect, l, t, r, b, 0, 0 }, true, true); }
+void solidrectangle(int l, int t, int r, int b) { drawShape({ ShapeKind::Rect, l, t, r, b, 0, 0 }, true, false); }
+void clearrectangle(int l, int t, int r, int b) { drawShape({ ShapeKind::Rect, l, t, r, b, 0, 0 }, true, false, true); }
+
+void circle(int x, int y, int radius) { ellipse(x - radius, y - radius, x + radius, y + radius); }
+void fillcircle(int x, int y, int radius) { fillellipse(x - radius, y - radius, x + radius, y + radius); }
+void solidcircle(int x, int y, int radius) { solidellipse(x - radius, y - radius, x + radius, y + radius); }
+void clearcircle(int x, int y, int radius) { clearellipse(x - radius, y - radius, x + radius, y + radius); }
+
+void ellipse(int l, int t, int r, int b) { drawShape({ ShapeKind::Ellipse, l, t, r, b, 0, 0 }, false, true); }
+void fillellipse(int l, int t, int r, int b) { drawShape({ ShapeKind::Ellipse, l, t, r, b, 0, 0 }, true, true); }
+void solidellipse(int l, int t, int r, int b) { drawShape({ ShapeKind::Ellipse, l, t, r, b, 0, 0 }, true, false); }
+void clearellipse(int l, int t, int r, int b) { drawShape({ ShapeKind::Ellipse, l, t, r, b, 0, 0 }, true, false, true); }
+
+void roundrect(int l, int t, int r, int b, int ew, int eh) { drawShape({ ShapeKind::RoundRect, l, t, r, b, (double)ew, (double)eh }, false, true); }
+void fillroundrect(int l, int t, int r, int b, int ew, int eh) { drawShape({ ShapeKind::RoundRect, l, t, r, b, (double)ew, (double)eh }, true, true); }
+void solidroundrect(int l, int t, int r, int b, int ew, int eh) { drawShape({ ShapeKind::RoundRect, l, t, r, b, (double)ew, (double)eh }, true, false); }
+void clearroundrect(int l, int t, int r, int b, int ew, int eh) { drawShape({ ShapeKind::RoundRect, l, t, r, b, (double)ew, (double)eh }, true, false, true); }
+
+/* ========================= 文本 ========================= */
+
+void outtextxy(int x, int y, LPCTSTR str)
+{
+	if (str) drawText(x, y, str, std::strlen(str));
+}
+
+void outtextxy(int x, int y, TCHAR c)
+{
+	drawText(x, y, &c, 1);
+}
+
+int textwidth(LPCTSTR str)
+{
+	++state().stats.metricCalls;
+	return str ? measure(str, std::strlen(str)) : 0;
+}
+
+int textwidth(TCHAR c)
+{
+	++state().stats.metricCalls;
+	return measure(&c, 1);
+}
+
+int textheight(LPCTSTR /*str*/)
+{
+	++state().stats.metricCalls;
+	return fontMetrics().h;
+}
+
+int textheight(TCHAR /*c*/)
+{
+	++state().stats.metricCalls;
+	return fontMetrics().h;
+}
+
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace)
+{
+	LOGFONT f = state().font;
+	f.lfHeight = nHeight;
+	f.lfWidth = nWidth;
+	if (lpszFace)
+	{
+		std::strncpy(f.lfFaceName, lpszFace, LF_FACESIZE - 1);
+		f.lfFaceName[LF_FACESIZE - 1] = 0;
+	}
+	state().font = f;
+}
+
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation, int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut)
+{
+	settextstyle(nHeight, nWidth, lpszFace);
+	LOGFONT& f = state().font;
+	f.lfEscapement = nEscapement;
+	f.lfOrientation = nOrientation;
+	f.lfWeight = nWeight;
+	f.lfItalic = bItalic;
+	f.lfUnderline = bUnderline;
+	f.lfStrikeOut = bStrikeOut;
+}
+
+void settextstyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation, int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut,
+	BYTE fbCharSet, BYTE fbOutPrecision, BYTE fbClipPrecision, BYTE fbQuality, BYTE fbPitchAndFamily)
+{
+	settextstyle(nHeight, nWidth, lpszFace, nEscapement, nOrientation, nWeight, bItalic, bUnderline, bStrikeOut);
+	LOGFONT& f = state().font;
+	f.lfCharSet = fbCharSet;
+	f.lfOutPrecision = fbOutPrecision;
+	f.lfClipPrecision = fbClipPrecision;
+	f.lfQuality = fbQuality;
+	f.lfPitchAndFamily = fbPitchAndFamily;
+}
+
+void settextstyle(const LOGFONT* font)
+{
+	if (font) state().font = *font;
+}
+
+void gettextstyle(LOGFONT* font)
+{
+	if (font) *font = state().font;
+}
+
+/* ========================= 图像 ========================= */
+
+int loadimage(IMAGE* pDstImg, LPCTSTR pImgFile, int nWidth, int nHeight, bool bResize)
+{
+	std::vector<DWORD> px;
+	int w = 0, h = 0;
+	++state().stats.imageLoads;
+	if (!readPNM(pImgFile, px, w, h))
+		return -1;
+
+	const int dw = nWidth > 0 ? nWidth : w;
+	const int dh = nHeight > 0 ? nHeight : h;
+	IMAGE scaled(dw, dh);
+	if (dw == w && dh == h)
+		std::memcpy(GetImageBuffer(&scaled), px.data(), px.size() * sizeof(DWORD));
+	else
+		StellarX::Pixel::scaleBilinear(GetImageBuffer(&scaled), dw, dw, dh, px.data(), w, w, h);
+	state().stats.bytesWritten += (std::uint64_t)dw * dh * 4;
+
+	if (pDstImg)
+	{
+		*pDstImg = scaled;
+	}
+	else
+	{
+		// 目标为绘图设备：可选调整设备尺寸后绘制到 (0,0)
+		if (bResize) Resize(GetWorkingImage() == state().screen.get() ? nullptr : GetWorkingImage(), dw, dh);
+		putimage(0, 0, &scaled);
+	}
+	return 0;
+}
+
+void saveimage(LPCTSTR pImgFile, IMAGE* pImg)
+{
+	writePPM(pImgFile, pImg ? pImg : GetWorkingImage());
+}
+
+void getimage(IMAGE* pDstImg, int srcX, int srcY, int srcWidth, int srcHeight)
+{
+	if (!pDstImg) return;
+	Resize(pDstImg, srcWidth, srcHeight);
+	Surface s = target();
+	Surface d = surfaceOf(pDstImg);
+	if (!s.px || !d.px) return;
+
+	auto& st = state();
+	const int x0 = (std::max)(srcX, 0), x1 = (std::min)(srcX + srcWidth, s.w);
+	for (int y = 0; y < srcHeight; ++y)
+	{
+		const int sy = srcY + y;
+		if (sy < 0 || sy >= s.h || x0 >= x1) continue;
+		StellarX::Pixel::copy(d.px + (std::size_t)y * d.w + (x0 - srcX), s.px + (std::size_t)sy * s.w + x0, (std::size_t)(x1 - x0));
+		st.stats.bytesRead += (std::uint64_t)(x1 - x0) * 4;
+		st.stats.bytesWritten += (std::uint64_t)(x1 - x0) * 4;
+		countSpan(d, y, x0 - srcX, x1 - srcX - 1);
+	}
+}
+
+void putimage(int dstX, int dstY, const IMAGE* pSrcImg, DWORD dwRop)
+{
+	if (!pSrcImg) return;
+	putimage(dstX, dstY, pSrcImg->getwidth(), pSrcImg->getheight(), pSrcImg, 0, 0, dwRop);
+}
+
+void putimage(int dstX, int dstY, int dstWidth, int dstHeight, const IMAGE* pSrcImg, int srcX, int srcY, DWORD dwRop)
+{
+	if (!pSrcImg) return;
+	auto& st = state();
+	if (pSrcImg == st.screen.get())
+		flushTiles();   // 屏幕到屏幕的拷贝读的是其它块的像素，不能分块执行
+	else if (deferring())
+	{
+		++st.stats.drawCalls;
+		DeferredCmd& c = record(DeferredCmd::Kind::Image, RECT{ dstX, dstY, dstX + dstWidth, dstY + dstHeight }, false);
+		c.a = dstX; c.b = dstY; c.c = dstWidth; c.d = dstHeight;
+		c.srcX = srcX; c.srcY = srcY;
+		c.image = pSrcImg;
+		c.value = dwRop;
+		if (std::find(st.tiles.sources.begin(), st.tiles.sources.end(), pSrcImg) == st.tiles.sources.end())
+			st.tiles.sources.push_back(pSrcImg);
+		return;
+	}
+	Surface d = target();
+	if (!d.px || !GetImageBuffer(const_cast<IMAGE*>(pSrcImg))) return;
+	++st.stats.drawCalls;
+	rasterImage(d, dstX, dstY, dstWidth, dstHeight, pSrcImg, srcX, srcY, dwRop);
+}
+
+/* ========================= 裁剪 ========================= */
+
+void setcliprgn(HRGN hrgn)
+{
+	auto& st = state();
+	st.clip.clear();
+	st.clipping = hrgn != nullptr;
+	st.clipTarget = st.working ? st.working : st.screen.get();
+	// 复制为矩形列表：调用方随后即可 DeleteObject；区域内矩形互不相交，不会重复写入
+	if (hrgn)
+		hrgn->region.forEachRect([&st](int l, int t, int r, int b) { st.clip.push_back(RECT{ l, t, r, b }); });
+}
+
+void clearcliprgn()
+{
+	auto& st = state();
+	if (deferring())
+	{
+		if (!st.clipping || st.clipTarget != st.screen.get()) return;
+		++st.stats.drawCalls;
+		record(DeferredCmd::Kind::Clear, RECT{ 0, 0, st.screen->getwidth(), st.screen->getheight() }, false);
+		return;
+	}
+	Surface s = target();
+	if (!s.px || !s.clip) return;
+	++st.stats.drawCalls;
+	rasterClear(s, st);
+}
+
+HRGN CreateRectRgn(int left, int top, int right, int bottom)
+{
+	auto* rgn = new SxHeadlessRegion;
+	if (left > right) std::swap(left, right);
+	if (top > bottom) std::swap(top, bottom);
+	rgn->region = StellarX::Region(left, top, right, bottom);
+	return rgn;
+}
+
+int CombineRgn(HRGN hrgnDst, HRGN hrgnSrc1, HRGN hrgnSrc2, int iMode)
+{
+	if (!hrgnDst || !hrgnSrc1 || (iMode != RGN_COPY && !hrgnSrc2)) return ERROR;
+	StellarX::Region r = hrgnSrc1->region;
+	switch (iMode)
+	{
+	case RGN_COPY: break;
+	case RGN_AND:  r.intersect(hrgnSrc2->region); break;
+	case RGN_OR:   r.unite(hrgnSrc2->region); break;
+	case RGN_DIFF: r.subtract(hrgnSrc2->region); break;
+	case RGN_XOR:
+	{
+		StellarX::Region both = r;
+		both.intersect(hrgnSrc2->region);
+		r.unite(hrgnSrc2->region).subtract(both);
+		break;
+	}
+	default: return ERROR;
+	}
+	hrgnDst->region = std::move(r);
+	const std::size_t n = hrgnDst->region.rectCount();
+	return n == 0 ? NULLREGION : (n == 1 ? SIMPLEREGION : COMPLEXREGION);
+}
+
+BOOL DeleteObject(HGDIOBJ hObject)
+{
+	// 无头后端中唯一的 GDI 对象是区域
+	delete static_cast<SxHeadlessRegion*>(hObject);
+	return hObject != nullptr;
+}
+
+/* ========================= 批量绘制 ========================= */
+
+namespace
+{
+	// 结算一帧过绘制：汇总计数缓冲并清零；有写入的帧保留一份计数供导出热力图
+	void endOverdrawFrame()
+	{
+		auto& st = state();
+		auto& od = st.overdraw;
+		if (!od.enabled) return;
+
+		StellarX::Headless::OverdrawFrame f;
+		f.frame = od.frames.size();
+		for (std::uint32_t c : od.heat)
+		{
+			if (!c) continue;
+			++f.pixelsTouched;
+			f.writes += c;
+			f.maxWrites = (std::max)(f.maxWrites, c);
+		}
+		f.screenBytes = f.writes * 4;
+		// resetStats 可能在帧中途清零了总计数：此时从 0 算起
+		const std::uint64_t start = st.stats.bytesWritten >= od.bytesAtFrameStart ? od.bytesAtFrameStart : 0;
+		f.bytesWritten = st.stats.bytesWritten - start;
+		od.bytesAtFrameStart = st.stats.bytesWritten;
+		od.frames.push_back(f);
+
+		if (f.writes)
+		{
+			od.last.swap(od.heat);
+			od.lastW = od.w;
+			od.lastH = od.h;
+		}
+		od.heat.assign((std::size_t)od.w * od.h, 0);
+	}
+
+	// 把屏幕 [left, right) × [top, bottom) 拷到可见帧；屏幕尺寸变化后的首次提交按整屏拷贝
+	void present(int left, int top, int right, int bottom)
+	{
+		auto& st = state();
+		flushTiles();
+		endOverdrawFrame();
+		++st.stats.presents;
+		if (!st.screen) return;
+
+		const int w = st.screen->getwidth(), h = st.screen->getheight();
+		if (!st.front || st.front->getwidth() != w || st.front->getheight() != h)
+		{
+			if (st.front) Resize(st.front.get(), w, h);
+			else st.front.reset(new IMAGE(w, h));
+			left = 0; top = 0; right = w; bottom = h;
+		}
+		left = (std::max)(left, 0);
+		top = (std::max)(top, 0);
+		right = (std::min)(right, w);
+		bottom = (std::min)(bottom, h);
+		if (left >= right || top >= bottom) return;
+
+		const Surface s = surfaceOf(st.screen.get()), d = surfaceOf(st.front.get());
+		StellarX::Pixel::copyRect(d.px + (std::size_t)top * w + left, w, s.px + (std::size_t)top * w + left, w, right - left, bottom - top);
+		st.stats.bytesPresented += (std::uint64_t)(right - left) * (bottom - top) * 4;
+	}
+}
+
+void BeginBatchDraw()
+{
+	state().batching = true;
+}
+
+void FlushBatchDraw()
+{
+	present(0, 0, INT_MAX, INT_MAX);
+}
+
+// 与 EasyX 一致，right/bottom 为闭区间
+void FlushBatchDraw(int left, int top, int right, int bottom)
+{
+	present(left, top, right + 1, bottom + 1);
+}
+
+void EndBatchDraw()
+{
+	FlushBatchDraw();
+	state().batching = false;
+}
+
+void EndBatchDraw(int left, int top, int right, int bottom)
+{
+	FlushBatchDraw(left, top, right, bottom);
+	state().batching = false;
+}
+
+/* ========================= 消息 ========================= */
+
+bool peekmessage(ExMessage* msg, BYTE filter, bool removemsg)
+{
+	auto& st = state();
+	for (auto it = st.queue.begin(); it != st.queue.end();)
+	{
+		if (it->due > st.clock) break;             // 脚本按到期时间有序
+		if (it->viaWndProc)
+		{
+			const ExMessage m = it->msg;
+			it = st.queue.erase(it);
+			dispatchToWndProc(m);                  // 窗口过程可能再次访问队列，迭代器需重取
+			it = st.queue.begin();
+			continue;
+		}
+		if (categoryOf(it->msg.message) & filter)
+		{
+			if (msg) *msg = it->msg;
+			if (removemsg)
+			{
+				const ExMessage m = it->msg;
+				st.queue.erase(it);
+				onDequeue(m);
+			}
+			return true;
+		}
+		++it;
+	}
+
+	// 脚本耗尽：按需合成 WM_CLOSE，让 runEventLoop 自然退出
+	if (st.queue.empty() && st.autoClose && (filter & EX_WINDOW))
+	{
+		if (msg) *msg = makeWindowMessage(WM_CLOSE);
+		return true;
+	}
+	return false;
+}
+
+ExMessage getmessage(BYTE filter)
+{
+	auto& st = state();
+	ExMessage msg{};
+	for (;;)
+	{
+		if (peekmessage(&msg, filter, true)) return msg;
+		// 阻塞语义：把虚拟时钟推进到下一条脚本消息；无消息可等时返回空消息，避免死等
+		if (st.queue.empty()) return ExMessage{};
+		st.clock = (std::max)(st.clock, st.queue.front().due);
+	}
+}
+
+void flushmessage(BYTE filter)
+{
+	auto& q = state().queue;
+	q.erase(std::remove_if(q.begin(), q.end(), [filter](const ScriptMsg& m)
+		{
+			return !m.viaWndProc && (categoryOf(m.msg.message) & filter);
+		}), q.end());
+}
+
+bool InputBox(LPTSTR pString, int nMaxCount, LPCTSTR, LPCTSTR, LPCTSTR, int, int, bool)
+{
+	auto& st = state();
+	if (st.inputReplies.empty()) return false;
+	auto reply = st.inputReplies.front();
+	st.inputReplies.pop_front();
+	if (pString && nMaxCount > 0)
+	{
+		std::strncpy(pString, reply.first.c_str(), (std::size_t)nMaxCount - 1);
+		pString[nMaxCount - 1] = 0;
+	}
+	return reply.second;
+}
+
+/* ========================= Win32 窗口接口 ========================= */
+
+LONG GetWindowLong(HWND hWnd, int nIndex)
+{
+	return (LONG)GetWindowLongPtr(hWnd, nIndex);
+}
+
+LONG SetWindowLong(HWND hWnd, int nIndex, LONG dwNewLong)
+{
+	return (LONG)SetWindowLongPtr(hWnd, nIndex, dwNewLong);
+}
+
+LONG_PTR GetWindowLongPtr(HWND hWnd, int nIndex)
+{
+	if (!hWnd) return 0;
+	auto it = hWnd->longs.find(nIndex);
+	return it == hWnd->longs.end() ? 0 : it->second;
+}
+
+LONG_PTR SetWindowLongPtr(HWND hWnd, int nIndex, LONG_PTR dwNewLong)
+{
+	if (!hWnd) return 0;
+	LONG_PTR& slot = hWnd->longs[nIndex];
+	const LONG_PTR old = slot;
+	slot = dwNewLong;
+	return old;
+}
+
+ULONG_PTR GetClassLongPtr(HWND hWnd, int nIndex)
+{
+	return (hWnd && nIndex == GCL_STYLE) ? (ULONG_PTR)hWnd->classStyle : 0;
+}
+
+ULONG_PTR SetClassLongPtr(HWND hWnd, int nIndex, LONG_PTR dwNewLong)
+{
+	if (!hWnd || nIndex != GCL_STYLE) return 0;
+	const ULONG_PTR old = (ULONG_PTR)hWnd->classStyle;
+	hWnd->classStyle = dwNewLong;
+	return old;
+}
+
+BOOL SetWindowPos(HWND hWnd, HWND, int, int, int cx, int cy, UINT uFlags)
+{
+	if (!hWnd) return FALSE;
+	// 虚拟窗口没有非客户区：窗口尺寸即客户区尺寸
+	if (!(uFlags & SWP_NOSIZE))
+	{
+		hWnd->clientW = (std::max)(0, cx);
+		hWnd->clientH = (std::max)(0, cy);
+	}
+	return TRUE;
+}
+
+BOOL SetWindowText(HWND hWnd, LPCTSTR lpString)
+{
+	if (!hWnd) return FALSE;
+	hWnd->title = lpString ? lpString : "";
+	return TRUE;
+}
+
+BOOL AdjustWindowRectEx(RECT* lpRect, DWORD, BOOL, DWORD)
+{
+	return lpRect ? TRUE : FALSE;
+}
+
+BOOL GetClientRect(HWND hWnd, RECT* lpRect)
+{
+	if (!hWnd || !lpRect) return FALSE;
+	*lpRect = { 0, 0, hWnd->clientW, hWnd->clientH };
+	return TRUE;
+}
+
+BOOL ValidateRect(HWND hWnd, const RECT*)
+{
+	return hWnd ? TRUE : FALSE;
+}
+
+BOOL InvalidateRect(HWND hWnd, const RECT*, BOOL)
+{
+	return hWnd ? TRUE : FALSE;
+}
+
+LRESULT SendMessage(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+{
+	if (!hWnd) return 0;
+	WNDPROC proc = currentProc();
+	return proc ? proc(hWnd, Msg, wParam, lParam) : 0;
+}
+
+LRESULT CallWindowProc(WNDPROC lpPrevWndFunc, HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+{
+	return lpPrevWndFunc ? lpPrevWndFunc(hWnd, Msg, wParam, lParam) : DefWindowProc(hWnd, Msg, wParam, lParam);
+}
+
+LRESULT DefWindowProc(HWND, UINT, WPARAM, LPARAM)
+{
+	return 0;
+}
+
+BOOL GetCursorPos(POINT* lpPoint)
+{
+	if (!lpPoint) return FALSE;
+	*lpPoint = state().cursor;
+	return TRUE;
+}
+
+BOOL ScreenToClient(HWND hWnd, POINT* lpPoint)
+{
+	// 虚拟窗口位于屏幕原点：屏幕坐标即客户区坐标
+	return (hWnd && lpPoint) ? TRUE : FALSE;
+}
+
+int GetSystemMetrics(int nIndex)
+{
+	switch (nIndex)
+	{
+	case SM_CXSCREEN:
+	case SM_CXVIRTUALSCREEN: return 1920;
+	case SM_CYSCREEN:
+	case SM_CYVIRTUALSCREEN: return 1080;
+	default:                 return 0;
+	}
+}
+
+void Sleep(DWORD dwMilliseconds)
+{
+	state().clock += dwMilliseconds;
+}
+
+ULONGLONG GetTickCount64()
+{
+	return state().clock;
+}
+
+DWORD GetTickCount()
+{
+	return (DWORD)state().clock;
+}
+
+/* ========================= StellarX::Headless ========================= */
+
+namespace StellarX
+{
+	namespace Headless
+	{
+		IMAGE* screen()
+		{
+			return state().screen.get();
+		}
+
+		IMAGE* front()
+		{
+			return state().front.get();
+		}
+
+		bool dumpPPM(const std::string& path, const IMAGE* img)
+		{
+			return writePPM(path.c_str(), img ? img : state().screen.get());
+		}
+
+		bool decodeImage(const std::string& path, std::vector<DWORD>& px, int& w, int& h)
+		{
+			return readPNM(path.c_str(), px, w, h);
+		}
+
+		void postMessage(const ExMessage& msg, unsigned delayMs)
+		{
+			enqueue(msg, delayMs, false);
+		}
+
+		void postMouse(UINT message, int x, int y, unsigned delayMs)
+		{
+			auto& st = state();
+			// 按键状态按脚本顺序累积，与真实消息中的 lbutton/rbutton 标志一致
+			if (message == WM_LBUTTONDOWN) st.lbutton = true;
+			if (message == WM_LBUTTONUP) st.lbutton = false;
+			if (message == WM_RBUTTONDOWN) st.rbutton = true;
+			if (message == WM_RBUTTONUP) st.rbutton = false;
+			if (message == WM_MBUTTONDOWN) st.mbutton = true;
+			if (message == WM_MBUTTONUP) st.mbutton = false;
+
+			ExMessage msg{};
+			msg.message = (USHORT)message;
+			msg.x = (short)x;
+			msg.y = (short)y;
+			msg.lbutton = st.lbutton;
+			msg.rbutton = st.rbutton;
+			msg.mbutton = st.mbutton;
+			enqueue(msg, delayMs, false);
+		}
+
+		void postKey(UINT message, BYTE vkcode, unsigned delayMs)
+		{
+			ExMessage msg{};
+			msg.message = (USHORT)message;
+			msg.vkcode = vkcode;
+			enqueue(msg, delayMs, false);
+		}
+
+		void postChar(TCHAR ch, unsigned delayMs)
+		{
+			ExMessage msg{};
+			msg.message = WM_CHAR;
+			msg.ch = ch;
+			enqueue(msg, delayMs, false);
+		}
+
+		void postResize(int width, int height, unsigned delayMs)
+		{
+			enqueue(makeWindowMessage(WM_SIZE, SIZE_RESTORED, MAKELPARAM(width, height)), delayMs, false);
+		}
+
+		void postSizeMove(int width, int height, unsigned delayMs)
+		{
+			enqueue(makeWindowMessage(WM_ENTERSIZEMOVE), delayMs, true);
+			enqueue(makeWindowMessage(WM_SIZING, WMSZ_BOTTOMRIGHT, MAKELPARAM(width, height)), 0, true);
+			enqueue(makeWindowMessage(WM_SIZE, SIZE_RESTORED, MAKELPARAM(width, height)), 0, false);
+			enqueue(makeWindowMessage(WM_EXITSIZEMOVE), 0, true);
+		}
+
+		void postClose(unsigned delayMs)
+		{
+			enqueue(makeWindowMessage(WM_CLOSE), delayMs, false);
+		}
+
+		std::size_t pendingMessages()
+		{
+			return state().queue.size();
+		}
+
+		void clearMessages()
+		{
+			state().queue.clear();
+		}
+
+		void setGlyphAtlasEnabled(bool on)
+		{
+			state().glyphAtlas = on;
+		}
+
+		void clearGlyphAtlas()
+		{
+			flushTiles();
+			glyphAtlas().glyphs.clear();
+			glyphAtlas().runs.clear();
+		}
+
+		void setAutoClose(bool on)
+		{
+			state().autoClose = on;
+		}
+
+		void pushInputBoxReply(const std::string& text, bool ok)
+		{
+			state().inputReplies.emplace_back(text, ok);
+		}
+
+		ULONGLONG now()
+		{
+			return state().clock;
+		}
+
+		void advanceClock(ULONGLONG ms)
+		{
+			state().clock += ms;
+		}
+
+		bool waitMessage(DWORD timeoutMs, BYTE filter)
+		{
+			auto& st = state();
+			const ULONGLONG limit = timeoutMs == INFINITE ? ~0ull : st.clock + timeoutMs;
+			// 经窗口过程分发的消息不受 filter 限制，peekmessage 取到它们时就会分发
+			for (const ScriptMsg& m : st.queue)
+			{
+				if (!m.viaWndProc && !(categoryOf(m.msg.message) & filter))
+					continue;
+				if (m.due > limit)
+					break;
+				st.clock = (std::max)(st.clock, m.due);
+				return true;
+			}
+			if (st.queue.empty() && st.autoClose && (filter & EX_WINDOW))
+				return true;                       // peekmessage 会合成 WM_CLOSE
+			if (timeoutMs != INFINITE)
+				st.clock = limit;
+			return false;
+		}
+
+		void beginTiledFrame(int tileSize)
+		{
+			auto& tb = state().tiles;
+			if (tb.active) return;
+			flushTiles();
+			tb.active = true;
+			tb.tileSize = tileSize;
+		}
+
+		void endTiledFrame()
+		{
+			auto& tb = state().tiles;
+			if (!tb.active) return;
+			tb.active = false;
+			flushTiles();
+			++tb.stats.frames;
+		}
+
+		bool tiledFrameActive()
+		{
+			return state().tiles.active;
+		}
+
+		TileStats& tileStats()
+		{
+			return state().tiles.stats;
+		}
+
+		void resetTileStats()
+		{
+			state().tiles.stats = TileStats{};
+		}
+
+		void setOverdrawEnabled(bool on)
+		{
+			auto& st = state();
+			auto& od = st.overdraw;
+			if (od.enabled == on) return;
+			flushTiles();
+			od.enabled = on;
+			od.w = od.h = 0;
+			od.heat.clear();
+			od.bytesAtFrameStart = st.stats.bytesWritten;
+			if (on) heatFor(st.screen.get());
+		}
+
+		bool overdrawEnabled()
+		{
+			return state().overdraw.enabled;
+		}
+
+		const std::vector<OverdrawFrame>& overdrawFrames()
+		{
+			return state().overdraw.frames;
+		}
+
+		void resetOverdraw()
+		{
+			auto& st = state();
+			auto& od = st.overdraw;
+			flushTiles();
+			od.frames.clear();
+			od.last.clear();
+			od.lastW = od.lastH = 0;
+			std::fill(od.heat.begin(), od.heat.end(), 0u);
+			od.bytesAtFrameStart = st.stats.bytesWritten;
+		}
+
+		bool dumpOverdrawPPM(const std::string& path)
+		{
+			const auto& st = state();
+			const auto& od = st.overdraw;
+			if (od.last.empty() || od.lastW <= 0 || od.lastH <= 0) return false;
+
+			// 未写入的像素显示为变暗的可见帧（便于对照界面），写入过的按次数着色：
+			// 1 蓝 / 2 绿 / 3 黄 / 4 橙 / 5~7 红 / 8 次及以上 品红
+			static const DWORD kRamp[] = { 0x2850E6, 0x28B43C, 0xE6C828, 0xF0781E, 0xDC1E1E, 0xDC1E1E, 0xDC1E1E, 0xFF3CFF };
+			const IMAGE* ctx = st.front && st.front->getwidth() == od.lastW && st.front->getheight() == od.lastH ? st.front.get() : nullptr;
+			const DWORD* cpx = ctx ? GetImageBuffer(const_cast<IMAGE*>(ctx)) : nullptr;
+			IMAGE map(od.lastW, od.lastH);
+			DWORD* out = GetImageBuffer(&map);
+			for (std::size_t i = 0; i < od.last.size(); ++i)
+			{
+				const std::uint32_t c = od.last[i];
+				if (c)
+				{
+					out[i] = kRamp[(std::min)(c, 8u) - 1];
+					continue;
+				}
+				const DWORD p = cpx ? cpx[i] : 0;
+				const DWORD lum = (((p >> 16) & 0xFF) + ((p >> 8) & 0xFF) + (p & 0xFF)) / 12;
+				out[i] = (lum << 16) | (lum << 8) | lum;
+			}
+			return writePPM(path.c_str(), &map);
+		}
+
+		Stats& stats()
+		{
+			return state().stats;
+		}
+
+		void resetStats()
+		{
+			state().stats = Stats{};
+		}
+	}
+}
+
+#endif // SX_BACKEND_HEADLESS
@@ -0,0 +1,419 @@
+﻿#include "SxImageCache.h"
+#include "SxLog.h"
+#include "SxPixelKernels.h"
+#include "SxThreadPool.h"
+#include "SxEventLoop.h"
+
+#include <cstring>
+#if !SX_BACKEND_HEADLESS
+#include <objbase.h>
+#include <wincodec.h>
+#endif
+
+namespace StellarX
+{
+	namespace
+	{
+		inline std::size_t imageBytes(IMAGE* img)
+		{
+			return (std::size_t)img->getwidth() * (std::size_t)img->getheight() * 4;
+		}
+
+		// 后台线程的读盘解码：只写 px，不碰 EasyX / GDI 与绘图状态。
+		// 返回 false 表示这里解不了；EasyX 下由 pump 在 UI 线程改用 loadimage 再试一次
+		bool decodeFile(const std::string& path, std::vector<DWORD>& px, int& w, int& h)
+		{
+#if SX_BACKEND_HEADLESS
+			return Headless::decodeImage(path, px, w, h);
+#else
+			// EasyX 未声明 loadimage 线程安全（它创建 GDI 对象，JPG/PNG 经 COM 的 IPicture），
+			// 后台线程改用 WIC：每个线程初始化一次 COM（多线程套间），线程退出时反初始化
+			struct ComScope
+			{
+				HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+				~ComScope() { if (SUCCEEDED(hr)) CoUninitialize(); }
+			};
+			thread_local ComScope com;
+			if (FAILED(com.hr) && com.hr != RPC_E_CHANGED_MODE)
+				return false;
+
+			const int wlen = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, nullptr, 0);
+			if (wlen <= 0)
+				return false;
+			std::wstring wpath((std::size_t)wlen, L'\0');
+			MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, &wpath[0], wlen);
+
+			IWICImagingFactory* factory = nullptr;
+			IWICBitmapDecoder* decoder = nullptr;
+			IWICBitmapFrameDecode* frame = nullptr;
+			IWICFormatConverter* conv = nullptr;
+			UINT uw = 0, uh = 0;
+			bool ok = SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory)))
+				&& SUCCEEDED(factory->CreateDecoderFromFilename(wpath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder))
+				&& SUCCEEDED(decoder->GetFrame(0, &frame))
+				&& SUCCEEDED(factory->CreateFormatConverter(&conv))
+				// IMAGE 的像素是 0xAARRGGBB 的 DWORD，内存中即 B、G、R、A
+				&& SUCCEEDED(conv->Initialize(frame, GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom))
+				&& SUCCEEDED(conv->GetSize(&uw, &uh)) && uw > 0 && uh > 0;
+			if (ok)
+			{
+				w = (int)uw;
+				h = (int)uh;
+				px.assign((std::size_t)w * h, 0);
+				ok = SUCCEEDED(conv->CopyPixels(nullptr, uw * 4, uw * uh * 4, reinterpret_cast<BYTE*>(px.data())));
+			}
+			if (conv) conv->Release();
+			if (frame) frame->Release();
+			if (decoder) decoder->Release();
+			if (factory) factory->Release();
+			return ok;
+#endif
+		}
+	}
+
+	std::unique_ptr<IMAGE> ImageCache::loadOnUiThread(const std::string& path)
+	{
+		std::unique_ptr<IMAGE> src(new IMAGE());
+		loadimage(src.get(), path.c_str());
+		if (src->getwidth() <= 0 || src->getheight() <= 0)
+			return nullptr;
+		return src;
+	}
+
+	std::uint64_t ImageAsset::whenReady(std::function<void()> fn)
+	{
+		if (!fn)
+			return 0;
+		if (state_ != State::Pending)
+		{
+			fn();
+			return 0;
+		}
+		const std::uint64_t token = nextToken++;
+		waiters.emplace_back(token, std::move(fn));
+		return token;
+	}
+
+	void ImageAsset::cancel(std::uint64_t token)
+	{
+		for (auto it = waiters.begin(); it != waiters.end(); ++it)
+			if (it->first == token)
+			{
+				waiters.erase(it);
+				return;
+			}
+	}
+
+	void ImageAsset::resolve(std::shared_ptr<IMAGE> image)
+	{
+		img = std::move(image);
+		state_ = img ? State::Ready : State::Failed;
+		// 回调可能释放最后一个持有者（从而析构本资产）：先把等待表移出
+		auto fire = std::move(waiters);
+		waiters.clear();
+		for (auto& w : fire)
+			w.second();
+	}
+
+	ImageCache& ImageCache::Get()
+	{
+		// 有意不析构：全局 Window 析构时可能仍持有 / 归还缓存中的图像
+		static ImageCache* inst = new ImageCache();
+		return *inst;
+	}
+
+	void ImageCache::setMaxSizes(std::size_t n)
+	{
+		maxSizes_ = n < 1 ? 1 : n;
+		for (auto& kv : entries)
+			while (kv.second.outputs.size() > maxSizes_)
+			{
+				stats.bytesHeld -= imageBytes(kv.second.outputs.back().get());
+				kv.second.outputs.pop_back();
+			}
+	}
+
+	void ImageCache::setBudget(std::size_t bytes)
+	{
+		budget_ = bytes;
+		trim(nullptr);
+	}
+
+	std::shared_ptr<IMAGE> ImageCache::scaled(const std::string& path, int w, int h)
+	{
+		if (path.empty() || w <= 0 || h <= 0)
+			return nullptr;
+
+		auto it = entries.find(path);
+		if (it == entries.end())
+		{
+			std::unique_ptr<IMAGE> src = loadOnUiThread(path);
+			++stats.decodes;
+			if (!src)
+			{
+				SX_LOGW("ImageCache") << SX_T("图像解码失败：", "failed to decode image: ") << path;
+				return nullptr;
+			}
+			Entry& e = install(path, std::move(src));
+			auto out = outputFor(e, w, h);
+			trim(&e);
+			return out;
+		}
+		auto out = outputFor(it->second, w, h);
+		trim(&it->second);
+		return out;
+	}
+
+	std::shared_ptr<ImageAsset> ImageCache::acquire(const std::string& path, int w, int h)
+	{
+		++stats.acquires;
+		const AssetKey key(path, w, h);
+		if (on_)
+		{
+			auto a = assets.find(key);
+			if (a != assets.end())
+			{
+				if (auto live = a->second.lock())
+				{
+					++stats.shared;
+					return live;
+				}
+			}
+		}
+
+		std::shared_ptr<ImageAsset> asset(new ImageAsset(path, w, h));
+		if (path.empty() || w <= 0 || h <= 0)
+		{
+			asset->resolve(nullptr);
+			return asset;
+		}
+		if (!on_)
+		{
+			// 对比路径：每个持有者各自读盘解码一份
+			auto img = std::make_shared<IMAGE>();
+			loadimage(img.get(), path.c_str(), w, h);
+			asset->resolve(img->getwidth() > 0 ? img : nullptr);
+			return asset;
+		}
+		assets[key] = asset;
+
+		// 源图已在内存中，或同步模式：就地解析（缩放只在内存中进行）
+		if (entries.count(path) || !async_)
+		{
+			asset->resolve(scaled(path, w, h));
+			return asset;
+		}
+
+		auto f = inflight.find(path);
+		if (f == inflight.end())
+		{
+			f = inflight.emplace(path, Inflight{}).first;
+			f->second.gen = ++decodeGen;
+			++stats.asyncDecodes;
+			const std::uint64_t gen = f->second.gen;
+			ThreadPool::Get().post([this, path, gen]
+				{
+					std::unique_ptr<Decode> d(new Decode);
+					d->path = path;
+					d->gen = gen;
+					d->ok = decodeFile(path, d->px, d->w, d->h);
+					{
+						std::lock_guard<std::mutex> lk(doneLock);
+						done.push_back(std::move(d));
+					}
+					// 空闲的事件循环立即醒来，在 UI 线程 pump
+					EventLoop::wake();
+				});
+		}
+		f->second.waiting.push_back(asset);
+		return asset;
+	}
+
+	std::size_t ImageCache::pump()
+	{
+		if (inflight.empty())
+			return 0;
+
+		std::vector<std::unique_ptr<Decode>> ready;
+		{
+			std::lock_guard<std::mutex> lk(doneLock);
+			ready.swap(done);
+		}
+
+		std::size_t resolved = 0;
+		for (auto& d : ready)
+		{
+			auto f = inflight.find(d->path);
+			if (f == inflight.end() || f->second.gen != d->gen)
+				continue;
+			std::vector<std::weak_ptr<ImageAsset>> waiting = std::move(f->second.waiting);
+			inflight.erase(f);
+			++stats.decodes;
+
+			Entry* e = nullptr;
+			if (d->ok)
+			{
+				std::unique_ptr<IMAGE> src(new IMAGE(d->w, d->h));
+				std::memcpy(GetImageBuffer(src.get()), d->px.data(), d->px.size() * sizeof(DWORD));
+				e = &install(d->path, std::move(src));
+			}
+#if !SX_BACKEND_HEADLESS
+			else if (auto src = loadOnUiThread(d->path))
+			{
+				// WIC 解不了的格式：loadimage 只在 UI 线程调用
+				e = &install(d->path, std::move(src));
+			}
+#endif
+			else
+				SX_LOGW("ImageCache") << SX_T("图像解码失败：", "failed to decode image: ") << d->path;
+
+			for (auto& wa : waiting)
+			{
+				auto asset = wa.lock();
+				if (!asset || !asset->pending())
+					continue;
+				asset->resolve(e ? outputFor(*e, asset->width(), asset->height()) : nullptr);
+				++resolved;
+			}
+			if (e)
+				trim(e);
+		}
+
+		// 顺带清理已无人持有的资产登记
+		for (auto a = assets.begin(); a != assets.end();)
+			a = a->second.expired() ? assets.erase(a) : std::next(a);
+		return resolved;
+	}
+
+	std::size_t ImageCache::finishPending()
+	{
+		if (inflight.empty())
+			return 0;
+		ThreadPool::Get().waitBackground();
+		return pump();
+	}
+
+	ImageCache::Entry& ImageCache::install(const std::string& path, std::unique_ptr<IMAGE> src)
+	{
+		SX_LOGD("ImageCache") << SX_T("解码源图：", "decoded source: ") << path
+			<< " " << src->getwidth() << "x" << src->getheight();
+		auto old = entries.find(path);
+		if (old != entries.end())
+		{
+			drop(old->second);
+			entries.erase(old);
+		}
+		stats.bytesHeld += imageBytes(src.get());
+		Entry& e = entries.emplace(path, Entry{}).first->second;
+		e.source = std::move(src);
+		e.lastUse = ++tick;
+		return e;
+	}
+
+	std::shared_ptr<IMAGE> ImageCache::outputFor(Entry& e, int w, int h)
+	{
+		e.lastUse = ++tick;
+		for (auto o = e.outputs.begin(); o != e.outputs.end(); ++o)
+		{
+			if ((*o)->getwidth() == w && (*o)->getheight() == h)
+			{
+				++stats.hits;
+				e.outputs.splice(e.outputs.begin(), e.outputs, o);
+				return e.outputs.front();
+			}
+		}
+
+		++stats.rescales;
+		IMAGE* from = levelFor(e, w, h);
+		auto out = std::make_shared<IMAGE>(w, h);
+		const int sw = from->getwidth(), sh = from->getheight();
+		auto* dst = reinterpret_cast<std::uint32_t*>(GetImageBuffer(out.get()));
+		const auto* src = reinterpret_cast<const std::uint32_t*>(GetImageBuffer(from));
+		if (sw == w && sh == h)
+			Pixel::copyRect(dst, w, src, sw, w, h);
+		else
+			Pixel::scaleBilinear(dst, w, w, h, src, sw, sw, sh);
+
+		stats.bytesHeld += imageBytes(out.get());
+		e.outputs.push_front(out);
+		while (e.outputs.size() > maxSizes_)
+		{
+			stats.bytesHeld -= imageBytes(e.outputs.back().get());
+			e.outputs.pop_back();
+		}
+		return out;
+	}
+
+	IMAGE* ImageCache::levelFor(Entry& e, int w, int h)
+	{
+		IMAGE* level = e.source.get();
+		for (std::size_t k = 0; level->getwidth() / 2 >= w && level->getheight() / 2 >= h; ++k)
+		{
+			if (k == e.mips.size())
+			{
+				const int lw = level->getwidth(), lh = level->getheight();
+				std::unique_ptr<IMAGE> mip(new IMAGE(lw / 2, lh / 2));
+				Pixel::halve(reinterpret_cast<std::uint32_t*>(GetImageBuffer(mip.get())), lw / 2,
+					reinterpret_cast<const std::uint32_t*>(GetImageBuffer(level)), lw, lw, lh);
+				stats.bytesHeld += imageBytes(mip.get());
+				++stats.mipLevels;
+				e.mips.push_back(std::move(mip));
+			}
+			level = e.mips[k].get();
+		}
+		return level;
+	}
+
+	void ImageCache::drop(Entry& e)
+	{
+		stats.bytesHeld -= imageBytes(e.source.get());
+		for (auto& m : e.mips)
+			stats.bytesHeld -= imageBytes(m.get());
+		for (auto& o : e.outputs)
+			stats.bytesHeld -= imageBytes(o.get());
+	}
+
+	void ImageCache::trim(const Entry* keep)
+	{
+		while (stats.bytesHeld > budget_)
+		{
+			auto victim = entries.end();
+			for (auto it = entries.begin(); it != entries.end(); ++it)
+				if (&it->second != keep && (victim == entries.end() || it->second.lastUse < victim->second.lastUse))
+					victim = it;
+			if (victim == entries.end())
+				return;
+			SX_LOGD("ImageCache") << SX_T("超出预算，丢弃：", "over budget, evicting: ") << victim->first;
+			drop(victim->second);
+			entries.erase(victim);
+			++stats.evictions;
+		}
+	}
+
+	void ImageCache::evict(const std::string& path)
+	{
+		// 之后的 acquire 不再复用该路径的旧资产（持有者手里的不受影响）
+		for (auto a = assets.begin(); a != assets.end();)
+			a = std::get<0>(a->first) == path ? assets.erase(a) : std::next(a);
+		auto it = entries.find(path);
+		if (it == entries.end())
+			return;
+		drop(it->second);
+		entries.erase(it);
+	}
+
+	void ImageCache::clear()
+	{
+		assets.clear();
+		for (auto& kv : entries)
+			drop(kv.second);
+		entries.clear();
+	}
+
+	void ImageCache::resetStats()
+	{
+		const std::size_t held = stats.bytesHeld;
+		stats = Stats{};
+		stats.bytesHeld = held;
+	}
+}
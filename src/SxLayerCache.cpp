@@ -0,0 +1,97 @@
+﻿#include "SxLayerCache.h"
+#include "SxHash.h"
+
+#include <algorithm>
+
+namespace StellarX
+{
+	LayerCache& LayerCache::Get()
+	{
+		// 与 SurfacePool 相同：有意不析构，静态控件析构时仍可能访问
+		static LayerCache* inst = new LayerCache();
+		return *inst;
+	}
+
+	void LayerCache::setCapacity(std::size_t bytes)
+	{
+		capacity = bytes;
+		shrinkTo(capacity);
+	}
+
+	const IMAGE* LayerCache::find(std::uint64_t key, const std::string& identity)
+	{
+		auto it = index.find(key);
+		// 键相同而内容不同是哈希碰撞：按未命中处理，随后 store 会替换该条目
+		if (it == index.end() || it->second->identity != identity)
+		{
+			++stats.misses;
+			return nullptr;
+		}
+		++stats.hits;
+		lru.splice(lru.begin(), lru, it->second);
+		return it->second->layer.get();
+	}
+
+	void LayerCache::store(std::uint64_t key, std::string identity, std::unique_ptr<IMAGE> layer)
+	{
+		if (!layer)
+			return;
+		const std::size_t pixels = (std::size_t)layer->getwidth() * (std::size_t)layer->getheight() * 4;
+		const std::size_t bytes = pixels + identity.size();
+		if (pixels == 0 || bytes > capacity)
+			return;
+
+		auto it = index.find(key);
+		if (it != index.end())
+		{
+			stats.bytes -= it->second->bytes;
+			lru.erase(it->second);
+			index.erase(it);
+		}
+		shrinkTo(capacity - bytes);
+		lru.push_front(Entry{ key, std::move(identity), std::move(layer), bytes });
+		index[key] = lru.begin();
+		stats.bytes += bytes;
+		stats.entries = lru.size();
+	}
+
+	void LayerCache::clear()
+	{
+		lru.clear();
+		index.clear();
+		stats.bytes = 0;
+		stats.entries = 0;
+	}
+
+	void LayerCache::resetStats()
+	{
+		stats.hits = stats.misses = stats.evictions = 0;
+	}
+
+	void LayerCache::shrinkTo(std::size_t limit)
+	{
+		while (stats.bytes > limit && !lru.empty())
+		{
+			stats.bytes -= lru.back().bytes;
+			index.erase(lru.back().key);
+			lru.pop_back();
+			++stats.evictions;
+		}
+		stats.entries = lru.size();
+	}
+
+	std::uint64_t LayerCache::hashScreenRect(int x, int y, int w, int h, std::uint64_t seed)
+	{
+		// 调用方已 SetWorkingImage(nullptr)：GetImageBuffer(NULL) 与 getwidth()/getheight() 均指屏幕
+		const DWORD* px = GetImageBuffer(nullptr);
+		if (!px)
+			return seed;
+		const int sw = getwidth(), sh = getheight();
+		const int x0 = (std::max)(x, 0), x1 = (std::min)(x + w, sw);
+		const int y0 = (std::max)(y, 0), y1 = (std::min)(y + h, sh);
+		PixelHasher hsh(seed);
+		for (int yy = y0; yy < y1 && x0 < x1; ++yy)
+			hsh.add(reinterpret_cast<const std::uint32_t*>(px) + (std::size_t)yy * sw + x0, (std::size_t)(x1 - x0));
+		return hsh.finish();
+	}
+}
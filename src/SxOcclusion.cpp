@@ -0,0 +1,143 @@
+﻿#include "SxOcclusion.h"
+#include "Control.h"
+#include <algorithm>
+
+namespace StellarX
+{
+	namespace Occlusion
+	{
+		namespace
+		{
+			bool gEnabled = true;
+
+			Stats& mutableStats()
+			{
+				static Stats s;
+				return s;
+			}
+		}
+
+		std::size_t cull(const std::vector<Control*>& layers, const Region* limit, std::vector<char>& culled)
+		{
+			culled.assign(layers.size(), 0);
+			if (!gEnabled)
+				return 0;
+
+			Stats& st = mutableStats();
+			// 不透明矩形先攒在数组里：绝大多数被遮控件整个落在某一块里（对话框、面板），
+			// 逐块包含测试即可判定；只有跨多块时才把数组并成区域做精确减法
+			std::vector<RECT> opaque;
+			Region scratch;
+			Region covered;
+			std::size_t merged = 0;
+			bool anyOpaque = false;
+			RECT bounds{ 0, 0, 0, 0 };
+
+			int limL = 0, limT = 0, limR = 0, limB = 0;
+			if (limit && !limit->getBounds(limL, limT, limR, limB))
+				return 0;
+
+			std::size_t n = 0;
+			for (std::size_t i = layers.size(); i-- > 0;)
+			{
+				Control* c = layers[i];
+				if (!c || !c->IsVisible())
+					continue;
+				RECT rc = c->getDamageRect();
+				// 限定范围外的控件既不会被画，也挡不住范围内的东西：直接跳过，
+				// 分块合成时顶层控件很多，不跳过的话每块都要把全部不透明矩形攒一遍
+				if (limit && (rc.right <= limL || rc.left >= limR || rc.bottom <= limT || rc.top >= limB))
+					continue;
+				++st.tested;
+				if (anyOpaque)
+				{
+					if (limit)
+					{
+						rc.left = (std::max)(rc.left, (LONG)limL);
+						rc.top = (std::max)(rc.top, (LONG)limT);
+						rc.right = (std::min)(rc.right, (LONG)limR);
+						rc.bottom = (std::min)(rc.bottom, (LONG)limB);
+					}
+					// 限定范围内根本不相交的不算剔除，由调用方按原逻辑跳过
+					const bool candidate = rc.left < rc.right && rc.top < rc.bottom
+						&& rc.left >= bounds.left && rc.top >= bounds.top && rc.right <= bounds.right && rc.bottom <= bounds.bottom
+						&& (!limit || limit->intersects((int)rc.left, (int)rc.top, (int)rc.right, (int)rc.bottom));
+					if (candidate)
+					{
+						bool hidden = false;
+						for (const RECT& o : opaque)
+						{
+							if (rc.left >= o.left && rc.top >= o.top && rc.right <= o.right && rc.bottom <= o.bottom)
+							{
+								hidden = true;
+								break;
+							}
+						}
+						if (!hidden)
+						{
+							for (; merged < opaque.size(); ++merged)
+								covered.unite(opaque[merged].left, opaque[merged].top, opaque[merged].right, opaque[merged].bottom);
+							Region visible((int)rc.left, (int)rc.top, (int)rc.right, (int)rc.bottom);
+							if (limit)
+								visible.intersect(*limit);
+							hidden = visible.subtract(covered).isEmpty();
+						}
+						if (hidden)
+						{
+							culled[i] = 1;
+							++n;
+							continue;
+						}
+					}
+				}
+				scratch.clear();
+				c->addOpaqueRegion(scratch);
+				scratch.forEachRect([&](int l, int t, int r, int b)
+					{
+						opaque.push_back(RECT{ l, t, r, b });
+						if (!anyOpaque)
+							bounds = RECT{ l, t, r, b };
+						else
+						{
+							bounds.left = (std::min)(bounds.left, (LONG)l);
+							bounds.top = (std::min)(bounds.top, (LONG)t);
+							bounds.right = (std::max)(bounds.right, (LONG)r);
+							bounds.bottom = (std::max)(bounds.bottom, (LONG)b);
+						}
+						anyOpaque = true;
+					});
+			}
+			st.culled += n;
+			st.frameCulled += n;
+			return n;
+		}
+
+		void setEnabled(bool on)
+		{
+			gEnabled = on;
+		}
+
+		bool enabled()
+		{
+			return gEnabled;
+		}
+
+		void beginFrame()
+		{
+			Stats& st = mutableStats();
+			st.lastFrameCulled = st.frameCulled;
+			st.frameCulled = 0;
+			++st.frames;
+		}
+
+		const Stats& stats()
+		{
+			return mutableStats();
+		}
+
+		void resetStats()
+		{
+			mutableStats() = Stats{};
+		}
+	}
+}
@@ -0,0 +1,766 @@
+﻿#include "SxPixelKernels.h"
+
+/********************************************************************************
+ * @文件: SxPixelKernels.cpp
+ * @摘要: 星垣(StellarX) 像素内核实现
+ * @描述:
+ *     每种操作有标量 / SSE2 / AVX2 三个版本，首次使用时按 CPU 能力填充函数指针表。
+ *     AVX2 版本用编译器的 target 属性单独开启指令集，整个库无需 -mavx2 编译，
+ *     在不支持 AVX2 的机器上也不会执行到这些指令。
+ *
+ *     混合公式（每通道，s/d 为源/目标，a 为源 alpha，结果逐位可复现）：
+ *         t   = s * a + d * (255 - a) + 128
+ *         out = (t + (t >> 8)) >> 8          // 即 round(t' / 255)
+ *     alpha 通道按 s = 255 代入，得到 a + d * (255 - a) / 255（source-over 的覆盖率）。
+ *
+ *     预乘 alpha（不透明度合成）：
+ *         premultiply        p   = round(c * a / 255)，alpha 字节写为 a
+ *         blendPremultiplied out = min(255, s + round(d * (255 - a) / 255))，目标的 alpha 字节不变
+ *     round(x / 255) 用同一个 (t + (t >> 8)) >> 8 公式，各指令集逐位一致。
+ *
+ *     双线性缩放分两趟（每通道，wx/wy ∈ [0,128]）：
+ *         横向 h   = a * (128 - wx) + b * wx                 // 每个用到的源行算一次，存 16 位
+ *         纵向 out = (h0 * (128 - wy) + h1 * wy + 8192) >> 14
+ *     2×2 降采样：out = avg(avg(s00, s10), avg(s01, s11))，avg(x, y) = (x + y + 1) >> 1。
+ ********************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SX_PIXEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SX_TARGET_SSE2
+#define SX_TARGET_AVX2
+#else
+#define SX_TARGET_SSE2 __attribute__((target("sse2")))
+#define SX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define SX_PIXEL_X86 0
+#endif
+
+namespace StellarX
+{
+	namespace Pixel
+	{
+		namespace
+		{
+			/* ---------------- 标量 ---------------- */
+
+			inline std::uint32_t blendChannel(std::uint32_t s, std::uint32_t d, std::uint32_t a)
+			{
+				const std::uint32_t t = s * a + d * (255 - a) + 128;
+				return (t + (t >> 8)) >> 8;
+			}
+
+			inline std::uint32_t blendPixel(std::uint32_t d, std::uint32_t s)
+			{
+				const std::uint32_t a = s >> 24;
+				if (a == 255) return s;
+				if (a == 0) return d;
+				return blendChannel(s & 0xFF, d & 0xFF, a)
+					| blendChannel((s >> 8) & 0xFF, (d >> 8) & 0xFF, a) << 8
+					| blendChannel((s >> 16) & 0xFF, (d >> 16) & 0xFF, a) << 16
+					| blendChannel(255, d >> 24, a) << 24;
+			}
+
+			void copyScalar(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				std::memmove(dst, src, n * sizeof(std::uint32_t));
+			}
+
+			void fillScalar(std::uint32_t* dst, std::size_t n, std::uint32_t px)
+			{
+				for (std::size_t i = 0; i < n; ++i) dst[i] = px;
+			}
+
+			void blendScalar(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i) dst[i] = blendPixel(dst[i], src[i]);
+			}
+
+			// 覆盖率混合：四个字节通道统一按 cov 在 px 与 dst 之间插值
+			inline std::uint32_t coverPixel(std::uint32_t d, std::uint32_t px, std::uint32_t a)
+			{
+				return blendChannel(px & 0xFF, d & 0xFF, a)
+					| blendChannel((px >> 8) & 0xFF, (d >> 8) & 0xFF, a) << 8
+					| blendChannel((px >> 16) & 0xFF, (d >> 16) & 0xFF, a) << 16
+					| blendChannel(px >> 24, d >> 24, a) << 24;
+			}
+
+			void coverScalar(std::uint32_t* dst, const std::uint8_t* cov, std::size_t n, std::uint32_t px)
+			{
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					const std::uint32_t a = cov[i];
+					if (a == 255) dst[i] = px;
+					else if (a) dst[i] = coverPixel(dst[i], px, a);
+				}
+			}
+
+			inline std::uint32_t premulPixel(std::uint32_t s, std::uint32_t a)
+			{
+				return blendChannel(s & 0xFF, 0, a)
+					| blendChannel((s >> 8) & 0xFF, 0, a) << 8
+					| blendChannel((s >> 16) & 0xFF, 0, a) << 16
+					| a << 24;
+			}
+
+			void premulScalar(std::uint32_t* dst, const std::uint32_t* src, std::size_t n, std::uint32_t a)
+			{
+				for (std::size_t i = 0; i < n; ++i) dst[i] = premulPixel(src[i], a);
+			}
+
+			// 预乘源覆盖：源颜色已乘过 alpha，目标只需乘 (255 - a)
+			inline std::uint32_t overPixel(std::uint32_t d, std::uint32_t s)
+			{
+				if (s == 0) return d;
+				const std::uint32_t a = s >> 24;
+				std::uint32_t out = d & 0xFF000000u;
+				for (int c = 0; c < 24; c += 8)
+					out |= (std::min)(255u, ((s >> c) & 0xFF) + blendChannel(0, (d >> c) & 0xFF, a)) << c;
+				return out;
+			}
+
+			void overScalar(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				for (std::size_t i = 0; i < n; ++i) dst[i] = overPixel(dst[i], src[i]);
+			}
+
+			// 横向插值：out[4i + c] = 第 i 个输出像素通道 c 的 128 倍值
+			void hlerpScalar(std::uint16_t* out, const std::uint32_t* src, const int* x0, const int* x1, const std::uint16_t* wx, int n)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					const std::uint32_t a = src[x0[i]], b = src[x1[i]];
+					const std::uint32_t w = wx[i], iw = 128 - w;
+					for (int c = 0; c < 4; ++c)
+						out[4 * i + c] = (std::uint16_t)(((a >> (8 * c)) & 0xFF) * iw + ((b >> (8 * c)) & 0xFF) * w);
+				}
+			}
+
+			void vlerpScalar(std::uint32_t* dst, const std::uint16_t* top, const std::uint16_t* bot, int n, int wy)
+			{
+				const std::uint32_t iw = 128 - (std::uint32_t)wy;
+				for (int i = 0; i < n; ++i)
+				{
+					std::uint32_t px = 0;
+					for (int c = 0; c < 4; ++c)
+						px |= ((top[4 * i + c] * iw + bot[4 * i + c] * (std::uint32_t)wy + 8192) >> 14) << (8 * c);
+					dst[i] = px;
+				}
+			}
+
+			// 逐字节 (x + y + 1) >> 1
+			inline std::uint32_t avgPixel(std::uint32_t x, std::uint32_t y)
+			{
+				return (x | y) - (((x ^ y) & 0xFEFEFEFEu) >> 1);
+			}
+
+			void halveScalar(std::uint32_t* dst, const std::uint32_t* r0, const std::uint32_t* r1, int dw)
+			{
+				for (int x = 0; x < dw; ++x)
+					dst[x] = avgPixel(avgPixel(r0[2 * x], r1[2 * x]), avgPixel(r0[2 * x + 1], r1[2 * x + 1]));
+			}
+
+#if SX_PIXEL_X86
+			/* ---------------- SSE2 ---------------- */
+
+			SX_TARGET_SSE2 inline __m128i load4(const std::uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+			SX_TARGET_SSE2 inline void store4(std::uint32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+			SX_TARGET_SSE2 inline __m128i loadH8(const std::uint16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+
+			SX_TARGET_SSE2 void copySse2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				// 快照与屏幕不会重叠，但 putimage 允许同一表面内搬运：重叠时退回 memmove
+				if (n < 4 || (dst < src + n && src < dst + n)) { copyScalar(dst, src, n); return; }
+				// 短行（按钮宽度量级）：首尾两段重叠读写，无逐像素尾循环
+				if (n <= 8)
+				{
+					const __m128i a = load4(src), b = load4(src + n - 4);
+					store4(dst, a); store4(dst + n - 4, b);
+					return;
+				}
+				// 先读满一组再写，尾部以最后 4 像素重叠收尾
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16)
+				{
+					const __m128i a = load4(src + i), b = load4(src + i + 4), c = load4(src + i + 8), d = load4(src + i + 12);
+					store4(dst + i, a); store4(dst + i + 4, b); store4(dst + i + 8, c); store4(dst + i + 12, d);
+				}
+				for (; i + 4 <= n; i += 4) store4(dst + i, load4(src + i));
+				if (i < n) store4(dst + n - 4, load4(src + n - 4));
+			}
+
+			SX_TARGET_SSE2 void fillSse2(std::uint32_t* dst, std::size_t n, std::uint32_t px)
+			{
+				if (n < 4) { fillScalar(dst, n, px); return; }
+				const __m128i v = _mm_set1_epi32((int)px);
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8) { store4(dst + i, v); store4(dst + i + 4, v); }
+				if (i + 4 <= n) { store4(dst + i, v); i += 4; }
+				if (i < n) store4(dst + n - 4, v);
+			}
+
+			// 两个像素（8 个 16 位通道）的混合
+			SX_TARGET_SSE2 inline __m128i blend2Sse2(__m128i s16, __m128i d16, __m128i a16)
+			{
+				const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a16);
+				__m128i t = _mm_add_epi16(_mm_mullo_epi16(s16, a16), _mm_mullo_epi16(d16, ia));
+				t = _mm_add_epi16(t, _mm_set1_epi16(128));
+				return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+			}
+
+			SX_TARGET_SSE2 void blendSse2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000u);
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+					const __m128i a = _mm_and_si128(s, alphaMask);
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, alphaMask)) == 0xFFFF)
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);   // 4 个全不透明
+						continue;
+					}
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xFFFF)
+						continue;                                                    // 4 个全透明
+					const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+					const __m128i so = _mm_or_si128(s, alphaMask);               // alpha 通道按 255 代入
+
+					const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+					const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+					const __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+					const __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+					const __m128i lo = blend2Sse2(_mm_unpacklo_epi8(so, zero), _mm_unpacklo_epi8(d, zero), aLo);
+					const __m128i hi = blend2Sse2(_mm_unpackhi_epi8(so, zero), _mm_unpackhi_epi8(d, zero), aHi);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+				}
+				for (; i < n; ++i) dst[i] = blendPixel(dst[i], src[i]);
+			}
+
+			SX_TARGET_SSE2 void coverSse2(std::uint32_t* dst, const std::uint8_t* cov, std::size_t n, std::uint32_t px)
+			{
+				// 形状边缘多为 1~3 像素的短段，直接走标量
+				if (n < 4) { coverScalar(dst, cov, n, px); return; }
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i s16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)px), zero);
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					std::uint32_t c4;
+					std::memcpy(&c4, cov + i, 4);
+					if (c4 == 0) continue;
+					if (c4 == 0xFFFFFFFFu) { store4(dst + i, _mm_set1_epi32((int)px)); continue; }
+					// 每个像素的覆盖率复制到它的 4 个 16 位通道
+					const __m128i c16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)c4), zero);
+					const __m128i cc = _mm_unpacklo_epi16(c16, c16);
+					const __m128i d = load4(dst + i);
+					const __m128i lo = blend2Sse2(s16, _mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(cc, cc));
+					const __m128i hi = blend2Sse2(s16, _mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(cc, cc));
+					store4(dst + i, _mm_packus_epi16(lo, hi));
+				}
+				if (i < n) coverScalar(dst + i, cov + i, n - i, px);
+			}
+
+			// 8 个 16 位通道的 round(x * m / 255)
+			SX_TARGET_SSE2 inline __m128i mulDiv255Sse2(__m128i x16, __m128i m16)
+			{
+				const __m128i t = _mm_add_epi16(_mm_mullo_epi16(x16, m16), _mm_set1_epi16(128));
+				return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+			}
+
+			SX_TARGET_SSE2 void premulSse2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n, std::uint32_t a)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i a16 = _mm_set1_epi16((short)a);
+				const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+				const __m128i alpha = _mm_set1_epi32((int)(a << 24));
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i s = load4(src + i);
+					const __m128i lo = mulDiv255Sse2(_mm_unpacklo_epi8(s, zero), a16);
+					const __m128i hi = mulDiv255Sse2(_mm_unpackhi_epi8(s, zero), a16);
+					store4(dst + i, _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), colorMask), alpha));
+				}
+				if (i < n) premulScalar(dst + i, src + i, n - i, a);
+			}
+
+			SX_TARGET_SSE2 void overSse2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000u);
+				const __m128i c255 = _mm_set1_epi16(255);
+				std::size_t i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i s = load4(src + i);
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF)
+						continue;                                                    // 4 个全透明
+					const __m128i d = load4(dst + i);
+					const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+					const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+					const __m128i iaLo = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+					const __m128i iaHi = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+					const __m128i lo = _mm_adds_epu16(sLo, mulDiv255Sse2(_mm_unpacklo_epi8(d, zero), iaLo));
+					const __m128i hi = _mm_adds_epu16(sHi, mulDiv255Sse2(_mm_unpackhi_epi8(d, zero), iaHi));
+					const __m128i out = _mm_packus_epi16(lo, hi);
+					store4(dst + i, _mm_or_si128(_mm_andnot_si128(alphaMask, out), _mm_and_si128(d, alphaMask)));
+				}
+				if (i < n) overScalar(dst + i, src + i, n - i);
+			}
+
+			SX_TARGET_SSE2 void hlerpSse2(std::uint16_t* out, const std::uint32_t* src, const int* x0, const int* x1, const std::uint16_t* wx, int n)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				int i = 0;
+				for (; i + 2 <= n; i += 2)
+				{
+					// 每个输出像素：(a.c, b.c) 交错成 16 位对，与 (128 - w, w) 做 madd
+					const __m128i p0 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(
+						_mm_cvtsi32_si128((int)src[x0[i]]), _mm_cvtsi32_si128((int)src[x1[i]])), zero);
+					const __m128i p1 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(
+						_mm_cvtsi32_si128((int)src[x0[i + 1]]), _mm_cvtsi32_si128((int)src[x1[i + 1]])), zero);
+					const __m128i w0 = _mm_set1_epi32((int)(((std::uint32_t)wx[i] << 16) | (128u - wx[i])));
+					const __m128i w1 = _mm_set1_epi32((int)(((std::uint32_t)wx[i + 1] << 16) | (128u - wx[i + 1])));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i),
+						_mm_packs_epi32(_mm_madd_epi16(p0, w0), _mm_madd_epi16(p1, w1)));
+				}
+				if (i < n) hlerpScalar(out + 4 * i, src, x0 + i, x1 + i, wx + i, n - i);
+			}
+
+			// 一对 16 位行向量（各 2 像素）的纵向插值，结果为 4 × 32 位 × 2
+			SX_TARGET_SSE2 inline __m128i vlerp2Sse2(__m128i t, __m128i b, __m128i w, __m128i round)
+			{
+				const __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(t, b), w), round), 14);
+				const __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(t, b), w), round), 14);
+				return _mm_packs_epi32(lo, hi);
+			}
+
+			SX_TARGET_SSE2 void vlerpSse2(std::uint32_t* dst, const std::uint16_t* top, const std::uint16_t* bot, int n, int wy)
+			{
+				const __m128i w = _mm_set1_epi32((int)(((std::uint32_t)wy << 16) | (128u - (std::uint32_t)wy)));
+				const __m128i round = _mm_set1_epi32(8192);
+				int i = 0;
+				for (; i + 4 <= n; i += 4)
+				{
+					const __m128i a = vlerp2Sse2(loadH8(top + 4 * i), loadH8(bot + 4 * i), w, round);
+					const __m128i b = vlerp2Sse2(loadH8(top + 4 * i + 8), loadH8(bot + 4 * i + 8), w, round);
+					store4(dst + i, _mm_packus_epi16(a, b));
+				}
+				if (i < n) vlerpScalar(dst + i, top + 4 * i, bot + 4 * i, n - i, wy);
+			}
+
+			SX_TARGET_SSE2 void halveSse2(std::uint32_t* dst, const std::uint32_t* r0, const std::uint32_t* r1, int dw)
+			{
+				int x = 0;
+				for (; x + 4 <= dw; x += 4)
+				{
+					const __m128 va = _mm_castsi128_ps(_mm_avg_epu8(load4(r0 + 2 * x), load4(r1 + 2 * x)));
+					const __m128 vb = _mm_castsi128_ps(_mm_avg_epu8(load4(r0 + 2 * x + 4), load4(r1 + 2 * x + 4)));
+					const __m128i even = _mm_castps_si128(_mm_shuffle_ps(va, vb, _MM_SHUFFLE(2, 0, 2, 0)));
+					const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(va, vb, _MM_SHUFFLE(3, 1, 3, 1)));
+					store4(dst + x, _mm_avg_epu8(even, odd));
+				}
+				if (x < dw) halveScalar(dst + x, r0 + 2 * x, r1 + 2 * x, dw - x);
+			}
+
+			/* ---------------- AVX2 ---------------- */
+
+			SX_TARGET_AVX2 inline __m256i load8(const std::uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+			SX_TARGET_AVX2 inline void store8(std::uint32_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+			SX_TARGET_AVX2 inline __m256i loadH16(const std::uint16_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+			SX_TARGET_AVX2 void copyAvx2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				if (n < 8 || (dst < src + n && src < dst + n)) { copySse2(dst, src, n); return; }
+				if (n <= 16)
+				{
+					const __m256i a = load8(src), b = load8(src + n - 8);
+					store8(dst, a); store8(dst + n - 8, b);
+					return;
+				}
+				if (n <= 32)
+				{
+					const __m256i a = load8(src), b = load8(src + 8), c = load8(src + n - 16), d = load8(src + n - 8);
+					store8(dst, a); store8(dst + 8, b); store8(dst + n - 16, c); store8(dst + n - 8, d);
+					return;
+				}
+				std::size_t i = 0;
+				for (; i + 32 <= n; i += 32)
+				{
+					const __m256i a = load8(src + i), b = load8(src + i + 8), c = load8(src + i + 16), d = load8(src + i + 24);
+					store8(dst + i, a); store8(dst + i + 8, b); store8(dst + i + 16, c); store8(dst + i + 24, d);
+				}
+				for (; i + 8 <= n; i += 8) store8(dst + i, load8(src + i));
+				if (i < n) store8(dst + n - 8, load8(src + n - 8));
+			}
+
+			SX_TARGET_AVX2 void fillAvx2(std::uint32_t* dst, std::size_t n, std::uint32_t px)
+			{
+				if (n < 8) { fillSse2(dst, n, px); return; }
+				const __m256i v = _mm256_set1_epi32((int)px);
+				std::size_t i = 0;
+				for (; i + 16 <= n; i += 16) { store8(dst + i, v); store8(dst + i + 8, v); }
+				if (i + 8 <= n) { store8(dst + i, v); i += 8; }
+				if (i < n) store8(dst + n - 8, v);
+			}
+
+			SX_TARGET_AVX2 inline __m256i blend4Avx2(__m256i s16, __m256i d16, __m256i a16)
+			{
+				const __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a16);
+				__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(s16, a16), _mm256_mullo_epi16(d16, ia));
+				t = _mm256_add_epi16(t, _mm256_set1_epi16(128));
+				return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+			}
+
+			SX_TARGET_AVX2 void blendAvx2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000u);
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+					const __m256i a = _mm256_and_si256(s, alphaMask);
+					if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, alphaMask)) == -1)
+					{
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+						continue;
+					}
+					if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(a, zero)) == -1)
+						continue;
+					const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+					const __m256i so = _mm256_or_si256(s, alphaMask);
+
+					// unpack/pack 都在各自 128 位半区内进行，成对使用时像素顺序保持不变
+					const __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+					const __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+					const __m256i aLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+					const __m256i aHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+					const __m256i lo = blend4Avx2(_mm256_unpacklo_epi8(so, zero), _mm256_unpacklo_epi8(d, zero), aLo);
+					const __m256i hi = blend4Avx2(_mm256_unpackhi_epi8(so, zero), _mm256_unpackhi_epi8(d, zero), aHi);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+				}
+				for (; i < n; ++i) dst[i] = blendPixel(dst[i], src[i]);
+			}
+
+			SX_TARGET_AVX2 void coverAvx2(std::uint32_t* dst, const std::uint8_t* cov, std::size_t n, std::uint32_t px)
+			{
+				if (n < 8) { coverSse2(dst, cov, n, px); return; }
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i s16 = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)px), zero);
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					std::uint64_t c8;
+					std::memcpy(&c8, cov + i, 8);
+					if (c8 == 0) continue;
+					if (c8 == ~0ull) { store8(dst + i, _mm256_set1_epi32((int)px)); continue; }
+					// 每像素一个 32 位 (c | c << 16)，再按半区内的 unpack 顺序复制成 4 个通道
+					const __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cov + i)));
+					const __m256i c32 = _mm256_or_si256(c, _mm256_slli_epi32(c, 16));
+					const __m256i d = load8(dst + i);
+					const __m256i lo = blend4Avx2(s16, _mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi32(c32, c32));
+					const __m256i hi = blend4Avx2(s16, _mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi32(c32, c32));
+					store8(dst + i, _mm256_packus_epi16(lo, hi));
+				}
+				if (i < n) coverScalar(dst + i, cov + i, n - i, px);
+			}
+
+			SX_TARGET_AVX2 inline __m256i mulDiv255Avx2(__m256i x16, __m256i m16)
+			{
+				const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x16, m16), _mm256_set1_epi16(128));
+				return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+			}
+
+			SX_TARGET_AVX2 void premulAvx2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n, std::uint32_t a)
+			{
+				if (n < 8) { premulSse2(dst, src, n, a); return; }
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i a16 = _mm256_set1_epi16((short)a);
+				const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+				const __m256i alpha = _mm256_set1_epi32((int)(a << 24));
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i s = load8(src + i);
+					const __m256i lo = mulDiv255Avx2(_mm256_unpacklo_epi8(s, zero), a16);
+					const __m256i hi = mulDiv255Avx2(_mm256_unpackhi_epi8(s, zero), a16);
+					store8(dst + i, _mm256_or_si256(_mm256_and_si256(_mm256_packus_epi16(lo, hi), colorMask), alpha));
+				}
+				if (i < n) premulScalar(dst + i, src + i, n - i, a);
+			}
+
+			SX_TARGET_AVX2 void overAvx2(std::uint32_t* dst, const std::uint32_t* src, std::size_t n)
+			{
+				if (n < 8) { overSse2(dst, src, n); return; }
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000u);
+				const __m256i c255 = _mm256_set1_epi16(255);
+				std::size_t i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i s = load8(src + i);
+					if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+						continue;
+					const __m256i d = load8(dst + i);
+					const __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+					const __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+					const __m256i iaLo = _mm256_sub_epi16(c255, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+					const __m256i iaHi = _mm256_sub_epi16(c255, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)));
+					const __m256i lo = _mm256_adds_epu16(sLo, mulDiv255Avx2(_mm256_unpacklo_epi8(d, zero), iaLo));
+					const __m256i hi = _mm256_adds_epu16(sHi, mulDiv255Avx2(_mm256_unpackhi_epi8(d, zero), iaHi));
+					const __m256i out = _mm256_packus_epi16(lo, hi);
+					store8(dst + i, _mm256_or_si256(_mm256_andnot_si256(alphaMask, out), _mm256_and_si256(d, alphaMask)));
+				}
+				if (i < n) overScalar(dst + i, src + i, n - i);
+			}
+
+			SX_TARGET_AVX2 inline __m256i vlerp4Avx2(__m256i t, __m256i b, __m256i w, __m256i round)
+			{
+				const __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(t, b), w), round), 14);
+				const __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(t, b), w), round), 14);
+				return _mm256_packs_epi32(lo, hi);
+			}
+
+			// 横向插值以两次随机读取为主，AVX2 下沿用 SSE2 版本；纵向插值是整行流式运算
+			SX_TARGET_AVX2 void vlerpAvx2(std::uint32_t* dst, const std::uint16_t* top, const std::uint16_t* bot, int n, int wy)
+			{
+				const __m256i w = _mm256_set1_epi32((int)(((std::uint32_t)wy << 16) | (128u - (std::uint32_t)wy)));
+				const __m256i round = _mm256_set1_epi32(8192);
+				int i = 0;
+				for (; i + 8 <= n; i += 8)
+				{
+					const __m256i a = vlerp4Avx2(loadH16(top + 4 * i), loadH16(bot + 4 * i), w, round);
+					const __m256i b = vlerp4Avx2(loadH16(top + 4 * i + 16), loadH16(bot + 4 * i + 16), w, round);
+					// 半区内打包后的 64 位组顺序为 0,2,1,3，重排回线性顺序
+					store8(dst + i, _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+				}
+				if (i < n) vlerpSse2(dst + i, top + 4 * i, bot + 4 * i, n - i, wy);
+			}
+#endif
+
+			struct Kernels
+			{
+				void (*copy)(std::uint32_t*, const std::uint32_t*, std::size_t);
+				void (*fill)(std::uint32_t*, std::size_t, std::uint32_t);
+				void (*blend)(std::uint32_t*, const std::uint32_t*, std::size_t);
+				void (*cover)(std::uint32_t*, const std::uint8_t*, std::size_t, std::uint32_t);
+				void (*premul)(std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t);
+				void (*over)(std::uint32_t*, const std::uint32_t*, std::size_t);
+				void (*hlerp)(std::uint16_t*, const std::uint32_t*, const int*, const int*, const std::uint16_t*, int);
+				void (*vlerp)(std::uint32_t*, const std::uint16_t*, const std::uint16_t*, int, int);
+				void (*halve)(std::uint32_t*, const std::uint32_t*, const std::uint32_t*, int);
+			};
+
+			Kernels kernelsFor(Isa isa)
+			{
+#if SX_PIXEL_X86
+				if (isa == Isa::AVX2) return { copyAvx2, fillAvx2, blendAvx2, coverAvx2, premulAvx2, overAvx2, hlerpSse2, vlerpAvx2, halveSse2 };
+				if (isa == Isa::SSE2) return { copySse2, fillSse2, blendSse2, coverSse2, premulSse2, overSse2, hlerpSse2, vlerpSse2, halveSse2 };
+#endif
+				(void)isa;
+				return { copyScalar, fillScalar, blendScalar, coverScalar, premulScalar, overScalar, hlerpScalar, vlerpScalar, halveScalar };
+			}
+
+			// 目标第 i 个像素中心在源轴上的位置：下标 i0/i1 与 i1 的 7 位权重
+			inline void axisSample(int sn, int dn, int i, int& i0, int& i1, std::uint16_t& w)
+			{
+				std::int64_t pos = (std::int64_t)(2 * i + 1) * sn * 128 / (2 * (std::int64_t)dn) - 64;
+				if (pos < 0) pos = 0;
+				i0 = (int)(pos >> 7);
+				w = (std::uint16_t)(pos & 127);
+				if (i0 >= sn - 1)
+				{
+					i0 = sn - 1;
+					w = 0;
+				}
+				i1 = i0 + 1 < sn ? i0 + 1 : sn - 1;
+			}
+
+			Isa detectIsa()
+			{
+#if SX_PIXEL_X86
+#if defined(_MSC_VER)
+				int r[4];
+				__cpuid(r, 0);
+				const int maxLeaf = r[0];
+				__cpuid(r, 1);
+				const bool sse2 = (r[3] & (1 << 26)) != 0;
+				const bool osxsave = (r[2] & (1 << 27)) != 0 && (r[2] & (1 << 28)) != 0;  // OSXSAVE + AVX
+				bool avx2 = false;
+				if (osxsave && maxLeaf >= 7 && (_xgetbv(0) & 6) == 6)
+				{
+					__cpuidex(r, 7, 0);
+					avx2 = (r[1] & (1 << 5)) != 0;
+				}
+#else
+				__builtin_cpu_init();
+				const bool sse2 = __builtin_cpu_supports("sse2");
+				const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+				if (avx2) return Isa::AVX2;
+				if (sse2) return Isa::SSE2;
+#endif
+				return Isa::Scalar;
+			}
+
+			struct Dispatch
+			{
+				Isa best = detectIsa();
+				Isa active = best;
+				Kernels k = kernelsFor(best);
+			};
+
+			Dispatch& dispatch()
+			{
+				static Dispatch d;
+				return d;
+			}
+		}
+
+		Isa activeIsa() { return dispatch().active; }
+		Isa bestIsa() { return dispatch().best; }
+
+		void setIsa(Isa isa)
+		{
+			Dispatch& d = dispatch();
+			d.active = (int)isa > (int)d.best ? d.best : isa;
+			d.k = kernelsFor(d.active);
+		}
+
+		const char* isaName(Isa isa)
+		{
+			switch (isa)
+			{
+			case Isa::AVX2: return "avx2";
+			case Isa::SSE2: return "sse2";
+			default:        return "scalar";
+			}
+		}
+
+		void copy(std::uint32_t* dst, const std::uint32_t* src, std::size_t n) { dispatch().k.copy(dst, src, n); }
+		void fill(std::uint32_t* dst, std::size_t n, std::uint32_t px) { dispatch().k.fill(dst, n, px); }
+		void blendSourceOver(std::uint32_t* dst, const std::uint32_t* src, std::size_t n) { dispatch().k.blend(dst, src, n); }
+		void blendCoverage(std::uint32_t* dst, const std::uint8_t* cov, std::size_t n, std::uint32_t px) { dispatch().k.cover(dst, cov, n, px); }
+		void premultiply(std::uint32_t* dst, const std::uint32_t* src, std::size_t n, std::uint8_t alpha) { dispatch().k.premul(dst, src, n, alpha); }
+		void blendPremultiplied(std::uint32_t* dst, const std::uint32_t* src, std::size_t n) { dispatch().k.over(dst, src, n); }
+
+		void copyRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h)
+		{
+			if (w <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < h; ++y)
+				k.copy(dst + y * dstStride, src + y * srcStride, (std::size_t)w);
+		}
+
+		void fillRect(std::uint32_t* dst, std::ptrdiff_t stride, int w, int h, std::uint32_t px)
+		{
+			if (w <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < h; ++y)
+				k.fill(dst + y * stride, (std::size_t)w, px);
+		}
+
+		void fillRectBordered(std::uint32_t* dst, std::ptrdiff_t stride, int w, int h, std::uint32_t fill, std::uint32_t border, int borderWidth)
+		{
+			if (w <= 0 || h <= 0) return;
+			const Kernels& k = dispatch().k;
+			const int bw = borderWidth < 1 ? 1 : borderWidth;
+			for (int y = 0; y < h; ++y)
+			{
+				std::uint32_t* row = dst + y * stride;
+				if (y < bw || y >= h - bw || w <= 2 * bw)
+				{
+					k.fill(row, (std::size_t)w, border);
+					continue;
+				}
+				k.fill(row, (std::size_t)bw, border);
+				k.fill(row + bw, (std::size_t)(w - 2 * bw), fill);
+				k.fill(row + w - bw, (std::size_t)bw, border);
+			}
+		}
+
+		void blendRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h)
+		{
+			if (w <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < h; ++y)
+				k.blend(dst + y * dstStride, src + y * srcStride, (std::size_t)w);
+		}
+
+		void premultiplyRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h, std::uint8_t alpha)
+		{
+			if (w <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < h; ++y)
+				k.premul(dst + y * dstStride, src + y * srcStride, (std::size_t)w, alpha);
+		}
+
+		void blendPremultipliedRect(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int w, int h)
+		{
+			if (w <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < h; ++y)
+				k.over(dst + y * dstStride, src + y * srcStride, (std::size_t)w);
+		}
+
+		void scaleBilinear(std::uint32_t* dst, std::ptrdiff_t dstStride, int dw, int dh,
+			const std::uint32_t* src, std::ptrdiff_t srcStride, int sw, int sh)
+		{
+			if (dw <= 0 || dh <= 0 || sw <= 0 || sh <= 0) return;
+			const Kernels& k = dispatch().k;
+
+			std::vector<int> x0(dw), x1(dw);
+			std::vector<std::uint16_t> wx(dw);
+			for (int x = 0; x < dw; ++x)
+				axisSample(sw, dw, x, x0[x], x1[x], wx[x]);
+
+			// 两行横向结果滚动复用：放大时相邻输出行共享源行，只在源行变化时重算
+			std::vector<std::uint16_t> rowA((std::size_t)dw * 4), rowB((std::size_t)dw * 4);
+			int haveA = -1, haveB = -1;
+			for (int y = 0; y < dh; ++y)
+			{
+				int y0, y1;
+				std::uint16_t wy;
+				axisSample(sh, dh, y, y0, y1, wy);
+				if (haveA != y0 && haveB == y0)
+				{
+					std::swap(rowA, rowB);
+					std::swap(haveA, haveB);
+				}
+				if (haveA != y0)
+				{
+					k.hlerp(rowA.data(), src + y0 * srcStride, x0.data(), x1.data(), wx.data(), dw);
+					haveA = y0;
+				}
+				if (haveB != y1)
+				{
+					k.hlerp(rowB.data(), src + y1 * srcStride, x0.data(), x1.data(), wx.data(), dw);
+					haveB = y1;
+				}
+				k.vlerp(dst + y * dstStride, rowA.data(), rowB.data(), dw, wy);
+			}
+		}
+
+		void halve(std::uint32_t* dst, std::ptrdiff_t dstStride, const std::uint32_t* src, std::ptrdiff_t srcStride, int sw, int sh)
+		{
+			const int dw = sw / 2, dh = sh / 2;
+			if (dw <= 0) return;
+			const Kernels& k = dispatch().k;
+			for (int y = 0; y < dh; ++y)
+				k.halve(dst + y * dstStride, src + 2 * y * srcStride, src + (2 * y + 1) * srcStride, dw);
+		}
+	}
+}
@@ -0,0 +1,75 @@
+﻿#include "SxPresent.h"
+#include "SxBackend.h"
+#include "SxLog.h"
+
+#include <vector>
+
+namespace StellarX
+{
+	namespace Present
+	{
+		namespace
+		{
+			bool g_enabled = true;
+			int g_maxRects = 8;
+			Stats g_stats;
+		}
+
+		void setEnabled(bool on) { g_enabled = on; }
+		bool enabled() { return g_enabled; }
+		void setMaxRects(int n) { g_maxRects = n < 1 ? 1 : n; }
+		int maxRects() { return g_maxRects; }
+		const Stats& stats() { return g_stats; }
+		void resetStats() { g_stats = Stats{}; }
+
+		void endBatch(const Region& touched, int screenW, int screenH)
+		{
+			const std::uint64_t full = (std::uint64_t)(screenW > 0 ? screenW : 0) * (screenH > 0 ? screenH : 0) * 4;
+			++g_stats.frames;
+			g_stats.fullBytes += full;
+
+			Region area = touched;
+			area.intersect(Region(0, 0, screenW, screenH));
+			if (!g_enabled || (std::uint64_t)area.area() * 4 * 2 > full)
+			{
+				EndBatchDraw();
+				++g_stats.rects;
+				g_stats.bytesPresented += full;
+				g_stats.lastFrameBytes = full;
+				return;
+			}
+
+			std::vector<RECT> rects;
+			if ((int)area.rectCount() > g_maxRects)
+			{
+				int l, t, r, b;
+				area.getBounds(l, t, r, b);
+				rects.push_back(RECT{ l, t, r, b });
+			}
+			else
+				area.forEachRect([&rects](int l, int t, int r, int b) { rects.push_back(RECT{ l, t, r, b }); });
+
+			std::uint64_t bytes = 0;
+			for (const RECT& rc : rects)
+				bytes += (std::uint64_t)(rc.right - rc.left) * (rc.bottom - rc.top) * 4;
+			++g_stats.partialFrames;
+			g_stats.rects += rects.size();
+			g_stats.bytesPresented += bytes;
+			g_stats.lastFrameBytes = bytes;
+			SX_LOG_TRACE("Present") << SX_T("局部提交：矩形数=", "partial present: rects=") << rects.size()
+				<< SX_T(" 字节=", " bytes=") << bytes;
+
+			if (rects.empty())
+			{
+				// 本批次没有改动屏幕：提交 1 个像素以结束批量绘制
+				EndBatchDraw(0, 0, 0, 0);
+				return;
+			}
+			// EasyX 的 right/bottom 为闭区间：传半开右/下界会多提交 1 像素，但不会漏掉边缘
+			for (std::size_t i = 0; i + 1 < rects.size(); ++i)
+				FlushBatchDraw(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom);
+			const RECT& last = rects.back();
+			EndBatchDraw(last.left, last.top, last.right, last.bottom);
+		}
+	}
+}
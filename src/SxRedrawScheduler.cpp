@@ -0,0 +1,174 @@
+﻿#include "SxRedrawScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+namespace StellarX
+{
+	namespace RedrawScheduler
+	{
+		namespace
+		{
+			bool gEnabled = false;
+			double gBudgetMs = 8.0;
+			int gTileSize = 256;
+
+			struct Plan
+			{
+				std::deque<Region> items;     // 待合成的工作项（互不相交）
+				std::uint64_t frames = 0;     // 本次重绘已执行的帧数
+				double workMs = 0;            // 本次重绘已花费的绘制时间
+				double maxFrameMs = 0;
+				double itemMs = 0;            // 已完成工作项的平均耗时（预估下一项）
+				std::uint64_t itemsDone = 0;
+			};
+
+			Plan& plan()
+			{
+				static Plan* p = new Plan();
+				return *p;
+			}
+
+			Stats& mutableStats()
+			{
+				static Stats s;
+				return s;
+			}
+		}
+
+		void setEnabled(bool on)
+		{
+			gEnabled = on;
+			if (!on)
+				cancel();
+		}
+
+		bool enabled()
+		{
+			return gEnabled;
+		}
+
+		void setFrameBudget(double ms)
+		{
+			gBudgetMs = (std::max)(0.5, ms);
+		}
+
+		double frameBudget()
+		{
+			return gBudgetMs;
+		}
+
+		void setTileSize(int px)
+		{
+			gTileSize = (std::max)(32, px);
+		}
+
+		int tileSize()
+		{
+			return gTileSize;
+		}
+
+		void schedule(const Region& area, const std::vector<RECT>& priority, POINT focus)
+		{
+			Plan& p = plan();
+			// 与未完成的部分合并后整体重新规划：优先级按最新的光标与对话框
+			Region remaining = area;
+			for (const Region& item : p.items)
+				remaining.unite(item);
+			p.items.clear();
+
+			for (const RECT& rc : priority)
+			{
+				Region item(rc.left, rc.top, rc.right, rc.bottom);
+				item.intersect(remaining);
+				if (item.isEmpty())
+					continue;
+				remaining.subtract(item);
+				p.items.push_back(std::move(item));
+			}
+
+			int l, t, r, b;
+			if (remaining.getBounds(l, t, r, b))
+			{
+				struct Tile { long long dist; Region rgn; };
+				std::vector<Tile> tiles;
+				const int ts = gTileSize;
+				for (int y = t; y < b; y += ts)
+					for (int x = l; x < r; x += ts)
+					{
+						Region item(x, y, (std::min)(x + ts, r), (std::min)(y + ts, b));
+						item.intersect(remaining);
+						if (item.isEmpty())
+							continue;
+						const long long dx = (long long)x + ts / 2 - focus.x, dy = (long long)y + ts / 2 - focus.y;
+						tiles.push_back(Tile{ dx * dx + dy * dy, std::move(item) });
+					}
+				std::stable_sort(tiles.begin(), tiles.end(), [](const Tile& a, const Tile& b) { return a.dist < b.dist; });
+				for (Tile& tile : tiles)
+					p.items.push_back(std::move(tile.rgn));
+			}
+		}
+
+		bool pending()
+		{
+			return !plan().items.empty();
+		}
+
+		void cancel()
+		{
+			plan() = Plan{};
+		}
+
+		Region runFrame(const std::function<void(const Region&)>& compose)
+		{
+			using Clock = std::chrono::steady_clock;
+			Plan& p = plan();
+			Stats& st = mutableStats();
+			Region touched;
+			if (p.items.empty())
+				return touched;
+
+			const auto t0 = Clock::now();
+			double elapsed = 0;
+			do
+			{
+				Region item = std::move(p.items.front());
+				p.items.pop_front();
+				const auto ti = Clock::now();
+				compose(item);
+				const double ms = std::chrono::duration<double, std::milli>(Clock::now() - ti).count();
+				p.itemMs = (p.itemMs * (double)p.itemsDone + ms) / (double)(p.itemsDone + 1);
+				++p.itemsDone;
+				++st.items;
+				touched.unite(item);
+				elapsed = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+			} while (!p.items.empty() && elapsed + p.itemMs <= gBudgetMs);
+
+			++p.frames;
+			++st.frames;
+			p.workMs += elapsed;
+			p.maxFrameMs = (std::max)(p.maxFrameMs, elapsed);
+			st.maxFrameMs = (std::max)(st.maxFrameMs, elapsed);
+			if (p.items.empty())
+			{
+				++st.redraws;
+				st.lastFrames = p.frames;
+				st.lastWorkMs = p.workMs;
+				st.lastMaxFrameMs = p.maxFrameMs;
+				p = Plan{};
+			}
+			return touched;
+		}
+
+		const Stats& stats()
+		{
+			return mutableStats();
+		}
+
+		void resetStats()
+		{
+			mutableStats() = Stats{};
+		}
+	}
+}
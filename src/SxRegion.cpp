@@ -0,0 +1,229 @@
+﻿#include "SxRegion.h"
+
+/********************************************************************************
+ * @文件: SxRegion.cpp
+ * @摘要: 星垣(StellarX) 区域代数实现
+ * @描述:
+ *     三种布尔运算共用一次“扫描线”合并：
+ *     1) 收集两个区域所有带的上下边，得到一组 y 断点；
+ *     2) 对每个 [y0, y1) 区间，取出两个区域在该区间内的区间列表（至多各一个带）；
+ *     3) 按 x 边界双指针合并两个区间列表，根据运算类型决定每段是否落在结果内，
+ *        结果直接追加到输出区域的区间数组末尾；
+ *     4) 收带时与上一个带比较，区间相同且上下相邻则撤回刚追加的区间并延长上一个带。
+ *     整个运算只有输出区域自身的两次数组增长，没有逐带分配。
+ ********************************************************************************/
+
+#include <algorithm>
+
+namespace StellarX
+{
+	namespace
+	{
+		// 合并两个有序区间列表并追加到 out；na/nb 为 0 表示该区域在本带为空
+		template <class Pred>
+		void mergeSpans(const Region::Span* a, std::size_t na, const Region::Span* b, std::size_t nb,
+			Pred keep, std::vector<Region::Span>& out, std::size_t bandFirst)
+		{
+			// 第 k 条边：偶数为区间左边，奇数为右边；越过奇数条边即处于区间内
+			auto edge = [](const Region::Span* s, std::size_t k) { return (k & 1) ? s[k / 2].right : s[k / 2].left; };
+			const std::size_t ea = na * 2, eb = nb * 2;
+
+			std::size_t i = 0, j = 0;
+			int x0 = 0;
+			bool started = false;
+			while (i < ea || j < eb)
+			{
+				int x;
+				if (i < ea && j < eb) x = (std::min)(edge(a, i), edge(b, j));
+				else if (i < ea)      x = edge(a, i);
+				else                  x = edge(b, j);
+
+				if (started && x > x0 && keep((i & 1) != 0, (j & 1) != 0))
+				{
+					if (out.size() > bandFirst && out.back().right == x0)
+						out.back().right = x;
+					else
+						out.push_back(Region::Span{ x0, x });
+				}
+				while (i < ea && edge(a, i) == x) ++i;
+				while (j < eb && edge(b, j) == x) ++j;
+				x0 = x;
+				started = true;
+			}
+		}
+	}
+
+	Region::Region(int left, int top, int right, int bottom)
+	{
+		if (left < right && top < bottom)
+		{
+			spans.push_back(Span{ left, right });
+			bands.push_back(Band{ top, bottom, 0, 1 });
+		}
+	}
+
+	void Region::closeBand(int top, int bottom, std::size_t first)
+	{
+		const std::size_t count = spans.size() - first;
+		if (count == 0)
+			return;
+		if (!bands.empty())
+		{
+			Band& prev = bands.back();
+			if (prev.bottom == top && prev.count == count
+				&& std::equal(spans.begin() + first, spans.end(), spans.begin() + prev.first))
+			{
+				prev.bottom = bottom;
+				spans.resize(first);
+				return;
+			}
+		}
+		bands.push_back(Band{ top, bottom, first, count });
+	}
+
+	Region Region::combine(const Region& a, const Region& b, Op op)
+	{
+		std::vector<int> ys;
+		ys.reserve((a.bands.size() + b.bands.size()) * 2);
+		for (const Band& band : a.bands) { ys.push_back(band.top); ys.push_back(band.bottom); }
+		for (const Band& band : b.bands) { ys.push_back(band.top); ys.push_back(band.bottom); }
+		std::sort(ys.begin(), ys.end());
+		ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+		auto keep = [op](bool inA, bool inB)
+			{
+				switch (op)
+				{
+				case Op::Union:     return inA || inB;
+				case Op::Intersect: return inA && inB;
+				default:            return inA && !inB;
+				}
+			};
+
+		Region out;
+		out.spans.reserve(a.spans.size() + b.spans.size());
+		std::size_t ia = 0, ib = 0;
+		for (std::size_t k = 0; k + 1 < ys.size(); ++k)
+		{
+			const int y0 = ys[k], y1 = ys[k + 1];
+			while (ia < a.bands.size() && a.bands[ia].bottom <= y0) ++ia;
+			while (ib < b.bands.size() && b.bands[ib].bottom <= y0) ++ib;
+			// y 断点包含所有带边，因此覆盖 y0 的带必然覆盖整个 [y0, y1)
+			const Band* ba = (ia < a.bands.size() && a.bands[ia].top <= y0) ? &a.bands[ia] : nullptr;
+			const Band* bb = (ib < b.bands.size() && b.bands[ib].top <= y0) ? &b.bands[ib] : nullptr;
+			if (!ba && !bb)
+				continue;
+			const std::size_t first = out.spans.size();
+			mergeSpans(ba ? a.spans.data() + ba->first : nullptr, ba ? ba->count : 0,
+				bb ? b.spans.data() + bb->first : nullptr, bb ? bb->count : 0,
+				keep, out.spans, first);
+			out.closeBand(y0, y1, first);
+		}
+		return out;
+	}
+
+	Region& Region::unite(const Region& other)
+	{
+		if (other.isEmpty())
+			return *this;
+		if (isEmpty())
+			return *this = other;
+		return *this = combine(*this, other, Op::Union);
+	}
+
+	Region& Region::intersect(const Region& other)
+	{
+		if (isEmpty() || other.isEmpty())
+		{
+			clear();
+			return *this;
+		}
+		return *this = combine(*this, other, Op::Intersect);
+	}
+
+	Region& Region::subtract(const Region& other)
+	{
+		if (isEmpty() || other.isEmpty())
+			return *this;
+		return *this = combine(*this, other, Op::Subtract);
+	}
+
+	bool Region::intersects(int left, int top, int right, int bottom) const
+	{
+		if (left >= right || top >= bottom)
+			return false;
+		// 带按 top 有序：先二分跳到第一个 bottom > top 的带
+		auto it = std::upper_bound(bands.begin(), bands.end(), top,
+			[](int y, const Band& b) { return y < b.bottom; });
+		for (; it != bands.end() && it->top < bottom; ++it)
+		{
+			for (std::size_t k = it->first; k < it->first + it->count; ++k)
+			{
+				if (spans[k].right <= left) continue;
+				if (spans[k].left >= right) break;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool Region::intersects(const Region& other) const
+	{
+		if (isEmpty() || other.isEmpty())
+			return false;
+		// 小区域逐矩形探测，避免构造完整的交集
+		const Region& probe = spans.size() <= other.spans.size() ? *this : other;
+		const Region& target = &probe == this ? other : *this;
+		bool hit = false;
+		probe.forEachRect([&](int l, int t, int r, int b) { hit = hit || target.intersects(l, t, r, b); });
+		return hit;
+	}
+
+	bool Region::contains(int x, int y) const
+	{
+		return intersects(x, y, x + 1, y + 1);
+	}
+
+	long long Region::area() const
+	{
+		long long sum = 0;
+		forEachRect([&sum](int l, int t, int r, int b) { sum += (long long)(r - l) * (b - t); });
+		return sum;
+	}
+
+	std::size_t Region::rectCount() const
+	{
+		return spans.size();
+	}
+
+	bool Region::getBounds(int& left, int& top, int& right, int& bottom) const
+	{
+		if (bands.empty())
+			return false;
+		top = bands.front().top;
+		bottom = bands.back().bottom;
+		left = spans[bands.front().first].left;
+		right = spans[bands.front().first + bands.front().count - 1].right;
+		for (const Band& b : bands)
+		{
+			left = (std::min)(left, spans[b.first].left);
+			right = (std::max)(right, spans[b.first + b.count - 1].right);
+		}
+		return true;
+	}
+
+	bool Region::operator==(const Region& o) const
+	{
+		// 表示法唯一：带与区间逐项相同即区域相同
+		if (bands.size() != o.bands.size() || spans.size() != o.spans.size())
+			return false;
+		for (std::size_t i = 0; i < bands.size(); ++i)
+		{
+			const Band& a = bands[i];
+			const Band& b = o.bands[i];
+			if (a.top != b.top || a.bottom != b.bottom || a.count != b.count)
+				return false;
+		}
+		return spans == o.spans;
+	}
+}
@@ -0,0 +1,284 @@
+﻿#include "SxRenderState.h"
+#include "CoreTypes.h"
+
+namespace StellarX
+{
+	namespace
+	{
+		bool faceEquals(const TCHAR* a, LPCTSTR b)
+		{
+			if (!b) return true;   // 不指定字体名时沿用当前字体名
+			for (int i = 0; i < LF_FACESIZE - 1; ++i)
+			{
+				if (a[i] != b[i]) return false;
+				if (!a[i]) return true;
+			}
+			return true;
+		}
+
+		bool fontEquals(const LOGFONT& a, const LOGFONT& b)
+		{
+			return a.lfHeight == b.lfHeight && a.lfWidth == b.lfWidth
+				&& a.lfEscapement == b.lfEscapement && a.lfOrientation == b.lfOrientation
+				&& a.lfWeight == b.lfWeight && a.lfItalic == b.lfItalic
+				&& a.lfUnderline == b.lfUnderline && a.lfStrikeOut == b.lfStrikeOut
+				&& a.lfCharSet == b.lfCharSet && a.lfOutPrecision == b.lfOutPrecision
+				&& a.lfClipPrecision == b.lfClipPrecision && a.lfQuality == b.lfQuality
+				&& a.lfPitchAndFamily == b.lfPitchAndFamily && faceEquals(a.lfFaceName, b.lfFaceName);
+		}
+
+		void add(RenderState::Counters& c, bool changed, bool font)
+		{
+			if (changed) { ++c.issued; if (font) ++c.fontsIssued; }
+			else { ++c.elided; if (font) ++c.fontsElided; }
+		}
+	}
+
+	RenderState& RenderState::Get()
+	{
+		// 与 SurfacePool 相同：有意不析构，静态控件析构时仍可能绘制
+		static RenderState* inst = new RenderState();
+		return *inst;
+	}
+
+	bool RenderState::count(bool changed, bool font)
+	{
+		add(frame, changed, font);
+		add(sum, changed, font);
+		return changed;
+	}
+
+	void RenderState::sync()
+	{
+		State dev;
+		gettextstyle(&dev.font);
+		dev.textColor = gettextcolor();
+		dev.fillColor = getfillcolor();
+		dev.lineColor = getlinecolor();
+		dev.bkColor = getbkcolor();
+		dev.bkMode = getbkmode();
+		getlinestyle(&dev.lineStyle);
+		getfillstyle(&dev.fillStyle);
+		// 设备与影子不一致说明应用代码直接改过状态：以应用的设置为准，放弃尚未执行的恢复
+		if (known && pending && !equals(dev, cur))
+			pending = false;
+		cur = dev;
+		known = true;
+		++frame.syncs;
+		++sum.syncs;
+	}
+
+	bool RenderState::equals(const State& a, const State& b)
+	{
+		return fontEquals(a.font, b.font) && a.textColor == b.textColor && a.fillColor == b.fillColor
+			&& a.lineColor == b.lineColor && a.bkColor == b.bkColor && a.bkMode == b.bkMode
+			&& a.lineStyle.style == b.lineStyle.style && a.lineStyle.thickness == b.lineStyle.thickness
+			&& a.lineStyle.userstylecount == b.lineStyle.userstylecount && a.lineStyle.puserstyle == b.lineStyle.puserstyle
+			&& a.fillStyle.style == b.fillStyle.style && a.fillStyle.hatch == b.fillStyle.hatch
+			&& a.fillStyle.ppattern == b.fillStyle.ppattern;
+	}
+
+	void RenderState::prepare()
+	{
+		if (!stack.empty())
+		{
+			if (!known) sync();
+			return;
+		}
+		// 栈外：设备可能被应用代码改过，先读回，再补上延后的恢复
+		sync();
+		flush();
+	}
+
+	void RenderState::flush()
+	{
+		if (!pending) return;
+		pending = false;
+		put(restore);
+	}
+
+	void RenderState::put(const State& s)
+	{
+		if (!known) sync();
+		putFont(s.font);
+		putTextColor(s.textColor);
+		putFillColor(s.fillColor);
+		putLineColor(s.lineColor);
+		putBkColor(s.bkColor);
+		putBkMode(s.bkMode);
+		putLineStyle(s.lineStyle);
+		putFillStyle(s.fillStyle.style, s.fillStyle.hatch, s.fillStyle.ppattern);
+	}
+
+	void RenderState::setTextStyle(int nHeight, int nWidth, LPCTSTR lpszFace, int nEscapement, int nOrientation,
+		int nWeight, bool bItalic, bool bUnderline, bool bStrikeOut)
+	{
+		prepare();
+		const LOGFONT& f = cur.font;
+		const bool same = f.lfHeight == nHeight && f.lfWidth == nWidth && faceEquals(f.lfFaceName, lpszFace)
+			&& f.lfEscapement == nEscapement && f.lfOrientation == nOrientation && f.lfWeight == nWeight
+			&& (f.lfItalic != 0) == bItalic && (f.lfUnderline != 0) == bUnderline && (f.lfStrikeOut != 0) == bStrikeOut;
+		if (!count(!same, true)) return;
+		settextstyle(nHeight, nWidth, lpszFace, nEscapement, nOrientation, nWeight, bItalic, bUnderline, bStrikeOut);
+		gettextstyle(&cur.font);   // 以设备实际保存的值为准（字体名截断等）
+	}
+
+	void RenderState::setTextStyle(const ControlText& t)
+	{
+		setTextStyle(t.nHeight, t.nWidth, t.lpszFace, t.nEscapement, t.nOrientation,
+			t.nWeight, t.bItalic, t.bUnderline, t.bStrikeOut);
+	}
+
+	void RenderState::setTextColor(COLORREF c) { prepare(); putTextColor(c); }
+	void RenderState::setFillColor(COLORREF c) { prepare(); putFillColor(c); }
+	void RenderState::setLineColor(COLORREF c) { prepare(); putLineColor(c); }
+	void RenderState::setBkColor(COLORREF c) { prepare(); putBkColor(c); }
+	void RenderState::setBkMode(int mode) { prepare(); putBkMode(mode); }
+
+	void RenderState::setLineStyle(int style, int thickness)
+	{
+		prepare();
+		const LINESTYLE& ls = cur.lineStyle;
+		const bool same = ls.style == (DWORD)style && ls.thickness == (DWORD)thickness && ls.userstylecount == 0;
+		if (!count(!same)) return;
+		setlinestyle(style, thickness);
+		getlinestyle(&cur.lineStyle);
+	}
+
+	void RenderState::setFillStyle(int style, long hatch, IMAGE* ppattern)
+	{
+		prepare();
+		putFillStyle(style, hatch, ppattern);
+	}
+
+	void RenderState::putFont(const LOGFONT& f)
+	{
+		if (!count(!fontEquals(cur.font, f), true)) return;
+		settextstyle(&f);
+		gettextstyle(&cur.font);
+	}
+
+	void RenderState::putTextColor(COLORREF c)
+	{
+		if (!count(cur.textColor != c)) return;
+		settextcolor(c);
+		cur.textColor = c;
+	}
+
+	void RenderState::putFillColor(COLORREF c)
+	{
+		if (!count(cur.fillColor != c)) return;
+		setfillcolor(c);
+		cur.fillColor = c;
+	}
+
+	void RenderState::putLineColor(COLORREF c)
+	{
+		if (!count(cur.lineColor != c)) return;
+		setlinecolor(c);
+		cur.lineColor = c;
+	}
+
+	void RenderState::putBkColor(COLORREF c)
+	{
+		if (!count(cur.bkColor != c)) return;
+		setbkcolor(c);
+		cur.bkColor = c;
+	}
+
+	void RenderState::putBkMode(int mode)
+	{
+		if (!count(cur.bkMode != mode)) return;
+		setbkmode(mode);
+		cur.bkMode = mode;
+	}
+
+	void RenderState::putLineStyle(const LINESTYLE& s)
+	{
+		// 自定义线型只能比较段长数组的指针，不可靠，始终下发
+		const LINESTYLE& ls = cur.lineStyle;
+		const bool same = ls.style == s.style && ls.thickness == s.thickness
+			&& ls.userstylecount == 0 && s.userstylecount == 0;
+		if (!count(!same)) return;
+		setlinestyle(&s);
+		getlinestyle(&cur.lineStyle);
+	}
+
+	void RenderState::putFillStyle(int style, long hatch, IMAGE* ppattern)
+	{
+		const FILLSTYLE& fs = cur.fillStyle;
+		if (!count(fs.style != style || fs.hatch != hatch || fs.ppattern != ppattern)) return;
+		setfillstyle(style, hatch, ppattern);
+		getfillstyle(&cur.fillStyle);
+	}
+
+	void RenderState::push()
+	{
+		// 最外层入栈时从设备读回，栈内的设置都经由本跟踪器，影子状态保持准确。
+		// 保存的是“逻辑状态”：若上一个控件的恢复尚未执行，保存的就是待恢复的状态
+		if (stack.empty())
+		{
+			sync();
+			stack.push_back(pending ? restore : cur);
+		}
+		else
+			stack.push_back(cur);
+		++frame.pushes;
+		++sum.pushes;
+	}
+
+	void RenderState::pop()
+	{
+		if (stack.empty()) return;
+		const State s = stack.back();
+		stack.pop_back();
+		if (!stack.empty())
+		{
+			put(s);
+			return;
+		}
+		// 绘制遍历内最外层恢复延后执行：相邻的兄弟控件多半使用相同的字体与颜色，
+		// 下一个控件入栈后再设置时即可被消除；遍历结束时补上恢复。
+		// 遍历之外控制权随即回到应用代码，立即恢复
+		if (passDepth > 0)
+		{
+			restore = s;
+			pending = true;
+			return;
+		}
+		put(s);
+	}
+
+	RenderState::DrawPass::DrawPass()
+	{
+		++Get().passDepth;
+	}
+
+	RenderState::DrawPass::~DrawPass()
+	{
+		RenderState& rs = Get();
+		if (--rs.passDepth == 0 && rs.stack.empty())
+			rs.flush();
+	}
+
+	void RenderState::beginFrame()
+	{
+		if (stack.empty())
+		{
+			sync();
+			flush();
+		}
+		if (frame.issued || frame.elided || frame.pushes)
+		{
+			last = frame;
+			++frames;
+		}
+		frame = Counters{};
+	}
+
+	void RenderState::resetStats()
+	{
+		frame = last = sum = Counters{};
+		frames = 0;
+	}
+}
@@ -0,0 +1,72 @@
+﻿#include "SxRleImage.h"
+#include "SxPixelKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace StellarX
+{
+	bool RleImage::encode(const std::uint32_t* src, int stride, int w, int h, std::size_t maxBytes)
+	{
+		runs.clear();
+		rows.clear();
+		imgW = imgH = 0;
+		if (w <= 0 || h <= 0)
+			return false;
+		rows.reserve((std::size_t)h);
+		for (int y = 0; y < h; ++y)
+		{
+			const std::uint32_t* row = src + (std::size_t)y * stride;
+			if (y > 0 && std::memcmp(row, row - stride, (std::size_t)w * sizeof(std::uint32_t)) == 0)
+			{
+				rows.push_back(rows.back());
+				continue;
+			}
+			const std::uint32_t begin = (std::uint32_t)runs.size();
+			for (int x = 0; x < w; ++x)
+				if (x == 0 || row[x] != row[x - 1])
+					runs.push_back(Run{ x, row[x] });
+			rows.push_back(Row{ begin, (std::uint32_t)runs.size() });
+			if (bytes() > maxBytes)
+			{
+				clear();
+				return false;
+			}
+		}
+		// 让实际占用与 bytes() 一致
+		runs.shrink_to_fit();
+		rows.shrink_to_fit();
+		imgW = w;
+		imgH = h;
+		return true;
+	}
+
+	void RleImage::decode(std::uint32_t* dst, int dstStride, int sx, int sy, int w, int h) const
+	{
+		for (int y = 0; y < h; ++y)
+		{
+			const Row& row = rows[(std::size_t)(sy + y)];
+			const Run* first = runs.data() + row.begin;
+			const Run* last = runs.data() + row.end;
+			// 最后一个起点不超过 sx 的游程
+			const Run* r = std::upper_bound(first, last, sx, [](int v, const Run& run) { return v < run.x; }) - 1;
+			std::uint32_t* out = dst + (std::size_t)y * dstStride;
+			for (int x = sx; x < sx + w; ++r)
+			{
+				const int runEnd = (r + 1 < last) ? (r + 1)->x : imgW;
+				const int n = (std::min)(runEnd, sx + w) - x;
+				Pixel::fill(out + (x - sx), (std::size_t)n, r->color);
+				x += n;
+			}
+		}
+	}
+
+	void RleImage::clear()
+	{
+		runs.clear();
+		rows.clear();
+		runs.shrink_to_fit();
+		rows.shrink_to_fit();
+		imgW = imgH = 0;
+	}
+}
@@ -0,0 +1,286 @@
+﻿#include "SxShapeMask.h"
+#include "SxPixelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace StellarX
+{
+	namespace
+	{
+		// 形状在掩码局部坐标（像素 i 覆盖 [i, i+1)）中的描述：外框 [x0, x1] × [y0, y1]，四角椭圆半轴 rx、ry
+		struct Outline
+		{
+			double x0, y0, x1, y1;
+			double rx, ry;
+
+			bool contains(double u, double v) const
+			{
+				if (u < x0 || u > x1 || v < y0 || v > y1) return false;
+				if (rx <= 0.0 || ry <= 0.0) return true;
+				const double dx = (std::max)({ x0 + rx - u, u - (x1 - rx), 0.0 }) / rx;
+				const double dy = (std::max)({ y0 + ry - v, v - (y1 - ry), 0.0 }) / ry;
+				return dx * dx + dy * dy <= 1.0;
+			}
+		};
+
+		// 4×4 超采样覆盖率，并记录每行的非零 / 全覆盖范围
+		template <class RowT>
+		void rasterize(const Outline& o, int w, int h, std::vector<std::uint8_t>& cov, std::vector<RowT>& rows)
+		{
+			static const double kSub[4] = { 0.125, 0.375, 0.625, 0.875 };
+			cov.assign((std::size_t)w * h, 0);
+			rows.resize((std::size_t)h);
+			for (int y = 0; y < h; ++y)
+			{
+				std::uint8_t* line = cov.data() + (std::size_t)y * w;
+				for (int x = 0; x < w; ++x)
+				{
+					int n = 0;
+					for (double sy : kSub)
+						for (double sx : kSub)
+							n += o.contains(x + sx, y + sy) ? 1 : 0;
+					line[x] = (std::uint8_t)((n * 255 + 8) / 16);
+				}
+
+				RowT& r = rows[(std::size_t)y];
+				int x0 = 0, x1 = w;
+				while (x0 < w && !line[x0]) ++x0;
+				while (x1 > x0 && !line[x1 - 1]) --x1;
+				int f0 = x0, f1 = x0;
+				// 形状是凸的：全覆盖像素在行内连续
+				while (f0 < x1 && line[f0] != 255) ++f0;
+				f1 = f0;
+				while (f1 < x1 && line[f1] == 255) ++f1;
+				r.x0 = (std::int16_t)x0; r.x1 = (std::int16_t)x1;
+				r.f0 = (std::int16_t)f0; r.f1 = (std::int16_t)f1;
+			}
+		}
+
+		inline std::uint32_t toPixel(COLORREF c) { return (std::uint32_t)BGR(c) & 0x00FFFFFF; }
+
+		const int kMaxSide = 1 << 14;
+		const int kMaxPen = 63;
+	}
+
+	ShapeMaskCache& ShapeMaskCache::Get()
+	{
+		static ShapeMaskCache* inst = new ShapeMaskCache();
+		return *inst;
+	}
+
+	std::size_t ShapeMaskCache::Mask::bytes() const
+	{
+		return outer.size() + inner.size() + (outerRows.size() + innerRows.size()) * sizeof(Row);
+	}
+
+	void ShapeMaskCache::setBudget(std::size_t bytes)
+	{
+		budget_ = bytes;
+		trim();
+	}
+
+	void ShapeMaskCache::clear()
+	{
+		masks.clear();
+		order.clear();
+		stats.bytesHeld = 0;
+	}
+
+	void ShapeMaskCache::resetStats()
+	{
+		const std::size_t held = stats.bytesHeld;
+		stats = Stats{};
+		stats.bytesHeld = held;
+	}
+
+	void ShapeMaskCache::setClip(const Region* region)
+	{
+		clip.clear();
+		clipping = region != nullptr;
+		clipTarget = clipping ? GetWorkingImage() : nullptr;
+		if (region)
+			region->forEachRect([this](int l, int t, int r, int b) { clip.push_back(RECT{ l, t, r, b }); });
+	}
+
+	void ShapeMaskCache::trim()
+	{
+		// 最近使用的一个总是保留：预算小于单个掩码时也能绘制
+		while (stats.bytesHeld > budget_ && order.size() > 1)
+		{
+			auto it = masks.find(order.back());
+			stats.bytesHeld -= it->second.bytes();
+			masks.erase(it);
+			order.pop_back();
+			++stats.evictions;
+		}
+	}
+
+	const ShapeMaskCache::Mask& ShapeMaskCache::maskFor(bool ellipse, int w, int h, int ew, int eh, int pen)
+	{
+		// 14 位宽高 + 14 位圆角宽高 + 6 位线宽 + 1 位形状
+		const std::uint64_t key = (std::uint64_t)w | (std::uint64_t)h << 14 | (std::uint64_t)ew << 28
+			| (std::uint64_t)eh << 42 | (std::uint64_t)pen << 56 | (std::uint64_t)(ellipse ? 1 : 0) << 62;
+		auto it = masks.find(key);
+		if (it != masks.end())
+		{
+			++stats.hits;
+			order.splice(order.begin(), order, it->second.lru);
+			return it->second;
+		}
+
+		++stats.builds;
+		Mask m;
+		m.w = w;
+		m.h = h;
+		const Outline outer = ellipse
+			? Outline{ 0.0, 0.0, (double)w, (double)h, w / 2.0, h / 2.0 }
+			: Outline{ 0.0, 0.0, (double)w, (double)h, ew / 2.0, eh / 2.0 };
+		rasterize(outer, w, h, m.outer, m.outerRows);
+		if (pen > 0)
+		{
+			const Outline inner = ellipse
+				? Outline{ (double)pen, (double)pen, (double)(w - pen), (double)(h - pen), w / 2.0 - pen, h / 2.0 - pen }
+				: Outline{ (double)pen, (double)pen, (double)(w - pen), (double)(h - pen),
+					(std::max)(0, ew - 2 * pen) / 2.0, (std::max)(0, eh - 2 * pen) / 2.0 };
+			if (inner.x0 < inner.x1 && inner.y0 < inner.y1)
+				rasterize(inner, w, h, m.inner, m.innerRows);
+			else
+			{
+				m.inner.assign((std::size_t)w * h, 0);
+				m.innerRows.assign((std::size_t)h, Row{ 0, 0, 0, 0 });
+			}
+		}
+
+		order.push_front(key);
+		m.lru = order.begin();
+		stats.bytesHeld += m.bytes();
+		Mask& stored = masks.emplace(key, std::move(m)).first->second;
+		trim();
+		return stored;
+	}
+
+	bool ShapeMaskCache::drawRoundRect(int l, int t, int r, int b, int ew, int eh, bool border)
+	{
+		return draw(false, l, t, r, b, ew, eh, border);
+	}
+
+	bool ShapeMaskCache::drawEllipse(int l, int t, int r, int b, bool border)
+	{
+		return draw(true, l, t, r, b, 0, 0, border);
+	}
+
+	bool ShapeMaskCache::draw(bool ellipse, int l, int t, int r, int b, int ew, int eh, bool border)
+	{
+		if (!on_)
+			return false;
+
+		FILLSTYLE fs;
+		getfillstyle(&fs);
+		LINESTYLE ls;
+		getlinestyle(&ls);
+		const int penStyle = (int)(ls.style & 0x0F);   // 低 4 位为线型（PS_STYLE_MASK）
+		if (penStyle == PS_NULL)
+			border = false;
+		const int pen = border ? (std::max)(1, (int)ls.thickness) : 0;
+		if (fs.style != BS_SOLID || (border && penStyle != PS_SOLID) || pen > kMaxPen)
+		{
+			++stats.fallbacks;
+			return false;
+		}
+
+		// 与后端一致：粗线以轮廓为中心，外框按 (线宽-1)/2 向外扩展，圆角同步放大
+		const int grow = pen > 0 ? (pen - 1) / 2 : 0;
+		l -= grow; t -= grow; r += grow; b += grow;
+		const int w = r - l + 1, h = b - t + 1;
+		if (w <= 0 || h <= 0)
+			return true;
+		if (w >= kMaxSide || h >= kMaxSide)
+		{
+			++stats.fallbacks;
+			return false;
+		}
+		if (!ellipse)
+		{
+			ew = (std::min)(w, (std::max)(0, ew + 2 * grow));
+			eh = (std::min)(h, (std::max)(0, eh + 2 * grow));
+		}
+
+		IMAGE* target = GetWorkingImage();
+		std::uint32_t* px = reinterpret_cast<std::uint32_t*>(GetImageBuffer(target));
+		const int sw = getwidth(), sh = getheight();
+		if (!px || sw <= 0 || sh <= 0)
+			return false;
+
+		const Mask& m = maskFor(ellipse, w, h, ew, eh, pen);
+		++stats.draws;
+		const std::uint32_t fillPx = toPixel(getfillcolor());
+		const std::uint32_t linePx = toPixel(getlinecolor());
+		const bool clipped = clipping && target == clipTarget;
+
+		// 屏幕行 y 上的 [a, b) 按表面边界与裁剪矩形切段，逐段回调 f(a, b)
+		auto forVisible = [&](int y, int a, int bEnd, auto&& f)
+			{
+				a = (std::max)(a, 0);
+				bEnd = (std::min)(bEnd, sw);
+				if (a >= bEnd) return;
+				if (!clipped) { f(a, bEnd); return; }
+				for (const RECT& rc : clip)
+				{
+					if (y < rc.top || y >= rc.bottom) continue;
+					const int ca = (std::max)(a, (int)rc.left), cb = (std::min)(bEnd, (int)rc.right);
+					if (ca < cb) f(ca, cb);
+				}
+			};
+
+		const int y0 = (std::max)(0, -t), y1 = (std::min)(h, sh - t);
+		for (int my = y0; my < y1; ++my)
+		{
+			const int y = t + my;
+			std::uint32_t* row = px + (std::size_t)y * sw;
+			const Row& o = m.outerRows[(std::size_t)my];
+			if (o.x0 >= o.x1) continue;
+			const std::uint8_t* oc = m.outer.data() + (std::size_t)my * w;
+			const std::uint8_t* ic = pen > 0 ? m.inner.data() + (std::size_t)my * w : nullptr;
+
+			// 边缘段：先按外轮廓混入线条色（有边框时），再按内部覆盖率混入填充色
+			auto edge = [&](int a, int e)
+				{
+					forVisible(y, l + a, l + e, [&](int sa, int se)
+						{
+							const std::size_t n = (std::size_t)(se - sa);
+							if (ic)
+							{
+								Pixel::blendCoverage(row + sa, oc + (sa - l), n, linePx);
+								Pixel::blendCoverage(row + sa, ic + (sa - l), n, fillPx);
+								stats.pixelsBlended += 2 * n;
+							}
+							else
+							{
+								Pixel::blendCoverage(row + sa, oc + (sa - l), n, fillPx);
+								stats.pixelsBlended += n;
+							}
+						});
+				};
+			auto solid = [&](int a, int e)
+				{
+					forVisible(y, l + a, l + e, [&](int sa, int se)
+						{
+							Pixel::fill(row + sa, (std::size_t)(se - sa), fillPx);
+							stats.pixelsFilled += (std::uint64_t)(se - sa);
+						});
+				};
+
+			const Row& full = ic ? m.innerRows[(std::size_t)my] : o;
+			if (full.f0 < full.f1)
+			{
+				edge(o.x0, full.f0);
+				solid(full.f0, full.f1);
+				edge(full.f1, o.x1);
+			}
+			else
+				edge(o.x0, o.x1);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,185 @@
+﻿#include "SxSurfacePool.h"
+#include "Control.h"
+#include "SxLog.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace StellarX
+{
+	namespace
+	{
+		inline std::size_t surfaceBytes(int w, int h)
+		{
+			return (std::size_t)(w > 0 ? w : 0) * (std::size_t)(h > 0 ? h : 0) * 4;
+		}
+
+		// 像素数向上取 2 的幂作为尺寸档
+		inline int sizeClass(std::size_t pixels)
+		{
+			int c = 0;
+			while (((std::size_t)1 << c) < pixels) ++c;
+			return c;
+		}
+	}
+
+	SurfacePool& SurfacePool::Get()
+	{
+		// 有意不析构：静态/全局控件可能晚于本池析构，仍需归还表面
+		static SurfacePool* inst = new SurfacePool();
+		return *inst;
+	}
+
+	void SurfacePool::setBudget(std::size_t bytes)
+	{
+		budget = bytes;
+		enforceBudget(nullptr);
+	}
+
+	std::unique_ptr<IMAGE> SurfacePool::acquire(Control* owner, int w, int h)
+	{
+		if (inUse.count(owner))
+			release(owner, nullptr);
+
+		++stats.acquires;
+		const std::size_t bytes = surfaceBytes(w, h);
+		const int cls = sizeClass(bytes / 4);
+
+		// 先找宽高完全一致的，再退而求其次找同一尺寸档的（均取最近归还者）
+		auto pick = cached.end();
+		for (auto it = cached.begin(); it != cached.end(); ++it)
+		{
+			if (it->img->getwidth() == w && it->img->getheight() == h)
+			{
+				pick = it;
+				break;
+			}
+			if (pick == cached.end() && sizeClass(it->bytes / 4) == cls)
+				pick = it;
+		}
+
+		std::unique_ptr<IMAGE> img;
+		if (pick != cached.end())
+		{
+			++stats.hits;
+			img = std::move(pick->img);
+			stats.bytesCached -= pick->bytes;
+			stats.bytesHeld -= pick->bytes;
+			cached.erase(pick);
+			if (img->getwidth() != w || img->getheight() != h)
+				Resize(img.get(), w, h);
+		}
+		else
+		{
+			++stats.misses;
+			img = std::make_unique<IMAGE>(w, h);
+		}
+
+		inUse[owner] = InUse{ bytes, ++tick };
+		stats.bytesInUse += bytes;
+		stats.bytesHeld += bytes;
+		enforceBudget(owner);
+		return img;
+	}
+
+	void SurfacePool::release(Control* owner, std::unique_ptr<IMAGE> img)
+	{
+		auto skip = skipped.find(owner);
+		if (skip != skipped.end())
+		{
+			stats.bytesSkipped -= skip->second;
+			skipped.erase(skip);
+		}
+		auto found = inUse.find(owner);
+		if (found != inUse.end())
+		{
+			stats.bytesInUse -= found->second.bytes;
+			stats.bytesHeld -= found->second.bytes;
+			inUse.erase(found);
+		}
+		if (!img)
+			return;
+
+		const std::size_t bytes = surfaceBytes(img->getwidth(), img->getheight());
+		if (bytes == 0 || stats.bytesHeld + bytes > budget)
+			return;                                   // 放不进预算：直接释放
+
+		cached.push_front(Cached{ std::move(img), bytes });
+		stats.bytesCached += bytes;
+		stats.bytesHeld += bytes;
+	}
+
+	void SurfacePool::skip(Control* owner, int w, int h)
+	{
+		const std::size_t bytes = surfaceBytes(w, h);
+		std::size_t& held = skipped[owner];
+		stats.bytesSkipped += bytes - held;
+		held = bytes;
+		++stats.opaqueSkips;
+	}
+
+	void SurfacePool::touch(const Control* owner)
+	{
+		auto found = inUse.find(owner);
+		if (found != inUse.end())
+			found->second.lastUse = ++tick;
+	}
+
+	void SurfacePool::trim()
+	{
+		while (!cached.empty())
+			dropCached(std::prev(cached.end()));
+	}
+
+	void SurfacePool::resetStats()
+	{
+		const Stats keep = stats;
+		stats = Stats{};
+		stats.bytesHeld = keep.bytesHeld;
+		stats.bytesInUse = keep.bytesInUse;
+		stats.bytesCached = keep.bytesCached;
+		stats.bytesSkipped = keep.bytesSkipped;
+	}
+
+	void SurfacePool::dropCached(std::list<Cached>::iterator it)
+	{
+		stats.bytesCached -= it->bytes;
+		stats.bytesHeld -= it->bytes;
+		++stats.trims;
+		cached.erase(it);
+	}
+
+	// 预算收口：先丢最久未用的缓存表面，再回收最久未用的隐藏控件快照；
+	// keep 为刚借出表面的控件，不参与回收。可见控件的快照不回收，预算因此是软上限。
+	void SurfacePool::enforceBudget(const Control* keep)
+	{
+		if (enforcing)
+			return;
+		enforcing = true;
+
+		while (stats.bytesHeld > budget && !cached.empty())
+			dropCached(std::prev(cached.end()));
+
+		if (stats.bytesHeld > budget)
+		{
+			std::vector<std::pair<std::uint64_t, const Control*>> victims;
+			for (const auto& kv : inUse)
+				if (kv.first != keep && kv.first && !kv.first->IsVisible())
+					victims.emplace_back(kv.second.lastUse, kv.first);
+			std::sort(victims.begin(), victims.end());
+
+			for (const auto& v : victims)
+			{
+				if (stats.bytesHeld <= budget)
+					break;
+				SX_LOGD("Snap") << SX_T("快照池超预算，回收隐藏控件快照：id=", "surface pool over budget, evict hidden snapshot: id=")
+					<< v.second->getId();
+				++stats.evictions;
+				// 作废快照会把表面归还给池；超预算时归还即释放
+				const_cast<Control*>(v.second)->invalidateBackgroundSnapshot();
+			}
+		}
+
+		enforcing = false;
+	}
+}
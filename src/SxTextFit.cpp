@@ -0,0 +1,40 @@
+﻿#include "SxTextFit.h"
+#include "SxTextMetrics.h"
+
+namespace StellarX
+{
+	std::vector<std::size_t> textCharEnds(const std::string& text)
+	{
+		std::vector<std::size_t> ends;
+		ends.reserve(text.size());
+		for (std::size_t i = 0; i < text.size();)
+		{
+			const std::size_t next = i + (std::size_t)gbkCharLen(text, i);
+			const std::size_t j = text.size() < next ? text.size() : next;
+			ends.push_back(j);
+			i = j;
+		}
+		return ends;
+	}
+
+	std::size_t fitTextPrefix(const std::string& text, int maxW)
+	{
+		return fitTextPrefix(text, textCharEnds(text), maxW, TextMeasureCache::Get().activeFontKey());
+	}
+
+	std::size_t fitTextPrefix(const std::string& text, const std::vector<std::size_t>& charEnds, int maxW, std::uint64_t fontKey)
+	{
+		auto& metrics = TextMeasureCache::Get();
+		// 不变量：前 lo 个字符放得下，前 hi+1 个字符放不下（hi 为上界）
+		std::size_t lo = 0, hi = charEnds.size();
+		while (lo < hi)
+		{
+			const std::size_t mid = lo + (hi - lo + 1) / 2;
+			if (metrics.width(fontKey, text.substr(0, charEnds[mid - 1])) <= maxW)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		return lo ? charEnds[lo - 1] : 0;
+	}
+}
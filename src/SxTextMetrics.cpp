@@ -0,0 +1,117 @@
+﻿#include "SxTextMetrics.h"
+#include "SxHash.h"
+
+namespace StellarX
+{
+	namespace
+	{
+		// 链表节点、哈希表槽位等固定开销的近似值
+		constexpr std::size_t kEntryOverhead = 64;
+	}
+
+	TextMeasureCache& TextMeasureCache::Get()
+	{
+		// 与 SurfacePool 相同：有意不析构，静态控件析构时仍可能度量文本
+		static TextMeasureCache* inst = new TextMeasureCache();
+		return *inst;
+	}
+
+	void TextMeasureCache::setCapacity(std::size_t bytes)
+	{
+		capacity = bytes;
+		shrinkTo(capacity);
+	}
+
+	std::uint64_t TextMeasureCache::activeFontKey() const
+	{
+		LOGFONT font{};
+		gettextstyle(&font);
+		return hashLogFont(font);
+	}
+
+	TextMeasureCache::Entry& TextMeasureCache::lookup(std::uint64_t fontKey, const std::string& text)
+	{
+		const std::uint64_t key = hashString(text, fontKey);
+		auto it = index.find(key);
+		if (it != index.end())
+		{
+			Entry& e = *it->second;
+			if (e.fontKey == fontKey && e.text == text)
+			{
+				lru.splice(lru.begin(), lru, it->second);
+				return e;
+			}
+			// 哈希碰撞：丢弃旧条目，按新内容重建
+			stats.bytes -= e.bytes;
+			lru.erase(it->second);
+			index.erase(it);
+		}
+
+		const std::size_t bytes = sizeof(Entry) + text.size() + kEntryOverhead;
+		shrinkTo(capacity > bytes ? capacity - bytes : 0);
+		lru.push_front(Entry{ key, fontKey, text, -1, -1, bytes });
+		index[key] = lru.begin();
+		stats.bytes += bytes;
+		stats.entries = lru.size();
+		return lru.front();
+	}
+
+	int TextMeasureCache::width(std::uint64_t fontKey, const std::string& text)
+	{
+		if (capacity == 0)
+		{
+			++stats.misses;
+			return textwidth(LPCTSTR(text.c_str()));
+		}
+		Entry& e = lookup(fontKey, text);
+		if (e.w >= 0)
+		{
+			++stats.hits;
+			return e.w;
+		}
+		++stats.misses;
+		return e.w = textwidth(LPCTSTR(text.c_str()));
+	}
+
+	int TextMeasureCache::height(std::uint64_t fontKey, const std::string& text)
+	{
+		if (capacity == 0)
+		{
+			++stats.misses;
+			return textheight(LPCTSTR(text.c_str()));
+		}
+		Entry& e = lookup(fontKey, text);
+		if (e.h >= 0)
+		{
+			++stats.hits;
+			return e.h;
+		}
+		++stats.misses;
+		return e.h = textheight(LPCTSTR(text.c_str()));
+	}
+
+	void TextMeasureCache::clear()
+	{
+		lru.clear();
+		index.clear();
+		stats.bytes = 0;
+		stats.entries = 0;
+	}
+
+	void TextMeasureCache::resetStats()
+	{
+		stats.hits = stats.misses = stats.evictions = 0;
+	}
+
+	void TextMeasureCache::shrinkTo(std::size_t limit)
+	{
+		while (stats.bytes > limit && !lru.empty())
+		{
+			stats.bytes -= lru.back().bytes;
+			index.erase(lru.back().key);
+			lru.pop_back();
+			++stats.evictions;
+		}
+		stats.entries = lru.size();
+	}
+}
@@ -0,0 +1,197 @@
+﻿#include "SxThreadPool.h"
+
+#include <algorithm>
+
+namespace StellarX
+{
+	ThreadPool& ThreadPool::Get()
+	{
+		// 有意不析构：进程退出时工作线程仍阻塞在条件变量上，析构会与之竞争
+		static ThreadPool* inst = new ThreadPool();
+		return *inst;
+	}
+
+	ThreadPool::ThreadPool()
+	{
+		setThreadCount(0);
+	}
+
+	void ThreadPool::setThreadCount(unsigned n)
+	{
+		if (n == 0)
+			n = (std::max)(1u, (std::min)(8u, std::thread::hardware_concurrency()));
+		if (n == threadCount() && workers.size() + 1 == n)
+			return;
+
+		stopWorkers();
+		queues.clear();
+		for (unsigned i = 0; i < n; ++i)
+			queues.push_back(std::unique_ptr<Queue>(new Queue));
+		for (unsigned i = 1; i < n; ++i)
+			workers.emplace_back(&ThreadPool::workerMain, this, i, batch);
+	}
+
+	void ThreadPool::stopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lk(batchLock);
+			quit = true;
+		}
+		batchReady.notify_all();
+		for (auto& t : workers)
+			t.join();
+		workers.clear();
+		quit = false;
+	}
+
+	void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t, unsigned)>& fn)
+	{
+		if (count == 0)
+			return;
+		++stats.batches;
+		stats.tasks += count;
+
+		const unsigned n = threadCount();
+		if (n <= 1 || count == 1)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				fn(i, 0);
+			return;
+		}
+
+		// 连续区段分给各线程：相邻屏幕块留在同一线程，缓存更友好
+		for (unsigned w = 0; w < n; ++w)
+		{
+			Queue& q = *queues[w];
+			std::lock_guard<std::mutex> lk(q.lock);
+			q.tasks.clear();
+			for (std::size_t i = count * w / n; i < count * (w + 1) / n; ++i)
+				q.tasks.push_back(i);
+		}
+
+		{
+			std::lock_guard<std::mutex> lk(batchLock);
+			job = &fn;
+			busy = (unsigned)workers.size();
+			batchSteals = 0;
+			++batch;
+		}
+		batchReady.notify_all();
+
+		const std::uint64_t own = drain(0);
+
+		std::unique_lock<std::mutex> lk(batchLock);
+		batchDone.wait(lk, [this] { return busy == 0; });
+		stats.steals += batchSteals + own;
+		job = nullptr;
+	}
+
+	void ThreadPool::post(std::function<void()> task)
+	{
+		if (!task)
+			return;
+		++stats.posted;
+		{
+			std::lock_guard<std::mutex> lk(bgLock);
+			bgTasks.push_back(std::move(task));
+			if (!background.joinable())
+				background = std::thread(&ThreadPool::backgroundMain, this);
+		}
+		bgReady.notify_one();
+	}
+
+	void ThreadPool::waitBackground()
+	{
+		std::unique_lock<std::mutex> lk(bgLock);
+		bgIdle.wait(lk, [this] { return bgTasks.empty() && !bgRunning; });
+	}
+
+	std::size_t ThreadPool::backgroundPending()
+	{
+		std::lock_guard<std::mutex> lk(bgLock);
+		return bgTasks.size() + (bgRunning ? 1 : 0);
+	}
+
+	void ThreadPool::backgroundMain()
+	{
+		std::unique_lock<std::mutex> lk(bgLock);
+		for (;;)
+		{
+			bgReady.wait(lk, [this] { return !bgTasks.empty(); });
+			std::function<void()> task = std::move(bgTasks.front());
+			bgTasks.pop_front();
+			bgRunning = true;
+			lk.unlock();
+			task();
+			lk.lock();
+			bgRunning = false;
+			if (bgTasks.empty())
+				bgIdle.notify_all();
+		}
+	}
+
+	void ThreadPool::workerMain(unsigned self, std::uint64_t seenBatch)
+	{
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lk(batchLock);
+				batchReady.wait(lk, [&] { return quit || batch != seenBatch; });
+				if (quit)
+					return;
+				seenBatch = batch;
+			}
+			const std::uint64_t stolen = drain(self);
+			{
+				std::lock_guard<std::mutex> lk(batchLock);
+				batchSteals += stolen;
+				if (--busy == 0)
+					batchDone.notify_all();
+			}
+		}
+	}
+
+	std::uint64_t ThreadPool::drain(unsigned self)
+	{
+		std::uint64_t stolen = 0;
+		std::size_t task = 0;
+		for (;;)
+		{
+			if (!popOwn(self, task))
+			{
+				if (!steal(self, task))
+					break;
+				++stolen;
+			}
+			(*job)(task, self);
+		}
+		return stolen;
+	}
+
+	bool ThreadPool::popOwn(unsigned self, std::size_t& task)
+	{
+		Queue& q = *queues[self];
+		std::lock_guard<std::mutex> lk(q.lock);
+		if (q.tasks.empty())
+			return false;
+		task = q.tasks.front();
+		q.tasks.pop_front();
+		return true;
+	}
+
+	bool ThreadPool::steal(unsigned self, std::size_t& task)
+	{
+		const unsigned n = threadCount();
+		for (unsigned k = 1; k < n; ++k)
+		{
+			Queue& q = *queues[(self + k) % n];
+			std::lock_guard<std::mutex> lk(q.lock);
+			if (q.tasks.empty())
+				continue;
+			task = q.tasks.back();
+			q.tasks.pop_back();
+			return true;
+		}
+		return false;
+	}
+}
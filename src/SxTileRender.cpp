@@ -0,0 +1,85 @@
+﻿#include "SxTileRender.h"
+#include "SxBackend.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace StellarX
+{
+	namespace TileRender
+	{
+		namespace
+		{
+			bool gEnabled = false;
+			int gTileSize = 128;
+			bool gRecording = false;
+
+			std::vector<std::function<void()>>& pending()
+			{
+				static std::vector<std::function<void()>>* v = new std::vector<std::function<void()>>();
+				return *v;
+			}
+		}
+
+		void setEnabled(bool on)
+		{
+			gEnabled = on;
+		}
+
+		bool enabled()
+		{
+			return gEnabled;
+		}
+
+		void setTileSize(int px)
+		{
+			gTileSize = (std::max)(16, px);
+		}
+
+		int tileSize()
+		{
+			return gTileSize;
+		}
+
+		bool beginFrame()
+		{
+#if SX_BACKEND_HEADLESS
+			if (!gEnabled || gRecording)
+				return false;
+			StellarX::Headless::beginTiledFrame(gTileSize);
+			gRecording = true;
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void endFrame()
+		{
+			if (!gRecording)
+				return;
+#if SX_BACKEND_HEADLESS
+			StellarX::Headless::endTiledFrame();
+#endif
+			gRecording = false;
+			// 回调里可能再登记（例如触发重绘），先换出再执行
+			std::vector<std::function<void()>> fns;
+			fns.swap(pending());
+			for (auto& fn : fns)
+				fn();
+		}
+
+		bool recording()
+		{
+			return gRecording;
+		}
+
+		void afterFrame(std::function<void()> fn)
+		{
+			if (gRecording)
+				pending().push_back(std::move(fn));
+			else
+				fn();
+		}
+	}
+}
@@ -191,18 +191,20 @@ void TabControl::setY(int y)
 
 void TabControl::draw()
 {
-	if (!dirty || !show)return;
-	   // 绘制画布背景和基本形状及其子画布控件
+	if (!isDirty() || !show)return;
+	   // 绘制画布背景和基本形状及其子画布控件；半透明时页签与页面画完再一起合成
+	++translucentHold;
 	Canvas::draw();
+	--translucentHold;
+	markChildrenDirty();
 	for (auto& c : controls)
-	{
-		c.first->setDirty(true);
 		c.first->draw();
-	}
 	for (auto& c : controls)
-	{
-		c.second->setDirty(true);
 		c.second->draw();
+	if (translucent())
+	{
+		endTranslucent();
+		markDisplayListPresented();
 	}
 
 	// 首次绘制时处理默认激活页签
@@ -346,6 +348,41 @@ void TabControl::setIsVisible(bool visible)
 	}
 }
 
+bool TabControl::sharesBody(const Control* child, int x, int y, int w, int h) const
+{
+	if (!bodyCovers(x, y, w, h))
+		return false;
+	auto overlaps = [&](const Control* c) {
+		if (!c->IsVisible())
+			return false;
+		const RECT rc = c->getDamageRect();
+		return rc.left < x + w && x < rc.right && rc.top < y + h && y < rc.bottom;
+	};
+	for (auto& tab : controls)
+	{
+		if (tab.first.get() == child)
+			return true;
+		if (overlaps(tab.first.get()))
+			return false;
+	}
+	for (auto& tab : controls)
+	{
+		if (tab.second.get() == child)
+			return true;
+		if (overlaps(tab.second.get()))
+			return false;
+	}
+	return false;
+}
+
+std::size_t TabControl::snapshotBytes() const
+{
+	std::size_t bytes = Canvas::snapshotBytes();
+	for (auto& tab : controls)
+		bytes += tab.first->snapshotBytes() + tab.second->snapshotBytes();
+	return bytes;
+}
+
 void TabControl::onWindowResize()
 {
 	// 调用基类的窗口变化处理，丢弃快照并标记脏
@@ -404,16 +441,6 @@ int TabControl::indexOf(const std::string& tabText) const
 	return idx;
 }
 
-void TabControl::setDirty(bool dirty)
-{
-	this->dirty = dirty;
-	for (auto& c : controls)
-	{
-		c.first->setDirty(dirty);
-		c.second->setDirty(dirty);
-	}
-}
-
 void TabControl::requestRepaint(Control* parent)
 {
 	if (shouldDeferManagedRepaint())
@@ -426,6 +453,13 @@ void TabControl::requestRepaint(Control* parent)
 
 	if (this == parent)
 	{
+		// 半透明时页签与页面是整体合成的，不能单独重画
+		if (translucent())
+		{
+			dirty = true;
+			draw();
+			return;
+		}
 		for (auto& control : controls)
 		{
 			if (control.first->isDirty() && control.first->IsVisible())
@@ -439,10 +473,26 @@ void TabControl::requestRepaint(Control* parent)
 		onRequestRepaintAsRoot();
 }
 
+void TabControl::collectDamageRects(std::vector<RECT>& out) const
+{
+	if (isDirty() || !hasSnap || translucent())
+	{
+		Control::collectDamageRects(out);
+		return;
+	}
+	for (auto& control : controls)
+	{
+		if (control.first->IsVisible() && control.first->isDirty())
+			control.first->collectDamageRects(out);
+		if (control.second->IsVisible() && control.second->isDirty())
+			control.second->collectDamageRects(out);
+	}
+}
+
 bool TabControl::canCommitManagedPartialRepaint() const
 {
 	// TabControl 只有在自己本体不脏且背景快照有效时，才允许只更新脏页签/脏页面。
-	return show && !dirty && hasValidBackgroundSnapshot();
+	return show && !isDirty() && hasValidBackgroundSnapshot() && !translucent();
 }
 
 void TabControl::commitManagedRepaint()
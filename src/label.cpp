@@ -1,4 +1,8 @@
 ﻿#include "Label.h"
+#include "SxHash.h"
+#include "SxLayerCache.h"
+#include "SxRenderState.h"
+#include "SxTextMetrics.h"
 
 Label::Label()
 	:Control(0, 0, 0, 0)
@@ -20,39 +24,150 @@ Label::Label(int x, int y, std::string text, COLORREF textcolor, COLORREF bkColo
 
 void Label::draw()
 {
-	if (dirty && show)
+	if (isDirty() && show)
 	{
 		saveStyle();
-		if (textBkDisap)
-			setbkmode(TRANSPARENT); //设置背景透明
-		else
+		// 图层缓存：内容键与上次绘制相同说明尺寸未变，可跳过字体设置与文本度量
+		const std::uint64_t contentKey = layerCacheEnabled
+			? StellarX::hashString(text, StellarX::hashControlText(textStyle, StellarX::hashValue(textBkDisap ? 0u : (unsigned)textBkColor + 1u)))
+			: 0;
+		const bool sizeKnown = layerCacheEnabled && contentKey == layerContentKey;
+		if (!sizeKnown)
 		{
-			setbkmode(OPAQUE); //设置背景不透明
-			setbkcolor(textBkColor); //设置背景颜色
+			if (layerCacheEnabled)
+				applyTextStyle();
+			else
+				recordDisplayList();
+			const int newWidth = StellarX::measureTextWidth(text);
+			const int newHeight = StellarX::measureTextHeight(text);
+			if (newWidth != this->width || newHeight != this->height)
+			{
+				if (hasSnap)
+					discardBackground();
+				this->width = newWidth;
+				this->height = newHeight;
+			}
 		}
-		settextcolor(textStyle.color);
-		settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-			textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-			textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);   //设置字体样式
-
-		const int newWidth = textwidth(text.c_str());
-		const int newHeight = textheight(text.c_str());
-		if (newWidth != this->width || newHeight != this->height)
+		// 直接绘制路径：文本、样式与屏幕都没变时不必回贴与重放
+		if (layerCacheEnabled || !displayListCurrent())
 		{
-			if (hasSnap)
-				discardBackground();
-			this->width = newWidth;
-			this->height = newHeight;
+			if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width) || (saveHeight != this->height) || !hasValidBackgroundSnapshot())
+				saveBackground(this->x, this->y, this->width, this->height);
+			// 恢复背景（清除旧内容）
+			restBackground();
+			if (layerCacheEnabled)
+			{
+				if (!beginTranslucent(contentKey))
+				{
+					drawLayer(contentKey);
+					endTranslucent();
+				}
+			}
+			else
+			{
+				if (!beginTranslucent(displayList.hash()))
+				{
+					displayList.replay();
+					endTranslucent();
+				}
+				markDisplayListPresented();
+			}
 		}
-		if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width) || (saveHeight != this->height) || !saveBkImage)
-			saveBackground(this->x, this->y, this->width, this->height);
-		// 恢复背景（清除旧内容）
-		restBackground();
-		outtextxy(x, y, LPCTSTR(text.c_str()));
 		restoreStyle();
 		dirty = false;
 	}
 }
+
+bool Label::isPresentationCurrent()
+{
+	// 图层缓存路径不经显示列表
+	if (!show || layerCacheEnabled)
+		return false;
+	saveStyle();
+	recordDisplayList();
+	const bool current = displayListCurrent();
+	restoreStyle();
+	return current;
+}
+
+void Label::recordDisplayList()
+{
+	displayList.clear();
+	if (textBkDisap)
+		displayList.setBkMode(TRANSPARENT); //设置背景透明
+	else
+	{
+		displayList.setBkMode(OPAQUE); //设置背景不透明
+		displayList.setBkColor(textBkColor); //设置背景颜色
+	}
+	displayList.setTextColor(textStyle.color);
+	displayList.setTextStyle(textStyle);   //设置字体样式
+	displayList.text(x, y, text);
+}
+
+void Label::applyTextStyle()
+{
+	auto& rs = StellarX::RenderState::Get();
+	if (textBkDisap)
+		rs.setBkMode(TRANSPARENT); //设置背景透明
+	else
+	{
+		rs.setBkMode(OPAQUE); //设置背景不透明
+		rs.setBkColor(textBkColor); //设置背景颜色
+	}
+	rs.setTextColor(textStyle.color);
+	rs.setTextStyle(textStyle);   //设置字体样式
+}
+
+void Label::drawLayer(std::uint64_t contentKey)
+{
+	if (width <= 0 || height <= 0)
+		return;
+	SetWorkingImage(nullptr);
+	// 透明背景的像素取决于底图，底图也并入键；不透明背景下文字单元格会整块覆盖
+	const std::uint64_t underlay = textBkDisap ? StellarX::LayerCache::hashScreenRect(x, y, width, height, 0) : 0;
+	const std::uint64_t key = textBkDisap ? StellarX::hashValue(underlay, contentKey) : contentKey;
+	std::string identity = layerIdentity(underlay);
+	auto& cache = StellarX::LayerCache::Get();
+	if (const IMAGE* layer = cache.find(key, identity))
+	{
+		putimage(x, y, layer);
+		layerContentKey = contentKey;
+		return;
+	}
+
+	// 未命中：以当前底图为起点在离屏表面上渲染，再贴回屏幕
+	auto layer = std::make_unique<IMAGE>(width, height);
+	getimage(layer.get(), x, y, width, height);
+	// 切换绘图目标后设备状态不同（EasyX 每个 IMAGE 各自保存绘图状态），前后都让跟踪器重新读回
+	SetWorkingImage(layer.get());
+	StellarX::RenderState::Get().invalidate();
+	applyTextStyle();
+	outtextxy(0, 0, LPCTSTR(text.c_str()));
+	SetWorkingImage(nullptr);
+	StellarX::RenderState::Get().invalidate();
+	putimage(x, y, layer.get());
+	cache.store(key, std::move(identity), std::move(layer));
+	layerContentKey = contentKey;
+}
+
+std::string Label::layerIdentity(std::uint64_t underlay) const
+{
+	std::string id = text;
+	auto put = [&id](const auto& v) { id.append(reinterpret_cast<const char*>(&v), sizeof(v)); };
+	id.push_back('\0');
+	for (LPCTSTR f = textStyle.lpszFace; f && *f; ++f)
+		put(*f);
+	id.push_back('\0');
+	put(textStyle.nHeight); put(textStyle.nWidth); put(textStyle.color);
+	put(textStyle.nEscapement); put(textStyle.nOrientation); put(textStyle.nWeight);
+	put(textStyle.bItalic); put(textStyle.bUnderline); put(textStyle.bStrikeOut);
+	put(textBkDisap); put(textBkColor);
+	put(width); put(height);
+	put(underlay);
+	return id;
+}
+
 //用于“隐藏提示框”时调用（还原并释放快照）
 void Label::hide()
 {
@@ -76,3 +191,9 @@ void Label::setText(std::string text)
 	this->text = text;
 	this->dirty = true;
 }
+
+void Label::setLayerCacheEnabled(bool on)
+{
+	layerCacheEnabled = on;
+	this->dirty = true;
+}
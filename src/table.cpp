@@ -1,5 +1,7 @@
 ﻿#include "Table.h"
 #include "SxLog.h"
+#include "SxRenderState.h"
+#include "SxTextMetrics.h"
 
 namespace
 {
@@ -26,57 +28,143 @@ namespace
 	}
 }
 
-// 绘制表格的当前页
-// 使用双循环绘制行和列，考虑分页偏移
-void Table::drawTable()
+// 列偏移只随列宽变化：布局时（initTextWaH / setWidth）算一次，记录单元格时直接查表
+void Table::layoutColumns()
 {
-	if (lineHeights.empty() || colWidths.empty())
+	colX.assign(colWidths.size() + 1, 0);
+	for (size_t j = 0; j < colWidths.size(); ++j)
+		colX[j + 1] = colX[j] + colWidths[j] + TABLE_COL_GAP;
+
+	// 列宽不小于文本宽度、各列文本不高于行高基准（lineHeights[0]）时，文本不会越出自己的单元格
+	cellsFitText = minColWidths.size() == colWidths.size();
+	for (size_t j = 0; cellsFitText && j < colWidths.size(); ++j)
+		cellsFitText = colWidths[j] >= minColWidths[j] && lineHeights[j] <= lineHeights[0];
+}
+
+// 表头与当前页能否合批（见 drawRows）。合批与逐格绘制像素相同的条件：
+//  - 线型为实线或无线：虚线的图案按每格轮廓起算，无法合并；
+//  - 既有底色又有网格时线宽为奇数：居中的画笔在轮廓两侧对称，一条格线不论由哪一格描出都落在同一批像素上，
+//    逐格时后一格的底色覆盖前一格的边框之处，后一格自己的边框会再描一遍；偶数线宽多出的 1 像素偏向哪一侧
+//    随后端而定（GDI 与无头后端不保证一致），不合批；
+//  - 文本在格内、边框不压到文本（文本距格边 TABLE_PAD_Y）、每行列数一致。
+bool Table::canBatchPage() const
+{
+	const bool fill = StellarX::FillMode::Null != tableFillMode;
+	const bool line = StellarX::LineStyle::Null != tableLineStyle;
+	if (line && StellarX::LineStyle::Solid != tableLineStyle)
+		return false;
+
+	const int penW = tableBorderWidth > 1 ? tableBorderWidth : 1;
+	if (!cellsFitText || penW - 1 - (penW - 1) / 2 >= TABLE_PAD_Y || (fill && line && penW % 2 == 0))
+		return false;
+
+	const size_t cols = colWidths.size();
+	if (!headers.empty() && headers.size() != cols)
+		return false;
+	const size_t startRow = (size_t)(currentPage - 1) * rowsPerPage;
+	for (size_t i = startRow; i < startRow + (size_t)rowsPerPage && i < data.size(); ++i)
+		if (data[i].size() != cols)
+			return false;
+	return true;
+}
+
+// 绘制若干等高的行：rows[k] 为第 k 行各单元格的文本，top 为首行上沿。
+// 合批时记录进显示列表：按组（约 TABLE_BATCH_PIXELS 像素的若干行）下发“底色带 → 网格 → 文本”；否则逐格“填充+描边 → 文本”直接画。
+// 合批只用与逐格绘制相同的图元（边框仍由 fillrectangle 的画笔描出），后端各自的画笔规则因此一致生效。
+// 分组是为了软件光栅：整页先填底色再描线、再出文本要把整页像素来回写三遍，按组写时后两遍都落在缓存里
+void Table::drawRows(const std::vector<const std::vector<std::string>*>& rows, int top, int rowH, bool batched)
+{
+	const size_t cols = colWidths.size();
+	if (rows.empty() || cols == 0 || colX.size() != cols + 1)
 		return;
 
 	const int border = tableBorderWidth > 0 ? tableBorderWidth : 0;
+	const int left = x + border;
 
-	// 表体从“表头之下”开始
-	dX = x + border;
-	dY = y + border + lineHeights.at(0) + TABLE_HEADER_EXTRA;          // 表头高度
-	uY = dY + lineHeights.at(0) + TABLE_ROW_EXTRA;
+	if (!batched)
+	{
+		for (size_t k = 0; k < rows.size(); ++k)
+		{
+			const int t = top + rowH * (int)k;
+			const auto& row = *rows[k];
+			for (size_t j = 0; j < row.size() && j < cols; ++j)
+			{
+				fillrectangle(left + colX[j], t, left + colX[j + 1], t + rowH);
+				outtextxy(left + colX[j] + TABLE_PAD_X, t + TABLE_PAD_Y, LPCTSTR(row[j].c_str()));
+			}
+		}
+		return;
+	}
 
-	size_t startRow = (currentPage - 1) * rowsPerPage;
-	size_t endRow = startRow + (size_t)rowsPerPage < data.size() ? startRow + (size_t)rowsPerPage : data.size();
+	const int right = left + colX[cols];
+	const bool fill = StellarX::FillMode::Null != tableFillMode;
+	const bool line = StellarX::LineStyle::Null != tableLineStyle;
+	const size_t group = (std::max)((size_t)1, (size_t)(TABLE_BATCH_PIXELS / (std::max)(1, colX[cols] * rowH)));
 
-	for (size_t i = startRow; i < endRow; ++i)
+	for (size_t k0 = 0; k0 < rows.size(); k0 += group)
 	{
-		for (size_t j = 0; j < data[i].size(); ++j)
+		const size_t k1 = (std::min)(rows.size(), k0 + group);
+		const int t0 = top + rowH * (int)k0, t1 = top + rowH * (int)k1;
+		if (!line)
 		{
-			uX = dX + colWidths.at(j) + TABLE_COL_GAP;
-			fillrectangle(dX, dY, uX, uY);
-			outtextxy(dX + TABLE_PAD_X, dY + TABLE_PAD_Y, LPCTSTR(data[i][j].c_str()));
-			dX += colWidths.at(j) + TABLE_COL_GAP;
+			// 只有底色：空笔下整块 fillrectangle，右下边缘的取舍与逐格填充相同，画刷按设备原点对齐
+			displayList.fillRect(left, t0, right, t1);
+		}
+		else
+		{
+			// 底色带（无边框）：格线处的底色随后被边框盖住；下一组的底色压到本组末行底线的部分，
+			// 由下一组首行的边框重描，与逐格时后一格重描边框相同
+			if (fill)
+				displayList.solidRect(left, t0, right, t1);
+			// 网格：每列、每行各一个只描边的矩形（空画刷）。每条格线的左 / 右（上 / 下）两侧轮廓都被描到，
+			// 交点处的转角也与逐格描边相同
+			displayList.setFillStyle(BS_NULL);
+			for (size_t j = 0; j < cols; ++j)
+				displayList.fillRect(left + colX[j], t0, left + colX[j + 1], t1);
+			for (size_t k = k0; k < k1; ++k)
+				displayList.fillRect(left, top + rowH * (int)k, right, top + rowH * (int)(k + 1));
+			displayList.setFillStyle((int)tableFillMode);
+		}
+		for (size_t k = k0; k < k1; ++k)
+		{
+			const int t = top + rowH * (int)k + TABLE_PAD_Y;
+			const auto& row = *rows[k];
+			for (size_t j = 0; j < cols; ++j)
+				displayList.text(left + colX[j] + TABLE_PAD_X, t, row[j]);
 		}
-		dX = x + border;
-		dY = uY;
-		uY = dY + lineHeights.at(0) + TABLE_ROW_EXTRA;
 	}
 }
 
-void Table::drawHeader()
+// 绘制表格的当前页（考虑分页偏移）
+void Table::drawTable(bool batched)
+{
+	if (lineHeights.empty() || colWidths.empty())
+		return;
+
+	const int border = tableBorderWidth > 0 ? tableBorderWidth : 0;
+	// 表体从“表头之下”开始
+	const int top = y + border + lineHeights.at(0) + TABLE_HEADER_EXTRA;
+
+	const size_t startRow = (size_t)(currentPage - 1) * rowsPerPage;
+	const size_t endRow = startRow + (size_t)rowsPerPage < data.size() ? startRow + (size_t)rowsPerPage : data.size();
+
+	std::vector<const std::vector<std::string>*> rows;
+	rows.reserve(endRow > startRow ? endRow - startRow : 0);
+	for (size_t i = startRow; i < endRow; ++i)
+		rows.push_back(&data[i]);
+	drawRows(rows, top, lineHeights.at(0) + TABLE_ROW_EXTRA, batched);
+}
+
+void Table::drawHeader(bool batched)
 {
 	if (headers.empty() || lineHeights.empty() || colWidths.empty())
 		return;
 
 	const int border = tableBorderWidth > 0 ? tableBorderWidth : 0;
 	// 内容区原点 = x+border, y+border
-	dX = x + border;
-	dY = y + border;
-	uY = dY + lineHeights.at(0) + TABLE_HEADER_EXTRA;
-
-	for (size_t i = 0; i < headers.size(); i++)
-	{
-		uX = dX + colWidths.at(i) + TABLE_COL_GAP;                // 注意这里是 +20，和表体一致
-		fillrectangle(dX, dY, uX, uY);
-		outtextxy(dX + TABLE_PAD_X, dY + TABLE_PAD_Y, LPCTSTR(headers[i].c_str()));
-		dX += colWidths.at(i) + TABLE_COL_GAP;                    // 列间距 20
-	}
+	drawRows({ &headers }, y + border, lineHeights.at(0) + TABLE_HEADER_EXTRA, batched);
 }
+
 // 遍历所有数据单元和表头，计算每列的最大宽度和每行的最大高度，
 // 为后续绘制表格单元格提供尺寸依据。此计算在数据变更时自动触发。
 void Table::initTextWaH()
@@ -95,13 +183,17 @@ void Table::initTextWaH()
 	colWidths.assign(maxCols, 0);
 	lineHeights.assign(maxCols, 0);
 
+	// 同一字体下逐格度量：字体键只取一次，重复的单元格文本直接命中度量缓存
+	auto& metrics = StellarX::TextMeasureCache::Get();
+	const std::uint64_t font = metrics.activeFontKey();
+
 	// 先看数据
 	for (size_t i = 0; i < data.size(); ++i)
 	{
 		for (size_t j = 0; j < data[i].size(); ++j)
 		{
-			const int w = textwidth(LPCTSTR(data[i][j].c_str()));
-			const int h = textheight(LPCTSTR(data[i][j].c_str()));
+			const int w = metrics.width(font, data[i][j]);
+			const int h = metrics.height(font, data[i][j]);
 			if (w > colWidths[j])   colWidths[j] = w;
 			if (h > lineHeights[j]) lineHeights[j] = h;
 		}
@@ -109,8 +201,8 @@ void Table::initTextWaH()
 	// 再用表头更新（谁大取谁）
 	for (size_t j = 0; j < headers.size(); ++j)
 	{
-		const int w = textwidth(LPCTSTR(headers[j].c_str()));
-		const int h = textheight(LPCTSTR(headers[j].c_str()));
+		const int w = metrics.width(font, headers[j]);
+		const int h = metrics.height(font, headers[j]);
 		if (w > colWidths[j])   colWidths[j] = w;
 		if (h > lineHeights[j]) lineHeights[j] = h;
 	}
@@ -122,7 +214,7 @@ void Table::initTextWaH()
 		if (h > maxLineH)
 			maxLineH = h;
 	if (maxLineH == 0)
-		maxLineH = textheight(LPCTSTR("A"));
+		maxLineH = StellarX::measureTextHeight("A");
 	if (rowsPerPage < 1)
 		rowsPerPage = 1;
 
@@ -130,6 +222,8 @@ void Table::initTextWaH()
 	for (size_t j = 0; j < colWidths.size(); ++j) {
 		colWidths[j] += 2 * padX;
 	}
+	minColWidths = colWidths;
+	layoutColumns();
 
 	// 表内容总宽 = Σ(列宽 + 列间距)
 	int contentW = 0;
@@ -142,8 +236,8 @@ void Table::initTextWaH()
 	const int rowsH = rowH * rowsPerPage;
 
 	// 页脚：
-	const int pageTextH = textheight(LPCTSTR(pageNumtext.c_str()));
-	const int btnTextH = textheight(LPCTSTR("上一页"));
+	const int pageTextH = StellarX::measureTextHeight(pageNumtext);
+	const int btnTextH = StellarX::measureTextHeight("上一页");
 	const int btnPadV = TABLE_BTN_TEXT_PAD_V;
 	const int btnH = btnTextH + 2 * btnPadV;
 	const int footerPad = TABLE_FOOTER_PAD;
@@ -163,12 +257,12 @@ void Table::initButton()
 	const int padH = TABLE_BTN_PAD_H;
 	const int padV = TABLE_BTN_PAD_V;                                  // 按钮垂直内边距
 
-	int pageW = textwidth(LPCTSTR(pageNumtext.c_str()));
-	int lblH = textheight(LPCTSTR(pageNumtext.c_str()));
+	int pageW = StellarX::measureTextWidth(pageNumtext);
+	int lblH = StellarX::measureTextHeight(pageNumtext);
 
 	// 统一按钮尺寸（用按钮文字自身宽高 + padding）
-	int prevW = textwidth(LPCTSTR(TABLE_STR_PREV)) + padH * 2;
-	int nextW = textwidth(LPCTSTR(TABLE_STR_NEXT)) + padH * 2;
+	int prevW = StellarX::measureTextWidth(TABLE_STR_PREV) + padH * 2;
+	int nextW = StellarX::measureTextWidth(TABLE_STR_NEXT) + padH * 2;
 	int btnH = lblH + padV * 2;
 
 	// 基于“页码标签”的矩形来摆放：
@@ -254,7 +348,7 @@ void Table::initPageNum()
 
 	// 按理来说 x + (this->width - textW) / 2;就可以
 	// 但是在绘制时，发现控件偏右，因此减去40
-	int textW = textwidth(LPCTSTR(pageNumtext.c_str()));
+	int textW = StellarX::measureTextWidth(pageNumtext);
 	pX = x + TABLE_PAGE_TEXT_OFFSET_X + (this->width - textW) / 2;
 
 	if (!pageNum)
@@ -348,6 +442,7 @@ void Table::setWidth(int width)
 		if (newWidth < 1) newWidth = 1;
 		colWidths[i] = newWidth;
 	}
+	layoutColumns();
 	this->width = width;
 	// 需要重新布局页脚元素
 	isNeedButtonAndPageNum = true;
@@ -372,53 +467,20 @@ void Table::draw()
 	// 在一些容器中，Table不会被立即绘制可能导致事件事件传递时触发空指针警报
 	// 由于单元格初始化依赖字体数据所以先设置一次字体样式
 	// 先保存当前绘图状态
-	saveStyle();
-
-	// 设置表格样式
-	setfillcolor(tableBkClor);
-	setlinecolor(tableBorderClor);
-	settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-		textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-		textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
-	settextcolor(textStyle.color);
-	setlinestyle((int)tableLineStyle, tableBorderWidth);
-	setfillstyle((int)tableFillMode);
-	// 是否需要计算单元格尺寸
+	// 是否需要计算单元格尺寸（度量只依赖字体）
 	if (isNeedCellSize)
 	{
+		saveStyle();
+		StellarX::RenderState::Get().setTextStyle(textStyle);
 		initTextWaH();
 		isNeedCellSize = false;
+		restoreStyle();
 	}
-	restoreStyle();
-	if (this->dirty && this->show)
+	if (isDirty() && this->show)
 	{
 		// 先保存当前绘图状态
 		saveStyle();
 
-		// 设置表格样式
-		setfillcolor(tableBkClor);
-		setlinecolor(tableBorderClor);
-		settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-			textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-			textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
-		settextcolor(textStyle.color);
-		setlinestyle((int)tableLineStyle, tableBorderWidth);
-		setfillstyle((int)tableFillMode);
-		setbkmode(TRANSPARENT);
-
-		if (isNeedDrawHeaders)
-		{
-			// 重新设置表格样式
-			setfillcolor(tableBkClor);
-			setlinecolor(tableBorderClor);
-			settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-				textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-				textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
-			settextcolor(textStyle.color);
-			setlinestyle((int)tableLineStyle, tableBorderWidth);
-			setfillstyle((int)tableFillMode);
-			setbkmode(TRANSPARENT);
-		}
 		// 在绘制前先恢复并更新背景快照：
 		// 如果已有快照且尺寸发生变化，先恢复旧快照以清除上一次绘制，然后丢弃旧快照再重新抓取新的区域。
 		if (hasSnap)
@@ -426,7 +488,7 @@ void Table::draw()
 			// 始终先恢复旧背景，清除上一帧内容
 			restBackground();
 			// 当尺寸变化或缓存图像无效时，需要重新截图
-			if (!saveBkImage || saveWidth != this->width || saveHeight != this->height)
+			if (!hasValidBackgroundSnapshot() || saveWidth != this->width || saveHeight != this->height)
 			{
 				invalidateBackgroundSnapshot();
 				saveBackground(this->x, this->y, this->width, this->height);
@@ -439,12 +501,35 @@ void Table::draw()
 		}
 		// 恢复最新的背景，保证绘制区域干净
 		restBackground();
-		// 绘制表头
-
-		//if (!headers.empty())
-			drawHeader();
-		// 绘制当前页
-		drawTable();
+		// 设置表格样式（只设一次）。能合批时表头与当前页先记录成一份显示列表再整体下发；
+		// 逐格绘制时直接画，不再把两千多个字符串多录一遍
+		const bool batched = canBatchPage();
+		displayList.clear();
+		if (batched)
+		{
+			displayList.setFillColor(tableBkClor);
+			displayList.setLineColor(tableBorderClor);
+			displayList.setTextStyle(textStyle);
+			displayList.setTextColor(textStyle.color);
+			displayList.setLineStyle((int)tableLineStyle, tableBorderWidth);
+			displayList.setFillStyle((int)tableFillMode);
+			displayList.setBkMode(TRANSPARENT);
+		}
+		else
+		{
+			auto& rs = StellarX::RenderState::Get();
+			rs.setFillColor(tableBkClor);
+			rs.setLineColor(tableBorderClor);
+			rs.setTextStyle(textStyle);
+			rs.setTextColor(textStyle.color);
+			rs.setLineStyle((int)tableLineStyle, tableBorderWidth);
+			rs.setFillStyle((int)tableFillMode);
+			rs.setBkMode(TRANSPARENT);
+		}
+		drawHeader(batched);
+		drawTable(batched);
+		if (batched)
+			displayList.replay();
 		// 绘制页码标签
 		drawPageNum();
 
@@ -647,6 +732,15 @@ void Table::onWindowResize()
 	}
 }
 
+std::size_t Table::snapshotBytes() const
+{
+	std::size_t bytes = Control::snapshotBytes();
+	for (const Control* c : { (const Control*)prevButton.get(), (const Control*)nextButton.get(), (const Control*)pageNum.get() })
+		if (c)
+			bytes += c->snapshotBytes();
+	return bytes;
+}
+
 int Table::getCurrentPage() const
 {
 	return this->currentPage;
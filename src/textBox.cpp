@@ -1,6 +1,9 @@
 ﻿// TextBox.cpp
 #include "TextBox.h"
 #include "SxLog.h"
+#include "SxRenderState.h"
+#include "SxTextMetrics.h"
+#include "SxTextFit.h"
 
 TextBox::TextBox(int x, int y, int width, int height, std::string text, StellarX::TextBoxmode mode, StellarX::ControlShape shape)
 	:Control(x, y, width, height), text(text), mode(mode), shape(shape)
@@ -10,92 +13,121 @@ TextBox::TextBox(int x, int y, int width, int height, std::string text, StellarX
 
 void TextBox::draw()
 {
-	if (dirty && show)
+	if (isDirty() && show)
 	{
 		saveStyle();
-		setfillcolor(textBoxBkClor);
-		setlinecolor(textBoxBorderClor);
-		if (textStyle.nHeight > height)
-			textStyle.nHeight = height;
-		if (textStyle.nWidth > width)
-			textStyle.nWidth = width;
-		settextstyle(textStyle.nHeight, textStyle.nWidth, textStyle.lpszFace,
-			textStyle.nEscapement, textStyle.nOrientation, textStyle.nWeight,
-			textStyle.bItalic, textStyle.bUnderline, textStyle.bStrikeOut);
-
-		settextcolor(textStyle.color);
-		setbkmode(TRANSPARENT);
-		
-		int text_width = 0;
-		int text_height = 0;
-		std::string pwdText;
-		std::string displayText;  // 用于显示的文本（可能被截断）
-		bool isTextTruncated = false;  // 标记文本是否被截断
-		
-		if (StellarX::TextBoxmode::PASSWORD_MODE == mode)
-		{
-			for (size_t i = 0; i < text.size(); ++i)
-				pwdText += '*';
-			displayText = pwdText;
-		}
-		else
+		recordDisplayList();
+		// 文本、样式与屏幕都没变时不必回贴与重放
+		if (!displayListCurrent())
 		{
-			displayText = text;
-		}
-
-		// 计算可用宽度（留出左右边距）
-		int availableWidth = width - 20;  // 左右各10像素边距
-		
-		// 截断文本以适应可用宽度
-		int currentWidth = textwidth(LPCTSTR(displayText.c_str()));
-		if (currentWidth > availableWidth && availableWidth > 0)
-		{
-			// 需要截断文本，预留空间放置省略号
-			int ellipsisWidth = textwidth("...");
-			int truncatedWidth = availableWidth - ellipsisWidth;
-			
-			std::string truncatedText = displayText;
-			while (truncatedText.size() > 0 && textwidth(LPCTSTR(truncatedText.c_str())) > truncatedWidth)
+			if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width) || (saveHeight != this->height) || !hasValidBackgroundSnapshot())
+				saveBackground(this->x, this->y, this->width, this->height);
+			// 恢复背景（清除旧内容）
+			restBackground();
+			if (!beginTranslucent(displayList.hash()))
 			{
-				truncatedText.pop_back();
+				displayList.replay();
+				endTranslucent();
 			}
-			displayText = truncatedText + "...";
-			isTextTruncated = true;
-			currentWidth = textwidth(LPCTSTR(displayText.c_str()));
-		}
-		
-		text_width = currentWidth;
-		text_height = textheight(LPCTSTR(displayText.c_str()));
-
-		if ((saveBkX != this->x) || (saveBkY != this->y) || (!hasSnap) || (saveWidth != this->width) || (saveHeight != this->height) || !saveBkImage)
-			saveBackground(this->x, this->y, this->width, this->height);
-		// 恢复背景（清除旧内容）
-		restBackground();
-		//根据形状绘制
-		switch (shape)
-		{
-		case StellarX::ControlShape::RECTANGLE:
-			fillrectangle(x, y, x + width, y + height);//有边框填充矩形
-			outtextxy(x + 10, (y + (height - text_height) / 2), LPCTSTR(displayText.c_str()));
-			break;
-		case StellarX::ControlShape::B_RECTANGLE:
-			solidrectangle(x, y, x + width, y + height);//无边框填充矩形
-			outtextxy(x + 10, (y + (height - text_height) / 2), LPCTSTR(displayText.c_str()));
-			break;
-		case StellarX::ControlShape::ROUND_RECTANGLE:
-			fillroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//有边框填充圆角矩形
-			outtextxy(x + 10, (y + (height - text_height) / 2), LPCTSTR(displayText.c_str()));
-			break;
-		case StellarX::ControlShape::B_ROUND_RECTANGLE:
-			solidroundrect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//无边框填充圆角矩形
-			outtextxy(x + 10, (y + (height - text_height) / 2), LPCTSTR(displayText.c_str()));
-			break;
+			markDisplayListPresented();
 		}
 		restoreStyle();
 		dirty = false;     //标记不需要重绘
 	}
 }
 
+bool TextBox::isPresentationCurrent()
+{
+	if (!show)
+		return false;
+	saveStyle();
+	recordDisplayList();
+	const bool current = displayListCurrent();
+	restoreStyle();
+	return current;
+}
+
+void TextBox::recordDisplayList()
+{
+	displayList.clear();
+	displayList.setFillColor(textBoxBkClor);
+	// 填充模式固定为实心，不随外层画布的空心填充走（不透明分类依赖于此）
+	displayList.setFillStyle((int)StellarX::FillMode::Solid);
+	displayList.setLineColor(textBoxBorderClor);
+	if (textStyle.nHeight > height)
+		textStyle.nHeight = height;
+	if (textStyle.nWidth > width)
+		textStyle.nWidth = width;
+	displayList.setTextStyle(textStyle);
+
+	displayList.setTextColor(textStyle.color);
+	displayList.setBkMode(TRANSPARENT);
+
+	int text_width = 0;
+	int text_height = 0;
+	std::string pwdText;
+	std::string displayText;  // 用于显示的文本（可能被截断）
+	bool isTextTruncated = false;  // 标记文本是否被截断
+	
+	if (StellarX::TextBoxmode::PASSWORD_MODE == mode)
+	{
+		for (size_t i = 0; i < text.size(); ++i)
+			pwdText += '*';
+		displayText = pwdText;
+	}
+	else
+	{
+		displayText = text;
+	}
+
+	// 计算可用宽度（留出左右边距）
+	int availableWidth = width - 20;  // 左右各10像素边距
+	
+	// 截断文本以适应可用宽度
+	int currentWidth = StellarX::measureTextWidth(displayText);
+	if (currentWidth > availableWidth && availableWidth > 0)
+	{
+		// 需要截断文本，预留空间放置省略号
+		int ellipsisWidth = StellarX::measureTextWidth("...");
+		int truncatedWidth = availableWidth - ellipsisWidth;
+		
+		// 二分查找能放下的最长整字符前缀（不撕裂 GBK 双字节）
+		displayText = displayText.substr(0, StellarX::fitTextPrefix(displayText, truncatedWidth)) + "...";
+		isTextTruncated = true;
+		currentWidth = StellarX::measureTextWidth(displayText);
+	}
+	
+	text_width = currentWidth;
+	text_height = StellarX::measureTextHeight(displayText);
+
+	//根据形状绘制
+	switch (shape)
+	{
+	case StellarX::ControlShape::RECTANGLE:
+		displayList.fillRect(x, y, x + width, y + height);//有边框填充矩形
+		displayList.text(x + 10, (y + (height - text_height) / 2), displayText);
+		break;
+	case StellarX::ControlShape::B_RECTANGLE:
+		displayList.solidRect(x, y, x + width, y + height);//无边框填充矩形
+		displayList.text(x + 10, (y + (height - text_height) / 2), displayText);
+		break;
+	case StellarX::ControlShape::ROUND_RECTANGLE:
+		displayList.fillRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//有边框填充圆角矩形
+		displayList.text(x + 10, (y + (height - text_height) / 2), displayText);
+		break;
+	case StellarX::ControlShape::B_ROUND_RECTANGLE:
+		displayList.solidRoundRect(x, y, x + width, y + height, rouRectangleSize.ROUND_RECTANGLEwidth, rouRectangleSize.ROUND_RECTANGLEheight);//无边框填充圆角矩形
+		displayList.text(x + 10, (y + (height - text_height) / 2), displayText);
+		break;
+	}
+}
+
+bool TextBox::isOpaque() const
+{
+	// 快照为 [x, x+width) × [y, y+height)，实心矩形填充把它整块盖满
+	return !translucent() && (shape == StellarX::ControlShape::RECTANGLE || shape == StellarX::ControlShape::B_RECTANGLE);
+}
+
 bool TextBox::handleEvent(const ExMessage& msg)
 {
 	if (!show) return false;
@@ -134,21 +166,21 @@ bool TextBox::handleEvent(const ExMessage& msg)
 		if (StellarX::TextBoxmode::INPUT_MODE == mode)
 		{
 			std::vector<char> temp(maxCharLen + 1, '\0');
-			dirty = InputBox(temp.data(), (int)maxCharLen + 1, "输入框", NULL, text.c_str(), NULL, NULL, false);
+			dirty = InputBox(temp.data(), (int)maxCharLen + 1, "输入框", NULL, text.c_str(), 0, 0, false);
 			if (dirty) text = temp.data();
 			consume = true;
 		}
 		else if (StellarX::TextBoxmode::READONLY_MODE == mode)
 		{
 			dirty = false;
-			InputBox(NULL, (int)maxCharLen, "输出框（输入无效！）", NULL, text.c_str(), NULL, NULL, false);
+			InputBox(NULL, (int)maxCharLen, "输出框（输入无效！）", NULL, text.c_str(), 0, 0, false);
 			consume = true;
 		}
 		else if (StellarX::TextBoxmode::PASSWORD_MODE == mode)
 		{
 			std::vector<char> temp(maxCharLen + 1, '\0');
 			// 不记录明文，只记录长度变化
-			dirty = InputBox(temp.data(), (int)maxCharLen + 1, "输入框\n不可见输入，覆盖即可", NULL, NULL, NULL, NULL, false);
+			dirty = InputBox(temp.data(), (int)maxCharLen + 1, "输入框\n不可见输入，覆盖即可", NULL, NULL, 0, 0, false);
 			if (dirty) text = temp.data();
 			consume = true;
 		}
@@ -166,7 +198,7 @@ bool TextBox::handleEvent(const ExMessage& msg)
 
 	if (dirty)
 		requestRepaint(parent);
-	markEventVisualChanged(dirty);
+	markEventVisualChanged(static_cast<bool>(dirty));
 
 	if (click)
 		click = false;
@@ -239,7 +271,13 @@ void TextBox::setText(std::string text)
 	}
 	else
 		if (hasSnap)
-			draw();
+		{
+			// 合成器模式下交给 Window 按损伤区合成，避免越过上层对话框直接画
+			if (usesCompositor())
+				onRequestRepaintAsRoot();
+			else
+				draw();
+		}
 	
 }
 
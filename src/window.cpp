@@ -1,7 +1,14 @@
 ﻿#include "Window.h"
 #include "Dialog.h"
 #include"SxLog.h"
-#include <easyx.h>
+#include "SxRenderState.h"
+#include "SxOcclusion.h"
+#include "SxTileRender.h"
+#include "SxImageCache.h"
+#include "SxPresent.h"
+#include "SxShapeMask.h"
+#include "SxRedrawScheduler.h"
+#include "SxEventLoop.h"
 #include <algorithm>
 // 可能频繁出现且对调试信息干扰较大的消息（例如鼠标移动），
 // 可以在日志输出时特殊处理以减少干扰。
@@ -27,10 +34,27 @@ static const char* SxMsgName(UINT m)
 	}
 }
 
-static bool SxRectsIntersect(const RECT& a, const RECT& b)
+static StellarX::Region SxRegionFromRect(const RECT& rc)
 {
-	return a.left < b.right && a.right > b.left &&
-		a.top < b.bottom && a.bottom > b.top;
+	return StellarX::Region(rc.left, rc.top, rc.right, rc.bottom);
+}
+
+static bool SxRegionIntersects(const StellarX::Region& rgn, const RECT& rc)
+{
+	return rgn.intersects(rc.left, rc.top, rc.right, rc.bottom);
+}
+
+// 把区域转换为 GDI 区域句柄（调用方负责 DeleteObject）
+static HRGN SxCreateRegionHandle(const StellarX::Region& rgn)
+{
+	HRGN out = CreateRectRgn(0, 0, 0, 0);
+	rgn.forEachRect([out](int l, int t, int r, int b)
+		{
+			HRGN part = CreateRectRgn(l, t, r, b);
+			CombineRgn(out, out, part, RGN_OR);
+			DeleteObject(part);
+		});
+	return out;
 }
 
 bool Window::isManagedDispatchActive() const
@@ -44,38 +68,75 @@ bool Window::isManagedDispatchActive() const
  * 关键点：
  *  - source 是真正发生视觉变化的控件；
  *  - root 是后续真正安全重绘的最小层级（通常是顶层控件/容器，或 Dialog 自身）；
- *  - coverage 记录这次变化影响的范围，用于判断哪些上层 Dialog 需要补画。
+ *  - coverage 记录这次变化影响的范围（区域并集），用于判断哪些上层 Dialog 需要补画；
+ *    同一 root 的多笔请求只累加真正变化的矩形，不再合并为外接矩形。
  */
 void Window::requestManagedRepaint(Control* source)
 {
 	if (!source)
 		return;
 
+	if (useCompositor)
+	{
+		// 显示列表与屏幕像素都未变（虚假重绘）：不登记损伤区
+		if (source->isPresentationCurrent())
+		{
+			source->setDirty(false);
+			return;
+		}
+
+		// 合成器：直接按 source 实际变化的范围登记损伤区，不再区分 root 能否局部提交
+		std::vector<RECT> rects;
+		source->collectDamageRects(rects);
+		for (const RECT& rc : rects)
+			invalidateRect(rc);
+		managedSceneDirty = true;
+
+		// 不在窗口容器中的 root（模态对话框）需要在合成时最后补画
+		Control* root = source->getManagedRepaintRoot();
+		auto owns = [root](const std::vector<std::unique_ptr<Control>>& v)
+			{
+				return std::any_of(v.begin(), v.end(), [root](const std::unique_ptr<Control>& c) { return c.get() == root; });
+			};
+		if (root && !owns(controls) && !owns(dialogs)
+			&& std::find(composeExtraRoots.begin(), composeExtraRoots.end(), root) == composeExtraRoots.end())
+			composeExtraRoots.push_back(root);
+
+		// 分发期之外（如模态对话框自身的循环）没有统一收口，立即合成
+		if (!managedDispatchActive && !compositing)
+			flushManagedRepaint();
+		return;
+	}
+
 	managedSceneDirty = true;
 	Control* root = source->getManagedRepaintRoot();
 	if (!root)
 		return;
 
-	RECT coverage = root->getBoundsRect();
+	// 可局部提交时只记 source 实际变化的范围：容器登记自己时取其脏子控件，而不是整个容器
+	StellarX::Region coverage;
 	if (root->canCommitManagedPartialRepaint())
-		coverage = source->getBoundsRect();
+	{
+		std::vector<RECT> rects;
+		source->collectDamageRects(rects);
+		for (const RECT& rc : rects)
+			coverage.unite(SxRegionFromRect(rc));
+	}
+	else
+		coverage = SxRegionFromRect(root->getBoundsRect());
 
-	for (auto& item : managedRepaintItems)
+	auto found = managedRepaintIndex.find(root);
+	if (found != managedRepaintIndex.end())
 	{
-		if (item.root == root)
-		{
-			item.coverage.left = (std::min)(item.coverage.left, coverage.left);
-			item.coverage.top = (std::min)(item.coverage.top, coverage.top);
-			item.coverage.right = (std::max)(item.coverage.right, coverage.right);
-			item.coverage.bottom = (std::max)(item.coverage.bottom, coverage.bottom);
-			return;
-		}
+		managedRepaintItems[found->second].coverage.unite(coverage);
+		return;
 	}
 
 	ManagedRepaintItem item;
 	item.root = root;
-	item.coverage = coverage;
-	managedRepaintItems.push_back(item);
+	item.coverage = std::move(coverage);
+	managedRepaintIndex.emplace(root, managedRepaintItems.size());
+	managedRepaintItems.push_back(std::move(item));
 }
 
 // 清空本轮托管重绘状态；通常在 flush/全场景重绘/resize 收口后调用
@@ -83,6 +144,198 @@ void Window::clearManagedRepaintState()
 {
 	managedSceneDirty = false;
 	managedRepaintItems.clear();
+	managedRepaintIndex.clear();
+	damageRegion.clear();
+	composeExtraRoots.clear();
+}
+
+bool Window::isCompositorEnabled() const
+{
+	return useCompositor;
+}
+
+/**
+ * setCompositorEnabled(on)
+ * 作用：切换“抓屏快照回贴”与“损伤区合成”两种局部重绘方式。
+ * 说明：
+ *  - 合成器模式下，控件的 saveBackground 只记录范围，不再 getimage；restBackground 为空操作；
+ *  - 批量绘制缓冲在两帧之间保持不变，充当保留的后台帧，收口时只在损伤区内重画；
+ *  - 两种模式的快照含义不同，切换时全部作废并整场景重画一次。
+ */
+void Window::setCompositorEnabled(bool on)
+{
+	if (useCompositor == on)
+		return;
+
+	SX_LOGI("Window") << SX_T("合成器：", "compositor: ") << (on ? "on" : "off");
+	useCompositor = on;
+	StellarX::RedrawScheduler::cancel();
+	for (auto& c : controls)
+		c->onWindowResize();
+	for (auto& d : dialogs)
+		d->onWindowResize();
+	clearManagedRepaintState();
+
+	if (hWnd)
+	{
+		BeginBatchDraw();
+		redrawScene(true, true);
+		EndBatchDraw();
+		clearManagedRepaintState();
+	}
+}
+
+/**
+ * invalidateRect(rc)
+ * 作用：登记一块损伤区。
+ * 规则：先裁剪到客户区，再并入损伤区域；区域并集天然去重，
+ *       同一次收口内同一像素只会被合成一次，且不会把两块远离的损伤区之间的空白卷入。
+ */
+void Window::invalidateRect(const RECT& rc)
+{
+	if (!useCompositor)
+		return;
+
+	damageRegion.unite(StellarX::Region(
+		(std::max)((int)rc.left, 0), (std::max)((int)rc.top, 0),
+		(std::min)((int)rc.right, width), (std::min)((int)rc.bottom, height)));
+	managedSceneDirty = true;
+}
+
+/**
+ * composeDamage()
+ * 作用：逐块合成本轮损伤区，返回各轮合成范围的并集（即本轮写过的屏幕像素，用于局部提交）。
+ * 说明：合成过程中控件可能因尺寸变化再登记损伤区（例如 Label 文本变长），
+ *       这些新区域在同一次收口内继续处理；轮数有上限，保证收口有界。
+ */
+StellarX::Region Window::composeDamage()
+{
+	compositing = true;
+	StellarX::Region touched;
+	for (int pass = 0; pass < 4 && !damageRegion.isEmpty(); ++pass)
+	{
+		StellarX::Region damage = std::move(damageRegion);
+		damageRegion.clear();
+		composeRegion(damage);
+		touched.unite(damage);
+	}
+	damageRegion.clear();
+	compositing = false;
+	return touched;
+}
+
+// 在损伤区域内按层级重画：窗口背景 → 相交的顶层控件 → 相交的对话框 → 未注册 root
+void Window::composeRegion(const StellarX::Region& damage)
+{
+	SX_LOG_TRACE("Compose") << SX_T("合成损伤区：矩形数=", "compose region: rects=")
+		<< damage.rectCount() << SX_T(" 面积=", " area=") << damage.area();
+
+	HRGN rgn = SxCreateRegionHandle(damage);
+	setcliprgn(rgn);
+	DeleteObject(rgn);
+	StellarX::ShapeMaskCache::Get().setClip(&damage);   // 掩码直接写像素缓冲，不经 GDI 裁剪
+	composeClipRegion = &damage;
+	StellarX::RenderState::DrawPass pass;
+
+	if (!bkImageFile.empty())
+		drawWindowBackground();          // 整图回贴，由裁剪区限定实际写入范围
+	else
+	{
+		StellarX::RenderState::Get().setBkColor(wBkcolor);
+		clearcliprgn();
+	}
+
+	// 遮挡剔除：损伤区内被上层实心控件完全盖住的层不画
+	std::vector<Control*> layers;
+	layers.reserve(controls.size() + dialogs.size() + composeExtraRoots.size());
+	for (auto& c : controls)
+		layers.push_back(c.get());
+	for (auto& d : dialogs)
+		layers.push_back(d.get());
+	for (auto* r : composeExtraRoots)
+		layers.push_back(r);
+	std::vector<char> culled;
+	StellarX::Occlusion::cull(layers, &damage, culled);
+
+	for (size_t i = 0; i < layers.size(); ++i)
+	{
+		Control* c = layers[i];
+		if (!c || !c->IsVisible() || !SxRegionIntersects(damage, c->getDamageRect()))
+			continue;
+		c->setDirty(!culled[i]);
+		if (!culled[i])
+			c->draw();
+	}
+
+	StellarX::ShapeMaskCache::Get().setClip(nullptr);
+	composeClipRegion = nullptr;
+	setcliprgn(NULL);
+}
+
+void Window::redrawSceneProgressive()
+{
+	namespace RS = StellarX::RedrawScheduler;
+	if (!useCompositor || !RS::enabled() || !hWnd)
+	{
+		BeginBatchDraw();
+		redrawScene(true, true);
+		EndBatchDraw();
+		return;
+	}
+
+	// 优先项：光标下的最上层 root（对话框在普通控件之上），其次是最上层的可见对话框
+	POINT pt{ -1, -1 };
+	if (GetCursorPos(&pt))
+		ScreenToClient(hWnd, &pt);
+	auto hit = [&pt](const std::vector<std::unique_ptr<Control>>& v) -> Control*
+		{
+			for (auto it = v.rbegin(); it != v.rend(); ++it)
+			{
+				if (!(*it)->IsVisible())
+					continue;
+				const RECT rc = (*it)->getBoundsRect();
+				if (pt.x >= rc.left && pt.x < rc.right && pt.y >= rc.top && pt.y < rc.bottom)
+					return it->get();
+			}
+			return nullptr;
+		};
+	Control* underCursor = hit(dialogs);
+	if (!underCursor)
+		underCursor = hit(controls);
+	Control* topDialog = nullptr;
+	for (auto it = dialogs.rbegin(); it != dialogs.rend() && !topDialog; ++it)
+		if ((*it)->IsVisible())
+			topDialog = it->get();
+
+	std::vector<RECT> priority;
+	if (underCursor)
+		priority.push_back(underCursor->getDamageRect());
+	if (topDialog && topDialog != underCursor)
+		priority.push_back(topDialog->getDamageRect());
+	progressiveFocus = pt;
+	RS::schedule(StellarX::Region(0, 0, width, height), priority, pt);
+	SX_LOGD("Redraw") << SX_T("渐进重绘：已登记，优先项=", "progressive redraw scheduled, priority items=") << priority.size();
+	runProgressiveFrame();
+}
+
+void Window::runProgressiveFrame()
+{
+	BeginBatchDraw();
+	// 每项自带背景（composeRegion 先清背景再画控件），未画到的块不提交：
+	// 尺寸刚变化时缓冲里的无效像素不会被显示出来，也不必为首帧铺满整屏背景
+	// 合成过程中控件新登记的损伤区（快照范围变化、标签变宽等）并入计划，算作同一次重绘，不在本帧超出预算地补画
+	compositing = true;
+	const StellarX::Region touched = StellarX::RedrawScheduler::runFrame([this](const StellarX::Region& item)
+		{
+			composeRegion(item);
+			if (!damageRegion.isEmpty())
+			{
+				StellarX::RedrawScheduler::schedule(damageRegion, {}, progressiveFocus);
+				damageRegion.clear();
+			}
+		});
+	compositing = false;
+	StellarX::Present::endBatch(touched, width, height);
 }
 
 void Window::drawWindowBackground()
@@ -91,34 +344,99 @@ void Window::drawWindowBackground()
 	{
 		if (!background || background->getwidth() != width || background->getheight() != height)
 		{
-			background = std::make_unique<IMAGE>();
-			loadimage(background.get(), bkImageFile.c_str(), width, height, true);
+			// 解码后的源像素常驻 ImageCache：尺寸变化只在内存中缩放，不再读盘；
+			// 首次使用时在后台解码，期间以纯色背景占位，就绪后由事件循环整场景重绘
+			auto& cache = StellarX::ImageCache::Get();
+			if (cache.enabled())
+			{
+				if (!bkAsset || bkAsset->width() != width || bkAsset->height() != height)
+				{
+					releaseBkAsset();
+					bkAsset = cache.acquire(bkImageFile, width, height);
+					if (bkAsset->pending())
+						bkAssetWaiter = bkAsset->whenReady([this]
+							{
+								bkAssetWaiter = 0;
+								bkImageArrived = true;
+							});
+				}
+				background = bkAsset->image();
+			}
+			else
+			{
+				background = std::make_shared<IMAGE>();
+				loadimage(background.get(), bkImageFile.c_str(), width, height, true);
+			}
+		}
+		if (background)
+		{
+			putimage(0, 0, background.get());
+			return;
 		}
-		putimage(0, 0, background.get());
-	}
-	else
-	{
-		setbkcolor(wBkcolor);
-		cleardevice();
 	}
+	StellarX::RenderState::Get().setBkColor(wBkcolor);
+	cleardevice();
+}
+
+void Window::releaseBkAsset()
+{
+	if (bkAsset && bkAssetWaiter)
+		bkAsset->cancel(bkAssetWaiter);
+	bkAssetWaiter = 0;
+	bkAsset.reset();
 }
 
 void Window::redrawScene(bool forceControlsDirty, bool forceDialogsDirty)
 {
+	// 合成器模式下整屏重绘可分块并行光栅化（见 SxTileRender.h）；控件仍在本线程依次 draw()
+	const bool tiled = useCompositor && StellarX::TileRender::beginFrame();
+	StellarX::RenderState::DrawPass pass;
+
 	drawWindowBackground();
 
-	for (auto& c : controls)
+	// 合成器模式下做遮挡剔除：完全压在实心对话框/画布下面的控件不画（快照模式见 SxOcclusion.h 的限制）
+	std::vector<char> culled;
+	if (useCompositor)
+	{
+		std::vector<Control*> layers;
+		layers.reserve(controls.size() + dialogs.size());
+		for (auto& c : controls)
+			layers.push_back(c.get());
+		for (auto& d : dialogs)
+			layers.push_back(d.get());
+		StellarX::Occlusion::cull(layers, nullptr, culled);
+	}
+	auto isCulled = [&culled](size_t i) { return i < culled.size() && culled[i]; };
+
+	// 整场景标脏只记代号，不逐个 setDirty：顶层控件与之比较，容器画本体时再标记自己的子树
+	if (forceControlsDirty)
+		sceneControls = true;
+	if (forceDialogsDirty)
+		sceneDialogs = true;
+
+	for (size_t i = 0; i < controls.size(); ++i)
 	{
-		if (forceControlsDirty)
-			c->setDirty(true);
+		auto& c = controls[i];
+		if (isCulled(i))
+		{
+			c->setDirty(false);
+			continue;
+		}
 		c->draw();
 	}
-	for (auto& d : dialogs)
+	for (size_t i = 0; i < dialogs.size(); ++i)
 	{
-		if (forceDialogsDirty && d->IsVisible())
-			d->setDirty(true);
+		auto& d = dialogs[i];
+		if (isCulled(controls.size() + i))
+		{
+			d->setDirty(false);
+			continue;
+		}
 		d->draw();
 	}
+
+	if (tiled)
+		StellarX::TileRender::endFrame();
 }
 
 /**
@@ -130,40 +448,89 @@ void Window::redrawScene(bool forceControlsDirty, bool forceDialogsDirty)
  *  3）最后把相交的 Dialog 补画回最上层。
  * 说明：
  *  - 这里不做整场景重画，而是只画本轮登记的 root；
- *  - 之所以按 controls 顺序提交，而不是按登记顺序，是为了保持顶层控件原有的 z-order。
+ *  - 之所以按 controls 顺序提交，而不是按登记顺序，是为了保持顶层控件原有的 z-order；
+ *  - root 的显示列表与屏幕像素都未变化时（isPresentationCurrent）跳过该 root。
  */
 void Window::flushManagedRepaint()
 {
 	if (!managedSceneDirty || !hWnd)
 		return;
+	// 比较与重画都要设置控件样式：兄弟 root 之间的恢复延后到提交结束
+	StellarX::RenderState::DrawPass pass;
+
+	// 批量绘制结束时只提交本轮写过的矩形（局部提交），而不是整个后台缓冲
+	if (useCompositor)
+	{
+		BeginBatchDraw();
+		const StellarX::Region touched = composeDamage();
+		StellarX::Present::endBatch(touched, width, height);
+		clearManagedRepaintState();
+		return;
+	}
+
+	// 显示列表与屏幕像素都未变的 root 不提交，也不因它补画对话框；全部未变时连提交(present)都省掉
+	std::vector<char> current(managedRepaintItems.size(), 0);
+	bool anyChanged = false;
+	for (size_t i = 0; i < managedRepaintItems.size(); ++i)
+	{
+		Control* root = managedRepaintItems[i].root;
+		const bool ownedByWindow = std::any_of(controls.begin(), controls.end(),
+			[root](const std::unique_ptr<Control>& c) { return c.get() == root; });
+		if (ownedByWindow && root->IsVisible() && root->isPresentationCurrent())
+		{
+			root->setDirty(false);
+			current[i] = 1;
+		}
+		else
+			anyChanged = true;
+	}
+	if (!anyChanged && !managedRepaintItems.empty())
+	{
+		clearManagedRepaintState();
+		return;
+	}
 
 	BeginBatchDraw();
-	std::vector<Control*> overlayDialogs;
+	std::vector<char> overlayMask(dialogs.size(), 0);
+
+	for (size_t i = 0; i < managedRepaintItems.size(); ++i)
+		if (!current[i])
+			collectManagedDialogOverlays(managedRepaintItems[i].root, managedRepaintItems[i].coverage, overlayMask);
 
-	for (auto& item : managedRepaintItems)
-		collectManagedDialogOverlays(item.root, item.coverage, overlayDialogs);
+	// 本轮写过的屏幕范围：提交前收集（绘制后脏标记与旧快照范围都会被刷新）
+	StellarX::Region touched;
+	auto touch = [&touched](const RECT& rc) { touched.unite(rc.left, rc.top, rc.right, rc.bottom); };
 
 	for (auto& control : controls)
 	{
-		for (auto& item : managedRepaintItems)
+		auto found = managedRepaintIndex.find(control.get());
+		if (found != managedRepaintIndex.end() && !current[found->second] && control->IsVisible())
 		{
-			if (item.root == control.get() && item.root && item.root->IsVisible())
-			{
-				item.root->commitManagedRepaint();
-				break;
-			}
+			// 局部提交只重画脏子控件；否则整个 root 连同旧快照范围一起重画
+			std::vector<RECT> rects;
+			if (control->canCommitManagedPartialRepaint())
+				control->collectDamageRects(rects);
+			else
+				rects.push_back(control->getDamageRect());
+			for (const RECT& rc : rects)
+				touch(rc);
+			touched.unite(managedRepaintItems[found->second].coverage);
+			control->commitManagedRepaint();
 		}
 	}
 
-	for (auto& dialog : overlayDialogs)
+	// 按 dialogs 的层级顺序补画，保证上层对话框最后画
+	for (size_t i = 0; i < dialogs.size(); ++i)
 	{
-		if (!dialog || !dialog->IsVisible())
+		Control* dialog = dialogs[i].get();
+		if (!overlayMask[i] || !dialog || !dialog->IsVisible())
 			continue;
+		touch(dialog->getDamageRect());
 		dialog->setDirty(true);
 		dialog->draw();
 	}
 
-	EndBatchDraw();
+	StellarX::Present::endBatch(touched, width, height);
 	clearManagedRepaintState();
 }
 
@@ -179,13 +546,14 @@ void Window::dispatchSyntheticMouseMoveToControls(short x, short y)
 }
 
 /**
- * collectManagedDialogOverlays(repaintRoot, coverage, overlays)
+ * collectManagedDialogOverlays(repaintRoot, coverage, overlayMask)
  * 作用：找出在本轮提交后需要重新盖到最上层的非模态 Dialog。
  * 规则：
  *  - 如果 repaintRoot 本身就是 Dialog，则从它自己开始往上层 Dialog 收集；
- *  - 如果 repaintRoot 是普通控件，则收集所有与 coverage 相交的可见 Dialog。
+ *  - 如果 repaintRoot 是普通控件，则收集所有与 coverage 区域相交的可见 Dialog；
+ *  - 结果按 dialogs 下标标记，天然去重且保持层级顺序。
  */
-void Window::collectManagedDialogOverlays(Control* repaintRoot, const RECT& coverage, std::vector<Control*>& overlays)
+void Window::collectManagedDialogOverlays(Control* repaintRoot, const StellarX::Region& coverage, std::vector<char>& overlayMask)
 {
 	size_t startIdx = 0;
 	if (auto* dialogRoot = dynamic_cast<Dialog*>(repaintRoot))
@@ -206,11 +574,8 @@ void Window::collectManagedDialogOverlays(Control* repaintRoot, const RECT& cove
 		if (!dialog || !dialog->IsVisible())
 			continue;
 
-		if (dialog == repaintRoot || SxRectsIntersect(dialog->getBoundsRect(), coverage))
-		{
-			if (std::find(overlays.begin(), overlays.end(), dialog) == overlays.end())
-				overlays.push_back(dialog);
-		}
+		if (dialog == repaintRoot || SxRegionIntersects(coverage, dialog->getBoundsRect()))
+			overlayMask[i] = 1;
 	}
 }
 
@@ -329,10 +694,13 @@ Window::Window(int w, int h, int mode, COLORREF bk, std::string title)
 
 Window::~Window()
 {
+	// 控件析构时会丢弃快照；此时不再需要登记损伤区
+	useCompositor = false;
 	// 先销毁控件树，再关闭图形环境，避免控件析构时访问已关闭的 EasyX 上下文。
 	dialogs.clear();
 	controls.clear();
 	background.reset();
+	releaseBkAsset();
 	if (hWnd && procHooked && oldWndProc)
 	{
 		SetWindowLongPtr(hWnd, GWLP_WNDPROC, (LONG_PTR)oldWndProc);
@@ -362,6 +730,11 @@ LRESULT CALLBACK Window::WndProcThunk(HWND h, UINT m, WPARAM w, LPARAM l)
 		return DefWindowProc(h, m, w, l);
 	}
 
+	// 事件循环关心的消息：交给原窗口过程处理（入队）之后再唤醒空闲等待，
+	// 先唤醒的话等待方可能在消息入队前就取空返回、再次阻塞而漏掉它
+	const bool wakeLoop = (m >= WM_MOUSEMOVE && m <= WM_MOUSEWHEEL) || (m >= WM_KEYDOWN && m <= WM_SYSKEYUP)
+		|| m == WM_SIZE || m == WM_EXITSIZEMOVE || m == WM_CLOSE;
+
 	// 关键点①：禁止系统擦背景，避免和我们自己的清屏/双缓冲打架造成闪烁
 	if (m == WM_ERASEBKGND)
 	{
@@ -422,6 +795,7 @@ LRESULT CALLBACK Window::WndProcThunk(HWND h, UINT m, WPARAM w, LPARAM l)
 		// 立即解冻重绘标志，同时标记区域为有效，避免触发额外 WM_PAINT。
 		SendMessage(h, WM_SETREDRAW, TRUE, 0);
 		ValidateRect(h, nullptr);
+		StellarX::EventLoop::wake(); // needResizeDirty 已置位
 		return 0;
 	}
 
@@ -439,9 +813,12 @@ LRESULT CALLBACK Window::WndProcThunk(HWND h, UINT m, WPARAM w, LPARAM l)
 		return 0;
 	}
 
-	// 其它消息：回落到旧过程
-	return self->oldWndProc ? CallWindowProc(self->oldWndProc, h, m, w, l)
+	// 其它消息：回落到旧过程（EasyX 在这里把输入放进自己的消息队列），之后再唤醒事件循环
+	const LRESULT r = self->oldWndProc ? CallWindowProc(self->oldWndProc, h, m, w, l)
 		: DefWindowProc(h, m, w, l);
+	if (wakeLoop)
+		StellarX::EventLoop::wake();
+	return r;
 }
 
 // ---------------- 绘制 ----------------
@@ -507,6 +884,7 @@ void Window::draw(std::string imagePath)
 	}
 
 	bkImageFile = std::move(imagePath);
+	StellarX::ImageCache::Get().evict(bkImageFile);   // 显式指定背景图：总是重新读盘
 	if (!headline.empty())
 	{
 		SetWindowText(hWnd, headline.c_str());
@@ -518,11 +896,8 @@ void Window::draw(std::string imagePath)
 	cls &= ~(CS_HREDRAW | CS_VREDRAW);
 	SetClassLongPtr(hWnd, GCL_STYLE, cls);
 
-	if (background)
-	{
-		background.reset();
-	}
-	background = std::make_unique<IMAGE>();
+	background.reset();
+	releaseBkAsset();
 
 	BeginBatchDraw();
 	redrawScene(true, true);
@@ -551,10 +926,15 @@ int Window::runEventLoop()
 	//       不再引入额外 pendingResize 等状态，避免分叉导致状态不一致。
 	while (running)
 	{
-	
+		// 每轮循环至多提交一帧：以此划分绘图状态计数
+		StellarX::RenderState::Get().beginFrame();
+		StellarX::Occlusion::beginFrame();
+		const std::uint64_t progressiveFrames = StellarX::RedrawScheduler::stats().frames;
+
 		bool consume = false; // 事件是否被消费的标志（用于输入事件分发）
 
-		if (peekmessage(&msg, EX_MOUSE | EX_KEY | EX_WINDOW, true))
+		const bool handled = peekmessage(&msg, EX_MOUSE | EX_KEY | EX_WINDOW, true);
+		if (handled)
 		{
 			if (msg.message == WM_CLOSE)
 			{
@@ -638,6 +1018,9 @@ int Window::runEventLoop()
 			managedDispatchActive = false;
 		}
 
+		// 后台解码落地、到期定时器（提示框延时等）、背景图就绪：与模态循环共用
+		pumpAsyncWork();
+
 		// 对话框打开/关闭属于全局层级变化：这里仍然使用整场景重绘兜底，
 		// 并在结束后清空本轮托管重绘登记，避免旧的 root 请求延后提交。
 		bool needredraw = false;
@@ -669,10 +1052,8 @@ int Window::runEventLoop()
 				dialogClose = false; // 重置标志
 			}
 
-			BeginBatchDraw();
 			SX_LOGD("Event") << SX_T("对话框打开/关闭，触发全量重绘", "The dialog box opens/closes, triggering a full redraw");
-			redrawScene(true, true);
-			EndBatchDraw();
+			redrawSceneProgressive();
 			needredraw = false;
 			dialogOpen = false;
 			clearManagedRepaintState();
@@ -740,10 +1121,9 @@ int Window::runEventLoop()
 				}
 
 				// 再次冻结窗口更新，保证批量绘制的原子性
+				// 批量绘制由 redrawSceneProgressive 开始与结束
 				SendMessage(hWnd, WM_SETREDRAW, FALSE, 0);
 
-				BeginBatchDraw();
-
 				// 调整底层画布尺寸
 				if (finalW != width || finalH != height)
 				{
@@ -772,9 +1152,7 @@ int Window::runEventLoop()
 				}
 
 				// 统一批量绘制
-				redrawScene(true, true);
-
-				EndBatchDraw();
+				redrawSceneProgressive();
 
 				// 解冻后标记区域有效，避免系统再次触发 WM_PAINT 覆盖自绘内容。
 				SendMessage(hWnd, WM_SETREDRAW, TRUE, 0);
@@ -790,24 +1168,73 @@ int Window::runEventLoop()
 		if (!needResizeDirty && !dialogOpen && !dialogClose)
 			flushManagedRepaint();
 
-		// 轻微睡眠，削峰填谷（不阻塞拖拽体验）
-		Sleep(10);
+		// 渐进重绘未完成：本轮还没画过就画下一帧，然后直接进入下一轮取消息，不睡眠
+		if (StellarX::RedrawScheduler::pending())
+		{
+			if (StellarX::RedrawScheduler::stats().frames == progressiveFrames)
+				runProgressiveFrame();
+			continue;
+		}
+
+		// 空闲：阻塞到下一条输入、跨线程唤醒（后台解码完成等）或最早的定时器到期，不再固定 Sleep(10) 轮询；
+		// 到期的定时器在下一轮的 pumpAsyncWork 中调用
+		StellarX::EventLoop::wait(EX_MOUSE | EX_KEY | EX_WINDOW, handled);
 	}
 
 	return 1;
 }
 
+bool Window::pumpAsyncWork()
+{
+	// 后台解码完成的图像与到期的定时器在 UI 线程落地：等待者标脏并登记托管重绘，随本轮一并提交
+	managedDispatchActive = true;
+	StellarX::ImageCache::Get().pump();
+	StellarX::EventLoop::runDueTimers();
+	managedDispatchActive = false;
+
+	// 背景图就绪则改变整个画面的底色，走整场景重绘
+	if (!bkImageArrived)
+		return false;
+	bkImageArrived = false;
+	if (needResizeDirty)
+		return false;
+	SX_LOGD("Event") << SX_T("背景图解码完成，触发全量重绘", "Background image decoded, triggering a full redraw");
+	redrawSceneProgressive();
+	clearManagedRepaintState();
+	return true;
+}
+
+bool Window::pumpPendingWork(std::uint64_t progressiveFrames)
+{
+	bool drew = pumpAsyncWork();
+
+	// 模态期间 dialogOpen 一直为真（关闭后由事件循环收口），这里不看它，直接提交托管重绘
+	if (!needResizeDirty && managedSceneDirty)
+	{
+		flushManagedRepaint();
+		drew = true;
+	}
+
+	if (StellarX::RedrawScheduler::pending() && StellarX::RedrawScheduler::stats().frames == progressiveFrames)
+	{
+		runProgressiveFrame();
+		drew = true;
+	}
+	return drew;
+}
+
 // ---------------- 其余接口 ----------------
 
 void Window::setBkImage(std::string pImgFile)
 {
 	// 更换背景图：立即加载并绘制一次；同时将所有控件标 dirty 并重绘
-	background = std::make_unique<IMAGE>();
+	background.reset();
+	releaseBkAsset();
+	StellarX::ImageCache::Get().evict(bkImageFile);
 	bkImageFile = std::move(pImgFile);
+	StellarX::ImageCache::Get().evict(bkImageFile);   // 文件可能已被替换：重新读盘
 
-	BeginBatchDraw();
-	redrawScene(true, true);
-	EndBatchDraw();
+	redrawSceneProgressive();
 }
 
 void Window::setBkcolor(COLORREF c)
@@ -815,11 +1242,11 @@ void Window::setBkcolor(COLORREF c)
 	// 更换纯色背景：立即清屏并批量重绘控件/对话框
 	wBkcolor = c;
 	background.reset();
+	releaseBkAsset();
+	StellarX::ImageCache::Get().evict(bkImageFile);
 	bkImageFile.clear();
 
-	BeginBatchDraw();
-	redrawScene(true, true);
-	EndBatchDraw();
+	redrawSceneProgressive();
 }
 
 void Window::setHeadline(std::string title)
@@ -834,6 +1261,7 @@ void Window::addControl(std::unique_ptr<Control> control)
 {
 	// 新增控件：仅加入管理容器，具体绘制在 draw()/收口时统一进行
 	control->setHostWindow(this);
+	control->setSceneStamp(&sceneControls);
 	controls.push_back(std::move(control));
 }
 
@@ -841,6 +1269,7 @@ void Window::addDialog(std::unique_ptr<Control> dlg)
 {
 	// 新增非模态对话框：管理顺序决定事件优先级（顶层从后往前）
 	dlg->setHostWindow(this);
+	dlg->setSceneStamp(&sceneDialogs);
 	dialogs.push_back(std::move(dlg));
 }
 